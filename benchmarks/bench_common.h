@@ -0,0 +1,25 @@
+/**
+ * @file bench_common.h
+ * @brief 基准共用的工具
+ */
+
+#ifndef ANALYSIS_TOOLKIT_BENCH_COMMON_H
+#define ANALYSIS_TOOLKIT_BENCH_COMMON_H
+
+#include "utility/Logger.h"
+
+namespace AnalysisToolkit {
+namespace Bench {
+
+// 关闭日志输出：被测代码路径中的日志只做级别检查，不影响测量结果
+inline void quietLogger() {
+    Logger* logger = Logger::getInstance();
+    logger->enableConsole(false);
+    logger->enableFile(false);
+    logger->setMinLevel(LogLevel::ERROR);
+}
+
+}  // namespace Bench
+}  // namespace AnalysisToolkit
+
+#endif  // ANALYSIS_TOOLKIT_BENCH_COMMON_H
@@ -0,0 +1,254 @@
+/**
+ * @file bench_hook.cpp
+ * @brief HookManager 查询路径和被 Hook 函数调用开销的基准
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "hook/inline_hook.h"
+
+using namespace AnalysisToolkit;
+
+namespace {
+
+constexpr int kTargetCount = 16;
+
+// 足够长、可被内联 Hook 的目标函数；模板参数保证每个实例的代码不同，不会被合并
+template <int N>
+__attribute__((noinline)) int benchTarget(int value) {
+    volatile int result = value;
+    for (int i = 0; i < 4; ++i) {
+        result = result * 31 + N;
+    }
+    return result;
+}
+
+template <int... N>
+std::vector<void*> targetAddresses(std::integer_sequence<int, N...>) {
+    return {reinterpret_cast<void*>(&benchTarget<N>)...};
+}
+
+// 额外的目标：供并发更新基准反复安装和移除
+__attribute__((noinline)) int churnTarget(int value) {
+    volatile int result = value;
+    for (int i = 0; i < 4; ++i) {
+        result = result * 17 + 3;
+    }
+    return result;
+}
+
+using TargetFunction = int (*)(int);
+
+TargetFunction original_targets[kTargetCount] = {};
+
+template <int N>
+int replacementTarget(int value) {
+    return original_targets[N](value) + 1;
+}
+
+template <int... N>
+std::vector<void*> replacementAddresses(std::integer_sequence<int, N...>) {
+    return {reinterpret_cast<void*>(&replacementTarget<N>)...};
+}
+
+ATKIT_HOOK_DEF_STATS(int, benchStatsTarget, int value) {
+    ATKIT_HOOK_STATS_SCOPE(benchStatsTarget);
+    return ATKIT_HOOK_CALL_ORIGINAL(benchStatsTarget, value) + 1;
+}
+
+TargetFunction original_churn = nullptr;
+
+int replacementChurn(int value) {
+    return original_churn(value) + 1;
+}
+
+// 在整个基准进程中只安装一次的 Hook 集合
+class HookFixture {
+  public:
+    static HookFixture& get() {
+        static HookFixture fixture;
+        return fixture;
+    }
+
+    bool ok() const {
+        return ok_;
+    }
+    const std::vector<void*>& targets() const {
+        return targets_;
+    }
+
+  private:
+    HookFixture() {
+        HookManager* manager = HookManager::getInstance();
+        manager->initialize();
+        targets_ = targetAddresses(std::make_integer_sequence<int, kTargetCount>());
+        std::vector<void*> replacements =
+            replacementAddresses(std::make_integer_sequence<int, kTargetCount>());
+
+        ok_ = true;
+        for (int i = 0; i < kTargetCount; ++i) {
+            void** original = reinterpret_cast<void**>(&original_targets[i]);
+            HookStatus status =
+                manager->hookFunction(targets_[i], replacements[i], original, "bench_target");
+            ok_ = ok_ && status == HookStatus::SUCCESS;
+        }
+    }
+
+    std::vector<void*> targets_;
+    bool ok_ = false;
+};
+
+// 未被 Hook 的函数通过 volatile 函数指针调用，防止被内联或常量折叠
+volatile TargetFunction direct_call = &benchTarget<kTargetCount>;
+
+}  // namespace
+
+// 注册表查询：isHooked / getHookInfo 均为无锁快照读
+void BM_HookIsHooked(benchmark::State& state) {
+    HookFixture& fixture = HookFixture::get();
+    if (!fixture.ok()) {
+        state.SkipWithError("Hook installation failed");
+        return;
+    }
+    HookManager* manager = HookManager::getInstance();
+    const auto& targets = fixture.targets();
+
+    size_t i = static_cast<size_t>(state.thread_index());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(manager->isHooked(targets[i++ % targets.size()]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_HookIsHooked)->ThreadRange(1, 8)->UseRealTime();
+
+void BM_HookGetInfo(benchmark::State& state) {
+    HookFixture& fixture = HookFixture::get();
+    if (!fixture.ok()) {
+        state.SkipWithError("Hook installation failed");
+        return;
+    }
+    HookManager* manager = HookManager::getInstance();
+    const auto& targets = fixture.targets();
+
+    size_t i = static_cast<size_t>(state.thread_index());
+    for (auto _ : state) {
+        auto info = manager->getHookInfo(targets[i++ % targets.size()]);
+        benchmark::DoNotOptimize(info);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_HookGetInfo)->ThreadRange(1, 8)->UseRealTime();
+
+// 零拷贝快照查询
+void BM_HookSnapshotFind(benchmark::State& state) {
+    HookFixture& fixture = HookFixture::get();
+    if (!fixture.ok()) {
+        state.SkipWithError("Hook installation failed");
+        return;
+    }
+    HookManager* manager = HookManager::getInstance();
+    const auto& targets = fixture.targets();
+
+    size_t i = static_cast<size_t>(state.thread_index());
+    for (auto _ : state) {
+        HookSnapshotRef snapshot = manager->acquireSnapshot();
+        benchmark::DoNotOptimize(snapshot.find(targets[i++ % targets.size()]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_HookSnapshotFind)->ThreadRange(1, 8)->UseRealTime();
+
+// 查询期间另一线程不断安装/移除 Hook，测量快照发布对读者的影响；updates 为更新次数
+void BM_HookLookupDuringUpdates(benchmark::State& state) {
+    HookFixture& fixture = HookFixture::get();
+    if (!fixture.ok()) {
+        state.SkipWithError("Hook installation failed");
+        return;
+    }
+    HookManager* manager = HookManager::getInstance();
+    const auto& targets = fixture.targets();
+
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> updates{0};
+    std::thread writer;
+    if (state.thread_index() == 0) {
+        writer = std::thread([&] {
+            void* churn = reinterpret_cast<void*>(&churnTarget);
+            while (!stop.load(std::memory_order_relaxed)) {
+                if (manager->hookFunction(churn,
+                                          reinterpret_cast<void*>(&replacementChurn),
+                                          reinterpret_cast<void**>(&original_churn),
+                                          "bench_churn") == HookStatus::SUCCESS) {
+                    manager->unhookFunction(churn);
+                    updates.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+
+    size_t i = static_cast<size_t>(state.thread_index());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(manager->isHooked(targets[i++ % targets.size()]));
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    if (writer.joinable()) {
+        stop.store(true);
+        writer.join();
+        state.counters["updates"] = static_cast<double>(updates.load());
+    }
+}
+BENCHMARK(BM_HookLookupDuringUpdates)->ThreadRange(1, 8)->UseRealTime();
+
+// 调用开销：原函数 / 被 Hook 的函数（替换函数调用原函数）/ 带统计的 Hook
+void BM_CallDirect(benchmark::State& state) {
+    int value = 1;
+    for (auto _ : state) {
+        value = direct_call(value);
+        benchmark::DoNotOptimize(value);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CallDirect);
+
+void BM_CallHooked(benchmark::State& state) {
+    if (!HookFixture::get().ok()) {
+        state.SkipWithError("Hook installation failed");
+        return;
+    }
+    volatile TargetFunction hooked = &benchTarget<0>;
+    int value = 1;
+    for (auto _ : state) {
+        value = hooked(value);
+        benchmark::DoNotOptimize(value);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CallHooked);
+
+void BM_CallHookedWithStats(benchmark::State& state) {
+    HookManager* manager = HookManager::getInstance();
+    void* target = reinterpret_cast<void*>(&benchTarget<kTargetCount + 1>);
+    if (ATKIT_HOOK_ADDRESS(target, benchStatsTarget) != HookStatus::SUCCESS) {
+        state.SkipWithError("Hook installation failed");
+        return;
+    }
+    manager->setHookStatsEnabled(true);
+
+    volatile TargetFunction hooked = &benchTarget<kTargetCount + 1>;
+    int value = 1;
+    for (auto _ : state) {
+        value = hooked(value);
+        benchmark::DoNotOptimize(value);
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    manager->setHookStatsEnabled(false);
+    manager->unhookFunction(target);
+}
+BENCHMARK(BM_CallHookedWithStats);
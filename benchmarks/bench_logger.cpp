@@ -0,0 +1,177 @@
+/**
+ * @file bench_logger.cpp
+ * @brief Logger 各输出目标和级别的吞吐量基准
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "bench_common.h"
+#include "utility/Logger.h"
+
+using namespace AnalysisToolkit;
+
+namespace {
+
+constexpr const char* kFormat = "hook hit addr=%p seq=%lld tid=%d";
+
+// 输出目标
+enum class LogSink {
+    CONSOLE,      // 标准输出（基准期间重定向到 /dev/null）
+    TEXT_FILE,    // 同步文本文件
+    ASYNC_FILE,   // 异步队列 + 文本文件
+    MAPPED_FILE,  // mmap 轮转文件
+    BINARY_FILE   // 二进制格式（隐含异步）
+};
+
+std::string benchLogPath() {
+    return (std::filesystem::temp_directory_path() /
+            ("atkit_bench_" + std::to_string(getpid()) + ".log"))
+        .string();
+}
+
+void removeBenchLogs(const std::string& path) {
+    std::error_code ignored;
+    std::filesystem::remove(path, ignored);
+    for (int i = 1; i < 8; ++i) {
+        std::filesystem::remove(path + "." + std::to_string(i), ignored);
+    }
+}
+
+// 只输出到 sink，不输出到其它目标；最低级别固定为 INFO，便于测量被过滤的 DEBUG
+bool configureLogger(Logger* logger, LogSink sink, const std::string& path) {
+    logger->disableAsync();
+    logger->setLogFormat(LogFormat::TEXT);
+    logger->enableFile(false);
+    logger->enableConsole(sink == LogSink::CONSOLE);
+    logger->setMinLevel(LogLevel::INFO);
+
+    switch (sink) {
+        case LogSink::CONSOLE:
+            return true;
+        case LogSink::TEXT_FILE:
+            return logger->setLogFile(path);
+        case LogSink::ASYNC_FILE:
+            return logger->setLogFile(path) && logger->enableAsync();
+        case LogSink::MAPPED_FILE:
+            return logger->setRotatingLogFile(path);
+        case LogSink::BINARY_FILE:
+            if (!logger->setLogFile(path)) {
+                return false;
+            }
+            logger->setLogFormat(LogFormat::BINARY);
+            return true;
+    }
+    return false;
+}
+
+void resetLogger(Logger* logger) {
+    logger->flush();
+    logger->disableAsync();
+    logger->setLogFormat(LogFormat::TEXT);
+    Bench::quietLogger();
+}
+
+// 把标准输出临时重定向到 /dev/null，避免控制台基准刷屏
+class StdoutSilencer {
+  public:
+    StdoutSilencer() {
+        fflush(stdout);
+        saved_fd_ = dup(STDOUT_FILENO);
+        int null_fd = open("/dev/null", O_WRONLY);
+        if (null_fd >= 0) {
+            dup2(null_fd, STDOUT_FILENO);
+            close(null_fd);
+        }
+    }
+    ~StdoutSilencer() {
+        fflush(stdout);
+        if (saved_fd_ >= 0) {
+            dup2(saved_fd_, STDOUT_FILENO);
+            close(saved_fd_);
+        }
+    }
+
+  private:
+    int saved_fd_ = -1;
+};
+
+// range(0) 为日志级别：DEBUG 低于最低级别，测量的是过滤开销
+void BM_Log(benchmark::State& state, LogSink sink) {
+    Logger* logger = Logger::getInstance();
+    const LogLevel level = static_cast<LogLevel>(state.range(0));
+    const std::string path = benchLogPath();
+    std::unique_ptr<StdoutSilencer> silencer;
+
+    if (state.thread_index() == 0) {
+        removeBenchLogs(path);
+        if (!configureLogger(logger, sink, path)) {
+            state.SkipWithError("Failed to configure log sink");
+        }
+        if (sink == LogSink::CONSOLE) {
+            silencer = std::make_unique<StdoutSilencer>();
+        }
+    }
+
+    // 与 ATKIT_LOG / ATKIT_BLOG 展开后的运行期路径相同（宏要求级别是编译期常量）
+    static const uint32_t format_id = BinaryLogFormats::registerFormat(kFormat);
+    static constexpr uint64_t string_args = binaryLogStringArgs(kFormat);
+    const uint64_t dropped_before = logger->getDroppedCount();
+    int thread = state.thread_index();
+    long long sequence = 0;
+    for (auto _ : state) {
+        if (logger->isEnabled(level)) {
+            if (sink == LogSink::BINARY_FILE) {
+                logger->logBinary(
+                    level, format_id, string_args, kFormat, &sequence, sequence, thread);
+            } else {
+                logger->log(level, kFormat, &sequence, sequence, thread);
+            }
+        }
+        ++sequence;
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    if (state.thread_index() == 0) {
+        // 包含异步队列的排空时间，否则生产者速度会掩盖写出瓶颈
+        resetLogger(logger);
+        silencer.reset();
+        removeBenchLogs(path);
+        state.counters["dropped"] =
+            static_cast<double>(logger->getDroppedCount() - dropped_before);
+    }
+}
+
+void logLevels(benchmark::internal::Benchmark* bench) {
+    bench->ArgName("level");
+    for (LogLevel level : {LogLevel::DEBUG, LogLevel::INFO, LogLevel::ERROR}) {
+        bench->Arg(static_cast<int64_t>(level));
+    }
+}
+
+}  // namespace
+
+BENCHMARK_CAPTURE(BM_Log, console, LogSink::CONSOLE)->Apply(logLevels);
+BENCHMARK_CAPTURE(BM_Log, text_file, LogSink::TEXT_FILE)
+    ->Apply(logLevels)
+    ->Threads(1)
+    ->Threads(4);
+BENCHMARK_CAPTURE(BM_Log, async_file, LogSink::ASYNC_FILE)
+    ->Apply(logLevels)
+    ->Threads(1)
+    ->Threads(4);
+BENCHMARK_CAPTURE(BM_Log, mapped_file, LogSink::MAPPED_FILE)
+    ->Apply(logLevels)
+    ->Threads(1)
+    ->Threads(4);
+BENCHMARK_CAPTURE(BM_Log, binary_file, LogSink::BINARY_FILE)
+    ->Apply(logLevels)
+    ->Threads(1)
+    ->Threads(4);
@@ -0,0 +1,23 @@
+/**
+ * @file bench_main.cpp
+ * @brief 基准入口：先关闭日志输出，再运行 Google Benchmark
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+#include "bench_common.h"
+
+int main(int argc, char** argv) {
+    AnalysisToolkit::Bench::quietLogger();
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::AddCustomContext("atkit_min_log_level", std::to_string(ATKIT_MIN_LOG_LEVEL));
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,219 @@
+/**
+ * @file bench_memory_parser.cpp
+ * @brief Benchmarks for maps parsing and region lookups versus mapping count
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "utility/MemoryMapSnapshot.h"
+#include "utility/MemoryRegionTable.h"
+#include "utility/ProcessMemoryParser.h"
+
+using namespace AnalysisToolkit;
+
+namespace {
+
+/**
+ * @brief Adds a number of extra entries to the process memory map
+ *
+ * Reserves one anonymous range and makes every other page read-only, so the
+ * kernel cannot merge neighbouring pages and reports each as its own mapping.
+ */
+class ExtraMappings {
+  public:
+    explicit ExtraMappings(size_t count) : page_size_(static_cast<size_t>(getpagesize())) {
+        if (count == 0) {
+            return;
+        }
+        size_ = count * page_size_;
+        void* memory = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                            -1, 0);
+        if (memory == MAP_FAILED) {
+            size_ = 0;
+            return;
+        }
+        base_ = static_cast<uint8_t*>(memory);
+        for (size_t i = 1; i < count; i += 2) {
+            mprotect(base_ + i * page_size_, page_size_, PROT_READ);
+        }
+    }
+    ~ExtraMappings() {
+        if (base_ != nullptr) {
+            munmap(base_, size_);
+        }
+    }
+
+    ExtraMappings(const ExtraMappings&) = delete;
+    ExtraMappings& operator=(const ExtraMappings&) = delete;
+
+    bool ok(size_t count) const {
+        return count == 0 || base_ != nullptr;
+    }
+
+    /**
+     * @brief Random addresses inside the extra mappings (or the stack without any)
+     */
+    std::vector<uintptr_t> sampleAddresses(size_t count) const {
+        std::vector<uintptr_t> addresses(count);
+        std::mt19937_64 rng(42);
+        for (auto& address : addresses) {
+            address = base_ != nullptr ? reinterpret_cast<uintptr_t>(base_) + rng() % size_
+                                       : reinterpret_cast<uintptr_t>(&address);
+        }
+        return addresses;
+    }
+
+  private:
+    size_t page_size_;
+    size_t size_ = 0;
+    uint8_t* base_ = nullptr;
+};
+
+size_t regionCount(ProcessMemoryParser& parser) {
+    auto result = parser.forEachRegion([](const MemoryRegionView&) { return true; });
+    return result.isSuccess() ? result.getValue() : 0;
+}
+
+void requireSupported(benchmark::State& state, const ExtraMappings& extra) {
+    if (!ProcessMemoryParser::isPlatformSupported()) {
+        state.SkipWithError("Platform not supported");
+    } else if (!extra.ok(static_cast<size_t>(state.range(0)))) {
+        state.SkipWithError("Failed to create extra mappings");
+    }
+}
+
+void mappingCounts(benchmark::internal::Benchmark* bench) {
+    bench->ArgName("extra_maps")->Arg(0)->Arg(256)->Arg(4096);
+}
+
+}  // namespace
+
+// Full parse into owning MemoryRegion objects
+void BM_ParseSelf(benchmark::State& state) {
+    ExtraMappings extra(static_cast<size_t>(state.range(0)));
+    requireSupported(state, extra);
+    ProcessMemoryParser parser;
+
+    for (auto _ : state) {
+        auto result = parser.parseSelf();
+        benchmark::DoNotOptimize(result);
+    }
+    state.counters["regions"] = static_cast<double>(regionCount(parser));
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(regionCount(parser)));
+}
+BENCHMARK(BM_ParseSelf)->Apply(mappingCounts);
+
+// Zero-copy visit without building a vector
+void BM_ForEachRegion(benchmark::State& state) {
+    ExtraMappings extra(static_cast<size_t>(state.range(0)));
+    requireSupported(state, extra);
+    ProcessMemoryParser parser;
+
+    for (auto _ : state) {
+        uintptr_t sum = 0;
+        parser.forEachRegion([&sum](const MemoryRegionView& view) {
+            sum += view.start_address;
+            return true;
+        });
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(regionCount(parser)));
+}
+BENCHMARK(BM_ForEachRegion)->Apply(mappingCounts);
+
+// Parse into the compact table with interned strings
+void BM_RegionTableCapture(benchmark::State& state) {
+    ExtraMappings extra(static_cast<size_t>(state.range(0)));
+    requireSupported(state, extra);
+    ProcessMemoryParser parser;
+
+    for (auto _ : state) {
+        auto table = MemoryRegionTable::capture(parser);
+        benchmark::DoNotOptimize(table);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(regionCount(parser)));
+}
+BENCHMARK(BM_RegionTableCapture)->Apply(mappingCounts);
+
+// One address lookup through the parser, which re-reads the maps file
+void BM_ParserFindContaining(benchmark::State& state) {
+    ExtraMappings extra(static_cast<size_t>(state.range(0)));
+    requireSupported(state, extra);
+    ProcessMemoryParser parser;
+    std::vector<uintptr_t> addresses = extra.sampleAddresses(256);
+
+    size_t i = 0;
+    for (auto _ : state) {
+        auto result = parser.findRegionsContaining(addresses[i++ % addresses.size()]);
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ParserFindContaining)->Apply(mappingCounts);
+
+// Address lookups against one snapshot
+void BM_SnapshotFind(benchmark::State& state) {
+    ExtraMappings extra(static_cast<size_t>(state.range(0)));
+    requireSupported(state, extra);
+    auto snapshot = MemoryMapSnapshot::captureSelf();
+    if (snapshot.hasError()) {
+        state.SkipWithError("Failed to capture snapshot");
+        return;
+    }
+    std::vector<uintptr_t> addresses = extra.sampleAddresses(4096);
+
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(snapshot.getValue().find(addresses[i++ % addresses.size()]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SnapshotFind)->Apply(mappingCounts);
+
+// Sorted batch lookups against one snapshot; items are addresses
+void BM_SnapshotFindBatch(benchmark::State& state) {
+    ExtraMappings extra(static_cast<size_t>(state.range(0)));
+    requireSupported(state, extra);
+    auto snapshot = MemoryMapSnapshot::captureSelf();
+    if (snapshot.hasError()) {
+        state.SkipWithError("Failed to capture snapshot");
+        return;
+    }
+    std::vector<uintptr_t> addresses = extra.sampleAddresses(4096);
+    std::sort(addresses.begin(), addresses.end());
+
+    for (auto _ : state) {
+        auto regions = snapshot.getValue().findBatch(addresses);
+        benchmark::DoNotOptimize(regions);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(addresses.size()));
+}
+BENCHMARK(BM_SnapshotFindBatch)->Apply(mappingCounts);
+
+// Address lookups against the compact table
+void BM_RegionTableFind(benchmark::State& state) {
+    ExtraMappings extra(static_cast<size_t>(state.range(0)));
+    requireSupported(state, extra);
+    ProcessMemoryParser parser;
+    auto table = MemoryRegionTable::capture(parser);
+    if (table.hasError()) {
+        state.SkipWithError("Failed to capture region table");
+        return;
+    }
+    std::vector<uintptr_t> addresses = extra.sampleAddresses(4096);
+
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(table.getValue().find(addresses[i++ % addresses.size()]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RegionTableFind)->Apply(mappingCounts);
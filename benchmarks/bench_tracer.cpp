@@ -0,0 +1,153 @@
+/**
+ * @file bench_tracer.cpp
+ * @brief QBDITracer 每条指令的回调开销基准
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "trace/qbdi.h"
+#include "utility/ModuleIndex.h"
+
+using namespace AnalysisToolkit;
+using namespace AnalysisToolkit::Trace;
+
+namespace {
+
+constexpr uint64_t kLoopIterations = 1000;
+
+// 固定的目标循环：无参数，避免依赖 callFunction 的参数传递约定
+extern "C" __attribute__((noinline)) uint64_t benchTraceLoop() {
+    uint64_t value = 0x9e3779b97f4a7c15ULL;
+    for (uint64_t i = 0; i < kLoopIterations; ++i) {
+        value ^= value << 13;
+        value ^= value >> 7;
+        value += i;
+        // 阻止编译器把循环折叠掉
+        __asm__ volatile("" : "+r"(value));
+    }
+    return value;
+}
+
+// 跟踪配置
+enum class TraceVariant {
+    NATIVE,           // 原生执行，作为基线
+    VM_ONLY,          // 在 VM 中执行，不登记回调
+    CALLBACK,         // 每条指令回调，不需要反汇编
+    CALLBACK_DISASM,  // 每条指令回调，附带反汇编文本
+    BASIC_BLOCK       // 基本块模式，只统计覆盖率
+};
+
+std::atomic<uint64_t> callback_count{0};
+
+// 跟踪范围：循环所在模块的可执行段
+bool startLoopTrace(QBDITracer* tracer) {
+    auto address = reinterpret_cast<uintptr_t>(&benchTraceLoop);
+    auto module = ModuleIndex::getInstance().findModuleContaining(address);
+    if (!module.has_value()) {
+        return false;
+    }
+    for (const auto& range : module->executable_ranges) {
+        if (address >= range.first && address < range.second) {
+            return tracer->startTrace(range.first, range.second);
+        }
+    }
+    return false;
+}
+
+bool configureTracer(QBDITracer* tracer, TraceVariant variant) {
+    tracer->stopTrace();
+    tracer->clearInstructionSubscribers();
+    tracer->enableInstructionLogging(false);
+    tracer->setTraceMode(variant == TraceVariant::BASIC_BLOCK ? TraceMode::BasicBlock
+                                                              : TraceMode::Instruction);
+
+    if (variant == TraceVariant::CALLBACK || variant == TraceVariant::CALLBACK_DISASM) {
+        InstructionSubscriber subscriber;
+        subscriber.callback = [](const InstructionInfo& info) {
+            callback_count.fetch_add(1, std::memory_order_relaxed);
+            benchmark::DoNotOptimize(info.address);
+        };
+        subscriber.needs_disassembly = variant == TraceVariant::CALLBACK_DISASM;
+        tracer->addInstructionSubscriber(subscriber);
+    }
+    return startLoopTrace(tracer);
+}
+
+void BM_TraceLoop(benchmark::State& state, TraceVariant variant) {
+    if (variant == TraceVariant::NATIVE) {
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(benchTraceLoop());
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(kLoopIterations));
+        return;
+    }
+
+    if (!Global::initialize() || Global::getTracer() == nullptr) {
+        state.SkipWithError("Failed to initialize trace module");
+        return;
+    }
+    QBDITracer* tracer = Global::getTracer();
+    if (!configureTracer(tracer, variant)) {
+        state.SkipWithError("Failed to start trace");
+        return;
+    }
+
+    const auto target = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(&benchTraceLoop));
+    const uint64_t instructions_before = tracer->getStats().instruction_count;
+    const uint64_t callbacks_before = callback_count.load();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(tracer->callFunction(target));
+    }
+    const uint64_t instructions = tracer->getStats().instruction_count - instructions_before;
+    const uint64_t callbacks = callback_count.load() - callbacks_before;
+
+    tracer->stopTrace();
+    tracer->clearInstructionSubscribers();
+
+    // items 为循环次数，与 NATIVE 基线可比
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(kLoopIterations));
+    if (instructions > 0) {
+        state.counters["insns_per_call"] =
+            static_cast<double>(instructions) / static_cast<double>(state.iterations());
+        state.counters["time_per_insn"] =
+            benchmark::Counter(static_cast<double>(instructions),
+                               benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+    }
+    state.counters["callbacks"] = static_cast<double>(callbacks);
+}
+
+// 批量调用：准备工作和状态快照按批摊销，range(0) 为每批调用次数
+void BM_TraceLoopBatch(benchmark::State& state) {
+    if (!Global::initialize() || Global::getTracer() == nullptr) {
+        state.SkipWithError("Failed to initialize trace module");
+        return;
+    }
+    QBDITracer* tracer = Global::getTracer();
+    if (!configureTracer(tracer, TraceVariant::VM_ONLY)) {
+        state.SkipWithError("Failed to start trace");
+        return;
+    }
+
+    const auto target = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(&benchTraceLoop));
+    const std::vector<std::vector<uint64_t>> arg_sets(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(tracer->callFunctionBatch(target, arg_sets));
+    }
+    tracer->stopTrace();
+
+    state.SetItemsProcessed(state.iterations() * state.range(0) *
+                            static_cast<int64_t>(kLoopIterations));
+}
+
+}  // namespace
+
+BENCHMARK(BM_TraceLoopBatch)->Arg(1)->Arg(64);
+BENCHMARK_CAPTURE(BM_TraceLoop, native, TraceVariant::NATIVE);
+BENCHMARK_CAPTURE(BM_TraceLoop, vm_only, TraceVariant::VM_ONLY);
+BENCHMARK_CAPTURE(BM_TraceLoop, callback, TraceVariant::CALLBACK);
+BENCHMARK_CAPTURE(BM_TraceLoop, callback_disasm, TraceVariant::CALLBACK_DISASM);
+BENCHMARK_CAPTURE(BM_TraceLoop, basic_block, TraceVariant::BASIC_BLOCK);
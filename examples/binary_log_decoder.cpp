@@ -0,0 +1,61 @@
+/**
+ * @file binary_log_decoder.cpp
+ * @brief Offline decoder for LogFormat::BINARY log files
+ *
+ * Usage: binary_log_decoder <log-file>
+ *
+ * Prints one line per record as "<seconds>.<nanoseconds> <level> <message>".
+ */
+
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+
+#include "utility/BinaryLog.h"
+#include "utility/Logger.h"
+
+using namespace AnalysisToolkit;
+
+namespace {
+
+const char* levelName(LogLevel level) {
+    switch (level) {
+        case LogLevel::TRACE:
+            return "T";
+        case LogLevel::DEBUG:
+            return "D";
+        case LogLevel::INFO:
+            return "I";
+        case LogLevel::WARN:
+            return "W";
+        case LogLevel::ERROR:
+            return "E";
+        case LogLevel::FATAL:
+            return "F";
+    }
+    return "?";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <log-file>\n", argv[0]);
+        return 1;
+    }
+
+    bool ok = BinaryLogReader::decodeFile(argv[1], [](const BinaryLogEntry& entry) {
+        printf("%" PRIu64 ".%09" PRIu64 " %s %s\n",
+               entry.timestamp / UINT64_C(1000000000),
+               entry.timestamp % UINT64_C(1000000000),
+               levelName(entry.level),
+               entry.message.c_str());
+        return true;
+    });
+
+    if (!ok) {
+        fprintf(stderr, "failed to decode %s\n", argv[1]);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,91 @@
+/**
+ * @file metrics_dump.cpp
+ * @brief Polls the metrics segment exported by an instrumented process
+ *
+ * Usage: metrics_dump <segment-file> [interval-ms]
+ *
+ * Without an interval the current values are printed once. With an interval the
+ * segment is re-read until interrupted, and counters are also shown as a rate
+ * per second since the previous read. The target process is never stopped.
+ */
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <unordered_map>
+
+#include "utility/Metrics.h"
+
+using namespace AnalysisToolkit;
+
+namespace {
+
+void printSamples(const std::vector<MetricSample>& samples,
+                  const std::unordered_map<std::string, uint64_t>* previous,
+                  double elapsed_seconds) {
+    for (const auto& sample : samples) {
+        if (sample.kind == MetricKind::GAUGE) {
+            printf("%-32s %20" PRId64 "\n", sample.name.c_str(), sample.gaugeValue());
+            continue;
+        }
+        printf("%-32s %20" PRIu64, sample.name.c_str(), sample.value);
+        if (previous != nullptr && elapsed_seconds > 0) {
+            auto it = previous->find(sample.name);
+            uint64_t last = it != previous->end() ? it->second : 0;
+            uint64_t delta = sample.value >= last ? sample.value - last : 0;
+            printf("  %14.1f/s", static_cast<double>(delta) / elapsed_seconds);
+        }
+        printf("\n");
+    }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc != 2 && argc != 3) {
+        fprintf(stderr, "usage: %s <segment-file> [interval-ms]\n", argv[0]);
+        return 1;
+    }
+
+    MetricsReader reader;
+    if (!reader.open(argv[1])) {
+        fprintf(stderr, "cannot open metrics segment %s\n", argv[1]);
+        return 1;
+    }
+    printf("pid %d\n", reader.getPid());
+
+    if (argc == 2) {
+        printSamples(reader.read(), nullptr, 0);
+        return 0;
+    }
+
+    int interval_ms = atoi(argv[2]);
+    if (interval_ms <= 0) {
+        fprintf(stderr, "invalid interval: %s\n", argv[2]);
+        return 1;
+    }
+
+    std::unordered_map<std::string, uint64_t> previous;
+    auto last_read = std::chrono::steady_clock::now();
+    bool first = true;
+    while (true) {
+        std::vector<MetricSample> samples = reader.read();
+        auto now = std::chrono::steady_clock::now();
+        double elapsed = std::chrono::duration<double>(now - last_read).count();
+
+        printf("----\n");
+        printSamples(samples, first ? nullptr : &previous, elapsed);
+        fflush(stdout);
+
+        previous.clear();
+        for (const auto& sample : samples) {
+            previous[sample.name] = sample.value;
+        }
+        last_read = now;
+        first = false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
+    }
+}
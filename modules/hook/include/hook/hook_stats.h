@@ -0,0 +1,133 @@
+#ifndef ANALYSIS_TOOLKIT_HOOK_STATS_H
+#define ANALYSIS_TOOLKIT_HOOK_STATS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "utility/Metrics.h"
+
+namespace AnalysisToolkit {
+
+// 延迟直方图桶数：第 i 个桶统计 [2^i, 2^(i+1)) 纳秒，最后一个桶包含更长的耗时
+constexpr size_t kHookLatencyBuckets = 32;
+
+// 可统计的 Hook 数量上限
+constexpr size_t kMaxHookStats = 256;
+
+// 单个 Hook 的聚合统计
+struct HookStats {
+    std::string name;
+    uint64_t hits = 0;            // 替换函数被调用的次数
+    uint64_t total_ns = 0;        // 替换函数的总耗时（含原函数）
+    uint64_t max_ns = 0;          // 单次调用的最大耗时
+    uint64_t original_calls = 0;  // 通过 ATKIT_HOOK_CALL_ORIGINAL 调用原函数的次数
+    uint64_t original_ns = 0;     // 原函数的总耗时
+    std::array<uint64_t, kHookLatencyBuckets> latency_buckets{};
+
+    uint64_t averageNs() const {
+        return hits == 0 ? 0 : total_ns / hits;
+    }
+
+    // 替换函数自身的开销（总耗时减去原函数耗时）
+    uint64_t selfNs() const {
+        return total_ns > original_ns ? total_ns - original_ns : 0;
+    }
+
+    // 近似分位数：返回包含该分位的桶的上界，p 取 [0, 1]
+    uint64_t percentileNs(double p) const;
+};
+
+// 单个 Hook 的计数器：计数保存在每个线程独立、按缓存行对齐的槽位中，查询时才汇总
+// 必须具有静态存储期（通常由 ATKIT_HOOK_DEF_STATS 定义）
+class HookStatsCounter {
+  public:
+    explicit HookStatsCounter(const char* name);
+
+    HookStatsCounter(const HookStatsCounter&) = delete;
+    HookStatsCounter& operator=(const HookStatsCounter&) = delete;
+
+    // 全局开关，默认关闭；关闭时计时宏不读取时钟
+    static void setEnabled(bool enabled);
+    static bool isEnabled() {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    // 汇总所有线程（包括已退出线程）的计数，按总耗时降序
+    static std::vector<HookStats> collect();
+
+    // 清零全部计数；与记录并发时可能漏掉少量计数
+    static void reset();
+
+    // 记录一次替换函数调用
+    void recordHit(uint64_t elapsed_ns);
+
+    // 记录一次原函数调用
+    void recordOriginal(uint64_t elapsed_ns);
+
+    // 调用原函数并在启用统计时记录其耗时
+    template <typename Func, typename... Args>
+    decltype(auto) callOriginal(Func* original, Args&&... args) {
+        if (!isEnabled()) {
+            return original(std::forward<Args>(args)...);
+        }
+        uint64_t start = now();
+        if constexpr (std::is_void_v<std::invoke_result_t<Func*, Args...>>) {
+            original(std::forward<Args>(args)...);
+            recordOriginal(now() - start);
+        } else {
+            auto result = original(std::forward<Args>(args)...);
+            recordOriginal(now() - start);
+            return result;
+        }
+    }
+
+    static uint64_t now() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                         std::chrono::steady_clock::now().time_since_epoch())
+                                         .count());
+    }
+
+  private:
+    static std::atomic<bool> enabled_;
+
+    uint32_t id_;  // 注册表中的槽位，表满时为 kMaxHookStats（不记录）
+};
+
+// 指标 hook.hits：ATKIT_HOOK_STATS_SCOPE 和插桩回调分发的命中次数，不受统计开关影响
+const MetricCounter& hookHitsMetric();
+
+// 作用域计时：析构时记录一次命中和整个作用域的耗时
+class HookStatsScope {
+  public:
+    explicit HookStatsScope(HookStatsCounter& counter)
+        : counter_(HookStatsCounter::isEnabled() ? &counter : nullptr),
+          start_(counter_ ? HookStatsCounter::now() : 0) {
+        if (MetricsRegistry::isRecording()) {
+            hookHitsMetric().add();
+        }
+    }
+
+    ~HookStatsScope() {
+        if (counter_ != nullptr) {
+            counter_->recordHit(HookStatsCounter::now() - start_);
+        }
+    }
+
+    HookStatsScope(const HookStatsScope&) = delete;
+    HookStatsScope& operator=(const HookStatsScope&) = delete;
+
+  private:
+    HookStatsCounter* counter_;
+    uint64_t start_;
+};
+
+}  // namespace AnalysisToolkit
+
+#endif  // ANALYSIS_TOOLKIT_HOOK_STATS_H
@@ -1,13 +1,16 @@
 #ifndef ANALYSIS_TOOLKIT_HOOK_H
 #define ANALYSIS_TOOLKIT_HOOK_H
 
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "hook/hook_stats.h"
 #include "utility/Logger.h"
 
 #ifdef __ANDROID__
@@ -23,7 +26,8 @@ enum class HookStatus {
     ALREADY_HOOKED = -2,
     INVALID_ADDRESS = -3,
     SYMBOL_NOT_FOUND = -4,
-    MEMORY_ERROR = -5
+    MEMORY_ERROR = -5,
+    PENDING = 1  // 目标库尚未加载，Hook 将在库加载后安装
 };
 
 // Hook 类型枚举
@@ -37,6 +41,9 @@ enum class HookType {
 using HookCallback = std::function<void(void*, void*, void*)>;
 using InstrumentCallback = std::function<void(void*, void*)>;
 
+// 插桩回调 ID，用于注销单个回调
+using InstrumentId = uint64_t;
+
 // Hook 信息结构体
 struct HookInfo {
     void* target_address;
@@ -48,15 +55,115 @@ struct HookInfo {
     bool is_active;
 };
 
+struct HookRegistrySnapshot;
+class MemoryMapSnapshot;
+
+// 只读快照引用：持有期间快照不会被回收，可在 Hook 处理函数中无锁、零拷贝地查询
+// 只应在短作用域内持有：长期持有会阻塞后续的 Hook 安装，持有期间也不要安装或移除 Hook
+class HookSnapshotRef {
+  public:
+    HookSnapshotRef(HookSnapshotRef&& other) noexcept
+        : snapshot_(other.snapshot_), reader_count_(other.reader_count_) {
+        other.snapshot_ = nullptr;
+        other.reader_count_ = nullptr;
+    }
+    HookSnapshotRef(const HookSnapshotRef&) = delete;
+    HookSnapshotRef& operator=(const HookSnapshotRef&) = delete;
+    HookSnapshotRef& operator=(HookSnapshotRef&&) = delete;
+
+    ~HookSnapshotRef() {
+        if (reader_count_ != nullptr) {
+            reader_count_->fetch_sub(1, std::memory_order_release);
+        }
+    }
+
+    // 按目标地址查找活动 Hook（二分查找），不存在时返回 nullptr
+    const HookInfo* find(void* target_address) const;
+
+    // 按目标地址排序的活动 Hook
+    const HookInfo* begin() const;
+    const HookInfo* end() const;
+    size_t size() const;
+
+  private:
+    friend class HookManager;
+
+    HookSnapshotRef(const HookRegistrySnapshot* snapshot, std::atomic<uint64_t>* reader_count)
+        : snapshot_(snapshot), reader_count_(reader_count) {}
+
+    const HookRegistrySnapshot* snapshot_;
+    std::atomic<uint64_t>* reader_count_;
+};
+
+// 批量 Hook 描述：symbol_name 非空时按 library_name + symbol_name 解析，否则使用 target_address
+struct HookSpec {
+    std::string library_name;
+    std::string symbol_name;
+    void* target_address = nullptr;
+    void* replace_function = nullptr;
+    void** original_function = nullptr;
+    std::string tag;
+};
+
 class HookManager {
   private:
     std::unordered_map<void*, std::unique_ptr<HookInfo>> active_hooks_;
 
+    // 读路径：写者在 getHooksMutex() 下重建并发布排序快照，读者只做原子操作
+    // 读者按 read_epoch_ 的奇偶登记到两组计数之一，旧快照在对应计数归零后回收
+    struct alignas(64) ReaderCount {
+        std::atomic<uint64_t> count{0};
+    };
+    struct RetiredSnapshot {
+        std::unique_ptr<const HookRegistrySnapshot> snapshot;
+        uint64_t epoch;
+    };
+    std::atomic<const HookRegistrySnapshot*> snapshot_{nullptr};
+    std::unique_ptr<const HookRegistrySnapshot> current_snapshot_;
+    std::vector<RetiredSnapshot> retired_snapshots_;
+    std::atomic<uint64_t> read_epoch_{0};
+    mutable ReaderCount readers_[2];
+
+    // 插桩回调：按地址登记，随快照一起发布，由唯一的静态跳板查表分发
+    struct InstrumentRegistration {
+        InstrumentId id;
+        std::shared_ptr<const InstrumentCallback> callback;
+    };
+    std::unordered_map<void*, std::vector<InstrumentRegistration>> instrument_callbacks_;
+    InstrumentId next_instrument_id_ = 1;
+
+    // 延迟 Hook：目标库加载后由加载器观察者安装，锁顺序为 pending_mutex_ -> getHooksMutex()
+    std::mutex pending_mutex_;
+    std::vector<HookSpec> pending_hooks_;
+    bool loader_observer_installed_ = false;
+
     // 内部工具方法
-    void* resolveSymbol(const std::string& library_name, const std::string& symbol_name);
-    bool isValidAddress(void* address);
+    // load_library 为 false 时只解析已加载的库（RTLD_NOLOAD），供批量与延迟路径使用
+    void* resolveSymbol(const std::string& library_name,
+                        const std::string& symbol_name,
+                        std::unordered_map<std::string, void*>* handle_cache = nullptr,
+                        bool load_library = true);
+    // dladdr 不认识的地址（JIT 等匿名代码）回退到内存映射快照检查是否可执行，未传入时现取一份
+    bool isValidAddress(void* address, const MemoryMapSnapshot* snapshot = nullptr);
     std::mutex& getHooksMutex() const;
 
+    // 安装 Hook 并登记信息，调用方需持有 getHooksMutex()
+    HookStatus installHookLocked(void* target_address,
+                                 void* replace_function,
+                                 void** original_function,
+                                 const std::string& symbol_name,
+                                 const std::string& library_name);
+
+    // 由 active_hooks_ 重建快照并发布，调用方需持有 getHooksMutex()
+    void publishSnapshotLocked();
+    void reclaimSnapshotsLocked();
+
+    // 在当前快照中查找 address 的插桩回调，释放快照后依次调用（无锁）
+    void dispatchInstrument(void* address, void* context) const;
+
+    // Hook dlopen 系列函数，调用方需持有 pending_mutex_
+    bool installLoaderObserverLocked();
+
   public:
     static HookManager* getInstance();
     ~HookManager();
@@ -74,20 +181,54 @@ class HookManager {
                           void** original_function,
                           const std::string& tag = "");
 
-    // 指令级插桩
+    // 批量 Hook：先解析全部符号，再在一次加锁内按地址顺序安装，返回每一项的状态
+    // Dobby 没有批量补丁接口，每个 Hook 仍单独修改页权限并刷新缓存，批量只省去加锁与解析开销
+    // 与 hookSymbol 不同，不会为解析符号而主动加载目标库
+    std::vector<HookStatus> hookBatch(const std::vector<HookSpec>& specs);
+
+    // 延迟 Hook 库符号：库已加载时立即安装，否则返回 PENDING，在库加载后自动安装
+    // 不会为了解析符号而主动加载目标库
+    HookStatus hookSymbolDeferred(const HookSpec& spec);
+
+    // 为已加载的库安装等待中的 Hook，返回安装成功的数量；加载器观察者在每次 dlopen 后调用
+    // 每次调用都会重新检查全部等待中的 Hook，因此随 dlopen 一起加载的依赖库也会被覆盖；
+    // 观察者不拦截 dlmopen，加载到其它链接命名空间的库不会触发自动安装
+    size_t installPendingHooks();
+
+    // 等待中的 Hook 数量
+    size_t getPendingHookCount();
+
+    // 指令级插桩：同一地址可登记多个回调，按登记顺序调用，callback_id 返回本次登记的 ID
+    // 回调在快照读临界区之外执行，可以在回调中安装或移除 Hook（包括注销自身）；
+    // 注销后仍在执行的回调会运行完毕
     HookStatus instrumentFunction(void* target_address,
                                   InstrumentCallback pre_callback,
-                                  const std::string& tag = "");
+                                  const std::string& tag = "",
+                                  InstrumentId* callback_id = nullptr);
+
+    // 注销单个插桩回调：只替换分发表，不修改代码，插桩点保留到 unhookFunction
+    HookStatus removeInstrumentCallback(void* target_address, InstrumentId callback_id);
 
     // 移除 Hook
     HookStatus unhookFunction(void* target_address);
 
-    // 查询 Hook 状态
+    // 查询 Hook 状态（无锁，可在 Hook 处理函数中调用）
     bool isHooked(void* target_address) const;
-    HookInfo* getHookInfo(void* target_address) const;
+    std::optional<HookInfo> getHookInfo(void* target_address) const;
+
+    // 获取所有活动 Hook 信息（按目标地址排序的副本）
+    std::vector<HookInfo> getAllHooks() const;
+
+    // 获取当前快照的引用，用于零拷贝查询
+    HookSnapshotRef acquireSnapshot() const;
 
-    // 获取所有 Hook 信息
-    std::vector<HookInfo*> getAllHooks() const;
+    // Hook 统计：只统计使用 ATKIT_HOOK_DEF_STATS 定义的 Hook，默认关闭
+    void setHookStatsEnabled(bool enabled);
+    bool isHookStatsEnabled() const;
+
+    // 汇总各线程的命中次数和延迟直方图，按总耗时降序
+    std::vector<HookStats> getHookStats() const;
+    void resetHookStats();
 
     // 工具方法
     void* getSymbolAddress(const std::string& library_name, const std::string& symbol_name);
@@ -103,6 +244,19 @@ class HookManager {
     ret_type (*original_##func_name)(__VA_ARGS__) = nullptr; \
     ret_type hooked_##func_name(__VA_ARGS__)
 
+// 与 ATKIT_HOOK_DEF 相同，另外定义该 Hook 的统计计数器 hook_stats_##func_name
+#define ATKIT_HOOK_DEF_STATS(ret_type, func_name, ...)                      \
+    ::AnalysisToolkit::HookStatsCounter hook_stats_##func_name(#func_name); \
+    ATKIT_HOOK_DEF(ret_type, func_name, __VA_ARGS__)
+
+// 放在替换函数开头：统计命中次数和整个替换函数的耗时
+#define ATKIT_HOOK_STATS_SCOPE(func_name) \
+    ::AnalysisToolkit::HookStatsScope atkit_hook_scope_##func_name(hook_stats_##func_name)
+
+// 调用原函数并单独统计原函数耗时，用于区分 Hook 自身的开销
+#define ATKIT_HOOK_CALL_ORIGINAL(func_name, ...) \
+    hook_stats_##func_name.callOriginal(original_##func_name __VA_OPT__(, ) __VA_ARGS__)
+
 #define ATKIT_HOOK_SYMBOL(lib_name, symbol, func_name)                                      \
     HookManager::getInstance()->hookSymbol(lib_name,                                        \
                                            symbol,                                          \
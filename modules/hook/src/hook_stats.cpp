@@ -0,0 +1,229 @@
+#include "hook/hook_stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+namespace AnalysisToolkit {
+
+namespace {
+
+// 单个线程上单个 Hook 的计数，只由所属线程写入，独占缓存行避免伪共享
+struct alignas(64) ThreadHookCounters {
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> total_ns{0};
+    std::atomic<uint64_t> max_ns{0};
+    std::atomic<uint64_t> original_calls{0};
+    std::atomic<uint64_t> original_ns{0};
+    std::atomic<uint64_t> buckets[kHookLatencyBuckets] = {};
+};
+
+// 单个线程的全部槽位，按 Hook ID 懒分配
+struct ThreadStatsBlock {
+    std::atomic<ThreadHookCounters*> slots[kMaxHookStats] = {};
+
+    ~ThreadStatsBlock() {
+        for (auto& slot : slots) {
+            delete slot.load(std::memory_order_relaxed);
+        }
+    }
+};
+
+// 只由所属线程递增，无需原子读改写
+inline void bump(std::atomic<uint64_t>& counter, uint64_t value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+size_t bucketFor(uint64_t elapsed_ns) {
+    if (elapsed_ns < 2) {
+        return 0;
+    }
+    size_t bucket = 63 - static_cast<size_t>(__builtin_clzll(elapsed_ns));
+    return std::min(bucket, kHookLatencyBuckets - 1);
+}
+
+void accumulate(HookStats& stats, const ThreadHookCounters& counters) {
+    stats.hits += counters.hits.load(std::memory_order_relaxed);
+    stats.total_ns += counters.total_ns.load(std::memory_order_relaxed);
+    stats.max_ns = std::max(stats.max_ns, counters.max_ns.load(std::memory_order_relaxed));
+    stats.original_calls += counters.original_calls.load(std::memory_order_relaxed);
+    stats.original_ns += counters.original_ns.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < kHookLatencyBuckets; ++i) {
+        stats.latency_buckets[i] += counters.buckets[i].load(std::memory_order_relaxed);
+    }
+}
+
+// 全局注册表：Hook 名称、存活线程的槽位和已退出线程的累计值
+struct StatsRegistry {
+    std::mutex mutex;
+    std::atomic<uint32_t> count{0};
+    std::string names[kMaxHookStats];
+    HookStats retired[kMaxHookStats];
+    std::vector<ThreadStatsBlock*> blocks;
+
+    void retire(ThreadStatsBlock* block) {
+        std::lock_guard<std::mutex> lock(mutex);
+        uint32_t registered = count.load(std::memory_order_relaxed);
+        for (uint32_t id = 0; id < registered; ++id) {
+            ThreadHookCounters* counters = block->slots[id].load(std::memory_order_acquire);
+            if (counters != nullptr) {
+                accumulate(retired[id], *counters);
+            }
+        }
+        blocks.erase(std::remove(blocks.begin(), blocks.end(), block), blocks.end());
+        delete block;
+    }
+};
+
+// 不析构，避免进程退出时线程局部对象访问已销毁的注册表
+StatsRegistry& registry() {
+    static StatsRegistry* instance = new StatsRegistry();
+    return *instance;
+}
+
+// 线程退出时把计数并入注册表
+struct ThreadStatsHandle {
+    ThreadStatsBlock* block;
+
+    ThreadStatsHandle() : block(new ThreadStatsBlock()) {
+        StatsRegistry& stats = registry();
+        std::lock_guard<std::mutex> lock(stats.mutex);
+        stats.blocks.push_back(block);
+    }
+
+    ~ThreadStatsHandle() {
+        registry().retire(block);
+    }
+};
+
+ThreadHookCounters* threadCounters(uint32_t id) {
+    thread_local ThreadStatsHandle handle;
+    ThreadHookCounters* counters = handle.block->slots[id].load(std::memory_order_relaxed);
+    if (counters == nullptr) {
+        counters = new ThreadHookCounters();
+        handle.block->slots[id].store(counters, std::memory_order_release);
+    }
+    return counters;
+}
+
+// 指标 hook.time_ns：统计开启时替换函数的总耗时
+const MetricCounter& hookTimeMetric() {
+    static const MetricCounter counter("hook.time_ns");
+    return counter;
+}
+
+}  // namespace
+
+std::atomic<bool> HookStatsCounter::enabled_{false};
+
+const MetricCounter& hookHitsMetric() {
+    static const MetricCounter counter("hook.hits");
+    return counter;
+}
+
+uint64_t HookStats::percentileNs(double p) const {
+    if (hits == 0) {
+        return 0;
+    }
+    p = std::clamp(p, 0.0, 1.0);
+    uint64_t rank = static_cast<uint64_t>(std::ceil(p * static_cast<double>(hits)));
+    rank = std::max<uint64_t>(rank, 1);
+    uint64_t seen = 0;
+    for (size_t i = 0; i + 1 < kHookLatencyBuckets; ++i) {
+        seen += latency_buckets[i];
+        if (seen >= rank) {
+            return std::min(uint64_t{1} << (i + 1), max_ns);
+        }
+    }
+    return max_ns;
+}
+
+HookStatsCounter::HookStatsCounter(const char* name) {
+    StatsRegistry& stats = registry();
+    std::lock_guard<std::mutex> lock(stats.mutex);
+    uint32_t id = stats.count.load(std::memory_order_relaxed);
+    if (id >= kMaxHookStats) {
+        id_ = static_cast<uint32_t>(kMaxHookStats);
+        return;
+    }
+    stats.names[id] = name != nullptr ? name : "";
+    stats.retired[id].name = stats.names[id];
+    stats.count.store(id + 1, std::memory_order_release);
+    id_ = id;
+}
+
+void HookStatsCounter::setEnabled(bool enabled) {
+    enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+void HookStatsCounter::recordHit(uint64_t elapsed_ns) {
+    if (id_ >= kMaxHookStats) {
+        return;
+    }
+    ThreadHookCounters* counters = threadCounters(id_);
+    bump(counters->hits, 1);
+    bump(counters->total_ns, elapsed_ns);
+    if (elapsed_ns > counters->max_ns.load(std::memory_order_relaxed)) {
+        counters->max_ns.store(elapsed_ns, std::memory_order_relaxed);
+    }
+    bump(counters->buckets[bucketFor(elapsed_ns)], 1);
+    hookTimeMetric().add(elapsed_ns);
+}
+
+void HookStatsCounter::recordOriginal(uint64_t elapsed_ns) {
+    if (id_ >= kMaxHookStats) {
+        return;
+    }
+    ThreadHookCounters* counters = threadCounters(id_);
+    bump(counters->original_calls, 1);
+    bump(counters->original_ns, elapsed_ns);
+}
+
+std::vector<HookStats> HookStatsCounter::collect() {
+    StatsRegistry& stats = registry();
+    std::lock_guard<std::mutex> lock(stats.mutex);
+    uint32_t registered = stats.count.load(std::memory_order_relaxed);
+
+    std::vector<HookStats> result(stats.retired, stats.retired + registered);
+    for (ThreadStatsBlock* block : stats.blocks) {
+        for (uint32_t id = 0; id < registered; ++id) {
+            ThreadHookCounters* counters = block->slots[id].load(std::memory_order_acquire);
+            if (counters != nullptr) {
+                accumulate(result[id], *counters);
+            }
+        }
+    }
+
+    std::stable_sort(result.begin(), result.end(), [](const HookStats& a, const HookStats& b) {
+        return a.total_ns > b.total_ns;
+    });
+    return result;
+}
+
+void HookStatsCounter::reset() {
+    StatsRegistry& stats = registry();
+    std::lock_guard<std::mutex> lock(stats.mutex);
+    uint32_t registered = stats.count.load(std::memory_order_relaxed);
+    for (uint32_t id = 0; id < registered; ++id) {
+        stats.retired[id] = HookStats();
+        stats.retired[id].name = stats.names[id];
+    }
+    for (ThreadStatsBlock* block : stats.blocks) {
+        for (uint32_t id = 0; id < registered; ++id) {
+            ThreadHookCounters* counters = block->slots[id].load(std::memory_order_acquire);
+            if (counters == nullptr) {
+                continue;
+            }
+            counters->hits.store(0, std::memory_order_relaxed);
+            counters->total_ns.store(0, std::memory_order_relaxed);
+            counters->max_ns.store(0, std::memory_order_relaxed);
+            counters->original_calls.store(0, std::memory_order_relaxed);
+            counters->original_ns.store(0, std::memory_order_relaxed);
+            for (auto& bucket : counters->buckets) {
+                bucket.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+}  // namespace AnalysisToolkit
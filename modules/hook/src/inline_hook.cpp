@@ -2,11 +2,142 @@
 
 #include <dlfcn.h>
 
+#include <algorithm>
+#include <exception>
+#include <thread>
+
 #include "dobby.h"
 #include "utility/Logger.h"
+#include "utility/MemoryMapSnapshot.h"
+#include "utility/Metrics.h"
+#include "utility/ModuleIndex.h"
+#include "utility/SymbolIndex.h"
 
 namespace AnalysisToolkit {
 
+namespace {
+
+// 指标 hook.active：当前生效的 Hook 数
+const MetricGauge& activeHooksMetric() {
+    static const MetricGauge gauge("hook.active");
+    return gauge;
+}
+
+// 本线程正在处理延迟 Hook 时跳过加载器回调，避免解析符号时的 dlopen 重入 pending_mutex_
+thread_local bool in_pending_hooks = false;
+
+struct PendingHookScope {
+    bool previous = in_pending_hooks;
+
+    PendingHookScope() {
+        in_pending_hooks = true;
+    }
+    ~PendingHookScope() {
+        in_pending_hooks = previous;
+    }
+};
+
+// 加载器观察者：dlopen 成功返回后安装等待该库的 Hook
+void notifyLibraryLoaded(void* handle) {
+    if (handle != nullptr && !in_pending_hooks) {
+        HookManager::getInstance()->installPendingHooks();
+    }
+}
+
+void* (*original_dlopen)(const char*, int) = nullptr;
+
+void* observed_dlopen(const char* filename, int flags) {
+    void* handle = original_dlopen(filename, flags);
+    notifyLibraryLoaded(handle);
+    return handle;
+}
+
+#ifdef __ANDROID__
+// Android 7.0 起链接器按调用者地址选择命名空间，优先 Hook 链接器入口以保留原始调用者
+void* (*original_loader_dlopen)(const char*, int, const void*) = nullptr;
+void* (*original_loader_dlopen_ext)(const char*, int, const void*, const void*) = nullptr;
+void* (*original_android_dlopen_ext)(const char*, int, const void*) = nullptr;
+
+void* observed_loader_dlopen(const char* filename, int flags, const void* caller) {
+    void* handle = original_loader_dlopen(filename, flags, caller);
+    notifyLibraryLoaded(handle);
+    return handle;
+}
+
+void* observed_loader_dlopen_ext(const char* filename,
+                                 int flags,
+                                 const void* extinfo,
+                                 const void* caller) {
+    void* handle = original_loader_dlopen_ext(filename, flags, extinfo, caller);
+    notifyLibraryLoaded(handle);
+    return handle;
+}
+
+void* observed_android_dlopen_ext(const char* filename, int flags, const void* extinfo) {
+    void* handle = original_android_dlopen_ext(filename, flags, extinfo);
+    notifyLibraryLoaded(handle);
+    return handle;
+}
+#endif
+
+HookSpec observerSpec(const char* library_name,
+                      const char* symbol_name,
+                      void* replace_function,
+                      void** original_function) {
+    HookSpec spec;
+    spec.library_name = library_name;
+    spec.symbol_name = symbol_name;
+    spec.replace_function = replace_function;
+    spec.original_function = original_function;
+    spec.tag = std::string("loader_observer:") + symbol_name;
+    return spec;
+}
+
+}  // namespace
+
+using InstrumentCallbackList = std::vector<std::shared_ptr<const InstrumentCallback>>;
+
+// 一个插桩地址上的回调，按登记顺序调用；列表单独计数，分发时可脱离快照持有
+struct InstrumentSlot {
+    void* address;
+    std::shared_ptr<const InstrumentCallbackList> callbacks;
+};
+
+// 不可变快照：按目标地址排序的活动 Hook 和插桩回调
+struct HookRegistrySnapshot {
+    std::vector<HookInfo> hooks;
+    std::vector<InstrumentSlot> instruments;
+};
+
+const HookInfo* HookSnapshotRef::find(void* target_address) const {
+    if (snapshot_ == nullptr) {
+        return nullptr;
+    }
+    auto it = std::lower_bound(snapshot_->hooks.begin(),
+                               snapshot_->hooks.end(),
+                               target_address,
+                               [](const HookInfo& info, void* address) {
+                                   return reinterpret_cast<uintptr_t>(info.target_address) <
+                                          reinterpret_cast<uintptr_t>(address);
+                               });
+    if (it == snapshot_->hooks.end() || it->target_address != target_address) {
+        return nullptr;
+    }
+    return &*it;
+}
+
+const HookInfo* HookSnapshotRef::begin() const {
+    return snapshot_ ? snapshot_->hooks.data() : nullptr;
+}
+
+const HookInfo* HookSnapshotRef::end() const {
+    return snapshot_ ? snapshot_->hooks.data() + snapshot_->hooks.size() : nullptr;
+}
+
+size_t HookSnapshotRef::size() const {
+    return snapshot_ ? snapshot_->hooks.size() : 0;
+}
+
 HookManager* HookManager::getInstance() {
     static std::once_flag flag;
     // 使用完全局部静态变量方法，避免静态析构顺序问题
@@ -32,6 +163,8 @@ bool HookManager::initialize() {
 }
 
 void HookManager::cleanup() {
+    PendingHookScope scope;
+    std::lock_guard<std::mutex> pending_lock(pending_mutex_);
     std::lock_guard<std::mutex> lock(getHooksMutex());
 
     // 清理所有 Hook
@@ -42,20 +175,54 @@ void HookManager::cleanup() {
         }
     }
     active_hooks_.clear();
+    instrument_callbacks_.clear();
+    pending_hooks_.clear();
+    loader_observer_installed_ = false;
+    publishSnapshotLocked();
     ATKIT_INFO("HookManager cleanup completed");
 }
 
-void* HookManager::resolveSymbol(const std::string& library_name, const std::string& symbol_name) {
+void* HookManager::resolveSymbol(const std::string& library_name,
+                                 const std::string& symbol_name,
+                                 std::unordered_map<std::string, void*>* handle_cache,
+                                 bool load_library) {
+    // 优先查符号索引：每个库只解析一次 ELF 符号表
+    if (!library_name.empty()) {
+        std::optional<uintptr_t> indexed =
+            SymbolIndex::getInstance().findSymbol(library_name, symbol_name);
+        if (indexed) {
+            return reinterpret_cast<void*>(*indexed);
+        }
+    }
+
     // 尝试使用 Dobby 的符号解析器
     void* symbol = DobbySymbolResolver(library_name.c_str(), symbol_name.c_str());
     if (symbol != nullptr) {
         return symbol;
     }
 
-    // 回退到 dlsym
-    void* handle = dlopen(library_name.c_str(), RTLD_LAZY);
+    // 回退到 dlsym；批量解析时每个库只打开一次，由调用方关闭
+    void* handle = nullptr;
+    bool cached = false;
+    if (handle_cache != nullptr) {
+        auto it = handle_cache->find(library_name);
+        if (it != handle_cache->end()) {
+            handle = it->second;
+            cached = true;
+        }
+    }
+    if (!cached) {
+        // 批量与延迟路径只查找已加载的库，不为解析符号主动加载
+        int flags = load_library ? RTLD_LAZY : RTLD_LAZY | RTLD_NOLOAD;
+        handle = dlopen(library_name.c_str(), flags);
+        if (handle == nullptr) {
+            ATKIT_ERROR("Failed to open library %s: %s", library_name.c_str(), dlerror());
+        }
+        if (handle_cache != nullptr) {
+            (*handle_cache)[library_name] = handle;
+        }
+    }
     if (handle == nullptr) {
-        ATKIT_ERROR("Failed to open library: %s, error: %s", library_name.c_str(), dlerror());
         return nullptr;
     }
 
@@ -67,18 +234,35 @@ void* HookManager::resolveSymbol(const std::string& library_name, const std::str
                     dlerror());
     }
 
-    dlclose(handle);
+    if (handle_cache == nullptr) {
+        dlclose(handle);
+    }
     return symbol;
 }
 
-bool HookManager::isValidAddress(void* address) {
+bool HookManager::isValidAddress(void* address, const MemoryMapSnapshot* snapshot) {
     if (address == nullptr) {
         return false;
     }
 
     // 使用 dladdr 检查地址是否有效
     Dl_info info;
-    return dladdr(address, &info) != 0;
+    if (dladdr(address, &info) != 0) {
+        return true;
+    }
+
+    // 加载器之外映射的代码只能通过内存映射确认
+    std::optional<MemoryMapSnapshot> captured;
+    if (snapshot == nullptr) {
+        auto result = MemoryMapSnapshot::captureSelf();
+        if (result.hasError()) {
+            return false;
+        }
+        captured = std::move(result.getValue());
+        snapshot = &*captured;
+    }
+    const MemoryRegion* region = snapshot->find(reinterpret_cast<uintptr_t>(address));
+    return region != nullptr && region->getPermissions().executable;
 }
 
 HookStatus HookManager::hookFunction(void* target_address,
@@ -91,7 +275,20 @@ HookStatus HookManager::hookFunction(void* target_address,
     }
 
     std::lock_guard<std::mutex> lock(getHooksMutex());
+    HookStatus status =
+        installHookLocked(target_address, replace_function, original_function, tag, "");
+    if (status == HookStatus::SUCCESS) {
+        publishSnapshotLocked();
+        ATKIT_INFO("Successfully hooked function at %p with tag: %s", target_address, tag.c_str());
+    }
+    return status;
+}
 
+HookStatus HookManager::installHookLocked(void* target_address,
+                                          void* replace_function,
+                                          void** original_function,
+                                          const std::string& symbol_name,
+                                          const std::string& library_name) {
     // 检查是否已经被 Hook
     auto it = active_hooks_.find(target_address);
     if (it != active_hooks_.end() && it->second->is_active) {
@@ -117,18 +314,17 @@ HookStatus HookManager::hookFunction(void* target_address,
     hook_info->replace_function = replace_function;
     hook_info->original_function = original_function ? *original_function : nullptr;
     hook_info->type = HookType::FUNCTION_INLINE;
-    hook_info->symbol_name = tag;
+    hook_info->symbol_name = symbol_name;
+    hook_info->library_name = library_name;
     hook_info->is_active = true;
 
     // 获取库信息
     Dl_info dl_info;
-    if (dladdr(target_address, &dl_info) != 0) {
+    if (library_name.empty() && dladdr(target_address, &dl_info) != 0) {
         hook_info->library_name = dl_info.dli_fname ? dl_info.dli_fname : "unknown";
     }
 
     active_hooks_[target_address] = std::move(hook_info);
-
-    ATKIT_INFO("Successfully hooked function at %p with tag: %s", target_address, tag.c_str());
     return HookStatus::SUCCESS;
 }
 
@@ -147,58 +343,307 @@ HookStatus HookManager::hookSymbol(const std::string& library_name,
 
     ATKIT_DEBUG("Resolved symbol %s at address: %p", symbol_name.c_str(), target_address);
 
-    HookStatus status = hookFunction(target_address, replace_function, original_function, tag);
+    if (!isValidAddress(target_address)) {
+        ATKIT_ERROR("Invalid target address: %p", target_address);
+        return HookStatus::INVALID_ADDRESS;
+    }
+
+    std::lock_guard<std::mutex> lock(getHooksMutex());
+    HookStatus status = installHookLocked(
+        target_address, replace_function, original_function, symbol_name, library_name);
     if (status == HookStatus::SUCCESS) {
-        // 更新符号信息
+        publishSnapshotLocked();
+        ATKIT_INFO("Successfully hooked function at %p with tag: %s", target_address, tag.c_str());
+    }
+    return status;
+}
+
+std::vector<HookStatus> HookManager::hookBatch(const std::vector<HookSpec>& specs) {
+    std::vector<HookStatus> results(specs.size(), HookStatus::FAILED);
+
+    struct PendingHook {
+        size_t index;
+        void* target_address;
+        std::string library_name;
+    };
+
+    // 第一阶段：不持锁解析全部符号并校验地址，同一个库的符号一次批量查索引
+    std::unordered_map<std::string, std::vector<size_t>> by_library;
+    for (size_t i = 0; i < specs.size(); ++i) {
+        if (!specs[i].symbol_name.empty() && !specs[i].library_name.empty()) {
+            by_library[specs[i].library_name].push_back(i);
+        }
+    }
+    std::vector<uintptr_t> indexed(specs.size(), 0);
+    for (const auto& group : by_library) {
+        std::vector<std::string> names;
+        names.reserve(group.second.size());
+        for (size_t index : group.second) {
+            names.push_back(specs[index].symbol_name);
+        }
+        std::vector<uintptr_t> addresses =
+            SymbolIndex::getInstance().findSymbols(group.first, names);
+        for (size_t j = 0; j < group.second.size(); ++j) {
+            indexed[group.second[j]] = addresses[j];
+        }
+    }
+
+    std::vector<PendingHook> pending;
+    pending.reserve(specs.size());
+    std::unordered_map<std::string, void*> handles;
+    // dladdr 未命中时才解析一次内存映射，整批共用
+    std::optional<MemoryMapSnapshot> snapshot;
+    for (size_t i = 0; i < specs.size(); ++i) {
+        const HookSpec& spec = specs[i];
+        void* target_address = spec.target_address;
+        if (indexed[i] != 0) {
+            target_address = reinterpret_cast<void*>(indexed[i]);
+        } else if (!spec.symbol_name.empty()) {
+            target_address = resolveSymbol(spec.library_name, spec.symbol_name, &handles, false);
+            if (target_address == nullptr) {
+                results[i] = HookStatus::SYMBOL_NOT_FOUND;
+                continue;
+            }
+        }
+
+        if (target_address == nullptr) {
+            results[i] = HookStatus::INVALID_ADDRESS;
+            continue;
+        }
+
+        std::string library_name = spec.library_name;
+        Dl_info dl_info;
+        if (dladdr(target_address, &dl_info) != 0) {
+            if (library_name.empty()) {
+                library_name = dl_info.dli_fname ? dl_info.dli_fname : "unknown";
+            }
+        } else {
+            if (!snapshot) {
+                auto captured = MemoryMapSnapshot::captureSelf();
+                snapshot = captured.isSuccess() ? std::move(captured.getValue())
+                                                : MemoryMapSnapshot();
+            }
+            if (!isValidAddress(target_address, &*snapshot)) {
+                results[i] = HookStatus::INVALID_ADDRESS;
+                continue;
+            }
+            if (library_name.empty()) {
+                const MemoryRegion* region =
+                    snapshot->find(reinterpret_cast<uintptr_t>(target_address));
+                library_name = region->getPathname().empty() ? "unknown" : region->getPathname();
+            }
+        }
+        pending.push_back({i, target_address, std::move(library_name)});
+    }
+    for (auto& entry : handles) {
+        if (entry.second != nullptr) {
+            dlclose(entry.second);
+        }
+    }
+
+    // 按地址排序只为访问局部性：Dobby 没有批量打补丁的接口，每个 DobbyHook 仍各自改页权限并刷新
+    // 指令缓存，批量节省的只是加锁与符号解析
+    std::stable_sort(
+        pending.begin(), pending.end(), [](const PendingHook& a, const PendingHook& b) {
+            return reinterpret_cast<uintptr_t>(a.target_address) <
+                   reinterpret_cast<uintptr_t>(b.target_address);
+        });
+
+    // 第二阶段：一次加锁安装全部 Hook
+    size_t installed = 0;
+    {
         std::lock_guard<std::mutex> lock(getHooksMutex());
-        auto it = active_hooks_.find(target_address);
-        if (it != active_hooks_.end()) {
-            it->second->symbol_name = symbol_name;
-            it->second->library_name = library_name;
+        for (const auto& entry : pending) {
+            const HookSpec& spec = specs[entry.index];
+            const std::string& name = spec.symbol_name.empty() ? spec.tag : spec.symbol_name;
+            results[entry.index] = installHookLocked(entry.target_address,
+                                                     spec.replace_function,
+                                                     spec.original_function,
+                                                     name,
+                                                     entry.library_name);
+            if (results[entry.index] == HookStatus::SUCCESS) {
+                installed++;
+            }
+        }
+        if (installed > 0) {
+            publishSnapshotLocked();
         }
     }
 
-    return status;
+    ATKIT_INFO("Batch hook installed %zu of %zu hooks", installed, specs.size());
+    return results;
+}
+
+HookStatus HookManager::hookSymbolDeferred(const HookSpec& spec) {
+    if (spec.library_name.empty() || spec.symbol_name.empty()) {
+        ATKIT_ERROR("Deferred hook requires both a library and a symbol name");
+        return HookStatus::FAILED;
+    }
+
+    PendingHookScope scope;
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    // 先安装观察者再检查库是否已加载，检查之后的加载一定会触发观察者
+    if (!installLoaderObserverLocked()) {
+        ATKIT_WARN("Loader observer unavailable, call installPendingHooks() after loading %s",
+                   spec.library_name.c_str());
+    }
+
+    if (ModuleIndex::getInstance().findModule(spec.library_name)) {
+        return hookBatch({spec}).front();
+    }
+
+    pending_hooks_.push_back(spec);
+    ATKIT_INFO("Deferred hook %s!%s until the library is loaded",
+               spec.library_name.c_str(),
+               spec.symbol_name.c_str());
+    return HookStatus::PENDING;
+}
+
+size_t HookManager::installPendingHooks() {
+    PendingHookScope scope;
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    if (pending_hooks_.empty()) {
+        return 0;
+    }
+
+    // 每个库只查一次模块索引
+    std::unordered_map<std::string, bool> loaded;
+    std::vector<HookSpec> ready;
+    std::vector<HookSpec> waiting;
+    for (auto& spec : pending_hooks_) {
+        auto it = loaded.find(spec.library_name);
+        if (it == loaded.end()) {
+            bool mapped = ModuleIndex::getInstance().findModule(spec.library_name).has_value();
+            it = loaded.emplace(spec.library_name, mapped).first;
+        }
+        (it->second ? ready : waiting).push_back(std::move(spec));
+    }
+    pending_hooks_ = std::move(waiting);
+    if (ready.empty()) {
+        return 0;
+    }
+
+    std::vector<HookStatus> results = hookBatch(ready);
+    size_t installed = 0;
+    for (size_t i = 0; i < ready.size(); ++i) {
+        if (results[i] == HookStatus::SUCCESS) {
+            installed++;
+        } else {
+            ATKIT_ERROR("Failed to install deferred hook %s!%s, status: %d",
+                        ready[i].library_name.c_str(),
+                        ready[i].symbol_name.c_str(),
+                        static_cast<int>(results[i]));
+        }
+    }
+    return installed;
+}
+
+size_t HookManager::getPendingHookCount() {
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    return pending_hooks_.size();
+}
+
+bool HookManager::installLoaderObserverLocked() {
+    if (loader_observer_installed_) {
+        return true;
+    }
+
+    std::vector<HookSpec> specs;
+#ifdef __ANDROID__
+    const char* linker = sizeof(void*) == 8 ? "linker64" : "linker";
+    specs.push_back(observerSpec(linker,
+                                 "__loader_dlopen",
+                                 reinterpret_cast<void*>(observed_loader_dlopen),
+                                 reinterpret_cast<void**>(&original_loader_dlopen)));
+    specs.push_back(observerSpec(linker,
+                                 "__loader_android_dlopen_ext",
+                                 reinterpret_cast<void*>(observed_loader_dlopen_ext),
+                                 reinterpret_cast<void**>(&original_loader_dlopen_ext)));
+    std::vector<HookStatus> results = hookBatch(specs);
+    if (results[0] != HookStatus::SUCCESS) {
+        // Android 8.0 之前链接器不导出 __loader_* 入口，退回 Hook libdl
+        specs.clear();
+        specs.push_back(observerSpec("libdl.so",
+                                     "dlopen",
+                                     reinterpret_cast<void*>(observed_dlopen),
+                                     reinterpret_cast<void**>(&original_dlopen)));
+        specs.push_back(observerSpec("libdl.so",
+                                     "android_dlopen_ext",
+                                     reinterpret_cast<void*>(observed_android_dlopen_ext),
+                                     reinterpret_cast<void**>(&original_android_dlopen_ext)));
+        results = hookBatch(specs);
+    }
+#else
+    // 只拦截 dlopen：依赖库随之加载，由 installPendingHooks 全量重查覆盖；dlmopen 不观察
+    HookSpec spec = observerSpec("",
+                                 "dlopen",
+                                 reinterpret_cast<void*>(observed_dlopen),
+                                 reinterpret_cast<void**>(&original_dlopen));
+    spec.symbol_name.clear();
+    spec.target_address = dlsym(RTLD_DEFAULT, "dlopen");
+    specs.push_back(spec);
+    std::vector<HookStatus> results = hookBatch(specs);
+#endif
+
+    loader_observer_installed_ = results[0] == HookStatus::SUCCESS;
+    return loader_observer_installed_;
 }
 
 HookStatus HookManager::instrumentFunction(void* target_address,
                                            InstrumentCallback pre_callback,
-                                           const std::string& tag) {
+                                           const std::string& tag,
+                                           InstrumentId* callback_id) {
     if (!isValidAddress(target_address)) {
         ATKIT_ERROR("Invalid target address for instrumentation: %p", target_address);
         return HookStatus::INVALID_ADDRESS;
     }
+    if (!pre_callback) {
+        ATKIT_ERROR("Empty instrument callback for address %p", target_address);
+        return HookStatus::FAILED;
+    }
 
-    // 创建包装回调
-    auto* wrapper_callback = new std::function<void(void*, DobbyRegisterContext*)>(
-        [pre_callback](void* address, DobbyRegisterContext* ctx) { pre_callback(address, ctx); });
-
-    dobby_instrument_callback_t dobby_callback = [](void* address, DobbyRegisterContext* ctx) {
-        // 这里需要从某个地方获取到原始的 callback
-        // 由于 dobby 不支持用户数据传递，我们需要使用全局映射
-        // 简化实现，直接调用
+    // Dobby 不传递用户数据：所有插桩点共用同一个跳板，按地址在快照中查找回调
+    static const dobby_instrument_callback_t trampoline = [](void* address,
+                                                             DobbyRegisterContext* ctx) {
+        HookManager::getInstance()->dispatchInstrument(address, ctx);
     };
 
-    int result = DobbyInstrument(target_address, dobby_callback);
-    if (result != 0) {
-        delete wrapper_callback;
-        ATKIT_ERROR("Dobby instrument failed for address %p, error code: %d",
-                    target_address,
-                    result);
-        return HookStatus::FAILED;
+    std::lock_guard<std::mutex> lock(getHooksMutex());
+    auto it = active_hooks_.find(target_address);
+    if (it != active_hooks_.end() && it->second->type != HookType::INSTRUCTION) {
+        ATKIT_WARN("Address %p already hooked with tag: %s",
+                   target_address,
+                   it->second->symbol_name.c_str());
+        return HookStatus::ALREADY_HOOKED;
     }
 
-    // 记录插桩信息
-    std::lock_guard<std::mutex> lock(getHooksMutex());
-    auto hook_info = std::make_unique<HookInfo>();
-    hook_info->target_address = target_address;
-    hook_info->replace_function = reinterpret_cast<void*>(wrapper_callback);
-    hook_info->original_function = nullptr;
-    hook_info->type = HookType::INSTRUCTION;
-    hook_info->symbol_name = tag;
-    hook_info->is_active = true;
+    // 地址已插桩时只追加回调
+    if (it == active_hooks_.end()) {
+        int result = DobbyInstrument(target_address, trampoline);
+        if (result != 0) {
+            ATKIT_ERROR("Dobby instrument failed for address %p, error code: %d",
+                        target_address,
+                        result);
+            return HookStatus::FAILED;
+        }
 
-    active_hooks_[target_address] = std::move(hook_info);
+        auto hook_info = std::make_unique<HookInfo>();
+        hook_info->target_address = target_address;
+        hook_info->replace_function = reinterpret_cast<void*>(trampoline);
+        hook_info->original_function = nullptr;
+        hook_info->type = HookType::INSTRUCTION;
+        hook_info->symbol_name = tag;
+        hook_info->is_active = true;
+        active_hooks_[target_address] = std::move(hook_info);
+    }
+
+    InstrumentId id = next_instrument_id_++;
+    instrument_callbacks_[target_address].push_back(
+        {id, std::make_shared<const InstrumentCallback>(std::move(pre_callback))});
+    publishSnapshotLocked();
+    if (callback_id != nullptr) {
+        *callback_id = id;
+    }
 
     ATKIT_INFO("Successfully instrumented function at %p with tag: %s",
                target_address,
@@ -206,6 +651,69 @@ HookStatus HookManager::instrumentFunction(void* target_address,
     return HookStatus::SUCCESS;
 }
 
+HookStatus HookManager::removeInstrumentCallback(void* target_address, InstrumentId callback_id) {
+    std::lock_guard<std::mutex> lock(getHooksMutex());
+    auto it = instrument_callbacks_.find(target_address);
+    if (it == instrument_callbacks_.end()) {
+        ATKIT_WARN("Address %p is not instrumented", target_address);
+        return HookStatus::FAILED;
+    }
+
+    auto& registrations = it->second;
+    auto found = std::find_if(registrations.begin(),
+                              registrations.end(),
+                              [callback_id](const InstrumentRegistration& registration) {
+                                  return registration.id == callback_id;
+                              });
+    if (found == registrations.end()) {
+        ATKIT_WARN("Instrument callback %llu not found at %p",
+                   static_cast<unsigned long long>(callback_id),
+                   target_address);
+        return HookStatus::FAILED;
+    }
+
+    // 正在执行的跳板持有旧的回调列表，回调对象在其返回后才析构
+    registrations.erase(found);
+    if (registrations.empty()) {
+        instrument_callbacks_.erase(it);
+    }
+    publishSnapshotLocked();
+    return HookStatus::SUCCESS;
+}
+
+void HookManager::dispatchInstrument(void* address, void* context) const {
+    // 只在查找期间登记为快照读者；回调在释放快照后执行，发布新快照不会等待用户代码
+    std::shared_ptr<const InstrumentCallbackList> callbacks;
+    {
+        HookSnapshotRef snapshot = acquireSnapshot();
+        if (snapshot.snapshot_ == nullptr) {
+            return;
+        }
+
+        const std::vector<InstrumentSlot>& slots = snapshot.snapshot_->instruments;
+        auto it = std::lower_bound(
+            slots.begin(), slots.end(), address, [](const InstrumentSlot& slot, void* target) {
+                return reinterpret_cast<uintptr_t>(slot.address) <
+                       reinterpret_cast<uintptr_t>(target);
+            });
+        if (it == slots.end() || it->address != address) {
+            return;
+        }
+        callbacks = it->callbacks;
+    }
+    hookHitsMetric().add();
+
+    for (const auto& callback : *callbacks) {
+        try {
+            (*callback)(address, context);
+        } catch (const std::exception& e) {
+            ATKIT_ERROR("Exception in instrument callback at %p: %s", address, e.what());
+        } catch (...) {
+            ATKIT_ERROR("Unknown exception in instrument callback at %p", address);
+        }
+    }
+}
+
 HookStatus HookManager::unhookFunction(void* target_address) {
     std::lock_guard<std::mutex> lock(getHooksMutex());
 
@@ -221,41 +729,129 @@ HookStatus HookManager::unhookFunction(void* target_address) {
         return HookStatus::FAILED;
     }
 
-    // 清理资源
+    // 插桩点的全部回调随快照一起退休
     if (it->second->type == HookType::INSTRUCTION) {
-        delete reinterpret_cast<std::function<void(void*, DobbyRegisterContext*)>*>(
-            it->second->replace_function);
+        instrument_callbacks_.erase(target_address);
     }
 
     active_hooks_.erase(it);
+    publishSnapshotLocked();
     ATKIT_INFO("Successfully unhooked function at %p", target_address);
     return HookStatus::SUCCESS;
 }
 
-bool HookManager::isHooked(void* target_address) const {
-    std::lock_guard<std::mutex> lock(getHooksMutex());
-    auto it = active_hooks_.find(target_address);
-    return it != active_hooks_.end() && it->second->is_active;
-}
+void HookManager::publishSnapshotLocked() {
+    auto next = std::make_unique<HookRegistrySnapshot>();
+    next->hooks.reserve(active_hooks_.size());
+    for (const auto& pair : active_hooks_) {
+        if (pair.second->is_active) {
+            next->hooks.push_back(*pair.second);
+        }
+    }
+    std::sort(next->hooks.begin(), next->hooks.end(), [](const HookInfo& a, const HookInfo& b) {
+        return reinterpret_cast<uintptr_t>(a.target_address) <
+               reinterpret_cast<uintptr_t>(b.target_address);
+    });
+    next->instruments.reserve(instrument_callbacks_.size());
+    for (const auto& pair : instrument_callbacks_) {
+        auto callbacks = std::make_shared<InstrumentCallbackList>();
+        callbacks->reserve(pair.second.size());
+        for (const auto& registration : pair.second) {
+            callbacks->push_back(registration.callback);
+        }
+        next->instruments.push_back({pair.first, std::move(callbacks)});
+    }
+    std::sort(next->instruments.begin(),
+              next->instruments.end(),
+              [](const InstrumentSlot& a, const InstrumentSlot& b) {
+                  return reinterpret_cast<uintptr_t>(a.address) <
+                         reinterpret_cast<uintptr_t>(b.address);
+              });
+
+    activeHooksMetric().set(static_cast<int64_t>(next->hooks.size()));
+    snapshot_.store(next.get());
+    uint64_t epoch = read_epoch_.load();
+    if (current_snapshot_) {
+        retired_snapshots_.push_back({std::move(current_snapshot_), epoch});
+    }
+    current_snapshot_ = std::move(next);
 
-HookInfo* HookManager::getHookInfo(void* target_address) const {
-    std::lock_guard<std::mutex> lock(getHooksMutex());
-    auto it = active_hooks_.find(target_address);
-    return it != active_hooks_.end() ? it->second.get() : nullptr;
+    // 复用另一组计数前，等待上上轮登记的读者退出（读临界区只是一次查找）
+    while (readers_[(epoch + 1) & 1].count.load() != 0) {
+        std::this_thread::yield();
+    }
+    // 此后没有读者能持有 epoch 之前退休的快照
+    retired_snapshots_.erase(std::remove_if(retired_snapshots_.begin(),
+                                            retired_snapshots_.end(),
+                                            [epoch](const RetiredSnapshot& retired) {
+                                                return retired.epoch < epoch;
+                                            }),
+                             retired_snapshots_.end());
+    read_epoch_.store(epoch + 1);
+
+    reclaimSnapshotsLocked();
 }
 
-std::vector<HookInfo*> HookManager::getAllHooks() const {
-    std::lock_guard<std::mutex> lock(getHooksMutex());
-    std::vector<HookInfo*> hooks;
-    hooks.reserve(active_hooks_.size());
+void HookManager::reclaimSnapshotsLocked() {
+    // 以当前计数登记的读者只会拿到最新快照，上一轮计数归零后上一轮退休的快照即可释放
+    uint64_t epoch = read_epoch_.load();
+    if (epoch == 0 || readers_[(epoch - 1) & 1].count.load() != 0) {
+        return;
+    }
+    retired_snapshots_.erase(std::remove_if(retired_snapshots_.begin(),
+                                            retired_snapshots_.end(),
+                                            [epoch](const RetiredSnapshot& retired) {
+                                                return retired.epoch < epoch;
+                                            }),
+                             retired_snapshots_.end());
+}
 
-    for (const auto& pair : active_hooks_) {
-        if (pair.second->is_active) {
-            hooks.push_back(pair.second.get());
+HookSnapshotRef HookManager::acquireSnapshot() const {
+    while (true) {
+        uint64_t epoch = read_epoch_.load();
+        std::atomic<uint64_t>& count = readers_[epoch & 1].count;
+        count.fetch_add(1);
+        // 登记期间写者翻转了 epoch：撤销并按新的 epoch 重试
+        if (read_epoch_.load() == epoch) {
+            return HookSnapshotRef(snapshot_.load(), &count);
         }
+        count.fetch_sub(1, std::memory_order_release);
     }
+}
+
+bool HookManager::isHooked(void* target_address) const {
+    HookSnapshotRef snapshot = acquireSnapshot();
+    return snapshot.find(target_address) != nullptr;
+}
+
+std::optional<HookInfo> HookManager::getHookInfo(void* target_address) const {
+    HookSnapshotRef snapshot = acquireSnapshot();
+    const HookInfo* info = snapshot.find(target_address);
+    if (info == nullptr) {
+        return std::nullopt;
+    }
+    return *info;
+}
+
+std::vector<HookInfo> HookManager::getAllHooks() const {
+    HookSnapshotRef snapshot = acquireSnapshot();
+    return std::vector<HookInfo>(snapshot.begin(), snapshot.end());
+}
+
+void HookManager::setHookStatsEnabled(bool enabled) {
+    HookStatsCounter::setEnabled(enabled);
+}
+
+bool HookManager::isHookStatsEnabled() const {
+    return HookStatsCounter::isEnabled();
+}
+
+std::vector<HookStats> HookManager::getHookStats() const {
+    return HookStatsCounter::collect();
+}
 
-    return hooks;
+void HookManager::resetHookStats() {
+    HookStatsCounter::reset();
 }
 
 void* HookManager::getSymbolAddress(const std::string& library_name,
@@ -3,6 +3,7 @@
 
 #include "hook/inline_hook.h"
 #include "utility/Logger.h"
+#include "utility/Metrics.h"
 
 namespace AnalysisToolkit {
 
@@ -14,6 +15,10 @@ struct Config {
     bool enable_file_log = false;
 
     bool enable_hook_manager = false;
+
+    // 指标导出：外部工具映射 metrics_path 轮询读取，为空时使用 MetricsRegistry::defaultPath()
+    bool enable_metrics = false;
+    std::string metrics_path = "";
 };
 
 bool initialize(const Config& config = Config{});
@@ -23,6 +28,7 @@ bool isInitialized();
 
 Logger* getLogger();
 HookManager* getHookManager();
+MetricsRegistry* getMetricsRegistry();
 
 }  // namespace AnalysisToolkit
 
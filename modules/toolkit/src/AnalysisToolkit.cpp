@@ -1,5 +1,7 @@
 #include "toolkit/AnalysisToolkit.h"
 
+#include <unistd.h>
+
 #include <atomic>
 
 namespace AnalysisToolkit {
@@ -24,6 +26,18 @@ bool initialize(const Config& config) {
 
     logger->info("AnalysisToolkit initializing...");
 
+    // 导出指标：失败不影响其它功能
+    if (config.enable_metrics) {
+        MetricsRegistry& metrics = MetricsRegistry::getInstance();
+        if (metrics.open(config.metrics_path)) {
+            logger->info("Metrics exported to " + metrics.getPath());
+        } else {
+            logger->warn("Failed to export metrics to " +
+                         (config.metrics_path.empty() ? MetricsRegistry::defaultPath(getpid())
+                                                      : config.metrics_path));
+        }
+    }
+
     // 初始化 Hook 管理器
     if (config.enable_hook_manager) {
         HookManager* hook_manager = HookManager::getInstance();
@@ -47,6 +61,9 @@ void cleanup() {
         // 清理 Hook 管理器
         HookManager::getInstance()->cleanup();
 
+        // 停止导出指标并删除段文件
+        MetricsRegistry::getInstance().close();
+
         logger->info("AnalysisToolkit cleanup completed");
         logger->flush();
         g_initialized.store(false);
@@ -70,4 +87,8 @@ HookManager* getHookManager() {
     return HookManager::getInstance();
 }
 
+MetricsRegistry* getMetricsRegistry() {
+    return &MetricsRegistry::getInstance();
+}
+
 }  // namespace AnalysisToolkit
@@ -0,0 +1,70 @@
+//
+// 覆盖率位图：每个跟踪范围一段位图，每一位对应一个指令对齐单元
+//
+
+#ifndef TRACE_COVERAGE_H
+#define TRACE_COVERAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace AnalysisToolkit {
+namespace Trace {
+
+// 位图粒度：每一位覆盖的字节数（取目标架构的最小指令对齐）
+#if defined(__aarch64__)
+constexpr uint64_t kCoverageGranularity = 4;
+#elif defined(__arm__)
+constexpr uint64_t kCoverageGranularity = 2;
+#else
+constexpr uint64_t kCoverageGranularity = 1;
+#endif
+
+// 单个范围的覆盖位图
+struct CoverageRange {
+    uint64_t start;               // 范围起始地址
+    uint64_t end;                 // 范围结束地址（不包含）
+    std::vector<uint64_t> words;  // 位图，第 i 位对应 start + i * kCoverageGranularity
+
+    bool isCovered(uint64_t address) const;
+    size_t coveredUnits() const;
+};
+
+// 多范围覆盖率位图
+class CoverageMap {
+  public:
+    // 添加一个需要统计覆盖率的范围
+    void addRange(uint64_t start, uint64_t end);
+
+    // 标记 [start, end) 已执行，返回是否有新覆盖
+    bool markBlock(uint64_t start, uint64_t end);
+
+    // 检查地址是否已覆盖
+    bool isCovered(uint64_t address) const;
+
+    // 已覆盖的字节数
+    uint64_t coveredBytes() const;
+
+    // 清空覆盖数据但保留范围
+    void reset();
+
+    // 移除所有范围
+    void clear();
+
+    const std::vector<CoverageRange>& ranges() const {
+        return ranges_;
+    }
+
+  private:
+    CoverageRange* findRange(uint64_t address);
+    const CoverageRange* findRange(uint64_t address) const;
+
+    std::vector<CoverageRange> ranges_;  // 按起始地址排序
+    mutable size_t last_range_ = 0;
+};
+
+}  // namespace Trace
+}  // namespace AnalysisToolkit
+
+#endif  // TRACE_COVERAGE_H
@@ -0,0 +1,83 @@
+//
+// 内存访问跟踪：列式批量缓冲区
+//
+
+#ifndef TRACE_MEMORY_ACCESS_H
+#define TRACE_MEMORY_ACCESS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace AnalysisToolkit {
+namespace Trace {
+
+// 访问类型
+enum MemoryAccessKind : uint8_t {
+    MEMORY_ACCESS_READ = 1,
+    MEMORY_ACCESS_WRITE = 2,
+};
+
+// 列式批量缓冲区：每一列是独立数组，便于向量化分析和直接写盘
+struct MemoryAccessBatch {
+    std::vector<uint64_t> pc;       // 指令地址
+    std::vector<uint64_t> address;  // 访问地址
+    std::vector<uint64_t> value;    // 读/写的值（超过 8 字节时只保留低位）
+    std::vector<uint16_t> size;     // 访问大小（字节）
+    std::vector<uint8_t> kind;      // MemoryAccessKind
+    uint32_t thread_id = 0;         // 产生该批次的线程
+
+    size_t count() const {
+        return pc.size();
+    }
+
+    bool empty() const {
+        return pc.empty();
+    }
+
+    void reserve(size_t capacity) {
+        pc.reserve(capacity);
+        address.reserve(capacity);
+        value.reserve(capacity);
+        size.reserve(capacity);
+        kind.reserve(capacity);
+    }
+
+    // 清空数据但保留容量，避免重新分配
+    void clear() {
+        pc.clear();
+        address.clear();
+        value.clear();
+        size.clear();
+        kind.clear();
+    }
+
+    void append(uint64_t pc_value,
+                uint64_t address_value,
+                uint64_t data,
+                uint16_t access_size,
+                uint8_t access_kind) {
+        pc.push_back(pc_value);
+        address.push_back(address_value);
+        value.push_back(data);
+        size.push_back(access_size);
+        kind.push_back(access_kind);
+    }
+};
+
+// 批量消费回调：batch 仅在回调期间有效
+using MemoryAccessBatchCallback = std::function<void(const MemoryAccessBatch& batch)>;
+
+// 内存访问跟踪配置
+struct MemoryTraceConfig {
+    MemoryAccessBatchCallback consumer;  // 批量消费回调
+    size_t batch_size = 8192;            // 每批次的访问条数
+    bool trace_reads = true;             // 是否记录读
+    bool trace_writes = true;            // 是否记录写
+};
+
+}  // namespace Trace
+}  // namespace AnalysisToolkit
+
+#endif  // TRACE_MEMORY_ACCESS_H
@@ -9,6 +9,13 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
+
+#include "trace/coverage.h"
+#include "trace/memory_access.h"
+#include "trace/register_trace.h"
+#include "trace/trace_recorder.h"
 
 namespace AnalysisToolkit {
 
@@ -17,19 +24,76 @@ class Logger;
 
 namespace Trace {
 
+// 指令分类（位掩码）
+enum InstructionClass : uint32_t {
+    INST_CLASS_NONE = 0,
+    INST_CLASS_CONTROL_FLOW = 1u << 0,  // 影响控制流
+    INST_CLASS_BRANCH = 1u << 1,        // 跳转
+    INST_CLASS_CALL = 1u << 2,          // 调用
+    INST_CLASS_RETURN = 1u << 3,        // 返回
+    INST_CLASS_COMPARE = 1u << 4,       // 比较
+    INST_CLASS_LOAD = 1u << 5,          // 可能读内存
+    INST_CLASS_STORE = 1u << 6,         // 可能写内存
+};
+
 // 指令信息结构
+// 字符串字段指向跟踪器内部的解码缓存，仅在回调期间有效；如需保存请自行拷贝
 struct InstructionInfo {
-    uint64_t address;         // 指令地址
-    std::string mnemonic;     // 指令助记符
-    std::string operand;      // 操作数
-    uint64_t thread_id;       // 线程ID
-    std::string disassembly;  // 完整反汇编字符串
+    uint64_t address;              // 指令地址
+    std::string_view mnemonic;     // 指令助记符
+    std::string_view operand;      // 操作数
+    uint64_t thread_id;            // 线程ID
+    std::string_view disassembly;  // 完整反汇编字符串
+    uint32_t size;                 // 指令长度
+    uint32_t inst_class;           // InstructionClass 位掩码
+};
+
+// 跟踪粒度
+enum class TraceMode {
+    Instruction,  // 每条指令回调一次
+    BasicBlock    // 每个基本块回调一次，只统计覆盖率
+};
+
+// 采样配置：用于在生产环境中以有限开销持续跟踪
+// Instruction 模式下 period 按基本块采样：平时只挂基本块入口探针，每 period 个基本块中
+// 只有一个挂载逐指令回调，块内每条指令都交给订阅者、记录器和热点统计，其余基本块不进入
+// 逐指令回调。启用寄存器跟踪时退回逐指令计数采样（每条指令仍进入回调）；
+// 内存访问回调不受采样影响。BasicBlock 模式下每个基本块仍进入回调，只跳过后续记录
+struct SamplingConfig {
+    uint32_t period = 1;         // 每 period 个基本块处理一个，1 表示不采样
+    uint32_t cpu_budget_us = 0;  // 每秒允许的跟踪线程CPU时间（微秒），0 表示不限制
+};
+
+// 热点地址（按执行次数排序）
+struct HotSpot {
+    uint64_t address = 0;
+    uint64_t count = 0;          // 执行次数
+    std::string module;          // 所属模块路径
+    uint64_t module_offset = 0;  // 相对模块基址的偏移
+    std::string symbol;          // 最近的导出符号，未知时为空
+    uint64_t symbol_offset = 0;  // 相对符号的偏移（无符号时为模块偏移）
 };
 
 // 跟踪回调函数类型
 using InstructionCallback = std::function<void(const InstructionInfo& info)>;
 
+// 订阅者ID
+using SubscriberId = uint32_t;
+constexpr SubscriberId kInvalidSubscriberId = 0;
+
+// 指令订阅者：回调 + 廉价的预过滤条件
+struct InstructionSubscriber {
+    InstructionCallback callback;
+    uint64_t range_start = 0;       // 地址过滤 [range_start, range_end)
+    uint64_t range_end = UINT64_MAX;
+    uint32_t class_mask = 0;        // InstructionClass 过滤，0 表示不过滤
+    bool needs_disassembly = true;  // 是否需要反汇编文本
+};
+
 // QBDI跟踪管理器
+// 每个调用 run()/callFunction() 的线程按需获得独立的VM，可并发跟踪；
+// 跟踪范围和回调配置在所有线程间共享，统计信息为各线程汇总
+// 线程退出时其VM和栈随之释放，剩余数据先写出、计数并入汇总统计
 class QBDITracer {
   public:
     QBDITracer();
@@ -47,35 +111,128 @@ class QBDITracer {
     // 开始跟踪指定地址范围
     bool startTrace(uint64_t start_addr, uint64_t end_addr);
 
-    // 开始跟踪整个模块
+    // 开始跟踪整个模块（所有可执行段），模块名可为完整路径、文件名或路径片段
     bool startTraceModule(const std::string& module_name);
 
+    // 在一个会话中同时跟踪多个模块
+    bool startTraceModules(const std::vector<std::string>& module_names);
+
+    // 将模块加入当前会话；未在跟踪时等同于 startTraceModule
+    bool addTraceModule(const std::string& module_name);
+
     // 停止跟踪
     void stopTrace();
 
     // 检查是否正在跟踪
     bool isTracing() const;
 
-    // 设置指令回调函数
+    // 设置跟踪粒度（在 startTrace 之前调用）
+    void setTraceMode(TraceMode mode);
+
+    // 获取当前跟踪粒度
+    TraceMode getTraceMode() const;
+
+    // 设置采样和CPU预算（在下次 startTrace 时生效）
+    // 采样方式见 SamplingConfig；超出预算后移除跟踪回调，直到下一个一秒窗口再重新挂载
+    void setSampling(const SamplingConfig& config);
+
+    // 获取当前采样配置
+    SamplingConfig getSampling() const;
+
+    // 热点分析：按指令（Instruction 模式）或基本块（BasicBlock 模式）统计执行次数
+    // 计数为每线程分块数组，在 stopTrace() 或线程退出VM时合并（在下次 startTrace 时生效）
+    // 每线程内存：块表按跟踪范围大小分配（每 1024 个指令对齐单元 8 字节），计数块在线程
+    // 首次执行到对应代码时分配（每块 8 KB，覆盖 1024 个对齐单元，如 ARM64 上 4 KB 代码）
+    void enableProfiling(bool enable = true);
+
+    bool isProfiling() const;
+
+    // 获取执行次数最多的 top_n 个地址，并通过 dladdr 符号化
+    std::vector<HotSpot> getHotSpots(size_t top_n = 20);
+
+    // 输出热点报告到日志
+    void printHotSpots(size_t top_n = 20);
+
+    // 获取覆盖率位图快照
+    CoverageMap getCoverage() const;
+
+    // 设置指令回调函数（单一回调的便捷接口，替换之前通过此接口设置的回调）
     void setInstructionCallback(InstructionCallback callback);
 
+    // 添加订阅者，可在跟踪过程中调用，不会阻塞VM线程
+    SubscriberId addInstructionSubscriber(const InstructionSubscriber& subscriber);
+
+    // 移除订阅者
+    bool removeInstructionSubscriber(SubscriberId id);
+
+    // 移除所有订阅者
+    void clearInstructionSubscribers();
+
     // 启用/禁用指令打印到日志
     void enableInstructionLogging(bool enable = true);
 
     // 设置日志级别过滤
     void setLogLevel(int level);
 
+    // 启用二进制记录模式：热路径只写入每线程环形缓冲区，由后台线程批量写出
+    bool enableRecording(const RecorderConfig& config);
+
+    // 停止记录并写出剩余记录
+    void disableRecording();
+
+    // 检查是否处于记录模式
+    bool isRecording() const;
+
+    // 启用内存访问跟踪（在 startTrace 之前调用），访问记录按批次交给 consumer
+    bool enableMemoryTrace(const MemoryTraceConfig& config);
+
+    // 停止内存访问跟踪：当前线程立即交付剩余批次，其他线程在下次进入或退出VM时交付
+    void disableMemoryTrace();
+
+    // 立即交付当前线程未满的批次
+    void flushMemoryTrace();
+
+    // 启用寄存器差分跟踪（Instruction 模式，在 startTrace 之前调用）：每条指令只记录相对上一条
+    // 变化的寄存器，每块开头写完整关键帧，可随机定位（见 trace/register_trace.h）。
+    // 记录每条指令，不受采样影响；跟踪回调中的嵌套调用不记录
+    bool enableRegisterTrace(const RegisterTraceConfig& config);
+
+    // 停止寄存器跟踪并写出文件；仍在VM中执行的线程未写出的记录被丢弃
+    void disableRegisterTrace();
+
+    bool isRegisterTracing() const;
+
     // 运行跟踪（阻塞式）
     void run();
 
-    // 通过QBDI虚拟机调用函数（这样可以被插桩）
+    // 通过QBDI虚拟机调用函数（这样可以被插桩），最多 8 个参数
+    // 目标不在跟踪范围内时插桩其所在的可执行映射段，在跟踪配置改变（如 startTrace、
+    // stopTrace）之前的后续调用中复用；调用结束后恢复调用前的寄存器和栈。
+    // 在跟踪回调中调用时使用独立的嵌套VM
     uint64_t callFunction(uint64_t func_addr, const std::vector<uint64_t>& args = {});
 
+    // 以多组参数依次调用同一函数，返回值与 arg_sets 一一对应（单次执行失败为 0）
+    // 准备工作每批只做一次，适合反复调用目标的场景；函数地址不可执行时返回空
+    std::vector<uint64_t> callFunctionBatch(uint64_t func_addr,
+                                            const std::vector<std::vector<uint64_t>>& arg_sets);
+
     // 获取跟踪统计信息
     struct TraceStats {
         uint64_t instruction_count;
         uint64_t execution_time_ms;
         uint64_t traced_addresses_count;
+        uint64_t recorded_count;               // 二进制记录数
+        uint64_t dropped_count;                // 缓冲区满丢弃的记录数
+        uint64_t decoded_count;                // 已缓存解码的指令地址数
+        uint64_t block_count;                  // 基本块执行次数
+        uint64_t unique_block_count;           // 发现的不同基本块数
+        uint64_t covered_bytes;                // 已覆盖的代码字节数
+        uint64_t memory_access_count;          // 记录的内存访问数
+        uint64_t sampled_count;                // 通过采样实际处理的事件数
+        uint64_t estimated_instruction_count;  // 估算的执行指令总数（含未插桩期间）
+        uint64_t estimated_block_count;        // 估算的基本块执行总数（含未插桩期间）
+        uint64_t budget_suspend_count;         // 因超出CPU预算暂停插桩的次数
+        uint64_t register_record_count;        // 已写入寄存器跟踪文件的记录数
     };
 
     TraceStats getStats() const;
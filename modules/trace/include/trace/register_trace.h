@@ -0,0 +1,269 @@
+//
+// 寄存器差分跟踪：每条指令只记录与上一条相比变化的寄存器（位掩码 + 差分值），
+// 每块开头写一个完整关键帧，任意位置的寄存器状态只需从所在块的关键帧向后重放
+//
+// 文件布局：
+//   RegisterTraceHeader
+//   [TraceChunkHeader + 块数据] * N      块数据为变长编码记录，可选 zlib 压缩
+//   块索引 RegisterChunkIndexEntry * N   按线程和线程内序号定位块
+//   RegisterTraceFooter
+//
+// 块内每条记录：varint(地址差分) varint(变化掩码) varint(寄存器差分)...
+// 块内第一条记录为关键帧，掩码包含除 PC 外的全部寄存器，差分基准为 0；
+// PC 不在掩码中，由记录地址给出。不同线程的块交错存放，每块只属于一个线程
+//
+
+#ifndef TRACE_REGISTER_TRACE_H
+#define TRACE_REGISTER_TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "trace/trace_file.h"
+
+namespace AnalysisToolkit {
+namespace Trace {
+
+// 每条状态最多包含的寄存器数（变化掩码为 64 位）
+constexpr uint32_t kMaxTraceRegisters = 64;
+
+struct RegisterTraceHeader {
+    char magic[8];  // "ATKREGTR"
+    uint32_t version;
+    uint32_t register_count;     // 每条状态的寄存器数
+    uint32_t pc_index;           // PC 的寄存器序号
+    uint32_t keyframe_interval;  // 每块最大记录数
+};
+
+struct RegisterChunkIndexEntry {
+    uint64_t file_offset;     // TraceChunkHeader 在文件中的偏移
+    uint64_t first_sequence;  // 块内第一条记录的线程内序号
+    uint64_t first_address;   // 块内第一条指令地址
+    uint32_t thread_id;
+    uint32_t record_count;
+};
+
+struct RegisterTraceFooter {
+    uint64_t index_offset;
+    uint64_t chunk_count;
+    uint64_t record_count;
+    char magic[8];  // "ATKREGND"
+};
+
+// 寄存器差分跟踪配置
+struct RegisterTraceConfig {
+    std::string output_path;            // 输出文件路径
+    uint32_t keyframe_interval = 4096;  // 关键帧间隔（记录数），随机访问最多重放这么多条
+    bool compress = true;               // 是否压缩块数据（未编译 zlib 时忽略）
+};
+
+// 重建后的一条记录：执行 address 处指令之前的寄存器状态
+struct RegisterTraceEntry {
+    uint64_t sequence;      // 线程内序号（从 0 开始）
+    uint64_t address;       // 指令地址
+    uint32_t thread_id;     // 线程ID
+    bool keyframe;          // 是否为关键帧
+    uint64_t changed_mask;  // 相对上一条变化的寄存器
+    uint64_t registers[kMaxTraceRegisters];
+};
+
+// 寄存器跟踪文件写入器：各线程的编码器写满一块后交给它，可在任意线程调用
+class RegisterTraceWriter {
+  public:
+    RegisterTraceWriter() = default;
+    ~RegisterTraceWriter();
+
+    RegisterTraceWriter(const RegisterTraceWriter&) = delete;
+    RegisterTraceWriter& operator=(const RegisterTraceWriter&) = delete;
+
+    bool open(const RegisterTraceConfig& config, uint32_t register_count, uint32_t pc_index);
+
+    // 写出索引并关闭文件，之后提交的块被丢弃
+    bool close();
+
+    bool isOpen() const;
+
+    // 每次 open() 分配新的会话号，编码器据此重置序号
+    uint64_t session() const {
+        return session_.load(std::memory_order_acquire);
+    }
+
+    uint32_t registerCount() const {
+        return register_count_;
+    }
+
+    uint32_t pcIndex() const {
+        return pc_index_;
+    }
+
+    uint32_t keyframeInterval() const {
+        return keyframe_interval_;
+    }
+
+    // 提交一个编码好的块；压缩在调用线程完成（使用 scratch），只有写文件时加锁。
+    // 不属于当前会话的块被丢弃
+    void writeChunk(uint64_t session,
+                    const RegisterChunkIndexEntry& info,
+                    const std::vector<uint8_t>& raw,
+                    std::vector<uint8_t>& scratch);
+
+    uint64_t recordCount() const;
+
+  private:
+    mutable std::mutex mutex_;
+    FILE* file_ = nullptr;
+    std::atomic<bool> compress_{false};
+    uint64_t file_offset_ = 0;
+    uint64_t record_count_ = 0;
+    std::vector<RegisterChunkIndexEntry> index_;
+
+    std::atomic<uint64_t> session_{0};
+    uint32_t register_count_ = 0;
+    uint32_t pc_index_ = 0;
+    uint32_t keyframe_interval_ = 0;
+};
+
+// 单线程编码器（非线程安全，每个 VM 独占一个）
+// 调用方提供当前指令写入的寄存器掩码，下一条指令只比较这些寄存器
+class RegisterTraceEncoder {
+  public:
+    // 绑定写入器；会话变化时重置序号，否则继续上次的序号
+    void attach(RegisterTraceWriter* writer, uint32_t thread_id);
+
+    // 写出未满的块后解除绑定
+    void detach();
+
+    bool isAttached() const {
+        return writer_ != nullptr;
+    }
+
+    // 下一条记录比较全部寄存器：状态可能在未观察到的地方被修改（刚进入VM、插桩中断等）
+    void invalidate() {
+        pending_mask_ = all_mask_;
+    }
+
+    // 记录执行 address 处指令之前的状态；writes 为该指令可能写入的寄存器，
+    // 0 表示无法确定，下一条记录比较全部寄存器
+    void record(uint64_t address, const uint64_t* registers, uint64_t writes) {
+        uint64_t changed = 0;
+        if (count_ == 0) {
+            beginChunk(address);
+            changed = all_mask_;
+        } else {
+            for (uint64_t mask = pending_mask_; mask != 0; mask &= mask - 1) {
+                uint32_t index = static_cast<uint32_t>(__builtin_ctzll(mask));
+                if (registers[index] != last_[index]) {
+                    changed |= 1ULL << index;
+                }
+            }
+        }
+        encode(address, registers, changed);
+        pending_mask_ = writes != 0 ? writes & all_mask_ : all_mask_;
+
+        if (++count_ >= keyframe_interval_) {
+            flush();
+        }
+    }
+
+    // 写出当前块，下一条记录成为关键帧
+    void flush();
+
+    uint64_t sequence() const {
+        return sequence_ + count_;
+    }
+
+  private:
+    void beginChunk(uint64_t address);
+    void encode(uint64_t address, const uint64_t* registers, uint64_t changed);
+
+    RegisterTraceWriter* writer_ = nullptr;
+    uint64_t session_ = 0;
+    uint32_t thread_id_ = 0;
+    uint32_t register_count_ = 0;
+    uint32_t keyframe_interval_ = 1;
+    uint64_t all_mask_ = 0;  // 除 PC 外的全部寄存器
+
+    uint64_t sequence_ = 0;  // 当前块第一条记录的序号
+    uint32_t count_ = 0;     // 当前块的记录数
+    uint64_t first_address_ = 0;
+    uint64_t prev_address_ = 0;
+    uint64_t pending_mask_ = 0;
+    uint64_t last_[kMaxTraceRegisters] = {};
+
+    std::vector<uint8_t> chunk_;
+    std::vector<uint8_t> scratch_;
+};
+
+// 基于 mmap 的寄存器跟踪读取器
+class RegisterTraceReader {
+  public:
+    using EntryCallback = std::function<bool(const RegisterTraceEntry& entry)>;
+
+    RegisterTraceReader() = default;
+    ~RegisterTraceReader();
+
+    RegisterTraceReader(const RegisterTraceReader&) = delete;
+    RegisterTraceReader& operator=(const RegisterTraceReader&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const {
+        return data_ != nullptr;
+    }
+
+    uint32_t registerCount() const {
+        return header_.register_count;
+    }
+
+    uint32_t pcIndex() const {
+        return header_.pc_index;
+    }
+
+    uint64_t recordCount() const {
+        return footer_.record_count;
+    }
+
+    const std::vector<RegisterChunkIndexEntry>& chunks() const {
+        return index_;
+    }
+
+    // 文件中出现的线程
+    std::vector<uint32_t> threads() const;
+
+    // 某线程的记录数
+    uint64_t recordCount(uint32_t thread_id) const;
+
+    // 重建线程 thread_id 第 sequence 条记录时的寄存器状态
+    bool stateAt(uint32_t thread_id, uint64_t sequence, RegisterTraceEntry& entry);
+
+    // 从第 first 条开始按序重放，回调返回 false 时停止
+    void forEach(uint32_t thread_id,
+                 uint64_t first,
+                 uint64_t count,
+                 const EntryCallback& callback);
+
+  private:
+    // 解码块并对每条记录调用回调，回调返回 false 时停止；块损坏时返回 false
+    bool decodeChunk(size_t chunk, RegisterTraceEntry& entry, const EntryCallback& callback);
+    size_t findChunk(uint32_t thread_id, uint64_t sequence) const;
+
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    RegisterTraceHeader header_ = {};
+    RegisterTraceFooter footer_ = {};
+    std::vector<RegisterChunkIndexEntry> index_;
+    std::unordered_map<uint32_t, std::vector<size_t>> thread_chunks_;  // 按序号排列的块
+    std::vector<uint8_t> scratch_;
+};
+
+}  // namespace Trace
+}  // namespace AnalysisToolkit
+
+#endif  // TRACE_REGISTER_TRACE_H
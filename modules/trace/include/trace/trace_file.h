@@ -0,0 +1,195 @@
+//
+// 索引化的压缩跟踪文件：分块存储、地址差分编码、按块压缩、文件尾索引
+//
+// 文件布局：
+//   TraceFileHeader
+//   [TraceChunkHeader + 块数据] * N      块数据为变长编码记录，可选 zlib 压缩
+//   字符串表                             地址 -> 反汇编文本
+//   块索引 TraceChunkIndexEntry * N      按序号和时间戳定位块
+//   TraceFileFooter                      定位字符串表和索引
+//
+
+#ifndef TRACE_TRACE_FILE_H
+#define TRACE_TRACE_FILE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "trace/trace_recorder.h"
+
+namespace AnalysisToolkit {
+namespace Trace {
+
+// 块数据编码方式
+enum TraceChunkCodec : uint32_t {
+    TRACE_CHUNK_RAW = 0,   // 未压缩
+    TRACE_CHUNK_ZLIB = 1,  // zlib deflate
+};
+
+struct TraceFileHeader {
+    char magic[8];  // "ATKTRIDX"
+    uint32_t version;
+    uint32_t chunk_records;  // 每块最大记录数
+};
+
+struct TraceChunkHeader {
+    uint32_t codec;         // TraceChunkCodec
+    uint32_t record_count;  // 块内记录数
+    uint32_t raw_size;      // 解压后大小
+    uint32_t stored_size;   // 文件中存储的大小
+};
+
+struct TraceChunkIndexEntry {
+    uint64_t file_offset;      // TraceChunkHeader 在文件中的偏移
+    uint64_t first_sequence;   // 块内第一条记录的全局序号
+    uint64_t first_timestamp;  // 块内最早时间戳（单调时钟纳秒）
+    uint64_t last_timestamp;   // 块内最晚时间戳（单调时钟纳秒）
+    uint32_t record_count;
+    uint32_t reserved;
+};
+
+struct TraceFileFooter {
+    uint64_t string_table_offset;
+    uint64_t string_count;
+    uint64_t index_offset;
+    uint64_t chunk_count;
+    uint64_t record_count;
+    char magic[8];  // "ATKTREND"
+};
+
+// 解码后的跟踪条目
+struct TraceFileEntry {
+    uint64_t index;      // 文件内全局序号（从 0 开始）
+    uint64_t address;    // 指令或基本块地址
+    uint64_t sequence;   // 线程内序号（同 TraceRecord::sequence）
+    uint64_t timestamp;  // 生产者写入时的单调时钟时间戳（纳秒，见 traceTimestampNs）
+    uint32_t thread_id;  // 线程ID
+    uint32_t flags;      // TraceRecordFlags
+};
+
+// 写入选项
+struct TraceFileOptions {
+    uint32_t chunk_records = 1 << 16;  // 每块记录数
+    bool compress = true;              // 是否压缩块数据（未编译 zlib 时忽略）
+};
+
+// 跟踪文件写入器（非线程安全，通常由记录器的后台线程独占）
+class TraceFileWriter {
+  public:
+    TraceFileWriter() = default;
+    ~TraceFileWriter();
+
+    TraceFileWriter(const TraceFileWriter&) = delete;
+    TraceFileWriter& operator=(const TraceFileWriter&) = delete;
+
+    bool open(const std::string& path, const TraceFileOptions& options = TraceFileOptions());
+
+    // 写出剩余块、字符串表和索引并关闭文件
+    bool close();
+
+    bool isOpen() const {
+        return file_ != nullptr;
+    }
+
+    // 追加一批记录，timestamp 为这批记录的时间戳
+    void append(const TraceRecord* records, size_t count, uint64_t timestamp);
+
+    // 追加一批记录，timestamps[i] 为第 i 条记录的时间戳
+    void append(const TraceRecord* records, const uint64_t* timestamps, size_t count);
+
+    // 为地址登记反汇编文本（每个地址只保存一次）
+    void annotate(uint64_t address, std::string_view text);
+
+    uint64_t recordCount() const {
+        return record_count_;
+    }
+
+  private:
+    void appendOne(const TraceRecord& record, uint64_t timestamp);
+    bool flushChunk();
+
+    FILE* file_ = nullptr;
+    TraceFileOptions options_;
+    uint64_t file_offset_ = 0;
+    uint64_t record_count_ = 0;
+
+    // 当前块的编码状态
+    std::vector<uint8_t> chunk_;
+    std::vector<uint8_t> compressed_;
+    TraceChunkIndexEntry current_ = {};
+    uint64_t prev_address_ = 0;
+    uint64_t prev_sequence_ = 0;
+    uint64_t prev_timestamp_ = 0;
+    uint32_t prev_thread_id_ = 0;
+
+    std::vector<TraceChunkIndexEntry> index_;
+    std::unordered_map<uint64_t, std::string> strings_;
+};
+
+// 基于 mmap 的跟踪文件读取器：只解压需要访问的块
+class TraceFileReader {
+  public:
+    using EntryCallback = std::function<bool(const TraceFileEntry& entry)>;
+
+    TraceFileReader() = default;
+    ~TraceFileReader();
+
+    TraceFileReader(const TraceFileReader&) = delete;
+    TraceFileReader& operator=(const TraceFileReader&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const {
+        return data_ != nullptr;
+    }
+
+    uint64_t recordCount() const {
+        return footer_.record_count;
+    }
+
+    size_t chunkCount() const {
+        return index_.size();
+    }
+
+    const std::vector<TraceChunkIndexEntry>& chunks() const {
+        return index_;
+    }
+
+    // 读取第 index 条记录
+    bool read(uint64_t index, TraceFileEntry& entry);
+
+    // 从第 first 条开始遍历，回调返回 false 时停止
+    void forEach(uint64_t first, uint64_t count, const EntryCallback& callback);
+
+    // 遍历时间窗口 [begin, end) 内的记录，回调返回 false 时停止
+    void forEachInTimeWindow(uint64_t begin, uint64_t end, const EntryCallback& callback);
+
+    // 获取地址的反汇编文本，未登记时返回空
+    std::string_view disassembly(uint64_t address) const;
+
+  private:
+    bool loadChunk(size_t chunk);
+    size_t findChunkBySequence(uint64_t index) const;
+
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    TraceFileFooter footer_ = {};
+    std::vector<TraceChunkIndexEntry> index_;
+    std::unordered_map<uint64_t, std::string_view> strings_;
+
+    // 最近解码的块
+    size_t loaded_chunk_ = SIZE_MAX;
+    std::vector<TraceFileEntry> entries_;
+    std::vector<uint8_t> scratch_;
+};
+
+}  // namespace Trace
+}  // namespace AnalysisToolkit
+
+#endif  // TRACE_TRACE_FILE_H
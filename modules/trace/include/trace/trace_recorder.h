@@ -0,0 +1,249 @@
+//
+// 二进制跟踪记录器：每线程无锁环形缓冲区 + 后台批量刷新线程
+//
+
+#ifndef TRACE_TRACE_RECORDER_H
+#define TRACE_TRACE_RECORDER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace AnalysisToolkit {
+namespace Trace {
+
+// 跟踪记录标志位
+enum TraceRecordFlags : uint32_t {
+    TRACE_RECORD_NONE = 0,
+    TRACE_RECORD_BLOCK_ENTRY = 1u << 0,  // 记录的是基本块入口地址
+};
+
+// 固定大小的二进制跟踪记录
+struct TraceRecord {
+    uint64_t address;    // 指令地址
+    uint64_t sequence;   // 线程内序号（丢弃的记录也会占用序号，便于发现缺口）
+    uint32_t thread_id;  // 线程ID
+    uint32_t flags;      // TraceRecordFlags
+};
+
+static_assert(sizeof(TraceRecord) == 24, "TraceRecord must stay a fixed 24-byte record");
+
+// 批量消费回调：由后台线程调用，records 仅在回调期间有效
+using RecordBatchCallback = std::function<void(const TraceRecord* records, size_t count)>;
+
+// 输出文件格式
+enum class RecordFileFormat {
+    Raw,     // 文件头 + 连续的 TraceRecord
+    Indexed  // 分块、差分编码、可压缩并带索引的格式（见 trace/trace_file.h）
+};
+
+// 记录器配置
+struct RecorderConfig {
+    std::string output_path;           // 输出文件路径，为空则不写文件
+    RecordBatchCallback consumer;      // 批量消费回调（可选）
+    size_t buffer_capacity = 1 << 16;  // 每线程环形缓冲区容量（记录数，向上取 2 的幂）
+    uint32_t flush_interval_ms = 10;   // 后台线程刷新间隔
+    RecordFileFormat file_format = RecordFileFormat::Raw;
+    uint32_t chunk_records = 1 << 16;  // Indexed 格式每块记录数
+    bool compress = true;              // Indexed 格式是否压缩
+    bool record_disassembly = false;   // Indexed 格式是否为每个地址保存反汇编文本
+};
+
+class TraceFileWriter;
+
+// 单调时钟（纳秒），与跟踪文件中的时间戳同源
+inline uint64_t traceTimestampNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+}
+
+// 单生产者/单消费者无锁环形缓冲区
+// 生产者为被跟踪线程，消费者为后台刷新线程；缓冲区满时丢弃新记录并计数
+// 生产者每 kTimestampStride 条记录读一次时钟，同一组记录共用该组第一条写入时的时间戳
+class TraceRingBuffer {
+  public:
+    static constexpr size_t kTimestampStride = 256;  // 容量较小时取容量的 1/4
+
+    TraceRingBuffer(size_t capacity, uint32_t thread_id);
+
+    TraceRingBuffer(const TraceRingBuffer&) = delete;
+    TraceRingBuffer& operator=(const TraceRingBuffer&) = delete;
+
+    // 写入一条记录（仅生产者线程调用，无分配、无锁）
+    bool push(uint64_t address, uint32_t flags) {
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        uint64_t sequence = next_sequence_++;
+
+        // 新的一组复用时间戳槽位，要求上一轮同槽位的整组记录已被取走
+        bool new_group = (head & stamp_mask_) == 0;
+        uint64_t limit = new_group ? stamp_limit_ : mask_;
+        if (head - cached_tail_ > limit) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head - cached_tail_ > limit) {
+                dropped_.store(dropped_.load(std::memory_order_relaxed) + 1,
+                               std::memory_order_relaxed);
+                return false;
+            }
+        }
+
+        if (new_group) {
+            stamps_[(head & mask_) >> stamp_shift_] = traceTimestampNs();
+        }
+
+        TraceRecord& record = records_[head & mask_];
+        record.address = address;
+        record.sequence = sequence;
+        record.thread_id = thread_id_;
+        record.flags = flags;
+
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 取出最多 max_count 条记录（仅消费者线程调用）；timestamps 不为空时同时取出每条的时间戳
+    size_t drain(TraceRecord* out, size_t max_count, uint64_t* timestamps = nullptr);
+
+    uint32_t threadId() const {
+        return thread_id_;
+    }
+
+    uint64_t recorded() const {
+        return head_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t dropped() const {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+  private:
+    std::unique_ptr<TraceRecord[]> records_;
+    std::unique_ptr<uint64_t[]> stamps_;  // 每组记录一个时间戳
+    uint64_t mask_;
+    uint64_t stamp_mask_;   // 组内偏移掩码
+    uint64_t stamp_limit_;  // 开始新的一组时允许的最大未取走记录数
+    uint32_t stamp_shift_;  // 组大小的位数
+    uint32_t thread_id_;
+
+    // 生产者私有
+    alignas(64) uint64_t next_sequence_ = 0;
+    uint64_t cached_tail_ = 0;
+    std::atomic<uint64_t> head_{0};
+    std::atomic<uint64_t> dropped_{0};
+
+    // 消费者写入
+    alignas(64) std::atomic<uint64_t> tail_{0};
+};
+
+// 跟踪记录器：管理每线程缓冲区，并由后台线程批量写出
+class TraceRecorder {
+  public:
+    struct Stats {
+        uint64_t recorded_count;  // 已写入缓冲区的记录数
+        uint64_t dropped_count;   // 缓冲区满被丢弃的记录数
+        uint64_t flushed_count;   // 已交付给文件/回调的记录数
+        uint64_t batch_count;     // 已交付的批次数
+        uint32_t thread_buffers;  // 已分配的线程缓冲区数
+    };
+
+    TraceRecorder();
+    ~TraceRecorder();
+
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    // 启动记录器和后台刷新线程
+    bool start(const RecorderConfig& config);
+
+    // 停止后台线程并写出剩余记录（不得与 record() 并发调用）
+    void stop();
+
+    bool isRunning() const {
+        return running_.load(std::memory_order_acquire);
+    }
+
+    // 热路径：为当前线程追加一条记录
+    void record(uint64_t address, uint32_t flags = TRACE_RECORD_NONE) {
+        ThreadCache& cache = t_cache_;
+        if (cache.generation != generation_.load(std::memory_order_acquire)) {
+            acquireThreadBuffer(cache);
+        }
+        cache.buffer->push(address, flags);
+    }
+
+    // 同步刷新所有缓冲区
+    void flush();
+
+    // 释放之前会话的缓冲区：start() 只让它们退休，仍在 record() 中的线程可能还在写入。
+    // 调用方须保证此时没有线程在 record() 中
+    void reclaimRetired();
+
+    // 为地址登记反汇编文本，写入 Indexed 格式文件的字符串表（可在任意线程调用）
+    void annotate(uint64_t address, std::string_view text);
+
+    // 是否正在写入 Indexed 格式文件
+    bool isIndexed() const {
+        return indexed_.load(std::memory_order_relaxed);
+    }
+
+    Stats getStats() const;
+
+    // 获取当前线程的系统线程ID
+    static uint32_t currentThreadId();
+
+  private:
+    struct ThreadCache {
+        uint64_t generation;
+        TraceRingBuffer* buffer;
+    };
+
+    void acquireThreadBuffer(ThreadCache& cache);
+    void drainerLoop();
+    size_t drainAll();
+    void deliver(const TraceRecord* records, const uint64_t* timestamps, size_t count);
+
+    static thread_local ThreadCache t_cache_;
+    static std::atomic<uint64_t> next_generation_;
+
+    RecorderConfig config_;
+    std::atomic<uint64_t> generation_;
+    std::atomic<bool> running_{false};
+
+    mutable std::mutex buffers_mutex_;
+    std::vector<std::unique_ptr<TraceRingBuffer>> buffers_;
+    std::vector<std::unique_ptr<TraceRingBuffer>> retired_buffers_;
+    size_t buffer_capacity_ = 0;  // 新缓冲区容量，与 buffers_ 一起受锁保护
+
+    std::mutex drain_mutex_;  // 串行化后台线程与 flush()
+    std::unique_ptr<TraceRecord[]> batch_;
+    std::unique_ptr<uint64_t[]> batch_timestamps_;
+    FILE* output_file_ = nullptr;
+    std::unique_ptr<TraceFileWriter> writer_;
+    std::atomic<bool> indexed_{false};
+
+    // 待写入的反汇编注释，由后台线程转交给 writer_
+    std::mutex annotations_mutex_;
+    std::vector<std::pair<uint64_t, std::string>> pending_annotations_;
+    std::atomic<uint64_t> flushed_count_{0};
+    std::atomic<uint64_t> batch_count_{0};
+
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    bool stop_requested_ = false;
+    std::thread drainer_;
+};
+
+}  // namespace Trace
+}  // namespace AnalysisToolkit
+
+#endif  // TRACE_TRACE_RECORDER_H
@@ -0,0 +1,129 @@
+//
+// 覆盖率位图实现
+//
+
+#include "trace/coverage.h"
+
+#include <algorithm>
+
+namespace AnalysisToolkit {
+namespace Trace {
+
+bool CoverageRange::isCovered(uint64_t address) const {
+    if (address < start || address >= end) {
+        return false;
+    }
+    uint64_t unit = (address - start) / kCoverageGranularity;
+    return (words[unit / 64] >> (unit % 64)) & 1;
+}
+
+size_t CoverageRange::coveredUnits() const {
+    size_t count = 0;
+    for (uint64_t word : words) {
+        count += static_cast<size_t>(__builtin_popcountll(word));
+    }
+    return count;
+}
+
+void CoverageMap::addRange(uint64_t start, uint64_t end) {
+    if (end <= start) {
+        return;
+    }
+
+    for (const auto& range : ranges_) {
+        if (range.start == start && range.end == end) {
+            return;
+        }
+    }
+
+    CoverageRange range;
+    range.start = start;
+    range.end = end;
+    uint64_t units = (end - start + kCoverageGranularity - 1) / kCoverageGranularity;
+    range.words.assign((units + 63) / 64, 0);
+
+    auto pos = std::lower_bound(
+        ranges_.begin(), ranges_.end(), start, [](const CoverageRange& r, uint64_t value) {
+            return r.start < value;
+        });
+    ranges_.insert(pos, std::move(range));
+    last_range_ = 0;
+}
+
+bool CoverageMap::markBlock(uint64_t start, uint64_t end) {
+    CoverageRange* range = findRange(start);
+    if (range == nullptr) {
+        return false;
+    }
+
+    uint64_t last = std::min(std::max(end, start + 1), range->end);
+    uint64_t first_unit = (start - range->start) / kCoverageGranularity;
+    uint64_t last_unit = (last - 1 - range->start) / kCoverageGranularity;
+
+    bool is_new = false;
+    for (uint64_t unit = first_unit; unit <= last_unit; ++unit) {
+        uint64_t& word = range->words[unit / 64];
+        uint64_t bit = 1ull << (unit % 64);
+        if ((word & bit) == 0) {
+            word |= bit;
+            is_new = true;
+        }
+    }
+    return is_new;
+}
+
+bool CoverageMap::isCovered(uint64_t address) const {
+    const CoverageRange* range = findRange(address);
+    return range != nullptr && range->isCovered(address);
+}
+
+uint64_t CoverageMap::coveredBytes() const {
+    uint64_t bytes = 0;
+    for (const auto& range : ranges_) {
+        bytes += range.coveredUnits() * kCoverageGranularity;
+    }
+    return bytes;
+}
+
+void CoverageMap::reset() {
+    for (auto& range : ranges_) {
+        std::fill(range.words.begin(), range.words.end(), 0);
+    }
+}
+
+void CoverageMap::clear() {
+    ranges_.clear();
+    last_range_ = 0;
+}
+
+CoverageRange* CoverageMap::findRange(uint64_t address) {
+    return const_cast<CoverageRange*>(static_cast<const CoverageMap*>(this)->findRange(address));
+}
+
+const CoverageRange* CoverageMap::findRange(uint64_t address) const {
+    // 基本块通常集中在同一个范围内，先检查上一次命中的范围
+    if (last_range_ < ranges_.size()) {
+        const CoverageRange& last = ranges_[last_range_];
+        if (address >= last.start && address < last.end) {
+            return &last;
+        }
+    }
+
+    auto it = std::upper_bound(
+        ranges_.begin(), ranges_.end(), address, [](uint64_t value, const CoverageRange& r) {
+            return value < r.start;
+        });
+    if (it == ranges_.begin()) {
+        return nullptr;
+    }
+    --it;
+    if (address >= it->end) {
+        return nullptr;
+    }
+
+    last_range_ = static_cast<size_t>(it - ranges_.begin());
+    return &*it;
+}
+
+}  // namespace Trace
+}  // namespace AnalysisToolkit
@@ -0,0 +1,130 @@
+//
+// 指令解码缓存实现
+//
+
+#include "instruction_cache.h"
+
+#include "trace/qbdi.h"
+
+namespace AnalysisToolkit {
+namespace Trace {
+
+uint32_t StringPool::intern(std::string_view text) {
+    auto it = index_.find(text);
+    if (it != index_.end()) {
+        return it->second;
+    }
+
+    uint32_t id = static_cast<uint32_t>(strings_.size());
+    strings_.emplace_back(text);
+    index_.emplace(std::string_view(strings_.back()), id);
+    return id;
+}
+
+DecodedInstruction InstructionCache::decode(QBDI::VMInstanceRef vm, uint64_t address) {
+    DecodedInstruction entry = {};
+    entry.address = address;
+    entry.mnemonic_id = StringPool::kInvalidId;
+    entry.disassembly_id = StringPool::kInvalidId;
+
+    const QBDI::InstAnalysis* analysis = vm->getInstAnalysis(QBDI::ANALYSIS_INSTRUCTION);
+    if (analysis == nullptr) {
+        return entry;
+    }
+
+    entry.size = analysis->instSize;
+
+    uint32_t inst_class = INST_CLASS_NONE;
+    if (analysis->affectControlFlow) {
+        inst_class |= INST_CLASS_CONTROL_FLOW;
+    }
+    if (analysis->isBranch) {
+        inst_class |= INST_CLASS_BRANCH;
+    }
+    if (analysis->isCall) {
+        inst_class |= INST_CLASS_CALL;
+    }
+    if (analysis->isReturn) {
+        inst_class |= INST_CLASS_RETURN;
+    }
+    if (analysis->isCompare) {
+        inst_class |= INST_CLASS_COMPARE;
+    }
+    if (analysis->mayLoad) {
+        inst_class |= INST_CLASS_LOAD;
+    }
+    if (analysis->mayStore) {
+        inst_class |= INST_CLASS_STORE;
+    }
+    entry.inst_class = inst_class;
+
+    if (analysis->mnemonic != nullptr) {
+        entry.mnemonic_id = strings_.intern(analysis->mnemonic);
+    }
+    return entry;
+}
+
+void InstructionCache::ensureDisassembly(QBDI::VMInstanceRef vm, DecodedInstruction& entry) {
+    if (entry.disassembly_id != StringPool::kInvalidId) {
+        return;
+    }
+
+    // 回调内请求当前指令的反汇编；每个地址只会发生一次
+    const QBDI::InstAnalysis* analysis = vm->getInstAnalysis(QBDI::ANALYSIS_DISASSEMBLY);
+    if (analysis == nullptr || analysis->disassembly == nullptr) {
+        entry.disassembly_id = strings_.intern("");
+        return;
+    }
+
+    std::string_view text(analysis->disassembly);
+
+    // 去掉前导空白，并记录操作数起始位置
+    size_t begin = text.find_first_not_of(" \t");
+    text = begin == std::string_view::npos ? std::string_view() : text.substr(begin);
+    entry.disassembly_id = strings_.intern(text);
+
+    size_t split = text.find_first_of(" \t");
+    if (split != std::string_view::npos) {
+        size_t operand = text.find_first_not_of(" \t", split);
+        entry.operand_offset =
+            static_cast<uint32_t>(operand == std::string_view::npos ? text.size() : operand);
+    } else {
+        entry.operand_offset = static_cast<uint32_t>(text.size());
+    }
+}
+
+void InstructionCache::ensureRegisterWrites(QBDI::VMInstanceRef vm, DecodedInstruction& entry) {
+    if (entry.register_writes != 0) {
+        return;
+    }
+
+    // 控制流指令可能跳到未插桩的代码再返回，分析不到写入时也无法确定：都按全部寄存器处理
+    const uint64_t all_registers = ~0ULL;
+    const QBDI::InstAnalysis* analysis = vm->getInstAnalysis(QBDI::ANALYSIS_OPERANDS);
+    if (analysis == nullptr || analysis->affectControlFlow) {
+        entry.register_writes = all_registers;
+        return;
+    }
+
+    uint64_t writes = 0;
+    for (uint8_t i = 0; i < analysis->numOperands; ++i) {
+        const QBDI::OperandAnalysis& operand = analysis->operands[i];
+        if (operand.type == QBDI::OPERAND_GPR && operand.regCtxIdx >= 0 &&
+            operand.regCtxIdx < 64 && (operand.regAccess & QBDI::REGISTER_WRITE)) {
+            writes |= 1ULL << operand.regCtxIdx;
+        }
+    }
+    if (analysis->flagsAccess & QBDI::REGISTER_WRITE) {
+        writes |= 1ULL << QBDI::REG_FLAG;
+    }
+    entry.register_writes = writes != 0 ? writes : all_registers;
+}
+
+std::string_view InstructionCache::operand(const DecodedInstruction& entry) const {
+    std::string_view text = disassembly(entry);
+    return entry.operand_offset < text.size() ? text.substr(entry.operand_offset)
+                                              : std::string_view();
+}
+
+}  // namespace Trace
+}  // namespace AnalysisToolkit
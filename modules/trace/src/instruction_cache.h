@@ -0,0 +1,119 @@
+//
+// 按地址缓存的指令解码信息，避免在热循环中重复获取反汇编和拷贝字符串
+//
+
+#ifndef TRACE_INSTRUCTION_CACHE_H
+#define TRACE_INSTRUCTION_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "QBDI.h"
+
+namespace AnalysisToolkit {
+namespace Trace {
+
+// 字符串驻留池：相同的助记符/反汇编只保存一份，以 ID 引用
+class StringPool {
+  public:
+    static constexpr uint32_t kInvalidId = 0xffffffff;
+
+    uint32_t intern(std::string_view text);
+
+    std::string_view get(uint32_t id) const {
+        return id < strings_.size() ? std::string_view(strings_[id]) : std::string_view();
+    }
+
+    size_t size() const {
+        return strings_.size();
+    }
+
+    void clear() {
+        index_.clear();
+        strings_.clear();
+    }
+
+  private:
+    // deque 保证元素地址稳定，index_ 的键直接引用其中的字符串
+    std::deque<std::string> strings_;
+    std::unordered_map<std::string_view, uint32_t> index_;
+};
+
+// 单条指令的解码结果
+struct DecodedInstruction {
+    uint64_t address;
+    uint32_t size;
+    uint32_t inst_class;       // InstructionClass 位掩码
+    uint32_t mnemonic_id;      // StringPool ID
+    uint32_t disassembly_id;   // StringPool ID，未请求文本时为 kInvalidId
+    uint32_t operand_offset;   // 操作数在反汇编字符串中的起始位置
+    uint64_t register_writes;  // 可能写入的 GPR 位掩码，0 表示尚未分析
+};
+
+// 地址 -> 解码信息缓存（非线程安全，每个 VM 独占一份）
+class InstructionCache {
+  public:
+    InstructionCache() {
+        entries_.reserve(4096);
+    }
+
+    // 查找指令，未命中时通过 ANALYSIS_INSTRUCTION 解码（不请求反汇编）
+    DecodedInstruction& lookup(QBDI::VMInstanceRef vm, uint64_t address) {
+        if (last_ != nullptr && last_->address == address) {
+            return *last_;
+        }
+
+        auto it = entries_.find(address);
+        if (it == entries_.end()) {
+            it = entries_.emplace(address, decode(vm, address)).first;
+            count_.store(entries_.size(), std::memory_order_relaxed);
+        }
+        last_ = &it->second;
+        return it->second;
+    }
+
+    // 确保条目已有反汇编文本，仅在消费者需要文本时调用
+    void ensureDisassembly(QBDI::VMInstanceRef vm, DecodedInstruction& entry);
+
+    // 确保条目已有写入寄存器掩码，仅在寄存器跟踪时调用
+    void ensureRegisterWrites(QBDI::VMInstanceRef vm, DecodedInstruction& entry);
+
+    std::string_view mnemonic(const DecodedInstruction& entry) const {
+        return strings_.get(entry.mnemonic_id);
+    }
+
+    std::string_view disassembly(const DecodedInstruction& entry) const {
+        return strings_.get(entry.disassembly_id);
+    }
+
+    std::string_view operand(const DecodedInstruction& entry) const;
+
+    // 可由其他线程读取（用于统计）
+    size_t size() const {
+        return count_.load(std::memory_order_relaxed);
+    }
+
+    void clear() {
+        last_ = nullptr;
+        entries_.clear();
+        count_.store(0, std::memory_order_relaxed);
+        strings_.clear();
+    }
+
+  private:
+    DecodedInstruction decode(QBDI::VMInstanceRef vm, uint64_t address);
+
+    std::unordered_map<uint64_t, DecodedInstruction> entries_;
+    DecodedInstruction* last_ = nullptr;
+    StringPool strings_;
+    std::atomic<size_t> count_{0};
+};
+
+}  // namespace Trace
+}  // namespace AnalysisToolkit
+
+#endif  // TRACE_INSTRUCTION_CACHE_H
@@ -4,36 +4,101 @@
 
 #include "trace/qbdi.h"
 
+#include <dlfcn.h>
+
+#include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <cstring>
+#include <ctime>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <thread>
+#include <unordered_map>
 #include <unordered_set>
 
 #include "QBDI.h"
+#include "instruction_cache.h"
 #include "utility/Logger.h"
+#include "utility/MemoryMapSnapshot.h"
+#include "utility/Metrics.h"
+#include "utility/ModuleIndex.h"
+#include "utility/SymbolIndex.h"
 
 namespace AnalysisToolkit {
 namespace Trace {
 
+namespace {
+
+// 单写者计数器自增：只有所属线程写入，其他线程只读，无需原子读-改-写
+inline void bumpCounter(std::atomic<uint64_t>& counter, uint64_t delta = 1) {
+    counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+// CPU预算检查间隔（事件数）和预算窗口长度
+constexpr uint32_t kBudgetCheckInterval = 1024;
+constexpr uint32_t kProbeCheckInterval = 256;
+constexpr uint64_t kBudgetWindowNs = 1000000000ULL;
+
+// 热点计数分块：每块覆盖 kProfileChunkUnits 个指令对齐单元，线程首次执行到时分配
+constexpr size_t kProfileChunkUnits = 1024;
+
+// 估算指令数时使用的平均指令长度（定长指令集取指令宽度）
+constexpr uint64_t kEstimatedInstructionSize = kCoverageGranularity > 1 ? kCoverageGranularity : 4;
+
+// 函数调用：寄存器传参个数上限（ARM64 x0-x7）、返回哨兵地址和同一线程的嵌套调用深度上限
+constexpr size_t kMaxCallArguments = 8;
+constexpr uint64_t kCallReturnAddress = 0xDEADBEEF;
+constexpr uint32_t kMaxCallDepth = 4;
+// 上下文不在读取订阅者快照时登记的代号
+constexpr uint64_t kQuiescentEpoch = UINT64_MAX;
+
+// 指标：执行的指令数、基本块数和内存访问数，离开VM时按线程批量累加
+const MetricCounter& traceInstructionsMetric() {
+    static const MetricCounter counter("trace.instructions");
+    return counter;
+}
+
+const MetricCounter& traceBlocksMetric() {
+    static const MetricCounter counter("trace.blocks");
+    return counter;
+}
+
+const MetricCounter& traceMemoryAccessesMetric() {
+    static const MetricCounter counter("trace.memory_accesses");
+    return counter;
+}
+
+// 用于区分不同跟踪器实例的全局编号，避免线程缓存指向已销毁的实例
+std::atomic<uint64_t> g_next_pool_id{1};
+
+}  // namespace
+
 // QBDITracer的私有实现类
 class QBDITracer::Impl {
   public:
     Impl()
-        : vm_(nullptr),
-          initialized_(false),
+        : initialized_(false),
           tracing_(false),
           enable_logging_(true),
+          recording_(false),
           log_level_(0),
-          instruction_count_(0),
+          trace_mode_(TraceMode::Instruction),
+          memory_trace_enabled_(false),
+          config_generation_(1),
+          pool_id_(g_next_pool_id.fetch_add(1)),
           start_time_(0),
-          stack_base_(0),
-          stack_size_(0) {
+          subscribers_(nullptr),
+          next_subscriber_id_(1),
+          legacy_subscriber_id_(kInvalidSubscriberId) {
         logger_ = Logger::getInstance();
+        registerPool();
     }
 
     ~Impl() {
         cleanup();
+        unregisterPool();
     }
 
     bool initialize() {
@@ -42,45 +107,14 @@ class QBDITracer::Impl {
         }
 
         try {
-            // 初始化QBDI VM
-            vm_ = new QBDI::VM();
-            if (!vm_) {
-                if (logger_) {
-                    logger_->error("Failed to create QBDI VM");
-                }
-                return false;
-            }
-
-            // 获取当前进程状态并设置到VM中
-            QBDI::GPRState* state = vm_->getGPRState();
-
-            // 尝试获取当前线程的寄存器状态
-            try {
-                // 设置基本的栈指针 - 为VM分配一个栈空间
-                stack_size_ = 0x10000;  // 64KB栈空间
-                stack_base_ = reinterpret_cast<uint64_t>(malloc(stack_size_));
-                if (stack_base_ == 0) {
-                    if (logger_) {
-                        logger_->error("Failed to allocate stack for QBDI VM");
-                    }
-                    return false;
-                }
-
-                // 设置栈指针到栈顶
-                uint64_t stack_top = stack_base_ + stack_size_;
-                vm_->getGPRState()->sp = stack_top;
-
-                if (logger_) {
-                    logger_->info("QBDI VM stack allocated: 0x%lx - 0x%lx", stack_base_, stack_top);
-                }
+            initialized_ = true;
 
-            } catch (const std::exception& e) {
-                if (logger_) {
-                    logger_->warn("Exception setting VM state: %s", e.what());
-                }
+            // 为初始化线程预先创建VM，其他线程在首次使用时按需创建
+            if (currentContext() == nullptr) {
+                initialized_ = false;
+                return false;
             }
 
-            initialized_ = true;
             if (logger_) {
                 logger_->info("QBDI Tracer initialized successfully");
             }
@@ -100,17 +134,26 @@ class QBDITracer::Impl {
             stopTrace();
         }
 
-        if (vm_) {
-            delete vm_;
-            vm_ = nullptr;
-        }
+        disableRecording();
+        disableMemoryTrace();
+        disableRegisterTrace();
 
-        // 释放分配的栈空间
-        if (stack_base_ != 0) {
-            free(reinterpret_cast<void*>(stack_base_));
-            stack_base_ = 0;
-            stack_size_ = 0;
+        // 先注销旧编号，之后退出的线程不再交还已销毁的上下文；此时不应有线程在VM中执行
+        unregisterPool();
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex_);
+            for (auto& context : contexts_) {
+                destroyContext(*context);
+            }
+            contexts_.clear();
+            released_stats_ = {};
         }
+        reclaimSubscribers();
+        recorder_.reclaimRetired();
+
+        // 使所有线程缓存的上下文失效
+        pool_id_ = g_next_pool_id.fetch_add(1);
+        registerPool();
 
         initialized_ = false;
         if (logger_) {
@@ -123,6 +166,14 @@ class QBDITracer::Impl {
     }
 
     bool startTrace(uint64_t start_addr, uint64_t end_addr) {
+        return startTraceRanges({{start_addr, end_addr}});
+    }
+
+    bool startTraceModule(const std::string& module_name) {
+        return startTraceModules({module_name});
+    }
+
+    bool startTraceModules(const std::vector<std::string>& module_names) {
         if (!initialized_) {
             if (logger_) {
                 logger_->error("QBDI Tracer not initialized");
@@ -130,77 +181,45 @@ class QBDITracer::Impl {
             return false;
         }
 
-        if (tracing_) {
-            stopTrace();
-        }
-
-        try {
-            // 添加指令范围
-            vm_->addInstrumentedRange(start_addr, end_addr);
-            if (logger_) {
-                logger_->info("Added instrumented range [0x%lx, 0x%lx]", start_addr, end_addr);
-            }
-
-            // 注册指令回调
-            uint32_t iid = vm_->addCodeCB(QBDI::PREINST, instructionCallback, this);
-            if (iid == QBDI::INVALID_EVENTID) {
-                if (logger_) {
-                    logger_->error("Failed to register instruction callback");
-                }
+        std::vector<std::pair<uint64_t, uint64_t>> ranges;
+        for (const auto& module_name : module_names) {
+            if (!resolveModuleRanges(module_name, ranges)) {
                 return false;
             }
-
-            callback_ids_.insert(iid);
-            traced_ranges_.emplace_back(start_addr, end_addr);
-
-            tracing_ = true;
-            instruction_count_ = 0;
-            start_time_ = getCurrentTimeMs();
-
-            if (logger_) {
-                logger_->info("Started tracing range [0x%lx, 0x%lx]", start_addr, end_addr);
-            }
-
-            return true;
-
-        } catch (const std::exception& e) {
-            if (logger_) {
-                logger_->error("Exception during trace start: %s", e.what());
-            }
-            return false;
         }
+        return startTraceRanges(ranges);
     }
 
-    bool startTraceModule(const std::string& module_name) {
-        if (!initialized_) {
-            if (logger_) {
-                logger_->error("QBDI Tracer not initialized");
-            }
+    bool addTraceModule(const std::string& module_name) {
+        if (!tracing_) {
+            return startTraceModule(module_name);
+        }
+
+        std::vector<std::pair<uint64_t, uint64_t>> ranges;
+        if (!resolveModuleRanges(module_name, ranges)) {
             return false;
         }
 
-        // 简化实现：获取主程序的文本段
-        // 在实际应用中，可以通过解析模块信息来获取准确的地址范围
-        try {
-            std::vector<QBDI::MemoryMap> maps = QBDI::getCurrentProcessMaps();
-            for (const auto& map : maps) {
-                if (map.permission & QBDI::PF_EXEC) {
-                    // 找到可执行段，开始跟踪
-                    return startTrace(map.range.start(), map.range.end());
+        {
+            std::lock_guard<std::mutex> lock(config_mutex_);
+            for (const auto& range : ranges) {
+                if (std::find(traced_ranges_.begin(), traced_ranges_.end(), range) ==
+                    traced_ranges_.end()) {
+                    traced_ranges_.push_back(range);
                 }
             }
-
-            if (logger_) {
-                logger_->error("No executable segment found for module: %s", module_name.c_str());
-            }
-            return false;
-
-        } catch (const std::exception& e) {
-            if (logger_) {
-                logger_->error("Exception during module trace start: %s", e.what());
+        }
+        {
+            std::lock_guard<std::mutex> lock(coverage_mutex_);
+            for (const auto& range : ranges) {
+                coverage_.addRange(range.first, range.second);
             }
-            return false;
         }
+
+        // 扩展当前会话：各线程在下次进入VM前同步新范围
+        config_generation_.fetch_add(1);
+        VMContext* context = findContext();
+        return context == nullptr || syncContext(*context);
     }
 
     void stopTrace() {
@@ -209,25 +228,37 @@ class QBDITracer::Impl {
         }
 
         try {
-            // 移除所有回调
-            for (uint32_t id : callback_ids_) {
-                vm_->deleteInstrumentation(id);
+            {
+                std::lock_guard<std::mutex> lock(config_mutex_);
+                traced_ranges_.clear();
             }
-            callback_ids_.clear();
 
-            // 清理范围
-            for (const auto& range : traced_ranges_) {
-                vm_->removeInstrumentedRange(range.first, range.second);
+            tracing_ = false;
+            config_generation_.fetch_add(1);
+
+            // 当前线程的VM立即移除回调和范围，其他线程在下次进入VM前同步
+            VMContext* context = findContext();
+            if (context != nullptr) {
+                syncContext(*context);
             }
-            traced_ranges_.clear();
 
-            tracing_ = false;
+            if (recording_) {
+                recorder_.flush();
+            }
+
+            // 合并各线程的热点计数
+            collectProfiles();
+
+            // 没有线程在VM中执行时释放退休的订阅者快照和记录缓冲区
+            reclaimSubscribers();
+            reclaimRecorderBuffers();
+
             uint64_t end_time = getCurrentTimeMs();
             uint64_t execution_time = end_time - start_time_;
 
             if (logger_) {
                 logger_->info("Stopped tracing. Instructions: %lu, Time: %lu ms",
-                              instruction_count_.load(),
+                              getStats().instruction_count,
                               execution_time);
             }
 
@@ -242,9 +273,142 @@ class QBDITracer::Impl {
         return tracing_;
     }
 
+    void setTraceMode(TraceMode mode) {
+        if (tracing_ && logger_) {
+            logger_->warn("Trace mode change takes effect on next startTrace");
+        }
+        trace_mode_ = mode;
+    }
+
+    TraceMode getTraceMode() const {
+        return trace_mode_;
+    }
+
+    void setSampling(const SamplingConfig& config) {
+        if (tracing_ && logger_) {
+            logger_->warn("Sampling change takes effect on next startTrace");
+        }
+        std::lock_guard<std::mutex> lock(config_mutex_);
+        sampling_config_ = config;
+        sampling_config_.period = std::max<uint32_t>(config.period, 1);
+    }
+
+    SamplingConfig getSampling() const {
+        std::lock_guard<std::mutex> lock(config_mutex_);
+        return sampling_config_;
+    }
+
+    CoverageMap getCoverage() const {
+        std::lock_guard<std::mutex> lock(coverage_mutex_);
+        return coverage_;
+    }
+
+    void enableProfiling(bool enable) {
+        if (tracing_ && logger_) {
+            logger_->warn("Profiling change takes effect on next startTrace");
+        }
+        std::lock_guard<std::mutex> lock(config_mutex_);
+        profiling_enabled_ = enable;
+    }
+
+    bool isProfiling() const {
+        std::lock_guard<std::mutex> lock(config_mutex_);
+        return profiling_enabled_;
+    }
+
+    std::vector<HotSpot> getHotSpots(size_t top_n) {
+        collectProfiles();
+
+        std::vector<HotSpot> hot_spots;
+        {
+            std::lock_guard<std::mutex> lock(profile_mutex_);
+            hot_spots.reserve(merged_profile_.size());
+            for (const auto& entry : merged_profile_) {
+                HotSpot spot;
+                spot.address = entry.first;
+                spot.count = entry.second;
+                hot_spots.push_back(std::move(spot));
+            }
+        }
+
+        size_t count = std::min(top_n, hot_spots.size());
+        std::partial_sort(hot_spots.begin(),
+                          hot_spots.begin() + count,
+                          hot_spots.end(),
+                          [](const HotSpot& a, const HotSpot& b) { return a.count > b.count; });
+        hot_spots.resize(count);
+
+        // 只对入选的地址做符号化
+        for (auto& spot : hot_spots) {
+            symbolize(spot);
+        }
+        return hot_spots;
+    }
+
+    void printHotSpots(size_t top_n) {
+        std::vector<HotSpot> hot_spots = getHotSpots(top_n);
+        if (!logger_) {
+            return;
+        }
+
+        logger_->info("Top %zu hot spots:", hot_spots.size());
+        for (size_t i = 0; i < hot_spots.size(); ++i) {
+            const HotSpot& spot = hot_spots[i];
+            logger_->info("#%zu 0x%lx %12lu  %s!%s+0x%lx",
+                          i + 1,
+                          spot.address,
+                          spot.count,
+                          spot.module.empty() ? "?" : spot.module.c_str(),
+                          spot.symbol.empty() ? "?" : spot.symbol.c_str(),
+                          spot.symbol_offset);
+        }
+    }
+
     void setInstructionCallback(InstructionCallback callback) {
-        std::lock_guard<std::mutex> lock(callback_mutex_);
-        user_callback_ = callback;
+        std::lock_guard<std::mutex> lock(subscribers_mutex_);
+        SubscriberList next = currentSubscribersLocked();
+        next.remove(legacy_subscriber_id_);
+        legacy_subscriber_id_ = kInvalidSubscriberId;
+
+        if (callback) {
+            InstructionSubscriber subscriber;
+            subscriber.callback = std::move(callback);
+            legacy_subscriber_id_ = next_subscriber_id_++;
+            next.entries.emplace_back(legacy_subscriber_id_, std::move(subscriber));
+        }
+        publishSubscribersLocked(std::move(next));
+    }
+
+    SubscriberId addInstructionSubscriber(const InstructionSubscriber& subscriber) {
+        if (!subscriber.callback) {
+            return kInvalidSubscriberId;
+        }
+
+        std::lock_guard<std::mutex> lock(subscribers_mutex_);
+        SubscriberList next = currentSubscribersLocked();
+        SubscriberId id = next_subscriber_id_++;
+        next.entries.emplace_back(id, subscriber);
+        publishSubscribersLocked(std::move(next));
+        return id;
+    }
+
+    bool removeInstructionSubscriber(SubscriberId id) {
+        std::lock_guard<std::mutex> lock(subscribers_mutex_);
+        SubscriberList next = currentSubscribersLocked();
+        if (!next.remove(id)) {
+            return false;
+        }
+        if (id == legacy_subscriber_id_) {
+            legacy_subscriber_id_ = kInvalidSubscriberId;
+        }
+        publishSubscribersLocked(std::move(next));
+        return true;
+    }
+
+    void clearInstructionSubscribers() {
+        std::lock_guard<std::mutex> lock(subscribers_mutex_);
+        legacy_subscriber_id_ = kInvalidSubscriberId;
+        publishSubscribersLocked(SubscriberList());
     }
 
     void enableInstructionLogging(bool enable) {
@@ -255,6 +419,132 @@ class QBDITracer::Impl {
         log_level_ = level;
     }
 
+    bool enableRecording(const RecorderConfig& config) {
+        recording_.store(false, std::memory_order_release);
+        if (!recorder_.start(config)) {
+            if (logger_) {
+                logger_->error("Failed to start trace recorder");
+            }
+            return false;
+        }
+        annotate_disassembly_.store(config.record_disassembly && recorder_.isIndexed(),
+                                    std::memory_order_relaxed);
+        recording_.store(true, std::memory_order_release);
+        reclaimRecorderBuffers();
+        return true;
+    }
+
+    void disableRecording() {
+        if (!recording_.exchange(false)) {
+            return;
+        }
+        annotate_disassembly_.store(false, std::memory_order_relaxed);
+        recorder_.stop();
+    }
+
+    bool isRecording() const {
+        return recording_.load();
+    }
+
+    bool enableMemoryTrace(const MemoryTraceConfig& config) {
+        if (!config.consumer || (!config.trace_reads && !config.trace_writes)) {
+            if (logger_) {
+                logger_->error("Invalid memory trace config: consumer and access type required");
+            }
+            return false;
+        }
+        if (tracing_ && logger_) {
+            logger_->warn("Memory trace takes effect on next startTrace");
+        }
+
+        std::lock_guard<std::mutex> lock(config_mutex_);
+        memory_config_ = config;
+        memory_config_.batch_size = std::max<size_t>(config.batch_size, 1);
+        memory_trace_enabled_ = true;
+        return true;
+    }
+
+    void disableMemoryTrace() {
+        {
+            std::lock_guard<std::mutex> lock(config_mutex_);
+            if (!memory_trace_enabled_) {
+                return;
+            }
+            memory_trace_enabled_ = false;
+            memory_config_ = MemoryTraceConfig();
+        }
+
+        // 批次和 consumer 只属于所属线程：各线程在 syncContext/leaveContext 中自行交付，
+        // 这里只处理当前线程
+        config_generation_.fetch_add(1);
+        VMContext* context = findContext();
+        if (context != nullptr && !context->in_vm.load()) {
+            syncContext(*context);
+        }
+    }
+
+    bool enableRegisterTrace(const RegisterTraceConfig& config) {
+        if (config.output_path.empty()) {
+            if (logger_) {
+                logger_->error("Invalid register trace config: output path required");
+            }
+            return false;
+        }
+        if (tracing_ && logger_) {
+            logger_->warn("Register trace takes effect on next startTrace");
+        }
+
+        disableRegisterTrace();
+        static_assert(QBDI::NUM_GPR <= kMaxTraceRegisters, "GPRState does not fit the bitmask");
+        if (!register_writer_.open(config, QBDI::NUM_GPR, QBDI::REG_PC)) {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(config_mutex_);
+        register_trace_enabled_ = true;
+        return true;
+    }
+
+    void disableRegisterTrace() {
+        {
+            std::lock_guard<std::mutex> lock(config_mutex_);
+            if (!register_trace_enabled_) {
+                return;
+            }
+            register_trace_enabled_ = false;
+        }
+
+        // 不在VM中的线程立即写出未满的块；仍在执行的线程其剩余记录被丢弃
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex_);
+            for (auto& context : contexts_) {
+                std::lock_guard<std::mutex> context_lock(context->profile_mutex);
+                if (!context->in_vm.load()) {
+                    context->register_encoder.detach();
+                    context->register_enabled = false;
+                }
+            }
+        }
+
+        uint64_t records = register_writer_.recordCount();
+        register_writer_.close();
+        if (logger_) {
+            logger_->info("Register trace stopped. Records: %lu", records);
+        }
+    }
+
+    bool isRegisterTracing() const {
+        std::lock_guard<std::mutex> lock(config_mutex_);
+        return register_trace_enabled_;
+    }
+
+    void flushMemoryTrace() {
+        VMContext* context = findContext();
+        if (context != nullptr) {
+            flushMemoryBatch(*context);
+        }
+    }
+
     void run() {
         if (!tracing_) {
             if (logger_) {
@@ -263,24 +553,34 @@ class QBDITracer::Impl {
             return;
         }
 
-        if (traced_ranges_.empty()) {
-            if (logger_) {
-                logger_->warn("No traced ranges defined");
+        std::pair<uint64_t, uint64_t> range;
+        {
+            std::lock_guard<std::mutex> lock(config_mutex_);
+            if (traced_ranges_.empty()) {
+                if (logger_) {
+                    logger_->warn("No traced ranges defined");
+                }
+                return;
             }
+            range = traced_ranges_[0];
+        }
+
+        VMContext* context = enterContext();
+        if (context == nullptr) {
             return;
         }
 
         try {
             // 从第一个追踪范围的起始地址开始运行
-            uint64_t start_addr = traced_ranges_[0].first;
-            uint64_t end_addr = traced_ranges_[0].second;
+            uint64_t start_addr = range.first;
+            uint64_t end_addr = range.second;
 
             if (logger_) {
                 logger_->info("Running QBDI VM from 0x%lx to 0x%lx", start_addr, end_addr);
             }
 
             // 运行执行引擎
-            bool success = vm_->run(start_addr, end_addr);
+            bool success = context->vm->run(start_addr, end_addr);
             if (!success) {
                 if (logger_) {
                     logger_->error("VM run failed");
@@ -291,145 +591,1230 @@ class QBDITracer::Impl {
                 logger_->error("Exception during VM run: %s", e.what());
             }
         }
+
+        leaveContext(*context);
     }
 
     uint64_t callFunction(uint64_t func_addr, const std::vector<uint64_t>& args) {
+        uint64_t result = 0;
+        callFunctions(func_addr, &args, 1, &result);
+        return result;
+    }
+
+    std::vector<uint64_t> callFunctionBatch(uint64_t func_addr,
+                                            const std::vector<std::vector<uint64_t>>& arg_sets) {
+        std::vector<uint64_t> results(arg_sets.size(), 0);
+        if (!arg_sets.empty() &&
+            !callFunctions(func_addr, arg_sets.data(), arg_sets.size(), results.data())) {
+            results.clear();
+        }
+        return results;
+    }
+
+    // 在当前线程的VM中依次调用函数：范围检查、配置同步和状态快照每批只做一次，
+    // 每次调用后恢复快照，各次调用互不影响。准备失败时返回 false
+    bool callFunctions(uint64_t func_addr,
+                       const std::vector<uint64_t>* arg_sets,
+                       size_t count,
+                       uint64_t* results) {
         if (!initialized_) {
             if (logger_) {
                 logger_->error("Cannot call function: QBDI not initialized");
             }
-            return 0;
+            return false;
         }
-
-        try {
-            if (logger_) {
-                logger_->info("Calling function at 0x%lx with %zu arguments",
-                              func_addr,
-                              args.size());
-            }
-
-            // 确保函数地址在跟踪范围内
-            bool in_range = false;
-            for (const auto& range : traced_ranges_) {
-                if (func_addr >= range.first && func_addr < range.second) {
-                    in_range = true;
-                    break;
-                }
-            }
-
-            if (!in_range) {
+        for (size_t i = 0; i < count; ++i) {
+            if (arg_sets[i].size() > kMaxCallArguments) {
                 if (logger_) {
-                    logger_->warn(
-                        "Function address 0x%lx not in traced ranges, adding temporary range",
-                        func_addr);
-                }
-                // 临时添加包含该函数的范围
-                vm_->addInstrumentedRange(func_addr, func_addr + 1024);
-            }
-
-            // 准备参数 - 根据调用约定设置寄存器
-            QBDI::GPRState* gprState = vm_->getGPRState();
-
-            // ARM64调用约定：前8个参数通过x0-x7传递
-            if (args.size() > 0 && args.size() <= 8) {
-                QBDI::rword* regs = &gprState->x0;
-                for (size_t i = 0; i < args.size() && i < 8; ++i) {
-                    regs[i] = static_cast<QBDI::rword>(args[i]);
-                    if (logger_) {
-                        logger_->debug("Set x%zu = 0x%lx", i, args[i]);
-                    }
+                    logger_->error("Cannot call function at 0x%lx: %zu arguments (max %zu)",
+                                   func_addr,
+                                   arg_sets[i].size(),
+                                   kMaxCallArguments);
                 }
+                return false;
             }
+        }
 
-            // 设置返回地址为特殊值，便于识别函数返回
-            uint64_t return_addr = 0xDEADBEEF;
-            gprState->lr = return_addr;
-
-            if (logger_) {
-                logger_->info("Starting function execution via QBDI run()");
-                logger_->debug("Stack pointer: 0x%lx", gprState->sp);
-                logger_->debug("Function address: 0x%lx", func_addr);
-            }
-
-            // 使用vm->run()从函数地址开始执行，直到返回
-            bool success = vm_->run(func_addr, return_addr);
+        VMContext* context = enterCallContext();
+        if (context == nullptr) {
+            return false;
+        }
 
-            if (!success) {
+        bool success = false;
+        try {
+            if (ensureCallRange(*context, func_addr)) {
                 if (logger_) {
-                    logger_->error("VM run failed");
+                    logger_->debug("Calling function at 0x%lx (%zu calls, depth %u)",
+                                   func_addr,
+                                   count,
+                                   context->depth);
                 }
-                return 0;
-            }
-
-            // 获取返回值 (ARM64约定：返回值在x0寄存器中)
-            uint64_t result = static_cast<uint64_t>(gprState->x0);
 
-            if (logger_) {
-                logger_->info("Function call completed, result: 0x%lx (%lu)", result, result);
+                CallSnapshot snapshot;
+                captureSnapshot(*context, snapshot);
+                for (size_t i = 0; i < count; ++i) {
+                    results[i] = runCall(*context, func_addr, arg_sets[i]);
+                    restoreSnapshot(*context, snapshot);
+                }
+                success = true;
             }
-
-            return result;
-
         } catch (const std::exception& e) {
             if (logger_) {
                 logger_->error("Exception during function call: %s", e.what());
             }
-            return 0;
         }
+
+        leaveContext(*context);
+        return success;
     }
 
     QBDITracer::TraceStats getStats() const {
-        QBDITracer::TraceStats stats;
-        stats.instruction_count = instruction_count_.load();
+        QBDITracer::TraceStats stats = sumContextStats();
+        stats.instruction_count -= stats_baseline_.instruction_count;
+        stats.block_count -= stats_baseline_.block_count;
+        stats.unique_block_count -= stats_baseline_.unique_block_count;
+        stats.memory_access_count -= stats_baseline_.memory_access_count;
+        stats.sampled_count -= stats_baseline_.sampled_count;
+        stats.estimated_instruction_count -= stats_baseline_.estimated_instruction_count;
+        stats.estimated_block_count -= stats_baseline_.estimated_block_count;
+        stats.budget_suspend_count -= stats_baseline_.budget_suspend_count;
+
+        // 估算总数 = 实际观察到的事件 + 按基本块推算的未观察部分
+        stats.estimated_instruction_count += stats.instruction_count;
+        stats.estimated_block_count += stats.block_count;
         stats.execution_time_ms = tracing_ ? (getCurrentTimeMs() - start_time_) : 0;
-        stats.traced_addresses_count = traced_ranges_.size();
+        {
+            std::lock_guard<std::mutex> lock(config_mutex_);
+            stats.traced_addresses_count = traced_ranges_.size();
+        }
+
+        TraceRecorder::Stats recorder_stats = recorder_.getStats();
+        stats.recorded_count = recorder_stats.recorded_count;
+        stats.dropped_count = recorder_stats.dropped_count;
+        stats.register_record_count = register_writer_.recordCount();
+        {
+            std::lock_guard<std::mutex> lock(coverage_mutex_);
+            stats.covered_bytes = coverage_.coveredBytes();
+        }
         return stats;
     }
 
   private:
-    // 指令回调函数
-    static QBDI::VMAction instructionCallback(QBDI::VMInstanceRef vm,
-                                              QBDI::GPRState* gprState,
-                                              QBDI::FPRState* fprState,
-                                              void* data) {
-        Impl* impl = static_cast<Impl*>(data);
-        return impl->handleInstruction(vm, gprState, fprState);
-    }
-
-    QBDI::VMAction handleInstruction(QBDI::VMInstanceRef vm,
-                                     QBDI::GPRState* gprState,
-                                     QBDI::FPRState* fprState) {
-        try {
-            instruction_count_++;
-
-            // 获取当前指令信息
-            const QBDI::InstAnalysis* analysis = vm_->getInstAnalysis(QBDI::ANALYSIS_INSTRUCTION);
-            if (!analysis) {
-                return QBDI::VMAction::CONTINUE;
+    bool startTraceRanges(const std::vector<std::pair<uint64_t, uint64_t>>& ranges) {
+        if (!initialized_) {
+            if (logger_) {
+                logger_->error("QBDI Tracer not initialized");
             }
+            return false;
+        }
 
-            InstructionInfo info;
-            info.address = analysis->address;
-            info.thread_id = std::hash<std::thread::id>{}(std::this_thread::get_id());
+        if (ranges.empty()) {
+            if (logger_) {
+                logger_->error("No ranges to trace");
+            }
+            return false;
+        }
 
-            // 获取反汇编信息
-            const QBDI::InstAnalysis* instAnalysis =
-                vm_->getInstAnalysis(QBDI::ANALYSIS_DISASSEMBLY);
-            if (instAnalysis) {
-                info.mnemonic = instAnalysis->mnemonic ? instAnalysis->mnemonic : "";
-                info.disassembly = instAnalysis->disassembly ? instAnalysis->disassembly : "";
+        if (tracing_) {
+            stopTrace();
+        }
+
+        try {
+            {
+                std::lock_guard<std::mutex> lock(config_mutex_);
+                traced_ranges_ = ranges;
             }
 
-            // 记录到日志
-            if (enable_logging_ && logger_) {
-                logger_->debug("0x%lx: %s", info.address, info.disassembly.c_str());
+            {
+                std::lock_guard<std::mutex> lock(coverage_mutex_);
+                coverage_.clear();
+                for (const auto& range : ranges) {
+                    coverage_.addRange(range.first, range.second);
+                }
+            }
+
+            // 丢弃上一轮未取走的热点计数
+            collectProfiles();
+            {
+                std::lock_guard<std::mutex> lock(profile_mutex_);
+                merged_profile_.clear();
+            }
+
+            stats_baseline_ = sumContextStats();
+            tracing_ = true;
+            start_time_ = getCurrentTimeMs();
+
+            // 发布新配置：各线程的VM在下次进入前同步，当前线程已有VM时立即同步
+            config_generation_.fetch_add(1);
+            VMContext* context = findContext();
+            if (context != nullptr && !syncContext(*context)) {
+                if (logger_) {
+                    logger_->error("Failed to apply trace configuration");
+                }
+                tracing_ = false;
+                config_generation_.fetch_add(1);
+                return false;
+            }
+
+            if (logger_) {
+                for (const auto& range : ranges) {
+                    logger_->info("Started tracing range [0x%lx, 0x%lx]", range.first, range.second);
+                }
+            }
+
+            return true;
+
+        } catch (const std::exception& e) {
+            if (logger_) {
+                logger_->error("Exception during trace start: %s", e.what());
+            }
+            return false;
+        }
+    }
+
+    // 通过缓存的模块索引解析模块的所有可执行段
+    bool resolveModuleRanges(const std::string& module_name,
+                             std::vector<std::pair<uint64_t, uint64_t>>& ranges) {
+        std::optional<ModuleInfo> module = ModuleIndex::getInstance().findModule(module_name);
+        if (!module.has_value()) {
+            if (logger_) {
+                logger_->error("Module not found: %s", module_name.c_str());
             }
+            return false;
+        }
+
+        if (module->executable_ranges.empty()) {
+            if (logger_) {
+                logger_->error("No executable segment found for module: %s", module_name.c_str());
+            }
+            return false;
+        }
+
+        for (const auto& range : module->executable_ranges) {
+            ranges.emplace_back(range.first, range.second);
+        }
+        if (logger_) {
+            logger_->info("Resolved module %s (%zu executable segments)",
+                          module->path.c_str(),
+                          module->executable_ranges.size());
+        }
+        return true;
+    }
+
+    struct ProfileRange {
+        uint64_t start;
+        uint64_t end;
+        // 同步配置时只分配块表，计数块在首次命中时分配，只执行少量代码的线程占用很少内存
+        std::vector<std::unique_ptr<uint64_t[]>> chunks;
+    };
+
+    // 每线程VM上下文：QBDI VM 不是线程安全的，每个线程独占一个VM和栈
+    struct VMContext {
+        Impl* owner = nullptr;
+        QBDI::VM* vm = nullptr;
+        uint64_t stack_base = 0;
+        size_t stack_size = 0;
+        uint32_t thread_id = 0;
+
+        // 嵌套调用：depth 为 0 的是线程的主上下文，跟踪回调中再次调用函数时使用 nested
+        uint32_t depth = 0;
+        VMContext* nested = nullptr;
+
+        // 已应用到该VM的配置
+        uint64_t applied_generation = 0;
+        std::vector<uint32_t> callback_ids;
+        std::vector<std::pair<uint64_t, uint64_t>> applied_ranges;
+
+        // 调用目标所在的映射段：配置不变时跨调用保留，已翻译的基本块不会失效
+        std::vector<std::pair<uint64_t, uint64_t>> call_ranges;
+        TraceMode trace_mode = TraceMode::Instruction;
+        bool memory_enabled = false;
+        SamplingConfig sampling;
+
+        // 线程私有的缓存和批次
+        InstructionCache instruction_cache;
+        MemoryAccessBatch memory_batch;
+        MemoryTraceConfig memory_config;
+
+        // 寄存器跟踪（只在主上下文中记录）；编码器的绑定和写出由 profile_mutex 保护
+        bool register_enabled = false;
+        RegisterTraceEncoder register_encoder;
+
+        // 采样与CPU预算状态
+        uint32_t probe_id = QBDI::INVALID_EVENTID;
+        uint32_t sample_countdown = 0;
+        // 按基本块采样：只常驻基本块入口探针，被采样的基本块临时挂载逐指令回调
+        bool block_sampling = false;
+        uint32_t sample_block_id = QBDI::INVALID_EVENTID;
+        uint32_t budget_check_countdown = 0;
+        uint64_t window_start_ns = 0;
+        uint64_t window_cpu_start_ns = 0;
+
+        // 线程私有统计（单写者）
+        std::atomic<uint64_t> instruction_count{0};
+        std::atomic<uint64_t> block_count{0};
+        std::atomic<uint64_t> unique_block_count{0};
+        std::atomic<uint64_t> memory_access_count{0};
+        std::atomic<uint64_t> sampled_count{0};
+        std::atomic<uint64_t> skipped_block_count{0};
+        std::atomic<uint64_t> estimated_instructions{0};
+        std::atomic<uint64_t> disarm_count{0};
+
+        // 已计入指标的计数（只由所属线程访问）
+        uint64_t reported_instructions = 0;
+        uint64_t reported_blocks = 0;
+        uint64_t reported_memory_accesses = 0;
+
+        // 热点计数：按追踪范围内的偏移索引的分块数组，只由所属线程写入
+        bool profiling = false;
+        size_t profile_hint = 0;
+        std::vector<ProfileRange> profile_ranges;
+
+        // 是否正在VM中执行，用于判断退休数据能否释放
+        std::atomic<bool> in_vm{false};
+
+        // 回调读取订阅者快照期间登记的代号，读完恢复为 kQuiescentEpoch
+        std::atomic<uint64_t> subscriber_epoch{kQuiescentEpoch};
+
+        // 串行化 in_vm 切换与计数数组的合并
+        std::mutex profile_mutex;
+    };
+
+    // 线程缓存的上下文：线程退出时析构，把上下文交还给仍然存在的跟踪器实例
+    struct ThreadContextCache {
+        uint64_t pool_id = 0;
+        VMContext* context = nullptr;
+
+        ~ThreadContextCache() {
+            releaseThreadContext(pool_id, context);
+        }
+    };
+
+    static thread_local ThreadContextCache t_context_cache_;
+
+    // 存活的跟踪器实例（按池编号）；有意不析构，其他线程在静态对象析构后退出时仍可访问
+    static std::mutex& poolRegistryMutex() {
+        static std::mutex* mutex = new std::mutex();
+        return *mutex;
+    }
+
+    static std::unordered_map<uint64_t, Impl*>& poolRegistry() {
+        static auto* registry = new std::unordered_map<uint64_t, Impl*>();
+        return *registry;
+    }
+
+    void registerPool() {
+        std::lock_guard<std::mutex> lock(poolRegistryMutex());
+        poolRegistry()[pool_id_] = this;
+    }
+
+    // 注销后不会再有线程交还上下文；持有注册表锁期间正在进行的交还已完成
+    void unregisterPool() {
+        std::lock_guard<std::mutex> lock(poolRegistryMutex());
+        poolRegistry().erase(pool_id_);
+    }
+
+    static void releaseThreadContext(uint64_t pool_id, VMContext* context) {
+        if (context == nullptr) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(poolRegistryMutex());
+        auto it = poolRegistry().find(pool_id);
+        if (it != poolRegistry().end()) {
+            it->second->releaseContext(context);
+        }
+    }
 
-            // 调用用户回调
+    // 获取（必要时创建）当前线程的VM上下文
+    VMContext* currentContext() {
+        ThreadContextCache& cache = t_context_cache_;
+        if (cache.pool_id == pool_id_ && cache.context != nullptr) {
+            return cache.context;
+        }
+
+        // 每个线程只缓存一个实例的上下文，切换到另一个实例前交还旧的
+        releaseThreadContext(cache.pool_id, cache.context);
+        cache = {};
+
+        uint32_t tid = TraceRecorder::currentThreadId();
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        auto context = createContext(tid);
+        if (!context) {
+            return nullptr;
+        }
+        contexts_.push_back(std::move(context));
+        cache.pool_id = pool_id_;
+        cache.context = contexts_.back().get();
+        return cache.context;
+    }
+
+    // 只返回当前线程已有的上下文，从不创建VM；用于启停跟踪等控制路径
+    VMContext* findContext() const {
+        const ThreadContextCache& cache = t_context_cache_;
+        return cache.pool_id == pool_id_ ? cache.context : nullptr;
+    }
+
+    // 线程退出：写出并合并剩余数据，计数并入已释放的统计，连同嵌套上下文一起销毁
+    void releaseContext(VMContext* context) {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        std::unordered_set<const VMContext*> released;
+        for (VMContext* current = context; current != nullptr; current = current->nested) {
             {
-                std::lock_guard<std::mutex> lock(callback_mutex_);
-                if (user_callback_) {
-                    user_callback_(info);
+                std::lock_guard<std::mutex> context_lock(current->profile_mutex);
+                mergeProfileLocked(*current);
+                current->register_encoder.detach();
+            }
+            addContextStats(released_stats_, *current);
+            destroyContext(*current);
+            released.insert(current);
+        }
+        contexts_.erase(std::remove_if(contexts_.begin(),
+                                       contexts_.end(),
+                                       [&released](const std::unique_ptr<VMContext>& entry) {
+                                           return released.count(entry.get()) != 0;
+                                       }),
+                        contexts_.end());
+    }
+
+    std::unique_ptr<VMContext> createContext(uint32_t tid) {
+        auto context = std::make_unique<VMContext>();
+        context->owner = this;
+        context->thread_id = tid;
+
+        // 初始化QBDI VM
+        context->vm = new QBDI::VM();
+        if (!context->vm) {
+            if (logger_) {
+                logger_->error("Failed to create QBDI VM");
+            }
+            return nullptr;
+        }
+
+        // 设置基本的栈指针 - 为VM分配一个栈空间
+        context->stack_size = 0x10000;  // 64KB栈空间
+        context->stack_base = reinterpret_cast<uint64_t>(malloc(context->stack_size));
+        if (context->stack_base == 0) {
+            if (logger_) {
+                logger_->error("Failed to allocate stack for QBDI VM");
+            }
+            delete context->vm;
+            return nullptr;
+        }
+
+        // 设置栈指针到栈顶
+        uint64_t stack_top = context->stack_base + context->stack_size;
+        context->vm->getGPRState()->sp = stack_top;
+
+        if (logger_) {
+            logger_->info("QBDI VM created for thread %u, stack: 0x%lx - 0x%lx",
+                          tid,
+                          context->stack_base,
+                          stack_top);
+        }
+        return context;
+    }
+
+    void destroyContext(VMContext& context) {
+        flushMemoryBatch(context);
+
+        if (context.vm) {
+            delete context.vm;
+            context.vm = nullptr;
+        }
+
+        // 释放分配的栈空间
+        if (context.stack_base != 0) {
+            free(reinterpret_cast<void*>(context.stack_base));
+            context.stack_base = 0;
+            context.stack_size = 0;
+        }
+    }
+
+    // 将共享配置同步到当前线程的VM（只能由上下文所属线程调用）
+    bool syncContext(VMContext& context) {
+        uint64_t generation = config_generation_.load();
+        if (context.applied_generation == generation) {
+            return true;
+        }
+
+        QBDI::VM* vm = context.vm;
+
+        // 先合并上一轮的热点计数
+        {
+            std::lock_guard<std::mutex> lock(context.profile_mutex);
+            mergeProfileLocked(context);
+            context.profiling = false;
+            context.profile_ranges.clear();
+        }
+
+        // 移除旧的回调和范围
+        disarmContext(context);
+        removeProbe(context);
+        for (const auto& range : context.applied_ranges) {
+            vm->removeInstrumentedRange(range.first, range.second);
+        }
+        context.applied_ranges.clear();
+        // 调用范围只在本代配置内复用：跟踪回调不按范围过滤，保留到下一个会话会把
+        // 整个外部模块带进VM并产生跟踪范围之外的事件
+        for (const auto& range : context.call_ranges) {
+            vm->removeInstrumentedRange(range.first, range.second);
+        }
+        context.call_ranges.clear();
+        flushMemoryBatch(context);
+        context.memory_enabled = false;
+        context.memory_config = MemoryTraceConfig();
+
+        bool success = true;
+        if (tracing_) {
+            std::lock_guard<std::mutex> lock(config_mutex_);
+
+            // 新的跟踪会话重新解码，避免代码被改写后使用过期的缓存
+            context.instruction_cache.clear();
+
+            // 添加指令范围
+            for (const auto& range : traced_ranges_) {
+                vm->addInstrumentedRange(range.first, range.second);
+                context.applied_ranges.push_back(range);
+                if (logger_) {
+                    logger_->info("Added instrumented range [0x%lx, 0x%lx] for thread %u",
+                                  range.first,
+                                  range.second,
+                                  context.thread_id);
+                }
+            }
+
+            // 复制会话配置，回调中重新挂载时无需加锁
+            context.trace_mode = trace_mode_;
+            context.memory_enabled = memory_trace_enabled_;
+            context.memory_config = memory_config_;
+            context.register_enabled = register_trace_enabled_ && context.depth == 0 &&
+                                       trace_mode_ == TraceMode::Instruction;
+            context.sampling = sampling_config_;
+            context.sample_countdown = 0;
+            // 寄存器差分依赖连续的指令流，开启时退回逐指令计数采样
+            context.block_sampling = context.trace_mode == TraceMode::Instruction &&
+                                     context.sampling.period > 1 && !context.register_enabled;
+            context.budget_check_countdown = kBudgetCheckInterval;
+            resetBudgetWindow(context);
+
+            if (profiling_enabled_) {
+                std::lock_guard<std::mutex> plock(context.profile_mutex);
+                context.profiling = true;
+                context.profile_hint = 0;
+                buildProfileRanges(context.profile_ranges);
+            }
+
+            success = armContext(context);
+        }
+
+        // 跟踪停止时写出未满的块；同一会话内继续时沿用序号
+        {
+            std::lock_guard<std::mutex> lock(context.profile_mutex);
+            if (tracing_ && context.register_enabled) {
+                context.register_encoder.attach(&register_writer_, context.thread_id);
+            } else {
+                context.register_enabled = false;
+                context.register_encoder.detach();
+            }
+        }
+
+        context.applied_generation = generation;
+        return success;
+    }
+
+    // 注册跟踪回调（只能由上下文所属线程调用）
+    bool armContext(VMContext& context) {
+        QBDI::VM* vm = context.vm;
+
+        // 重新挂载前的指令没有被观察到
+        context.register_encoder.invalidate();
+
+        // 按跟踪粒度注册回调
+        uint32_t iid = QBDI::INVALID_EVENTID;
+        if (context.trace_mode == TraceMode::BasicBlock) {
+            iid = vm->addVMEventCB(
+                QBDI::BASIC_BLOCK_NEW | QBDI::BASIC_BLOCK_ENTRY, basicBlockCallback, &context);
+        } else if (context.block_sampling) {
+            iid = vm->addVMEventCB(QBDI::BASIC_BLOCK_ENTRY, sampleProbeCallback, &context);
+        } else {
+            iid = vm->addCodeCB(QBDI::PREINST, instructionCallback, &context);
+        }
+        if (iid == QBDI::INVALID_EVENTID) {
+            if (logger_) {
+                logger_->error("Failed to register trace callback");
+            }
+            return false;
+        }
+        context.callback_ids.push_back(iid);
+
+        // 内存访问跟踪
+        if (context.memory_enabled) {
+            context.memory_batch.reserve(context.memory_config.batch_size);
+            uint32_t mid = vm->addMemAccessCB(
+                memoryAccessType(context.memory_config), memoryAccessCallback, &context);
+            if (mid == QBDI::INVALID_EVENTID) {
+                if (logger_) {
+                    logger_->warn("Failed to register memory access callback");
+                }
+            } else {
+                context.callback_ids.push_back(mid);
+            }
+        }
+
+        return true;
+    }
+
+    void disarmContext(VMContext& context) {
+        for (uint32_t id : context.callback_ids) {
+            context.vm->deleteInstrumentation(id);
+        }
+        context.callback_ids.clear();
+        if (context.sample_block_id != QBDI::INVALID_EVENTID) {
+            context.vm->deleteInstrumentation(context.sample_block_id);
+            context.sample_block_id = QBDI::INVALID_EVENTID;
+        }
+    }
+
+    void removeProbe(VMContext& context) {
+        if (context.probe_id != QBDI::INVALID_EVENTID) {
+            context.vm->deleteInstrumentation(context.probe_id);
+            context.probe_id = QBDI::INVALID_EVENTID;
+        }
+    }
+
+    // 超出CPU预算：移除跟踪回调，改为轻量的基本块探针，等待下一个时间窗口重新挂载
+    // 在回调中修改插桩后必须返回 BREAK_TO_VM
+    QBDI::VMAction suspendForBudget(VMContext& context) {
+        disarmContext(context);
+        flushMemoryBatch(context);
+        context.probe_id =
+            context.vm->addVMEventCB(QBDI::BASIC_BLOCK_ENTRY, budgetProbeCallback, &context);
+        context.budget_check_countdown = kProbeCheckInterval;
+        bumpCounter(context.disarm_count);
+        return QBDI::VMAction::BREAK_TO_VM;
+    }
+
+    // 每隔 kBudgetCheckInterval 个事件检查一次当前窗口的线程CPU时间
+    bool budgetExceeded(VMContext& context) {
+        if (context.sampling.cpu_budget_us == 0 || --context.budget_check_countdown != 0) {
+            return false;
+        }
+        context.budget_check_countdown = kBudgetCheckInterval;
+
+        uint64_t now = steadyTimeNs();
+        if (now - context.window_start_ns >= kBudgetWindowNs) {
+            resetBudgetWindow(context, now);
+            return false;
+        }
+        uint64_t cpu_used = threadCpuTimeNs() - context.window_cpu_start_ns;
+        return cpu_used > static_cast<uint64_t>(context.sampling.cpu_budget_us) * 1000;
+    }
+
+    void resetBudgetWindow(VMContext& context, uint64_t now = steadyTimeNs()) {
+        context.window_start_ns = now;
+        context.window_cpu_start_ns = threadCpuTimeNs();
+    }
+
+    // 周期采样：每 period 个事件处理一个；回调已经发生，跳过的只是后续处理。
+    // 按基本块采样时逐指令回调只挂在被采样的基本块上，块内每条指令都处理
+    static bool sampleEvent(VMContext& context) {
+        uint32_t period = context.sampling.period;
+        if (period > 1 && !context.block_sampling) {
+            if (context.sample_countdown != 0) {
+                context.sample_countdown--;
+                return false;
+            }
+            context.sample_countdown = period - 1;
+        }
+        bumpCounter(context.sampled_count);
+        return true;
+    }
+
+    static uint64_t steadyTimeNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    static uint64_t threadCpuTimeNs() {
+        struct timespec ts;
+        if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+            return 0;
+        }
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+    }
+
+    // 未逐条观察到的指令按基本块字节数估算
+    static uint64_t estimateInstructions(const QBDI::VMState* vmState) {
+        return (vmState->basicBlockEnd - vmState->basicBlockStart) / kEstimatedInstructionSize;
+    }
+
+    // 按基本块采样的入口探针
+    static QBDI::VMAction sampleProbeCallback(QBDI::VMInstanceRef vm,
+                                              const QBDI::VMState* vmState,
+                                              QBDI::GPRState* gprState,
+                                              QBDI::FPRState* fprState,
+                                              void* data) {
+        VMContext* context = static_cast<VMContext*>(data);
+        return context->owner->handleSampleProbe(*context, vmState);
+    }
+
+    // 每 period 个基本块为其中一个挂载只覆盖该块的逐指令回调，下一个基本块入口处移除；
+    // QBDI 增删插桩只重新翻译受影响的范围，其余基本块按原生翻译结果执行
+    QBDI::VMAction handleSampleProbe(VMContext& context, const QBDI::VMState* vmState) {
+        QBDI::VMAction action = QBDI::VMAction::CONTINUE;
+        if (context.sample_block_id != QBDI::INVALID_EVENTID) {
+            context.vm->deleteInstrumentation(context.sample_block_id);
+            context.sample_block_id = QBDI::INVALID_EVENTID;
+            action = QBDI::VMAction::BREAK_TO_VM;
+        }
+
+        if (budgetExceeded(context)) {
+            return suspendForBudget(context);
+        }
+        if (context.sample_countdown != 0) {
+            context.sample_countdown--;
+            bumpCounter(context.skipped_block_count);
+            bumpCounter(context.estimated_instructions, estimateInstructions(vmState));
+            return action;
+        }
+        context.sample_countdown = context.sampling.period - 1;
+
+        context.sample_block_id = context.vm->addCodeRangeCB(vmState->basicBlockStart,
+                                                             vmState->basicBlockEnd,
+                                                             QBDI::PREINST,
+                                                             instructionCallback,
+                                                             &context);
+        if (context.sample_block_id == QBDI::INVALID_EVENTID) {
+            return action;
+        }
+        return QBDI::VMAction::BREAK_TO_VM;
+    }
+
+    // 预算暂停期间的基本块探针
+    static QBDI::VMAction budgetProbeCallback(QBDI::VMInstanceRef vm,
+                                              const QBDI::VMState* vmState,
+                                              QBDI::GPRState* gprState,
+                                              QBDI::FPRState* fprState,
+                                              void* data) {
+        VMContext* context = static_cast<VMContext*>(data);
+        return context->owner->handleBudgetProbe(*context, vmState);
+    }
+
+    QBDI::VMAction handleBudgetProbe(VMContext& context, const QBDI::VMState* vmState) {
+        bumpCounter(context.skipped_block_count);
+        bumpCounter(context.estimated_instructions, estimateInstructions(vmState));
+
+        if (--context.budget_check_countdown != 0) {
+            return QBDI::VMAction::CONTINUE;
+        }
+        context.budget_check_countdown = kProbeCheckInterval;
+
+        uint64_t now = steadyTimeNs();
+        if (now - context.window_start_ns < kBudgetWindowNs) {
+            return QBDI::VMAction::CONTINUE;
+        }
+
+        // 进入新的时间窗口，重新挂载跟踪回调
+        removeProbe(context);
+        resetBudgetWindow(context, now);
+        context.budget_check_countdown = kBudgetCheckInterval;
+        armContext(context);
+        return QBDI::VMAction::BREAK_TO_VM;
+    }
+
+    // 进入VM前：获取上下文、同步配置并标记正在执行
+    VMContext* enterContext() {
+        return enterContext(currentContext());
+    }
+
+    VMContext* enterContext(VMContext* context) {
+        if (context == nullptr) {
+            if (logger_) {
+                logger_->error("No QBDI VM available for current thread");
+            }
+            return nullptr;
+        }
+
+        syncContext(*context);
+        // 两次进入VM之间寄存器可能在VM外被修改
+        context->register_encoder.invalidate();
+        {
+            std::lock_guard<std::mutex> lock(context->profile_mutex);
+            context->in_vm.store(true);
+        }
+        return context;
+    }
+
+    void leaveContext(VMContext& context) {
+        publishMetrics(context);
+        // 配置已在执行期间改变（如停止内存跟踪）：在所属线程上交付未满的批次
+        if (context.applied_generation != config_generation_.load()) {
+            flushMemoryBatch(context);
+        }
+
+        std::lock_guard<std::mutex> lock(context.profile_mutex);
+        context.in_vm.store(false);
+
+        // 跟踪已在执行期间停止：立即交出计数和未满的寄存器块，不必等到下次进入VM
+        if (context.applied_generation != config_generation_.load()) {
+            mergeProfileLocked(context);
+            context.register_encoder.flush();
+        }
+    }
+
+    // 调用函数使用的上下文：在本线程的跟踪回调中再次调用时VM正在执行、不能重入，
+    // 改用下一层嵌套上下文（独立的VM和栈）
+    VMContext* enterCallContext() {
+        VMContext* context = currentContext();
+        while (context != nullptr && context->in_vm.load()) {
+            context = nestedContext(*context);
+        }
+        return enterContext(context);
+    }
+
+    VMContext* nestedContext(VMContext& parent) {
+        if (parent.nested != nullptr) {
+            return parent.nested;
+        }
+        if (parent.depth + 1 >= kMaxCallDepth) {
+            if (logger_) {
+                logger_->error("Nested function call depth limit (%u) reached on thread %u",
+                               kMaxCallDepth,
+                               parent.thread_id);
+            }
+            return nullptr;
+        }
+
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        auto context = createContext(parent.thread_id);
+        if (!context) {
+            return nullptr;
+        }
+        context->depth = parent.depth + 1;
+        parent.nested = context.get();
+        contexts_.push_back(std::move(context));
+        return parent.nested;
+    }
+
+    // 确认调用目标已插桩：不在跟踪范围内时插桩其所在的整个可执行映射段，
+    // 该范围保留到下次配置同步，期间的后续调用复用已翻译的基本块
+    bool ensureCallRange(VMContext& context, uint64_t func_addr) {
+        if (containsAddress(context.applied_ranges, func_addr) ||
+            containsAddress(context.call_ranges, func_addr)) {
+            return true;
+        }
+
+        auto snapshot = MemoryMapSnapshot::captureSelf();
+        const MemoryRegion* region =
+            snapshot.isSuccess() ? snapshot.getValue().find(func_addr) : nullptr;
+        if (region == nullptr || !region->getPermissions().executable) {
+            if (logger_) {
+                logger_->error("Function address 0x%lx is not in executable memory", func_addr);
+            }
+            return false;
+        }
+
+        context.vm->addInstrumentedRange(region->getStartAddress(), region->getEndAddress());
+        context.call_ranges.emplace_back(region->getStartAddress(), region->getEndAddress());
+        if (logger_) {
+            logger_->debug("Instrumented call range 0x%lx-0x%lx for thread %u",
+                           region->getStartAddress(),
+                           region->getEndAddress(),
+                           context.thread_id);
+        }
+        return true;
+    }
+
+    static bool containsAddress(const std::vector<std::pair<uint64_t, uint64_t>>& ranges,
+                                uint64_t address) {
+        for (const auto& range : ranges) {
+            if (address >= range.first && address < range.second) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 单次调用：按 ARM64 调用约定通过 x0-x7 传参，返回 x0；执行失败返回 0
+    uint64_t runCall(VMContext& context, uint64_t func_addr, const std::vector<uint64_t>& args) {
+        QBDI::VM* vm = context.vm;
+        QBDI::GPRState* gprState = vm->getGPRState();
+
+        QBDI::rword* regs = &gprState->x0;
+        for (size_t i = 0; i < args.size(); ++i) {
+            regs[i] = static_cast<QBDI::rword>(args[i]);
+        }
+        // 返回地址设为哨兵值，执行到该地址即函数返回
+        gprState->lr = kCallReturnAddress;
+
+        if (!vm->run(func_addr, kCallReturnAddress)) {
+            if (logger_) {
+                logger_->error("VM run failed for function at 0x%lx", func_addr);
+            }
+            return 0;
+        }
+        return static_cast<uint64_t>(gprState->x0);
+    }
+
+    // 调用前的寄存器和栈状态
+    struct CallSnapshot {
+        QBDI::GPRState gpr;
+        QBDI::FPRState fpr;
+        std::vector<uint8_t> stack;  // [sp, 栈顶) 中调用方已使用的部分
+    };
+
+    static void captureSnapshot(VMContext& context, CallSnapshot& snapshot) {
+        snapshot.gpr = *context.vm->getGPRState();
+        snapshot.fpr = *context.vm->getFPRState();
+        snapshot.stack.clear();
+
+        uint64_t sp = snapshot.gpr.sp;
+        uint64_t stack_top = context.stack_base + context.stack_size;
+        if (sp >= context.stack_base && sp < stack_top) {
+            const auto* begin = reinterpret_cast<const uint8_t*>(sp);
+            snapshot.stack.assign(begin, begin + (stack_top - sp));
+        }
+    }
+
+    // 恢复快照：被调函数留下的寄存器和对调用方栈帧的改写不会影响下一次调用
+    static void restoreSnapshot(VMContext& context, const CallSnapshot& snapshot) {
+        context.vm->setGPRState(&snapshot.gpr);
+        context.vm->setFPRState(&snapshot.fpr);
+        context.register_encoder.invalidate();
+        if (!snapshot.stack.empty()) {
+            memcpy(reinterpret_cast<void*>(snapshot.gpr.sp),
+                   snapshot.stack.data(),
+                   snapshot.stack.size());
+        }
+    }
+
+    // 把本次在VM中新增的计数累加到指标；未导出指标时只推进已计入的位置
+    static void publishMetrics(VMContext& context) {
+        uint64_t instructions = context.instruction_count.load(std::memory_order_relaxed);
+        uint64_t blocks = context.block_count.load(std::memory_order_relaxed);
+        uint64_t accesses = context.memory_access_count.load(std::memory_order_relaxed);
+        if (MetricsRegistry::isRecording()) {
+            traceInstructionsMetric().add(instructions - context.reported_instructions);
+            traceBlocksMetric().add(blocks - context.reported_blocks);
+            traceMemoryAccessesMetric().add(accesses - context.reported_memory_accesses);
+        }
+        context.reported_instructions = instructions;
+        context.reported_blocks = blocks;
+        context.reported_memory_accesses = accesses;
+    }
+
+    // 按跟踪范围建立计数块表（需持有 config_mutex_）：重叠的范围合并后按起始地址排序，
+    // 每 kProfileChunkUnits 个指令对齐单元占一个块表项，计数块留到首次命中时分配
+    void buildProfileRanges(std::vector<ProfileRange>& ranges) const {
+        std::vector<std::pair<uint64_t, uint64_t>> sorted = traced_ranges_;
+        std::sort(sorted.begin(), sorted.end());
+        for (const auto& range : sorted) {
+            if (!ranges.empty() && range.first <= ranges.back().end) {
+                ranges.back().end = std::max(ranges.back().end, range.second);
+            } else {
+                ranges.push_back({range.first, range.second, {}});
+            }
+        }
+        for (auto& range : ranges) {
+            size_t units = (range.end - range.start) / kCoverageGranularity + 1;
+            range.chunks.resize((units + kProfileChunkUnits - 1) / kProfileChunkUnits);
+        }
+    }
+
+    // 热路径：按地址在分块数组中计数，先查上次命中的范围，再二分查找
+    static void profileHit(VMContext& context, uint64_t address) {
+        std::vector<ProfileRange>& ranges = context.profile_ranges;
+        size_t hint = context.profile_hint;
+        if (hint >= ranges.size() || address < ranges[hint].start || address >= ranges[hint].end) {
+            auto it = std::upper_bound(
+                ranges.begin(), ranges.end(), address, [](uint64_t value, const ProfileRange& r) {
+                    return value < r.start;
+                });
+            if (it == ranges.begin() || address >= (it - 1)->end) {
+                return;
+            }
+            hint = static_cast<size_t>(it - ranges.begin()) - 1;
+            context.profile_hint = hint;
+        }
+
+        ProfileRange& range = ranges[hint];
+        size_t unit = (address - range.start) / kCoverageGranularity;
+        std::unique_ptr<uint64_t[]>& chunk = range.chunks[unit / kProfileChunkUnits];
+        if (!chunk) {
+            chunk = std::make_unique<uint64_t[]>(kProfileChunkUnits);
+        }
+        chunk[unit % kProfileChunkUnits]++;
+    }
+
+    // 将上下文的计数合并到共享结果（需持有 context.profile_mutex，且所属线程不在VM中）
+    void mergeProfileLocked(VMContext& context) {
+        std::lock_guard<std::mutex> lock(profile_mutex_);
+        for (auto& range : context.profile_ranges) {
+            for (size_t c = 0; c < range.chunks.size(); ++c) {
+                uint64_t* counts = range.chunks[c].get();
+                if (counts == nullptr) {
+                    continue;
+                }
+                uint64_t base = range.start + c * kProfileChunkUnits * kCoverageGranularity;
+                for (size_t i = 0; i < kProfileChunkUnits; ++i) {
+                    if (counts[i] != 0) {
+                        merged_profile_[base + i * kCoverageGranularity] += counts[i];
+                    }
+                }
+                // 保留已分配的块供本轮继续计数
+                std::fill(counts, counts + kProfileChunkUnits, 0);
+            }
+        }
+    }
+
+    // 合并所有不在VM中执行的线程的计数，仍在执行的线程在退出VM时合并
+    void collectProfiles() {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        for (auto& context : contexts_) {
+            std::lock_guard<std::mutex> context_lock(context->profile_mutex);
+            if (!context->in_vm.load()) {
+                mergeProfileLocked(*context);
+            }
+        }
+    }
+
+    // 已释放的上下文不再持有解码缓存，其余计数保留在 released_stats_ 中
+    QBDITracer::TraceStats sumContextStats() const {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        QBDITracer::TraceStats stats = released_stats_;
+        for (const auto& context : contexts_) {
+            addContextStats(stats, *context);
+            stats.decoded_count += context->instruction_cache.size();
+        }
+        return stats;
+    }
+
+    static void addContextStats(QBDITracer::TraceStats& stats, const VMContext& context) {
+        stats.instruction_count += context.instruction_count.load(std::memory_order_relaxed);
+        stats.block_count += context.block_count.load(std::memory_order_relaxed);
+        stats.unique_block_count += context.unique_block_count.load(std::memory_order_relaxed);
+        stats.memory_access_count += context.memory_access_count.load(std::memory_order_relaxed);
+        stats.sampled_count += context.sampled_count.load(std::memory_order_relaxed);
+        stats.estimated_instruction_count +=
+            context.estimated_instructions.load(std::memory_order_relaxed);
+        stats.estimated_block_count += context.skipped_block_count.load(std::memory_order_relaxed);
+        stats.budget_suspend_count += context.disarm_count.load(std::memory_order_relaxed);
+    }
+
+    bool anyContextInVM() const {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        for (const auto& context : contexts_) {
+            if (context->in_vm.load()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static QBDI::MemoryAccessType memoryAccessType(const MemoryTraceConfig& config) {
+        if (config.trace_reads && config.trace_writes) {
+            return QBDI::MEMORY_READ_WRITE;
+        }
+        return config.trace_reads ? QBDI::MEMORY_READ : QBDI::MEMORY_WRITE;
+    }
+
+    void flushMemoryBatch(VMContext& context) {
+        if (!context.memory_batch.empty() && context.memory_config.consumer) {
+            context.memory_config.consumer(context.memory_batch);
+        }
+        context.memory_batch.clear();
+    }
+
+    // 内存访问回调
+    static QBDI::VMAction memoryAccessCallback(QBDI::VMInstanceRef vm,
+                                               QBDI::GPRState* gprState,
+                                               QBDI::FPRState* fprState,
+                                               void* data) {
+        VMContext* context = static_cast<VMContext*>(data);
+        return context->owner->handleMemoryAccess(*context, vm);
+    }
+
+    QBDI::VMAction handleMemoryAccess(VMContext& context, QBDI::VMInstanceRef vm) {
+        // 追加到列式批次，批次满时整体交付，而不是每次访问调用一次回调
+        MemoryAccessBatch& batch = context.memory_batch;
+        uint64_t count = 0;
+        for (const QBDI::MemoryAccess& access : vm->getInstMemoryAccess()) {
+            uint8_t kind = 0;
+            if (access.type & QBDI::MEMORY_READ) {
+                kind |= MEMORY_ACCESS_READ;
+            }
+            if (access.type & QBDI::MEMORY_WRITE) {
+                kind |= MEMORY_ACCESS_WRITE;
+            }
+
+            if (batch.empty()) {
+                batch.thread_id = context.thread_id;
+            }
+            batch.append(access.instAddress, access.accessAddress, access.value, access.size, kind);
+            count++;
+
+            if (batch.count() >= context.memory_config.batch_size) {
+                context.memory_config.consumer(batch);
+                batch.clear();
+            }
+        }
+
+        bumpCounter(context.memory_access_count, count);
+        return QBDI::VMAction::CONTINUE;
+    }
+
+    // 基本块事件回调
+    static QBDI::VMAction basicBlockCallback(QBDI::VMInstanceRef vm,
+                                             const QBDI::VMState* vmState,
+                                             QBDI::GPRState* gprState,
+                                             QBDI::FPRState* fprState,
+                                             void* data) {
+        VMContext* context = static_cast<VMContext*>(data);
+        return context->owner->handleBasicBlock(*context, vmState);
+    }
+
+    QBDI::VMAction handleBasicBlock(VMContext& context, const QBDI::VMState* vmState) {
+        // 新基本块只会出现一次，此处加锁不影响热路径
+        if (vmState->event & QBDI::BASIC_BLOCK_NEW) {
+            bumpCounter(context.unique_block_count);
+            std::lock_guard<std::mutex> lock(coverage_mutex_);
+            coverage_.markBlock(vmState->basicBlockStart, vmState->basicBlockEnd);
+        }
+
+        if (vmState->event & QBDI::BASIC_BLOCK_ENTRY) {
+            bumpCounter(context.block_count);
+            bumpCounter(context.estimated_instructions, estimateInstructions(vmState));
+            if (context.profiling) {
+                profileHit(context, vmState->basicBlockStart);
+            }
+
+            if (budgetExceeded(context)) {
+                return suspendForBudget(context);
+            }
+            if (sampleEvent(context) && recording_.load(std::memory_order_relaxed)) {
+                recorder_.record(vmState->basicBlockStart, TRACE_RECORD_BLOCK_ENTRY);
+            }
+        }
+
+        return QBDI::VMAction::CONTINUE;
+    }
+
+    // 记录执行当前指令前的寄存器：只比较上一条指令可能写入的寄存器
+    static void recordRegisters(VMContext& context,
+                                QBDI::VMInstanceRef vm,
+                                const QBDI::GPRState* gprState,
+                                uint64_t address) {
+        DecodedInstruction& decoded = context.instruction_cache.lookup(vm, address);
+        context.instruction_cache.ensureRegisterWrites(vm, decoded);
+
+        if constexpr (sizeof(QBDI::rword) == sizeof(uint64_t)) {
+            context.register_encoder.record(
+                address, reinterpret_cast<const uint64_t*>(gprState), decoded.register_writes);
+        } else {
+            uint64_t registers[QBDI::NUM_GPR];
+            for (uint32_t i = 0; i < QBDI::NUM_GPR; ++i) {
+                registers[i] = QBDI_GPR_GET(gprState, i);
+            }
+            context.register_encoder.record(address, registers, decoded.register_writes);
+        }
+    }
+
+    // 指令回调函数
+    static QBDI::VMAction instructionCallback(QBDI::VMInstanceRef vm,
+                                              QBDI::GPRState* gprState,
+                                              QBDI::FPRState* fprState,
+                                              void* data) {
+        VMContext* context = static_cast<VMContext*>(data);
+        return context->owner->handleInstruction(*context, vm, gprState, fprState);
+    }
+
+    QBDI::VMAction handleInstruction(VMContext& context,
+                                     QBDI::VMInstanceRef vm,
+                                     QBDI::GPRState* gprState,
+                                     QBDI::FPRState* fprState) {
+        try {
+            bumpCounter(context.instruction_count);
+            if (context.profiling) {
+                profileHit(context, QBDI_GPR_GET(gprState, QBDI::REG_PC));
+            }
+
+            if (budgetExceeded(context)) {
+                return suspendForBudget(context);
+            }
+
+            uint64_t address = QBDI_GPR_GET(gprState, QBDI::REG_PC);
+
+            // 寄存器差分依赖连续的指令流，不参与采样
+            if (context.register_enabled) {
+                recordRegisters(context, vm, gprState, address);
+            }
+
+            if (!sampleEvent(context)) {
+                return QBDI::VMAction::CONTINUE;
+            }
+
+            // 记录模式：只写入固定大小的二进制记录，不分配内存、不格式化、不加锁
+            if (recording_.load(std::memory_order_relaxed)) {
+                recorder_.record(address);
+            }
+
+            // 订阅者列表为不可变快照：先登记读取代号再取指针，回调返回时撤销登记
+            SubscriberReadGuard read_guard(context.subscriber_epoch, subscriber_epoch_.load());
+            const SubscriberList* subscribers = subscribers_.load();
+            bool log_text = enable_logging_ && logger_ && logger_->getMinLevel() <= LogLevel::DEBUG;
+            bool annotate = annotate_disassembly_.load(std::memory_order_relaxed);
+            if (!log_text && subscribers == nullptr && !annotate) {
+                return QBDI::VMAction::CONTINUE;
+            }
+
+            // 从缓存获取解码信息，每个地址只解码一次
+            InstructionCache& cache = context.instruction_cache;
+            DecodedInstruction& decoded = cache.lookup(vm, address);
+
+            // 每个地址的反汇编只写入跟踪文件字符串表一次
+            if (annotate && decoded.disassembly_id == StringPool::kInvalidId) {
+                cache.ensureDisassembly(vm, decoded);
+                recorder_.annotate(address, cache.disassembly(decoded));
+            }
+            if (!log_text && subscribers == nullptr) {
+                return QBDI::VMAction::CONTINUE;
+            }
+
+            // 只有消费者需要文本时才请求反汇编
+            if (log_text || (subscribers && subscribers->needs_disassembly)) {
+                cache.ensureDisassembly(vm, decoded);
+            }
+
+            InstructionInfo info;
+            info.address = address;
+            info.mnemonic = cache.mnemonic(decoded);
+            info.operand = cache.operand(decoded);
+            info.thread_id = context.thread_id;
+            info.disassembly = cache.disassembly(decoded);
+            info.size = decoded.size;
+            info.inst_class = decoded.inst_class;
+
+            // 记录到日志
+            if (log_text) {
+                logger_->debug("0x%lx: %.*s",
+                               info.address,
+                               static_cast<int>(info.disassembly.size()),
+                               info.disassembly.data());
+            }
+
+            // 分发给订阅者
+            if (subscribers) {
+                for (const auto& entry : subscribers->entries) {
+                    const InstructionSubscriber& subscriber = entry.second;
+                    if (address < subscriber.range_start || address >= subscriber.range_end) {
+                        continue;
+                    }
+                    if (subscriber.class_mask != 0 &&
+                        (subscriber.class_mask & decoded.inst_class) == 0) {
+                        continue;
+                    }
+                    subscriber.callback(info);
                 }
             }
 
@@ -443,6 +1828,30 @@ class QBDITracer::Impl {
         }
     }
 
+    static void symbolize(HotSpot& spot) {
+        // 符号索引包含 .symtab 中的局部符号，dladdr 只能看到导出符号
+        std::optional<SymbolInfo> symbol =
+            SymbolIndex::getInstance().findSymbolContaining(spot.address);
+        Dl_info info;
+        bool resolved = dladdr(reinterpret_cast<void*>(spot.address), &info) != 0;
+        if (resolved && info.dli_fname) {
+            spot.module = info.dli_fname;
+            spot.module_offset = spot.address - reinterpret_cast<uint64_t>(info.dli_fbase);
+        }
+        if (symbol) {
+            spot.symbol = symbol->name;
+            spot.symbol_offset = spot.address - symbol->address;
+            if (spot.module.empty()) {
+                spot.module = symbol->module_path;
+            }
+        } else if (resolved && info.dli_sname) {
+            spot.symbol = info.dli_sname;
+            spot.symbol_offset = spot.address - reinterpret_cast<uint64_t>(info.dli_saddr);
+        } else {
+            spot.symbol_offset = spot.module_offset;
+        }
+    }
+
     uint64_t getCurrentTimeMs() const {
         auto now = std::chrono::steady_clock::now();
         return std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch())
@@ -450,28 +1859,161 @@ class QBDITracer::Impl {
     }
 
   private:
-    QBDI::VM* vm_;
     Logger* logger_;
 
     std::atomic<bool> initialized_;
     std::atomic<bool> tracing_;
     bool enable_logging_;
+    std::atomic<bool> recording_;
     int log_level_;
+    TraceMode trace_mode_;
 
-    std::atomic<uint64_t> instruction_count_;
-    uint64_t start_time_;
+    // 内存访问跟踪配置
+    bool memory_trace_enabled_;
+    MemoryTraceConfig memory_config_;
+
+    // 寄存器差分跟踪：各线程的编码器写满一块后交给写入器
+    bool register_trace_enabled_ = false;
+    RegisterTraceWriter register_writer_;
 
-    std::unordered_set<uint32_t> callback_ids_;
+    // 采样与CPU预算配置
+    SamplingConfig sampling_config_;
+
+    // 热点分析：各线程计数在停止跟踪或退出VM时合并到此处
+    bool profiling_enabled_ = false;
+    std::mutex profile_mutex_;
+    std::unordered_map<uint64_t, uint64_t> merged_profile_;
+
+    // 共享的跟踪配置，各线程VM按代号同步
+    mutable std::mutex config_mutex_;
+    std::atomic<uint64_t> config_generation_;
     std::vector<std::pair<uint64_t, uint64_t>> traced_ranges_;
 
-    std::mutex callback_mutex_;
-    InstructionCallback user_callback_;
+    // 每线程VM池
+    mutable std::mutex pool_mutex_;
+    std::vector<std::unique_ptr<VMContext>> contexts_;
+    uint64_t pool_id_;
+    // 线程退出时已释放的上下文的累计计数
+    QBDITracer::TraceStats released_stats_ = {};
+
+    // 统计基线：各线程计数器只增不减，会话统计为与基线的差值
+    QBDITracer::TraceStats stats_baseline_ = {};
+    uint64_t start_time_;
+
+    // 不可变订阅者快照
+    struct SubscriberList {
+        std::vector<std::pair<SubscriberId, InstructionSubscriber>> entries;
+        bool needs_disassembly = false;
+
+        bool remove(SubscriberId id) {
+            for (auto it = entries.begin(); it != entries.end(); ++it) {
+                if (it->first == id) {
+                    entries.erase(it);
+                    return true;
+                }
+            }
+            return false;
+        }
+    };
+
+    // 读临界区：只覆盖一次回调，线程阻塞在VM内其他位置时不妨碍回收
+    struct SubscriberReadGuard {
+        std::atomic<uint64_t>& slot;
+
+        SubscriberReadGuard(std::atomic<uint64_t>& epoch_slot, uint64_t epoch)
+            : slot(epoch_slot) {
+            slot.store(epoch);
+        }
+
+        ~SubscriberReadGuard() {
+            slot.store(kQuiescentEpoch, std::memory_order_release);
+        }
+    };
 
-    // VM栈空间管理
-    uint64_t stack_base_;
-    size_t stack_size_;
+    struct RetiredSubscriberList {
+        std::unique_ptr<SubscriberList> list;
+        uint64_t epoch;
+    };
+
+    SubscriberList currentSubscribersLocked() const {
+        const SubscriberList* current = subscribers_.load(std::memory_order_acquire);
+        return current ? *current : SubscriberList();
+    }
+
+    // 发布新快照（需持有 subscribers_mutex_）
+    // 旧快照可能仍被VM线程读取，按换下时的代号放入退休列表，所有读者都登记了更新的代号后释放
+    void publishSubscribersLocked(SubscriberList next) {
+        next.needs_disassembly = false;
+        for (const auto& entry : next.entries) {
+            next.needs_disassembly |= entry.second.needs_disassembly;
+        }
+
+        std::unique_ptr<SubscriberList> published;
+        if (!next.entries.empty()) {
+            published = std::make_unique<SubscriberList>(std::move(next));
+        }
+
+        subscribers_.store(published.get());
+        uint64_t epoch = subscriber_epoch_.fetch_add(1);
+        if (current_subscribers_) {
+            retired_subscribers_.push_back({std::move(current_subscribers_), epoch});
+        }
+        current_subscribers_ = std::move(published);
+
+        reclaimSubscribersLocked();
+    }
+
+    void reclaimSubscribers() {
+        std::lock_guard<std::mutex> lock(subscribers_mutex_);
+        reclaimSubscribersLocked();
+    }
+
+    // 读者登记的代号不大于其可能持有的快照的退休代号，小于所有登记代号的快照已无人持有
+    void reclaimSubscribersLocked() {
+        if (retired_subscribers_.empty()) {
+            return;
+        }
+        uint64_t oldest = kQuiescentEpoch;
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex_);
+            for (const auto& context : contexts_) {
+                oldest = std::min(oldest, context->subscriber_epoch.load());
+            }
+        }
+        retired_subscribers_.erase(std::remove_if(retired_subscribers_.begin(),
+                                                  retired_subscribers_.end(),
+                                                  [oldest](const RetiredSubscriberList& retired) {
+                                                      return retired.epoch < oldest;
+                                                  }),
+                                   retired_subscribers_.end());
+    }
+
+    // 记录器旧会话的缓冲区只会被VM中的线程写入（record() 只在回调中调用）
+    void reclaimRecorderBuffers() {
+        if (!anyContextInVM()) {
+            recorder_.reclaimRetired();
+        }
+    }
+
+    std::mutex subscribers_mutex_;  // 仅串行化写者
+    std::atomic<const SubscriberList*> subscribers_;
+    std::unique_ptr<SubscriberList> current_subscribers_;
+    std::vector<RetiredSubscriberList> retired_subscribers_;
+    std::atomic<uint64_t> subscriber_epoch_{1};
+    SubscriberId next_subscriber_id_;
+    SubscriberId legacy_subscriber_id_;
+
+    // 二进制记录器
+    TraceRecorder recorder_;
+    std::atomic<bool> annotate_disassembly_{false};
+
+    // 基本块覆盖率（所有线程共享）
+    mutable std::mutex coverage_mutex_;
+    CoverageMap coverage_;
 };
 
+thread_local QBDITracer::Impl::ThreadContextCache QBDITracer::Impl::t_context_cache_;
+
 // QBDITracer 公共接口实现
 QBDITracer::QBDITracer() : pImpl(std::make_unique<Impl>()) {}
 
@@ -497,6 +2039,14 @@ bool QBDITracer::startTraceModule(const std::string& module_name) {
     return pImpl->startTraceModule(module_name);
 }
 
+bool QBDITracer::startTraceModules(const std::vector<std::string>& module_names) {
+    return pImpl->startTraceModules(module_names);
+}
+
+bool QBDITracer::addTraceModule(const std::string& module_name) {
+    return pImpl->addTraceModule(module_name);
+}
+
 void QBDITracer::stopTrace() {
     pImpl->stopTrace();
 }
@@ -505,10 +2055,58 @@ bool QBDITracer::isTracing() const {
     return pImpl->isTracing();
 }
 
+void QBDITracer::setTraceMode(TraceMode mode) {
+    pImpl->setTraceMode(mode);
+}
+
+TraceMode QBDITracer::getTraceMode() const {
+    return pImpl->getTraceMode();
+}
+
+void QBDITracer::setSampling(const SamplingConfig& config) {
+    pImpl->setSampling(config);
+}
+
+SamplingConfig QBDITracer::getSampling() const {
+    return pImpl->getSampling();
+}
+
+void QBDITracer::enableProfiling(bool enable) {
+    pImpl->enableProfiling(enable);
+}
+
+bool QBDITracer::isProfiling() const {
+    return pImpl->isProfiling();
+}
+
+std::vector<HotSpot> QBDITracer::getHotSpots(size_t top_n) {
+    return pImpl->getHotSpots(top_n);
+}
+
+void QBDITracer::printHotSpots(size_t top_n) {
+    pImpl->printHotSpots(top_n);
+}
+
+CoverageMap QBDITracer::getCoverage() const {
+    return pImpl->getCoverage();
+}
+
 void QBDITracer::setInstructionCallback(InstructionCallback callback) {
     pImpl->setInstructionCallback(callback);
 }
 
+SubscriberId QBDITracer::addInstructionSubscriber(const InstructionSubscriber& subscriber) {
+    return pImpl->addInstructionSubscriber(subscriber);
+}
+
+bool QBDITracer::removeInstructionSubscriber(SubscriberId id) {
+    return pImpl->removeInstructionSubscriber(id);
+}
+
+void QBDITracer::clearInstructionSubscribers() {
+    pImpl->clearInstructionSubscribers();
+}
+
 void QBDITracer::enableInstructionLogging(bool enable) {
     pImpl->enableInstructionLogging(enable);
 }
@@ -517,6 +2115,42 @@ void QBDITracer::setLogLevel(int level) {
     pImpl->setLogLevel(level);
 }
 
+bool QBDITracer::enableRecording(const RecorderConfig& config) {
+    return pImpl->enableRecording(config);
+}
+
+void QBDITracer::disableRecording() {
+    pImpl->disableRecording();
+}
+
+bool QBDITracer::isRecording() const {
+    return pImpl->isRecording();
+}
+
+bool QBDITracer::enableMemoryTrace(const MemoryTraceConfig& config) {
+    return pImpl->enableMemoryTrace(config);
+}
+
+void QBDITracer::disableMemoryTrace() {
+    pImpl->disableMemoryTrace();
+}
+
+bool QBDITracer::enableRegisterTrace(const RegisterTraceConfig& config) {
+    return pImpl->enableRegisterTrace(config);
+}
+
+void QBDITracer::disableRegisterTrace() {
+    pImpl->disableRegisterTrace();
+}
+
+bool QBDITracer::isRegisterTracing() const {
+    return pImpl->isRegisterTracing();
+}
+
+void QBDITracer::flushMemoryTrace() {
+    pImpl->flushMemoryTrace();
+}
+
 void QBDITracer::run() {
     pImpl->run();
 }
@@ -525,6 +2159,11 @@ uint64_t QBDITracer::callFunction(uint64_t func_addr, const std::vector<uint64_t
     return pImpl->callFunction(func_addr, args);
 }
 
+std::vector<uint64_t> QBDITracer::callFunctionBatch(
+    uint64_t func_addr, const std::vector<std::vector<uint64_t>>& arg_sets) {
+    return pImpl->callFunctionBatch(func_addr, arg_sets);
+}
+
 QBDITracer::TraceStats QBDITracer::getStats() const {
     return pImpl->getStats();
 }
@@ -0,0 +1,486 @@
+//
+// 寄存器差分跟踪实现
+//
+
+#include "trace/register_trace.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef ATKIT_TRACE_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include "trace_encoding.h"
+#include "utility/Logger.h"
+
+namespace AnalysisToolkit {
+namespace Trace {
+
+namespace {
+
+constexpr char kHeaderMagic[8] = {'A', 'T', 'K', 'R', 'E', 'G', 'T', 'R'};
+constexpr char kFooterMagic[8] = {'A', 'T', 'K', 'R', 'E', 'G', 'N', 'D'};
+constexpr uint32_t kFormatVersion = 1;
+
+uint64_t registerMask(uint32_t register_count, uint32_t pc_index) {
+    uint64_t mask = register_count >= 64 ? ~0ULL : (1ULL << register_count) - 1;
+    return mask & ~(1ULL << pc_index);
+}
+
+}  // namespace
+
+// ============================================================================
+// RegisterTraceWriter
+// ============================================================================
+
+RegisterTraceWriter::~RegisterTraceWriter() {
+    close();
+}
+
+bool RegisterTraceWriter::open(const RegisterTraceConfig& config,
+                               uint32_t register_count,
+                               uint32_t pc_index) {
+    close();
+
+    if (register_count == 0 || register_count > kMaxTraceRegisters ||
+        pc_index >= register_count) {
+        ATKIT_ERROR("Invalid register layout for register trace: %u registers, pc %u",
+                    register_count,
+                    pc_index);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    file_ = fopen(config.output_path.c_str(), "wb");
+    if (file_ == nullptr) {
+        ATKIT_ERROR("Failed to open register trace file: %s", config.output_path.c_str());
+        return false;
+    }
+    setvbuf(file_, nullptr, _IOFBF, 1 << 20);
+
+    register_count_ = register_count;
+    pc_index_ = pc_index;
+    keyframe_interval_ = std::max<uint32_t>(config.keyframe_interval, 1);
+#ifdef ATKIT_TRACE_HAVE_ZLIB
+    compress_.store(config.compress, std::memory_order_relaxed);
+#else
+    compress_.store(false, std::memory_order_relaxed);
+#endif
+
+    RegisterTraceHeader header;
+    memcpy(header.magic, kHeaderMagic, sizeof(header.magic));
+    header.version = kFormatVersion;
+    header.register_count = register_count_;
+    header.pc_index = pc_index_;
+    header.keyframe_interval = keyframe_interval_;
+    fwrite(&header, sizeof(header), 1, file_);
+
+    file_offset_ = sizeof(header);
+    record_count_ = 0;
+    index_.clear();
+    session_.fetch_add(1, std::memory_order_acq_rel);
+    return true;
+}
+
+bool RegisterTraceWriter::isOpen() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return file_ != nullptr;
+}
+
+uint64_t RegisterTraceWriter::recordCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return record_count_;
+}
+
+void RegisterTraceWriter::writeChunk(uint64_t session,
+                                     const RegisterChunkIndexEntry& info,
+                                     const std::vector<uint8_t>& raw,
+                                     std::vector<uint8_t>& scratch) {
+    if (info.record_count == 0 || session != session_.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    TraceChunkHeader header;
+    header.codec = TRACE_CHUNK_RAW;
+    header.record_count = info.record_count;
+    header.raw_size = static_cast<uint32_t>(raw.size());
+
+    const uint8_t* payload = raw.data();
+    size_t payload_size = raw.size();
+
+#ifdef ATKIT_TRACE_HAVE_ZLIB
+    if (compress_.load(std::memory_order_relaxed)) {
+        uLongf compressed_size = compressBound(static_cast<uLong>(raw.size()));
+        scratch.resize(compressed_size);
+        if (compress2(scratch.data(),
+                      &compressed_size,
+                      raw.data(),
+                      static_cast<uLong>(raw.size()),
+                      1) == Z_OK &&
+            compressed_size < raw.size()) {
+            header.codec = TRACE_CHUNK_ZLIB;
+            payload = scratch.data();
+            payload_size = compressed_size;
+        }
+    }
+#endif
+
+    header.stored_size = static_cast<uint32_t>(payload_size);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (file_ == nullptr || session != session_.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    RegisterChunkIndexEntry entry = info;
+    entry.file_offset = file_offset_;
+    fwrite(&header, sizeof(header), 1, file_);
+    fwrite(payload, 1, payload_size, file_);
+    file_offset_ += sizeof(header) + payload_size;
+    record_count_ += info.record_count;
+    index_.push_back(entry);
+}
+
+bool RegisterTraceWriter::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (file_ == nullptr) {
+        return false;
+    }
+
+    RegisterTraceFooter footer = {};
+    footer.index_offset = file_offset_;
+    footer.chunk_count = index_.size();
+    footer.record_count = record_count_;
+    memcpy(footer.magic, kFooterMagic, sizeof(footer.magic));
+
+    if (!index_.empty()) {
+        fwrite(index_.data(), sizeof(RegisterChunkIndexEntry), index_.size(), file_);
+    }
+    fwrite(&footer, sizeof(footer), 1, file_);
+
+    bool success = ferror(file_) == 0;
+    fclose(file_);
+    file_ = nullptr;
+    index_.clear();
+    if (!success) {
+        ATKIT_ERROR("Failed to write register trace file");
+    }
+    return success;
+}
+
+// ============================================================================
+// RegisterTraceEncoder
+// ============================================================================
+
+void RegisterTraceEncoder::attach(RegisterTraceWriter* writer, uint32_t thread_id) {
+    uint64_t session = writer->session();
+    if (writer != writer_ || session != session_) {
+        chunk_.clear();
+        count_ = 0;
+        sequence_ = 0;
+    }
+
+    writer_ = writer;
+    session_ = session;
+    thread_id_ = thread_id;
+    register_count_ = writer->registerCount();
+    keyframe_interval_ = writer->keyframeInterval();
+    all_mask_ = registerMask(register_count_, writer->pcIndex());
+    chunk_.reserve(static_cast<size_t>(keyframe_interval_) * 4);
+    invalidate();
+}
+
+void RegisterTraceEncoder::detach() {
+    flush();
+    writer_ = nullptr;
+}
+
+void RegisterTraceEncoder::flush() {
+    if (writer_ == nullptr || count_ == 0) {
+        return;
+    }
+
+    RegisterChunkIndexEntry info = {};
+    info.first_sequence = sequence_;
+    info.first_address = first_address_;
+    info.thread_id = thread_id_;
+    info.record_count = count_;
+    writer_->writeChunk(session_, info, chunk_, scratch_);
+
+    sequence_ += count_;
+    count_ = 0;
+    chunk_.clear();
+}
+
+void RegisterTraceEncoder::beginChunk(uint64_t address) {
+    // 每块独立编码：关键帧的差分基准为 0
+    first_address_ = address;
+    prev_address_ = 0;
+    memset(last_, 0, sizeof(last_));
+}
+
+void RegisterTraceEncoder::encode(uint64_t address, const uint64_t* registers, uint64_t changed) {
+    size_t offset = chunk_.size();
+    chunk_.resize(offset + (2 + __builtin_popcountll(changed)) * kMaxVarintSize);
+    uint8_t* out = chunk_.data() + offset;
+    out = writeVarint(out, deltaOf(address, prev_address_));
+    out = writeVarint(out, changed);
+    for (uint64_t mask = changed; mask != 0; mask &= mask - 1) {
+        uint32_t index = static_cast<uint32_t>(__builtin_ctzll(mask));
+        out = writeVarint(out, deltaOf(registers[index], last_[index]));
+        last_[index] = registers[index];
+    }
+    chunk_.resize(out - chunk_.data());
+    prev_address_ = address;
+}
+
+// ============================================================================
+// RegisterTraceReader
+// ============================================================================
+
+RegisterTraceReader::~RegisterTraceReader() {
+    close();
+}
+
+bool RegisterTraceReader::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        ATKIT_ERROR("Failed to open register trace file: %s", path.c_str());
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) <
+                                   sizeof(RegisterTraceHeader) + sizeof(RegisterTraceFooter)) {
+        ATKIT_ERROR("Register trace file too small: %s", path.c_str());
+        ::close(fd);
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        ATKIT_ERROR("Failed to map register trace file: %s", path.c_str());
+        return false;
+    }
+
+    data_ = static_cast<const uint8_t*>(mapping);
+    size_ = static_cast<size_t>(st.st_size);
+
+    // 校验文件头和文件尾
+    memcpy(&header_, data_, sizeof(header_));
+    memcpy(&footer_, data_ + size_ - sizeof(footer_), sizeof(footer_));
+    if (memcmp(header_.magic, kHeaderMagic, sizeof(kHeaderMagic)) != 0 ||
+        header_.version != kFormatVersion || header_.register_count == 0 ||
+        header_.register_count > kMaxTraceRegisters ||
+        header_.pc_index >= header_.register_count ||
+        memcmp(footer_.magic, kFooterMagic, sizeof(kFooterMagic)) != 0 ||
+        footer_.index_offset < sizeof(header_) ||
+        footer_.index_offset + footer_.chunk_count * sizeof(RegisterChunkIndexEntry) >
+            size_ - sizeof(footer_)) {
+        ATKIT_ERROR("Invalid or truncated register trace file: %s", path.c_str());
+        close();
+        return false;
+    }
+
+    index_.resize(footer_.chunk_count);
+    if (!index_.empty()) {
+        memcpy(index_.data(),
+               data_ + footer_.index_offset,
+               index_.size() * sizeof(RegisterChunkIndexEntry));
+    }
+
+    for (size_t i = 0; i < index_.size(); ++i) {
+        thread_chunks_[index_[i].thread_id].push_back(i);
+    }
+    for (auto& entry : thread_chunks_) {
+        std::stable_sort(entry.second.begin(), entry.second.end(), [this](size_t a, size_t b) {
+            return index_[a].first_sequence < index_[b].first_sequence;
+        });
+    }
+    return true;
+}
+
+void RegisterTraceReader::close() {
+    if (data_ != nullptr) {
+        munmap(const_cast<uint8_t*>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+    header_ = {};
+    footer_ = {};
+    index_.clear();
+    thread_chunks_.clear();
+}
+
+std::vector<uint32_t> RegisterTraceReader::threads() const {
+    std::vector<uint32_t> result;
+    result.reserve(thread_chunks_.size());
+    for (const auto& entry : thread_chunks_) {
+        result.push_back(entry.first);
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+uint64_t RegisterTraceReader::recordCount(uint32_t thread_id) const {
+    auto it = thread_chunks_.find(thread_id);
+    if (it == thread_chunks_.end()) {
+        return 0;
+    }
+    uint64_t count = 0;
+    for (size_t chunk : it->second) {
+        count += index_[chunk].record_count;
+    }
+    return count;
+}
+
+size_t RegisterTraceReader::findChunk(uint32_t thread_id, uint64_t sequence) const {
+    auto it = thread_chunks_.find(thread_id);
+    if (it == thread_chunks_.end()) {
+        return SIZE_MAX;
+    }
+
+    const std::vector<size_t>& chunks = it->second;
+    auto pos = std::upper_bound(
+        chunks.begin(), chunks.end(), sequence, [this](uint64_t value, size_t chunk) {
+            return value < index_[chunk].first_sequence;
+        });
+    if (pos == chunks.begin()) {
+        return SIZE_MAX;
+    }
+
+    size_t chunk = *(pos - 1);
+    const RegisterChunkIndexEntry& info = index_[chunk];
+    return sequence - info.first_sequence < info.record_count ? chunk : SIZE_MAX;
+}
+
+bool RegisterTraceReader::decodeChunk(size_t chunk,
+                                      RegisterTraceEntry& entry,
+                                      const EntryCallback& callback) {
+    const RegisterChunkIndexEntry& info = index_[chunk];
+    if (info.file_offset + sizeof(TraceChunkHeader) > footer_.index_offset) {
+        return false;
+    }
+
+    TraceChunkHeader header;
+    memcpy(&header, data_ + info.file_offset, sizeof(header));
+    const uint8_t* payload = data_ + info.file_offset + sizeof(header);
+    if (payload + header.stored_size > data_ + footer_.index_offset) {
+        return false;
+    }
+
+    const uint8_t* raw = payload;
+    size_t raw_size = header.stored_size;
+    if (header.codec == TRACE_CHUNK_ZLIB) {
+#ifdef ATKIT_TRACE_HAVE_ZLIB
+        scratch_.resize(header.raw_size);
+        uLongf out_size = header.raw_size;
+        if (uncompress(scratch_.data(), &out_size, payload, header.stored_size) != Z_OK) {
+            ATKIT_ERROR("Failed to decompress register trace chunk %zu", chunk);
+            return false;
+        }
+        raw = scratch_.data();
+        raw_size = out_size;
+#else
+        ATKIT_ERROR("Register trace chunk %zu is compressed but zlib is not available", chunk);
+        return false;
+#endif
+    } else if (header.codec != TRACE_CHUNK_RAW) {
+        return false;
+    }
+
+    const uint64_t valid_mask = registerMask(header_.register_count, header_.pc_index);
+    const uint8_t* cursor = raw;
+    const uint8_t* end = raw + raw_size;
+
+    memset(&entry, 0, sizeof(entry));
+    entry.thread_id = info.thread_id;
+    for (uint32_t i = 0; i < header.record_count; ++i) {
+        uint64_t address, changed;
+        if ((cursor = readVarint(cursor, end, address)) == nullptr ||
+            (cursor = readVarint(cursor, end, changed)) == nullptr ||
+            (changed & ~valid_mask) != 0) {
+            ATKIT_ERROR("Corrupted register trace chunk %zu", chunk);
+            return false;
+        }
+        for (uint64_t mask = changed; mask != 0; mask &= mask - 1) {
+            uint32_t index = static_cast<uint32_t>(__builtin_ctzll(mask));
+            uint64_t delta;
+            if ((cursor = readVarint(cursor, end, delta)) == nullptr) {
+                ATKIT_ERROR("Corrupted register trace chunk %zu", chunk);
+                return false;
+            }
+            entry.registers[index] = applyDelta(entry.registers[index], delta);
+        }
+
+        entry.sequence = info.first_sequence + i;
+        entry.address = applyDelta(entry.address, address);
+        entry.registers[header_.pc_index] = entry.address;
+        entry.keyframe = i == 0;
+        entry.changed_mask = changed;
+        if (!callback(entry)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool RegisterTraceReader::stateAt(uint32_t thread_id,
+                                  uint64_t sequence,
+                                  RegisterTraceEntry& entry) {
+    size_t chunk = findChunk(thread_id, sequence);
+    if (chunk == SIZE_MAX) {
+        return false;
+    }
+
+    // 从块首的关键帧重放到目标记录
+    bool found = false;
+    RegisterTraceEntry state;
+    decodeChunk(chunk, state, [&](const RegisterTraceEntry& current) {
+        if (current.sequence != sequence) {
+            return true;
+        }
+        entry = current;
+        found = true;
+        return false;
+    });
+    return found;
+}
+
+void RegisterTraceReader::forEach(uint32_t thread_id,
+                                  uint64_t first,
+                                  uint64_t count,
+                                  const EntryCallback& callback) {
+    size_t start = findChunk(thread_id, first);
+    if (start == SIZE_MAX || count == 0) {
+        return;
+    }
+
+    const std::vector<size_t>& chunks = thread_chunks_[thread_id];
+    auto it = std::find(chunks.begin(), chunks.end(), start);
+    uint64_t last = first + count;
+    RegisterTraceEntry state;
+    for (; it != chunks.end(); ++it) {
+        bool more = decodeChunk(*it, state, [&](const RegisterTraceEntry& current) {
+            if (current.sequence < first) {
+                return true;
+            }
+            return current.sequence < last && callback(current);
+        });
+        if (!more) {
+            break;
+        }
+    }
+}
+
+}  // namespace Trace
+}  // namespace AnalysisToolkit
@@ -0,0 +1,57 @@
+//
+// 跟踪文件共用的变长整数与差分编码
+//
+
+#ifndef TRACE_TRACE_ENCODING_H
+#define TRACE_TRACE_ENCODING_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace AnalysisToolkit {
+namespace Trace {
+
+// 单个 varint 编码后的最大字节数
+constexpr size_t kMaxVarintSize = 10;
+
+inline uint64_t zigzagEncode(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t zigzagDecode(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+inline uint8_t* writeVarint(uint8_t* out, uint64_t value) {
+    while (value >= 0x80) {
+        *out++ = static_cast<uint8_t>(value) | 0x80;
+        value >>= 7;
+    }
+    *out++ = static_cast<uint8_t>(value);
+    return out;
+}
+
+inline const uint8_t* readVarint(const uint8_t* in, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; in < end && shift < 64; shift += 7) {
+        uint8_t byte = *in++;
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return in;
+        }
+    }
+    return nullptr;
+}
+
+inline uint64_t applyDelta(uint64_t base, uint64_t encoded) {
+    return base + static_cast<uint64_t>(zigzagDecode(encoded));
+}
+
+inline uint64_t deltaOf(uint64_t value, uint64_t base) {
+    return zigzagEncode(static_cast<int64_t>(value - base));
+}
+
+}  // namespace Trace
+}  // namespace AnalysisToolkit
+
+#endif  // TRACE_TRACE_ENCODING_H
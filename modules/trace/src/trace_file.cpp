@@ -0,0 +1,456 @@
+//
+// 索引化跟踪文件读写实现
+//
+
+#include "trace/trace_file.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef ATKIT_TRACE_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include "trace_encoding.h"
+#include "utility/Logger.h"
+
+namespace AnalysisToolkit {
+namespace Trace {
+
+namespace {
+
+constexpr char kHeaderMagic[8] = {'A', 'T', 'K', 'T', 'R', 'I', 'D', 'X'};
+constexpr char kFooterMagic[8] = {'A', 'T', 'K', 'T', 'R', 'E', 'N', 'D'};
+constexpr uint32_t kFormatVersion = 3;
+
+// 每条记录编码后的最大字节数：5 个 varint 字段
+constexpr size_t kMaxEncodedRecord = 5 * kMaxVarintSize;
+
+}  // namespace
+
+// ============================================================================
+// TraceFileWriter
+// ============================================================================
+
+TraceFileWriter::~TraceFileWriter() {
+    close();
+}
+
+bool TraceFileWriter::open(const std::string& path, const TraceFileOptions& options) {
+    close();
+
+    file_ = fopen(path.c_str(), "wb");
+    if (file_ == nullptr) {
+        ATKIT_ERROR("Failed to open trace file: %s", path.c_str());
+        return false;
+    }
+    setvbuf(file_, nullptr, _IOFBF, 1 << 20);
+
+    options_ = options;
+    options_.chunk_records = std::max<uint32_t>(options.chunk_records, 1);
+#ifndef ATKIT_TRACE_HAVE_ZLIB
+    options_.compress = false;
+#endif
+
+    TraceFileHeader header;
+    memcpy(header.magic, kHeaderMagic, sizeof(header.magic));
+    header.version = kFormatVersion;
+    header.chunk_records = options_.chunk_records;
+    fwrite(&header, sizeof(header), 1, file_);
+
+    file_offset_ = sizeof(header);
+    record_count_ = 0;
+    chunk_.clear();
+    chunk_.reserve(static_cast<size_t>(options_.chunk_records) * 8);
+    current_ = {};
+    index_.clear();
+    strings_.clear();
+    return true;
+}
+
+void TraceFileWriter::append(const TraceRecord* records, size_t count, uint64_t timestamp) {
+    if (file_ == nullptr) {
+        return;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        appendOne(records[i], timestamp);
+    }
+}
+
+void TraceFileWriter::append(const TraceRecord* records,
+                             const uint64_t* timestamps,
+                             size_t count) {
+    if (file_ == nullptr) {
+        return;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        appendOne(records[i], timestamps[i]);
+    }
+}
+
+void TraceFileWriter::appendOne(const TraceRecord& record, uint64_t timestamp) {
+    if (current_.record_count == 0) {
+        // 每块独立编码，读取时无需依赖前面的块；所有字段的差分都从 0 开始，
+        // 块内时间戳可能乱序（多线程交错排空），不能以块内最早时间戳为基准
+        current_.first_sequence = record_count_;
+        current_.first_timestamp = timestamp;
+        current_.last_timestamp = timestamp;
+        prev_address_ = 0;
+        prev_sequence_ = 0;
+        prev_timestamp_ = 0;
+        prev_thread_id_ = 0;
+    }
+
+    size_t offset = chunk_.size();
+    chunk_.resize(offset + kMaxEncodedRecord);
+    uint8_t* out = chunk_.data() + offset;
+    out = writeVarint(out, deltaOf(record.address, prev_address_));
+    out = writeVarint(out, deltaOf(record.sequence, prev_sequence_));
+    out = writeVarint(out, deltaOf(timestamp, prev_timestamp_));
+    out = writeVarint(out, deltaOf(record.thread_id, prev_thread_id_));
+    out = writeVarint(out, record.flags);
+    chunk_.resize(out - chunk_.data());
+
+    prev_address_ = record.address;
+    prev_sequence_ = record.sequence;
+    prev_timestamp_ = timestamp;
+    prev_thread_id_ = record.thread_id;
+
+    current_.first_timestamp = std::min(current_.first_timestamp, timestamp);
+    current_.last_timestamp = std::max(current_.last_timestamp, timestamp);
+    current_.record_count++;
+    record_count_++;
+
+    if (current_.record_count >= options_.chunk_records) {
+        flushChunk();
+    }
+}
+
+void TraceFileWriter::annotate(uint64_t address, std::string_view text) {
+    if (file_ == nullptr || text.empty()) {
+        return;
+    }
+    strings_.try_emplace(address, text);
+}
+
+bool TraceFileWriter::flushChunk() {
+    if (current_.record_count == 0) {
+        return true;
+    }
+
+    TraceChunkHeader header;
+    header.codec = TRACE_CHUNK_RAW;
+    header.record_count = current_.record_count;
+    header.raw_size = static_cast<uint32_t>(chunk_.size());
+
+    const uint8_t* payload = chunk_.data();
+    size_t payload_size = chunk_.size();
+
+#ifdef ATKIT_TRACE_HAVE_ZLIB
+    if (options_.compress) {
+        uLongf compressed_size = compressBound(static_cast<uLong>(chunk_.size()));
+        compressed_.resize(compressed_size);
+        // 速度优先：跟踪数据量大，压缩级别 1 已能获得大部分收益
+        if (compress2(compressed_.data(),
+                      &compressed_size,
+                      chunk_.data(),
+                      static_cast<uLong>(chunk_.size()),
+                      1) == Z_OK &&
+            compressed_size < chunk_.size()) {
+            header.codec = TRACE_CHUNK_ZLIB;
+            payload = compressed_.data();
+            payload_size = compressed_size;
+        }
+    }
+#endif
+
+    header.stored_size = static_cast<uint32_t>(payload_size);
+
+    current_.file_offset = file_offset_;
+    fwrite(&header, sizeof(header), 1, file_);
+    fwrite(payload, 1, payload_size, file_);
+    file_offset_ += sizeof(header) + payload_size;
+
+    index_.push_back(current_);
+    current_ = {};
+    chunk_.clear();
+    return true;
+}
+
+bool TraceFileWriter::close() {
+    if (file_ == nullptr) {
+        return false;
+    }
+
+    flushChunk();
+
+    TraceFileFooter footer = {};
+    footer.string_table_offset = file_offset_;
+    footer.string_count = strings_.size();
+
+    // 字符串表：address, length, bytes
+    for (const auto& entry : strings_) {
+        uint64_t address = entry.first;
+        uint32_t length = static_cast<uint32_t>(entry.second.size());
+        fwrite(&address, sizeof(address), 1, file_);
+        fwrite(&length, sizeof(length), 1, file_);
+        fwrite(entry.second.data(), 1, length, file_);
+        file_offset_ += sizeof(address) + sizeof(length) + length;
+    }
+
+    footer.index_offset = file_offset_;
+    footer.chunk_count = index_.size();
+    footer.record_count = record_count_;
+    memcpy(footer.magic, kFooterMagic, sizeof(footer.magic));
+
+    if (!index_.empty()) {
+        fwrite(index_.data(), sizeof(TraceChunkIndexEntry), index_.size(), file_);
+    }
+    fwrite(&footer, sizeof(footer), 1, file_);
+
+    bool success = ferror(file_) == 0;
+    fclose(file_);
+    file_ = nullptr;
+    if (!success) {
+        ATKIT_ERROR("Failed to write trace file");
+    }
+    return success;
+}
+
+// ============================================================================
+// TraceFileReader
+// ============================================================================
+
+TraceFileReader::~TraceFileReader() {
+    close();
+}
+
+bool TraceFileReader::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        ATKIT_ERROR("Failed to open trace file: %s", path.c_str());
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 ||
+        static_cast<size_t>(st.st_size) < sizeof(TraceFileHeader) + sizeof(TraceFileFooter)) {
+        ATKIT_ERROR("Trace file too small: %s", path.c_str());
+        ::close(fd);
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        ATKIT_ERROR("Failed to map trace file: %s", path.c_str());
+        return false;
+    }
+
+    data_ = static_cast<const uint8_t*>(mapping);
+    size_ = static_cast<size_t>(st.st_size);
+
+    // 校验文件头和文件尾
+    TraceFileHeader header;
+    memcpy(&header, data_, sizeof(header));
+    memcpy(&footer_, data_ + size_ - sizeof(footer_), sizeof(footer_));
+    if (memcmp(header.magic, kHeaderMagic, sizeof(kHeaderMagic)) != 0 ||
+        header.version != kFormatVersion ||
+        memcmp(footer_.magic, kFooterMagic, sizeof(kFooterMagic)) != 0 ||
+        footer_.index_offset + footer_.chunk_count * sizeof(TraceChunkIndexEntry) >
+            size_ - sizeof(footer_) ||
+        footer_.string_table_offset > footer_.index_offset) {
+        ATKIT_ERROR("Invalid or truncated trace file: %s", path.c_str());
+        close();
+        return false;
+    }
+
+    index_.resize(footer_.chunk_count);
+    if (!index_.empty()) {
+        memcpy(index_.data(),
+               data_ + footer_.index_offset,
+               index_.size() * sizeof(TraceChunkIndexEntry));
+    }
+
+    // 字符串直接指向映射内存，不复制
+    const uint8_t* cursor = data_ + footer_.string_table_offset;
+    const uint8_t* strings_end = data_ + footer_.index_offset;
+    strings_.reserve(footer_.string_count);
+    for (uint64_t i = 0; i < footer_.string_count; ++i) {
+        uint64_t address;
+        uint32_t length;
+        if (cursor + sizeof(address) + sizeof(length) > strings_end) {
+            break;
+        }
+        memcpy(&address, cursor, sizeof(address));
+        memcpy(&length, cursor + sizeof(address), sizeof(length));
+        cursor += sizeof(address) + sizeof(length);
+        if (cursor + length > strings_end) {
+            break;
+        }
+        strings_.emplace(address, std::string_view(reinterpret_cast<const char*>(cursor), length));
+        cursor += length;
+    }
+
+    return true;
+}
+
+void TraceFileReader::close() {
+    if (data_ != nullptr) {
+        munmap(const_cast<uint8_t*>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+    footer_ = {};
+    index_.clear();
+    strings_.clear();
+    entries_.clear();
+    loaded_chunk_ = SIZE_MAX;
+}
+
+size_t TraceFileReader::findChunkBySequence(uint64_t index) const {
+    auto it = std::upper_bound(
+        index_.begin(), index_.end(), index, [](uint64_t value, const TraceChunkIndexEntry& entry) {
+            return value < entry.first_sequence;
+        });
+    if (it == index_.begin()) {
+        return SIZE_MAX;
+    }
+    return static_cast<size_t>(std::distance(index_.begin(), it) - 1);
+}
+
+bool TraceFileReader::loadChunk(size_t chunk) {
+    if (chunk == loaded_chunk_) {
+        return true;
+    }
+    if (chunk >= index_.size()) {
+        return false;
+    }
+
+    const TraceChunkIndexEntry& info = index_[chunk];
+    if (info.file_offset + sizeof(TraceChunkHeader) > footer_.string_table_offset) {
+        return false;
+    }
+
+    TraceChunkHeader header;
+    memcpy(&header, data_ + info.file_offset, sizeof(header));
+    const uint8_t* payload = data_ + info.file_offset + sizeof(header);
+    if (payload + header.stored_size > data_ + footer_.string_table_offset) {
+        return false;
+    }
+
+    const uint8_t* raw = payload;
+    size_t raw_size = header.stored_size;
+    if (header.codec == TRACE_CHUNK_ZLIB) {
+#ifdef ATKIT_TRACE_HAVE_ZLIB
+        scratch_.resize(header.raw_size);
+        uLongf out_size = header.raw_size;
+        if (uncompress(scratch_.data(), &out_size, payload, header.stored_size) != Z_OK) {
+            ATKIT_ERROR("Failed to decompress trace chunk %zu", chunk);
+            return false;
+        }
+        raw = scratch_.data();
+        raw_size = out_size;
+#else
+        ATKIT_ERROR("Trace chunk %zu is compressed but zlib is not available", chunk);
+        return false;
+#endif
+    } else if (header.codec != TRACE_CHUNK_RAW) {
+        return false;
+    }
+
+    entries_.clear();
+    entries_.reserve(header.record_count);
+
+    const uint8_t* cursor = raw;
+    const uint8_t* end = raw + raw_size;
+    TraceFileEntry entry = {};
+    for (uint32_t i = 0; i < header.record_count; ++i) {
+        uint64_t address, sequence, timestamp, thread_id, flags;
+        if ((cursor = readVarint(cursor, end, address)) == nullptr ||
+            (cursor = readVarint(cursor, end, sequence)) == nullptr ||
+            (cursor = readVarint(cursor, end, timestamp)) == nullptr ||
+            (cursor = readVarint(cursor, end, thread_id)) == nullptr ||
+            (cursor = readVarint(cursor, end, flags)) == nullptr) {
+            ATKIT_ERROR("Corrupted trace chunk %zu", chunk);
+            entries_.clear();
+            return false;
+        }
+
+        entry.index = info.first_sequence + i;
+        entry.address = applyDelta(entry.address, address);
+        entry.sequence = applyDelta(entry.sequence, sequence);
+        entry.timestamp = applyDelta(entry.timestamp, timestamp);
+        entry.thread_id = static_cast<uint32_t>(applyDelta(entry.thread_id, thread_id));
+        entry.flags = static_cast<uint32_t>(flags);
+        entries_.push_back(entry);
+    }
+
+    loaded_chunk_ = chunk;
+    return true;
+}
+
+bool TraceFileReader::read(uint64_t index, TraceFileEntry& entry) {
+    size_t chunk = findChunkBySequence(index);
+    if (chunk == SIZE_MAX || !loadChunk(chunk)) {
+        return false;
+    }
+
+    uint64_t offset = index - index_[chunk].first_sequence;
+    if (offset >= entries_.size()) {
+        return false;
+    }
+    entry = entries_[offset];
+    return true;
+}
+
+void TraceFileReader::forEach(uint64_t first, uint64_t count, const EntryCallback& callback) {
+    uint64_t last = first + std::min(count, recordCount() - std::min(first, recordCount()));
+    size_t chunk = findChunkBySequence(first);
+    uint64_t index = first;
+
+    while (index < last && chunk < index_.size() && loadChunk(chunk)) {
+        uint64_t base = index_[chunk].first_sequence;
+        for (uint64_t i = index - base; i < entries_.size() && index < last; ++i, ++index) {
+            if (!callback(entries_[i])) {
+                return;
+            }
+        }
+        chunk++;
+    }
+}
+
+void TraceFileReader::forEachInTimeWindow(uint64_t begin,
+                                          uint64_t end,
+                                          const EntryCallback& callback) {
+    // 只解压时间范围与窗口重叠的块
+    for (size_t chunk = 0; chunk < index_.size(); ++chunk) {
+        const TraceChunkIndexEntry& info = index_[chunk];
+        if (info.last_timestamp < begin || info.first_timestamp >= end) {
+            continue;
+        }
+        if (!loadChunk(chunk)) {
+            return;
+        }
+        for (const auto& entry : entries_) {
+            if (entry.timestamp >= begin && entry.timestamp < end && !callback(entry)) {
+                return;
+            }
+        }
+    }
+}
+
+std::string_view TraceFileReader::disassembly(uint64_t address) const {
+    auto it = strings_.find(address);
+    return it == strings_.end() ? std::string_view() : it->second;
+}
+
+}  // namespace Trace
+}  // namespace AnalysisToolkit
@@ -0,0 +1,345 @@
+//
+// 二进制跟踪记录器实现
+//
+
+#include "trace/trace_recorder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <functional>
+
+#if defined(__linux__) || defined(__ANDROID__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(__APPLE__)
+#include <pthread.h>
+#endif
+
+#include "trace/trace_file.h"
+#include "utility/Logger.h"
+
+namespace AnalysisToolkit {
+namespace Trace {
+
+namespace {
+
+// 每批次最多交付的记录数
+constexpr size_t kBatchCapacity = 4096;
+
+// 简单的文件头，便于离线工具识别
+struct RecordFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+};
+
+size_t roundUpPowerOfTwo(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+}  // namespace
+
+// ============================================================================
+// TraceRingBuffer
+// ============================================================================
+
+TraceRingBuffer::TraceRingBuffer(size_t capacity, uint32_t thread_id)
+    : mask_(roundUpPowerOfTwo(std::max<size_t>(capacity, 64)) - 1), thread_id_(thread_id) {
+    records_ = std::make_unique<TraceRecord[]>(mask_ + 1);
+
+    // 组较小时缓冲区接近满也能开始新的一组
+    uint64_t stride = std::min<uint64_t>(kTimestampStride, (mask_ + 1) / 4);
+    stamp_mask_ = stride - 1;
+    stamp_limit_ = mask_ + 1 - stride;
+    stamp_shift_ = static_cast<uint32_t>(__builtin_ctzll(stride));
+    stamps_ = std::make_unique<uint64_t[]>((mask_ + 1) >> stamp_shift_);
+}
+
+size_t TraceRingBuffer::drain(TraceRecord* out, size_t max_count, uint64_t* timestamps) {
+    uint64_t tail = tail_.load(std::memory_order_relaxed);
+    uint64_t head = head_.load(std::memory_order_acquire);
+    size_t count = static_cast<size_t>(std::min<uint64_t>(head - tail, max_count));
+
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = records_[(tail + i) & mask_];
+    }
+    if (timestamps != nullptr) {
+        for (size_t i = 0; i < count; ++i) {
+            timestamps[i] = stamps_[((tail + i) & mask_) >> stamp_shift_];
+        }
+    }
+
+    tail_.store(tail + count, std::memory_order_release);
+    return count;
+}
+
+// ============================================================================
+// TraceRecorder
+// ============================================================================
+
+thread_local TraceRecorder::ThreadCache TraceRecorder::t_cache_ = {0, nullptr};
+std::atomic<uint64_t> TraceRecorder::next_generation_{1};
+
+TraceRecorder::TraceRecorder() : generation_(next_generation_.fetch_add(1)) {
+    batch_ = std::make_unique<TraceRecord[]>(kBatchCapacity);
+    batch_timestamps_ = std::make_unique<uint64_t[]>(kBatchCapacity);
+}
+
+TraceRecorder::~TraceRecorder() {
+    stop();
+}
+
+uint32_t TraceRecorder::currentThreadId() {
+    static thread_local uint32_t tid = 0;
+    if (tid == 0) {
+#if defined(__linux__) || defined(__ANDROID__)
+        tid = static_cast<uint32_t>(syscall(SYS_gettid));
+#elif defined(__APPLE__)
+        uint64_t id = 0;
+        pthread_threadid_np(nullptr, &id);
+        tid = static_cast<uint32_t>(id);
+#else
+        tid = static_cast<uint32_t>(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+#endif
+    }
+    return tid;
+}
+
+bool TraceRecorder::start(const RecorderConfig& config) {
+    if (running_.load()) {
+        stop();
+    }
+
+    FILE* file = nullptr;
+    std::unique_ptr<TraceFileWriter> writer;
+    if (!config.output_path.empty() && config.file_format == RecordFileFormat::Indexed) {
+        TraceFileOptions options;
+        options.chunk_records = config.chunk_records;
+        options.compress = config.compress;
+        writer = std::make_unique<TraceFileWriter>();
+        if (!writer->open(config.output_path, options)) {
+            return false;
+        }
+    } else if (!config.output_path.empty()) {
+        file = fopen(config.output_path.c_str(), "wb");
+        if (file == nullptr) {
+            ATKIT_ERROR("Failed to open trace record file: %s", config.output_path.c_str());
+            return false;
+        }
+
+        // 大块缓冲，减少写系统调用
+        setvbuf(file, nullptr, _IOFBF, 1 << 20);
+
+        RecordFileHeader header;
+        memcpy(header.magic, "ATKTRACE", sizeof(header.magic));
+        header.version = 1;
+        header.record_size = sizeof(TraceRecord);
+        fwrite(&header, sizeof(header), 1, file);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(annotations_mutex_);
+        pending_annotations_.clear();
+    }
+
+    config_ = config;
+    output_file_ = file;
+    writer_ = std::move(writer);
+    indexed_.store(writer_ != nullptr, std::memory_order_relaxed);
+    flushed_count_ = 0;
+    batch_count_ = 0;
+    stop_requested_ = false;
+
+    {
+        // 旧缓冲区只退休不释放：缓存了旧代号的线程可能仍在向其中写入
+        std::lock_guard<std::mutex> lock(buffers_mutex_);
+        for (auto& buffer : buffers_) {
+            retired_buffers_.push_back(std::move(buffer));
+        }
+        buffers_.clear();
+        buffer_capacity_ = config.buffer_capacity;
+        // 新的代号使所有线程的缓存失效
+        generation_.store(next_generation_.fetch_add(1));
+    }
+    running_.store(true, std::memory_order_release);
+
+    drainer_ = std::thread(&TraceRecorder::drainerLoop, this);
+
+    ATKIT_INFO("Trace recorder started (buffer capacity: %zu records, output: %s)",
+               config.buffer_capacity,
+               config.output_path.empty() ? "<none>" : config.output_path.c_str());
+    return true;
+}
+
+void TraceRecorder::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        stop_requested_ = true;
+    }
+    wake_cv_.notify_all();
+
+    if (drainer_.joinable()) {
+        drainer_.join();
+    }
+
+    // 写出残留记录
+    flush();
+
+    if (output_file_ != nullptr) {
+        fclose(output_file_);
+        output_file_ = nullptr;
+    }
+    if (writer_) {
+        writer_->close();
+        writer_.reset();
+    }
+    indexed_.store(false, std::memory_order_relaxed);
+
+    Stats stats = getStats();
+    ATKIT_INFO("Trace recorder stopped. Recorded: %lu, dropped: %lu, flushed: %lu",
+               stats.recorded_count,
+               stats.dropped_count,
+               stats.flushed_count);
+}
+
+void TraceRecorder::flush() {
+    drainAll();
+
+    std::lock_guard<std::mutex> lock(drain_mutex_);
+    if (output_file_ != nullptr) {
+        fflush(output_file_);
+    }
+}
+
+void TraceRecorder::annotate(uint64_t address, std::string_view text) {
+    if (!isIndexed() || text.empty()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(annotations_mutex_);
+    pending_annotations_.emplace_back(address, std::string(text));
+}
+
+void TraceRecorder::reclaimRetired() {
+    std::lock_guard<std::mutex> lock(buffers_mutex_);
+    retired_buffers_.clear();
+}
+
+TraceRecorder::Stats TraceRecorder::getStats() const {
+    Stats stats = {};
+    {
+        std::lock_guard<std::mutex> lock(buffers_mutex_);
+        for (const auto& buffer : buffers_) {
+            stats.recorded_count += buffer->recorded();
+            stats.dropped_count += buffer->dropped();
+        }
+        stats.thread_buffers = static_cast<uint32_t>(buffers_.size());
+    }
+    stats.flushed_count = flushed_count_.load();
+    stats.batch_count = batch_count_.load();
+    return stats;
+}
+
+void TraceRecorder::acquireThreadBuffer(ThreadCache& cache) {
+    uint32_t tid = currentThreadId();
+
+    std::lock_guard<std::mutex> lock(buffers_mutex_);
+    uint64_t generation = generation_.load(std::memory_order_relaxed);
+
+    // 同一线程可能因多个记录器交替使用而丢失缓存，先查找已有缓冲区
+    for (const auto& buffer : buffers_) {
+        if (buffer->threadId() == tid) {
+            cache.buffer = buffer.get();
+            cache.generation = generation;
+            return;
+        }
+    }
+
+    buffers_.push_back(std::make_unique<TraceRingBuffer>(buffer_capacity_, tid));
+    cache.buffer = buffers_.back().get();
+    cache.generation = generation;
+}
+
+void TraceRecorder::drainerLoop() {
+    auto interval = std::chrono::milliseconds(std::max<uint32_t>(config_.flush_interval_ms, 1));
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            wake_cv_.wait_for(lock, interval, [this] { return stop_requested_; });
+            if (stop_requested_) {
+                break;
+            }
+        }
+
+        // 持续排空直到没有新数据，避免高负载时积压
+        while (drainAll() > 0) {
+        }
+    }
+}
+
+size_t TraceRecorder::drainAll() {
+    std::lock_guard<std::mutex> drain_lock(drain_mutex_);
+
+    std::vector<TraceRingBuffer*> buffers;
+    {
+        std::lock_guard<std::mutex> lock(buffers_mutex_);
+        buffers.reserve(buffers_.size());
+        for (const auto& buffer : buffers_) {
+            buffers.push_back(buffer.get());
+        }
+    }
+
+    if (writer_) {
+        std::vector<std::pair<uint64_t, std::string>> annotations;
+        {
+            std::lock_guard<std::mutex> lock(annotations_mutex_);
+            annotations.swap(pending_annotations_);
+        }
+        for (const auto& annotation : annotations) {
+            writer_->annotate(annotation.first, annotation.second);
+        }
+    }
+
+    size_t total = 0;
+    for (TraceRingBuffer* buffer : buffers) {
+        // 只有 Indexed 格式需要时间戳
+        uint64_t* timestamps = writer_ ? batch_timestamps_.get() : nullptr;
+        size_t count = buffer->drain(batch_.get(), kBatchCapacity, timestamps);
+        if (count > 0) {
+            deliver(batch_.get(), timestamps, count);
+            total += count;
+        }
+    }
+    return total;
+}
+
+void TraceRecorder::deliver(const TraceRecord* records,
+                            const uint64_t* timestamps,
+                            size_t count) {
+    if (output_file_ != nullptr) {
+        fwrite(records, sizeof(TraceRecord), count, output_file_);
+    }
+    if (writer_) {
+        // 时间戳由生产者写入缓冲区时打上，与刷新间隔无关
+        writer_->append(records, timestamps, count);
+    }
+
+    if (config_.consumer) {
+        config_.consumer(records, count);
+    }
+
+    flushed_count_.fetch_add(count, std::memory_order_relaxed);
+    batch_count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+}  // namespace Trace
+}  // namespace AnalysisToolkit
@@ -0,0 +1,206 @@
+//
+// 二进制日志：记录只保存格式串ID、级别、时间戳和原始参数字节，格式化推迟到后台线程或离线解码
+//
+// 文件是连续的记录流，每条记录为 BinaryLogRecordHeader + payload：
+//   format_id == kBinaryLogFileMagic   文件头（payload 为 "ATKBLOG" + 版本号），可出现多次
+//   format_id == kBinaryLogDefinition  格式串定义（payload 为 uint32 ID + 格式串文本）
+//   format_id == kBinaryLogText        预格式化文本（payload 为文本）
+//   其他                               参数记录（payload 为编码后的参数）
+//
+
+#ifndef ANALYSIS_TOOLKIT_BINARY_LOG_H
+#define ANALYSIS_TOOLKIT_BINARY_LOG_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <type_traits>
+
+namespace AnalysisToolkit {
+
+enum class LogLevel;
+
+constexpr uint32_t kBinaryLogText = 0;
+constexpr uint32_t kBinaryLogDefinition = 0xffffffffU;
+constexpr uint32_t kBinaryLogFileMagic = 0xfffffffeU;
+constexpr uint32_t kBinaryLogVersion = 1;
+
+// 单条记录参数区的最大字节数（与异步队列槽位大小一致）
+constexpr size_t kBinaryLogMaxPayload = 992;
+
+struct BinaryLogRecordHeader {
+    uint32_t format_id;     // 格式串ID
+    uint16_t payload_size;  // payload 字节数
+    uint8_t level;          // LogLevel
+    uint8_t reserved;
+    uint64_t timestamp;  // 纳秒（system_clock）
+};
+
+// 参数类型标记，每个参数以 1 字节标记开头
+enum class BinaryArgType : uint8_t {
+    INT64 = 1,    // 有符号整数，8 字节
+    UINT64 = 2,   // 无符号整数，8 字节
+    DOUBLE = 3,   // 浮点数，8 字节
+    POINTER = 4,  // 指针，8 字节
+    STRING = 5,   // 字符串，uint16 长度 + 字节
+};
+
+// 进程内的格式串注册表：ID 从 1 开始，只保存指针，格式串必须是静态存储期的字面量
+class BinaryLogFormats {
+  public:
+    static constexpr size_t kMaxFormats = 4096;
+
+    // 注册格式串，表满时返回 kBinaryLogText
+    static uint32_t registerFormat(const char* format);
+
+    // 查找格式串，ID 无效时返回 nullptr（无锁，任意线程调用）
+    static const char* lookup(uint32_t id);
+
+    // 已注册的格式串数量，有效 ID 为 [1, count()]
+    static uint32_t count();
+};
+
+// 扫描格式串，返回以 %s 转换的参数位置掩码（第 i 个参数对应第 i 位，最多 64 个）。
+// 解析规则与 formatBinaryLog 一致；ATKIT_BLOG 在编译期对字面量求值
+constexpr uint64_t binaryLogStringArgs(const char* format) {
+    auto is_flag = [](char c) {
+        return c == '-' || c == '+' || c == ' ' || c == '#' || c == '.' || (c >= '0' && c <= '9');
+    };
+    auto is_length = [](char c) {
+        return c == 'h' || c == 'l' || c == 'j' || c == 'z' || c == 't' || c == 'L' || c == 'q';
+    };
+
+    uint64_t mask = 0;
+    uint32_t index = 0;
+    const char* p = format;
+    while (*p != '\0') {
+        if (*p++ != '%') {
+            continue;
+        }
+        if (*p == '%') {
+            p++;
+            continue;
+        }
+        while (is_flag(*p)) {
+            p++;
+        }
+        while (is_length(*p)) {
+            p++;
+        }
+        if (*p == '\0') {
+            break;
+        }
+        if (*p++ == 's' && index < 64) {
+            mask |= 1ULL << index;
+        }
+        index++;
+    }
+    return mask;
+}
+
+// 参数编码器：把 printf 风格的参数按类型标记写入固定缓冲区，空间不足的参数被丢弃
+class BinaryLogEncoder {
+  public:
+    BinaryLogEncoder(char* buffer, size_t capacity) : buffer_(buffer), capacity_(capacity) {}
+
+    // as_string 只对 char* 有效：由格式串中的转换决定，%p 等转换只记录指针值、不读取内容
+    template <typename T>
+    void add(T value, bool as_string) {
+        using Type = std::decay_t<T>;
+        if constexpr (std::is_same_v<Type, const char*> || std::is_same_v<Type, char*>) {
+            if (as_string) {
+                addString(value);
+            } else {
+                addScalar(BinaryArgType::POINTER,
+                          static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value)));
+            }
+        } else if constexpr (std::is_pointer_v<Type> || std::is_null_pointer_v<Type>) {
+            addScalar(BinaryArgType::POINTER,
+                      static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value)));
+        } else if constexpr (std::is_floating_point_v<Type>) {
+            double number = static_cast<double>(value);
+            uint64_t bits;
+            memcpy(&bits, &number, sizeof(bits));
+            addScalar(BinaryArgType::DOUBLE, bits);
+        } else if constexpr (std::is_enum_v<Type>) {
+            add(static_cast<std::underlying_type_t<Type>>(value), false);
+        } else if constexpr (std::is_integral_v<Type> && std::is_signed_v<Type>) {
+            addScalar(BinaryArgType::INT64, static_cast<uint64_t>(static_cast<int64_t>(value)));
+        } else if constexpr (std::is_integral_v<Type>) {
+            addScalar(BinaryArgType::UINT64, static_cast<uint64_t>(value));
+        } else {
+            static_assert(std::is_arithmetic_v<Type>, "unsupported binary log argument type");
+        }
+    }
+
+    // string_args 为 binaryLogStringArgs 的结果
+    template <typename... Args>
+    void addAll(uint64_t string_args, Args... args) {
+        uint32_t index = 0;
+        ((add(args, index < 64 && (string_args >> index & 1) != 0), index++), ...);
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+  private:
+    void addScalar(BinaryArgType type, uint64_t value) {
+        if (size_ + 1 + sizeof(value) > capacity_) {
+            return;
+        }
+        buffer_[size_] = static_cast<char>(type);
+        memcpy(buffer_ + size_ + 1, &value, sizeof(value));
+        size_ += 1 + sizeof(value);
+    }
+
+    void addString(const char* value) {
+        if (value == nullptr) {
+            value = "(null)";
+        }
+        if (size_ + 1 + sizeof(uint16_t) > capacity_) {
+            return;
+        }
+        size_t length = strlen(value);
+        size_t available = capacity_ - size_ - 1 - sizeof(uint16_t);
+        length = length < available ? length : available;
+        length = length < UINT16_MAX ? length : UINT16_MAX;
+
+        uint16_t stored = static_cast<uint16_t>(length);
+        buffer_[size_] = static_cast<char>(BinaryArgType::STRING);
+        memcpy(buffer_ + size_ + 1, &stored, sizeof(stored));
+        memcpy(buffer_ + size_ + 1 + sizeof(stored), value, length);
+        size_ += 1 + sizeof(stored) + length;
+    }
+
+    char* buffer_;
+    size_t capacity_;
+    size_t size_ = 0;
+};
+
+// 按格式串展开编码后的参数，结果追加到 output
+void formatBinaryLog(const char* format, const char* args, size_t size, std::string& output);
+
+// 解码后的日志条目
+struct BinaryLogEntry {
+    LogLevel level;
+    uint64_t timestamp;  // 纳秒（system_clock）
+    std::string message;
+};
+
+// 离线解码器：顺序读取二进制日志文件，回调返回 false 时停止
+class BinaryLogReader {
+  public:
+    using EntryCallback = std::function<bool(const BinaryLogEntry& entry)>;
+
+    // 成功读完（或回调提前停止）返回 true，文件无法打开或格式错误返回 false。
+    // 遇到全零记录头（崩溃后段文件未截断的尾部）视为文件结尾
+    static bool decodeFile(const std::string& path, const EntryCallback& callback);
+};
+
+}  // namespace AnalysisToolkit
+
+#endif
@@ -2,32 +2,137 @@
 #define ANALYSIS_TOOLKIT_LOGGER_H
 
 #include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
+
+#include "utility/BinaryLog.h"
 
 #ifdef __ANDROID__
 #include <android/log.h>
 #endif
 
+// 编译期最低日志级别（对应 LogLevel 的数值），低于该级别的 ATKIT_* 语句不会生成代码
+#ifndef ATKIT_MIN_LOG_LEVEL
+#define ATKIT_MIN_LOG_LEVEL 0
+#endif
+
 namespace AnalysisToolkit {
 enum class LogLevel { TRACE = 0, DEBUG = 1, INFO = 2, WARN = 3, ERROR = 4, FATAL = 5 };
 
+// 异步队列满时的处理策略
+enum class LogOverflowPolicy {
+    BLOCK,           // 等待后台线程腾出空间
+    DROP,            // 丢弃新记录，只计数
+    DROP_AND_REPORT  // 丢弃新记录，并由后台线程输出丢弃数量
+};
+
+// 日志文件格式
+enum class LogFormat {
+    TEXT,   // 每条记录格式化为一行文本
+    BINARY  // 只保存格式串ID和参数字节，用 BinaryLogReader 解码
+};
+
+// 异步日志配置
+struct AsyncLogConfig {
+    size_t queue_capacity = 4096;  // 队列槽位数（向上取 2 的幂）
+    LogOverflowPolicy overflow_policy = LogOverflowPolicy::DROP_AND_REPORT;
+    uint32_t flush_interval_ms = 20;  // 后台线程最长等待时间
+    size_t batch_bytes = 64 * 1024;   // 单次写出的缓冲大小
+};
+
+// 映射文件轮转配置
+struct LogRotationConfig {
+    size_t max_file_bytes = 8 * 1024 * 1024;  // 单个文件（映射段）大小，最小 256 KB
+    size_t max_files = 4;                     // 保留的文件数（含当前文件）
+};
+
+class LogQueue;
+struct LogRecord;
+class MappedLogFile;
+
 class Logger {
   private:
     static std::unique_ptr<Logger> instance_;
+    static std::atomic<Logger*> instance_ptr_;
     static std::mutex instance_mutex_;
     mutable std::mutex file_mutex_;
     mutable std::ofstream file_stream_;
+    std::unique_ptr<MappedLogFile> mapped_file_;
     std::atomic<bool> file_enabled_{false};
     std::atomic<bool> console_enabled_{true};
     std::atomic<LogLevel> min_level_{LogLevel::DEBUG};
     std::string log_file_path_;
     std::string tag_;
 
+    // 异步模式：生产者写入无锁队列，后台线程批量输出
+    std::atomic<bool> async_enabled_{false};
+    AsyncLogConfig async_config_;
+    std::unique_ptr<LogQueue> queue_;
+    std::thread writer_thread_;
+    mutable std::mutex writer_mutex_;
+    mutable std::condition_variable writer_cv_;
+    mutable std::condition_variable flushed_cv_;
+    mutable std::atomic<uint64_t> flush_target_{0};
+    bool writer_stop_ = false;
+    mutable bool queue_full_ = false;  // 生产者请求立即排空，受 writer_mutex_ 保护
+    uint64_t written_count_ = 0;       // 已写出的记录数，受 writer_mutex_ 保护
+    mutable std::atomic<uint64_t> dropped_count_{0};
+    uint64_t reported_drops_ = 0;
+
+    // 二进制模式：格式串定义在第一次写出引用它的记录前追加到文件
+    std::atomic<LogFormat> log_format_{LogFormat::TEXT};
+    mutable bool binary_header_written_ = false;  // 受 file_mutex_ 保护
+    mutable uint32_t binary_formats_written_ = 0;  // 已写出定义的格式串数量，受 file_mutex_ 保护
+    bool file_batch_binary_ = false;               // 当前文件批次含二进制记录，仅后台线程访问
+    uint32_t batch_max_format_ = 0;                // 当前文件批次引用的最大格式串ID，仅后台线程访问
+
+    // 线程私有的格式化缓冲区，常见长度下不分配堆内存
+    struct FormatBuffer {
+        char inline_storage[1024];
+        std::unique_ptr<char[]> heap_storage;
+        char* data = inline_storage;
+        size_t capacity = sizeof(inline_storage);
+        uint32_t thread_id = 0;  // 缓存的线程ID
+
+        void reserve(size_t size);
+    };
+
+    static FormatBuffer& threadFormatBuffer();
+    static uint32_t currentThreadId();
+    static uint64_t monotonicTimestamp();
+
     void writeLog(LogLevel level, const std::string& message) const;
+    void writeLog(LogLevel level, const char* message, size_t length) const;
+    void writeBinary(LogLevel level, uint32_t format_id, const char* payload, size_t size) const;
+    void writeDirect(LogLevel level,
+                     const char* message,
+                     size_t length,
+                     uint32_t format_id = kBinaryLogText) const;
+    void appendFileLine(std::string& output,
+                        LogLevel level,
+                        uint64_t timestamp,
+                        uint32_t thread_id,
+                        const char* message,
+                        size_t length) const;
+    void writeFileLocked(const char* data, size_t size, bool binary, uint32_t max_format_id) const;
+    void appendBinaryPreambleLocked(std::string& preamble, uint32_t max_format_id) const;
+    void closeFileLocked();
+    void enqueueLog(LogLevel level,
+                    const char* message,
+                    size_t length,
+                    uint32_t format_id = kBinaryLogText) const;
+    void writerLoop();
+    size_t drainQueue(std::string& console_batch, std::string& file_batch);
+    void writeBatches(std::string& console_batch, std::string& file_batch);
     const char* getLevelString(LogLevel level) const;
+    static uint64_t binaryTimestamp();
 
   public:
     static Logger* getInstance();
@@ -36,7 +141,8 @@ class Logger {
     bool initialize(const std::string& tag = "AnalysisToolkit",
                     const std::string& file_path = "",
                     LogLevel min_level = LogLevel::DEBUG,
-                    bool console_enabled = true);
+                    bool console_enabled = true,
+                    LogFormat format = LogFormat::TEXT);
 
     void setTag(const std::string& tag);
     void setMinLevel(LogLevel level);
@@ -44,6 +150,17 @@ class Logger {
     void enableFile(bool enabled);
     bool setLogFile(const std::string& file_path);
 
+    // 使用预分配的 mmap 段写文件，写满后轮转为 file_path.1 ... file_path.(N-1)
+    bool setRotatingLogFile(const std::string& file_path,
+                            const LogRotationConfig& config = LogRotationConfig());
+
+    // 切换文件格式；二进制模式会同时启用异步模式，使调用方只做参数拷贝
+    void setLogFormat(LogFormat format);
+
+    LogFormat getLogFormat() const {
+        return log_format_.load();
+    }
+
     void trace(const std::string& message) const;
     void debug(const std::string& message) const;
     void info(const std::string& message) const;
@@ -52,41 +169,112 @@ class Logger {
     void fatal(const std::string& message) const;
 
     template <typename... Args>
-    void info(const std::string& format, Args... args) const {
-        if (min_level_.load() <= LogLevel::INFO) {
-            char buffer[1024];
-            snprintf(buffer, sizeof(buffer), format.c_str(), args...);
-            writeLog(LogLevel::INFO, std::string(buffer));
-        }
+    void trace(const char* format, Args... args) const {
+        log(LogLevel::TRACE, format, args...);
     }
 
     template <typename... Args>
-    void debug(const std::string& format, Args... args) const {
-        if (min_level_.load() <= LogLevel::DEBUG) {
-            char buffer[1024];
-            snprintf(buffer, sizeof(buffer), format.c_str(), args...);
-            writeLog(LogLevel::DEBUG, std::string(buffer));
-        }
+    void debug(const char* format, Args... args) const {
+        log(LogLevel::DEBUG, format, args...);
+    }
+
+    template <typename... Args>
+    void info(const char* format, Args... args) const {
+        log(LogLevel::INFO, format, args...);
     }
 
     template <typename... Args>
-    void warn(const std::string& format, Args... args) const {
-        if (min_level_.load() <= LogLevel::WARN) {
-            char buffer[1024];
-            snprintf(buffer, sizeof(buffer), format.c_str(), args...);
-            writeLog(LogLevel::WARN, std::string(buffer));
+    void warn(const char* format, Args... args) const {
+        log(LogLevel::WARN, format, args...);
+    }
+
+    template <typename... Args>
+    void error(const char* format, Args... args) const {
+        log(LogLevel::ERROR, format, args...);
+    }
+
+    template <typename... Args>
+    void fatal(const char* format, Args... args) const {
+        log(LogLevel::FATAL, format, args...);
+    }
+
+    // 格式化到线程私有缓冲区后输出；没有参数时 format 按原文输出
+    template <typename... Args>
+    void log(LogLevel level, const char* format, Args... args) const {
+        if (!isEnabled(level)) {
+            return;
+        }
+
+        if constexpr (sizeof...(Args) == 0) {
+            writeLog(level, format, strlen(format));
+        } else {
+            FormatBuffer& buffer = threadFormatBuffer();
+            int length = snprintf(buffer.data, buffer.capacity, format, args...);
+            if (length < 0) {
+                return;
+            }
+            // 超长消息：扩容后重新格式化，只在首次出现时分配
+            if (static_cast<size_t>(length) >= buffer.capacity) {
+                buffer.reserve(static_cast<size_t>(length) + 1);
+                snprintf(buffer.data, buffer.capacity, format, args...);
+            }
+            writeLog(level, buffer.data, static_cast<size_t>(length));
         }
     }
 
     template <typename... Args>
-    void error(const std::string& format, Args... args) const {
-        if (min_level_.load() <= LogLevel::ERROR) {
-            char buffer[1024];
-            snprintf(buffer, sizeof(buffer), format.c_str(), args...);
-            writeLog(LogLevel::ERROR, std::string(buffer));
+    void log(LogLevel level, const std::string& format, Args... args) const {
+        log(level, format.c_str(), args...);
+    }
+
+    // 二进制记录：调用方只拷贝参数字节，格式化推迟到后台线程或离线解码
+    // format 必须与 format_id 对应（通常通过 ATKIT_BLOG_* 宏调用），文本模式下直接格式化；
+    // string_args 为 binaryLogStringArgs(format)，只有 %s 对应的 char* 参数按字符串拷贝
+    template <typename... Args>
+    void logBinary(LogLevel level,
+                   uint32_t format_id,
+                   uint64_t string_args,
+                   const char* format,
+                   Args... args) const {
+        if (!isEnabled(level)) {
+            return;
         }
+        if (format_id == kBinaryLogText ||
+            log_format_.load(std::memory_order_relaxed) != LogFormat::BINARY) {
+            log(level, format, args...);
+            return;
+        }
+
+        char payload[kBinaryLogMaxPayload];
+        uint64_t timestamp = binaryTimestamp();
+        memcpy(payload, &timestamp, sizeof(timestamp));
+        BinaryLogEncoder encoder(payload + sizeof(timestamp), sizeof(payload) - sizeof(timestamp));
+        encoder.addAll(string_args, args...);
+        writeBinary(level, format_id, payload, sizeof(timestamp) + encoder.size());
+    }
+
+    // 级别检查：编译期阈值 + 运行期阈值
+    bool isEnabled(LogLevel level) const {
+        return static_cast<int>(level) >= ATKIT_MIN_LOG_LEVEL &&
+               level >= min_level_.load(std::memory_order_relaxed);
     }
 
+    // 启用异步模式：调用线程只做格式化和入队
+    bool enableAsync(const AsyncLogConfig& config = AsyncLogConfig());
+
+    // 关闭异步模式，先写出队列中的所有记录
+    void disableAsync();
+
+    bool isAsync() const {
+        return async_enabled_.load();
+    }
+
+    // 因队列满而丢弃的记录数
+    uint64_t getDroppedCount() const {
+        return dropped_count_.load();
+    }
+
+    // 屏障：等待此前入队的记录全部写出，并刷新文件
     void flush();
     bool isConsoleEnabled() const {
         return console_enabled_.load();
@@ -102,12 +290,46 @@ class Logger {
     }
 };
 
-#define ATKIT_TRACE(msg) AnalysisToolkit::Logger::getInstance()->trace(msg)
-#define ATKIT_DEBUG(...) AnalysisToolkit::Logger::getInstance()->debug(__VA_ARGS__)
-#define ATKIT_INFO(...) AnalysisToolkit::Logger::getInstance()->info(__VA_ARGS__)
-#define ATKIT_WARN(...) AnalysisToolkit::Logger::getInstance()->warn(__VA_ARGS__)
-#define ATKIT_ERROR(...) AnalysisToolkit::Logger::getInstance()->error(__VA_ARGS__)
-#define ATKIT_FATAL(msg) AnalysisToolkit::Logger::getInstance()->fatal(msg)
+// 先检查级别再求值参数；低于 ATKIT_MIN_LOG_LEVEL 的语句在编译期被丢弃
+#define ATKIT_LOG(level, ...)                                                            \
+    do {                                                                                 \
+        if constexpr (static_cast<int>(level) >= ATKIT_MIN_LOG_LEVEL) {                  \
+            AnalysisToolkit::Logger* atkit_logger = AnalysisToolkit::Logger::getInstance(); \
+            if (atkit_logger->isEnabled(level)) {                                        \
+                atkit_logger->log(level, __VA_ARGS__);                                   \
+            }                                                                            \
+        }                                                                                \
+    } while (0)
+
+#define ATKIT_TRACE(...) ATKIT_LOG(AnalysisToolkit::LogLevel::TRACE, __VA_ARGS__)
+#define ATKIT_DEBUG(...) ATKIT_LOG(AnalysisToolkit::LogLevel::DEBUG, __VA_ARGS__)
+#define ATKIT_INFO(...) ATKIT_LOG(AnalysisToolkit::LogLevel::INFO, __VA_ARGS__)
+#define ATKIT_WARN(...) ATKIT_LOG(AnalysisToolkit::LogLevel::WARN, __VA_ARGS__)
+#define ATKIT_ERROR(...) ATKIT_LOG(AnalysisToolkit::LogLevel::ERROR, __VA_ARGS__)
+#define ATKIT_FATAL(...) ATKIT_LOG(AnalysisToolkit::LogLevel::FATAL, __VA_ARGS__)
+
+// 二进制日志宏：format 必须是字符串字面量，每个调用点只注册一次格式串，
+// 哪些参数按字符串编码在编译期由格式串决定
+#define ATKIT_BLOG(level, format, ...)                                                      \
+    do {                                                                                    \
+        if constexpr (static_cast<int>(level) >= ATKIT_MIN_LOG_LEVEL) {                     \
+            AnalysisToolkit::Logger* atkit_logger = AnalysisToolkit::Logger::getInstance(); \
+            if (atkit_logger->isEnabled(level)) {                                           \
+                static constexpr uint64_t atkit_string_args =                               \
+                    AnalysisToolkit::binaryLogStringArgs(format);                           \
+                static const uint32_t atkit_format_id =                                     \
+                    AnalysisToolkit::BinaryLogFormats::registerFormat(format);              \
+                atkit_logger->logBinary(                                                    \
+                    level, atkit_format_id, atkit_string_args, format, ##__VA_ARGS__);      \
+            }                                                                               \
+        }                                                                                   \
+    } while (0)
+
+#define ATKIT_BLOG_TRACE(...) ATKIT_BLOG(AnalysisToolkit::LogLevel::TRACE, __VA_ARGS__)
+#define ATKIT_BLOG_DEBUG(...) ATKIT_BLOG(AnalysisToolkit::LogLevel::DEBUG, __VA_ARGS__)
+#define ATKIT_BLOG_INFO(...) ATKIT_BLOG(AnalysisToolkit::LogLevel::INFO, __VA_ARGS__)
+#define ATKIT_BLOG_WARN(...) ATKIT_BLOG(AnalysisToolkit::LogLevel::WARN, __VA_ARGS__)
+#define ATKIT_BLOG_ERROR(...) ATKIT_BLOG(AnalysisToolkit::LogLevel::ERROR, __VA_ARGS__)
 }  // namespace AnalysisToolkit
 
 #endif
@@ -0,0 +1,124 @@
+/**
+ * @file MemoryMapSnapshot.h
+ * @brief Immutable, indexed view of a process memory map
+ * @author AnalysisToolkit
+ * @date 2024
+ *
+ * A snapshot is built from a single parse of the maps file. Regions are kept
+ * in a sorted interval array so that address lookups are a binary search,
+ * and regions are additionally indexed by pathname. Use one
+ * snapshot for a burst of queries (symbolizing a trace, validating a batch
+ * of hook targets) instead of calling the ProcessMemoryParser find* methods
+ * repeatedly, each of which re-reads the maps file.
+ */
+
+#ifndef ANALYSIS_TOOLKIT_MEMORY_MAP_SNAPSHOT_H
+#define ANALYSIS_TOOLKIT_MEMORY_MAP_SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "utility/ProcessMemoryParser.h"
+
+namespace AnalysisToolkit {
+
+/**
+ * @brief Sorted, read-only copy of a process memory map
+ *
+ * A snapshot never changes after construction, so it can be shared between
+ * threads without locking. It does not track later mmap/munmap calls.
+ */
+class MemoryMapSnapshot {
+  public:
+    /**
+     * @brief Create an empty snapshot
+     */
+    MemoryMapSnapshot() = default;
+
+    /**
+     * @brief Build a snapshot from parsed regions
+     * @param regions Regions as returned by ProcessMemoryParser; sorted if needed
+     */
+    explicit MemoryMapSnapshot(std::vector<MemoryRegion> regions);
+
+    /**
+     * @brief Parse a process once and build a snapshot
+     * @param parser Parser to use; its region filter applies
+     * @param pid Process ID (use -1 for current process)
+     */
+    static ProcessMemoryParser::Result<MemoryMapSnapshot> capture(ProcessMemoryParser& parser,
+                                                                  int pid = -1);
+
+    /**
+     * @brief Parse the current process with a default parser
+     */
+    static ProcessMemoryParser::Result<MemoryMapSnapshot> captureSelf();
+
+    /**
+     * @brief Find the region containing an address
+     * @return The region, or nullptr if the address is not mapped
+     */
+    const MemoryRegion* find(uintptr_t address) const;
+
+    /**
+     * @brief Look up many addresses at once
+     * @param addresses Addresses to resolve; sorted input is resolved in a
+     *        single merge pass, unsorted input falls back to one binary
+     *        search per address
+     * @return One entry per address, nullptr for unmapped addresses
+     */
+    std::vector<const MemoryRegion*> findBatch(const std::vector<uintptr_t>& addresses) const;
+
+    /**
+     * @brief Check that [address, address + size) is mapped contiguously
+     * @param required Permissions every covering region must have
+     */
+    bool containsRange(uintptr_t address,
+                       size_t size,
+                       const MemoryPermissions& required = MemoryPermissions()) const;
+
+    /**
+     * @brief Find regions by pathname
+     * @param pathname Path to look for; the empty path selects anonymous regions
+     * @param exact_match Whether the path must match exactly; otherwise any
+     *        path containing @p pathname matches
+     * @return Matching regions in address order
+     */
+    std::vector<const MemoryRegion*> findByPath(const std::string& pathname,
+                                                bool exact_match = true) const;
+
+    /**
+     * @brief Find regions that have at least the given permissions
+     */
+    std::vector<const MemoryRegion*> findByPermissions(const MemoryPermissions& permissions) const;
+
+    /**
+     * @brief All regions in address order
+     */
+    const std::vector<MemoryRegion>& getRegions() const {
+        return regions_;
+    }
+
+    size_t size() const {
+        return regions_.size();
+    }
+    bool empty() const {
+        return regions_.empty();
+    }
+
+  private:
+    // Index of the last region starting at or below address, or size_t(-1)
+    size_t lowerIndex(uintptr_t address) const;
+    std::vector<const MemoryRegion*> collect(const std::vector<size_t>& indices) const;
+
+    std::vector<MemoryRegion> regions_;
+    std::vector<uintptr_t> starts_;  // regions_[i].getStartAddress(), kept dense for searching
+    std::unordered_map<std::string, std::vector<size_t>> path_index_;
+};
+
+}  // namespace AnalysisToolkit
+
+#endif  // ANALYSIS_TOOLKIT_MEMORY_MAP_SNAPSHOT_H
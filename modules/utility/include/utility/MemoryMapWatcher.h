@@ -0,0 +1,110 @@
+/**
+ * @file MemoryMapWatcher.h
+ * @brief Incremental memory map refresh with change detection
+ * @author AnalysisToolkit
+ * @date 2024
+ *
+ * Tracks the memory map of a process across polls and reports what changed
+ * since the previous poll. Each poll reads the raw maps text and compares
+ * its size and checksum with the previous read; only when they differ is
+ * the text parsed into a new MemoryMapSnapshot and diffed against the old
+ * one. Polling an unchanged process therefore costs one read() and a hash.
+ */
+
+#ifndef ANALYSIS_TOOLKIT_MEMORY_MAP_WATCHER_H
+#define ANALYSIS_TOOLKIT_MEMORY_MAP_WATCHER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "utility/MemoryMapSnapshot.h"
+#include "utility/ProcessMemoryParser.h"
+
+namespace AnalysisToolkit {
+
+/**
+ * @brief Changes between two memory map snapshots
+ *
+ * Regions are matched by address range and backing (offset, device, inode
+ * and pathname). A region whose permissions alone changed is reported in
+ * permission_changed; any other difference, including a split or merge
+ * caused by a partial mprotect/munmap, is reported as removed plus added.
+ */
+struct MemoryMapDiff {
+    struct PermissionChange {
+        MemoryRegion before;
+        MemoryRegion after;
+    };
+
+    std::vector<MemoryRegion> added;    ///< Regions only in the newer snapshot
+    std::vector<MemoryRegion> removed;  ///< Regions only in the older snapshot
+    std::vector<PermissionChange> permission_changed;
+
+    bool empty() const {
+        return added.empty() && removed.empty() && permission_changed.empty();
+    }
+};
+
+/**
+ * @brief Polls a process memory map and reports minimal diffs
+ *
+ * All methods are thread-safe.
+ */
+class MemoryMapWatcher {
+  public:
+    /**
+     * @param pid Process ID (use -1 for current process)
+     */
+    explicit MemoryMapWatcher(int pid = -1);
+
+    MemoryMapWatcher(const MemoryMapWatcher&) = delete;
+    MemoryMapWatcher& operator=(const MemoryMapWatcher&) = delete;
+
+    /**
+     * @brief Re-read the memory map if it changed
+     * @return Changes since the previous poll; empty if nothing changed. The
+     *         first poll reports every region as added.
+     */
+    ProcessMemoryParser::Result<MemoryMapDiff> poll();
+
+    /**
+     * @brief Snapshot taken by the most recent poll that saw a change
+     * @return nullptr before the first successful poll
+     */
+    std::shared_ptr<const MemoryMapSnapshot> getSnapshot() const;
+
+    /**
+     * @brief Restrict the watched regions; the next poll re-parses
+     */
+    void setRegionFilter(std::function<bool(const MemoryRegion&)> filter);
+
+    /**
+     * @brief Number of polls that parsed the maps text
+     */
+    uint64_t getParseCount() const;
+
+    /**
+     * @brief Compute the changes from one snapshot to another
+     */
+    static MemoryMapDiff diff(const MemoryMapSnapshot& before, const MemoryMapSnapshot& after);
+
+  private:
+    mutable std::mutex mutex_;
+    ProcessMemoryParser parser_;
+    int pid_;
+    std::shared_ptr<const MemoryMapSnapshot> snapshot_;
+
+    // Size and checksum of the maps text behind snapshot_
+    size_t text_size_ = 0;
+    uint64_t text_checksum_ = 0;
+    bool valid_ = false;
+    uint64_t parse_count_ = 0;
+};
+
+}  // namespace AnalysisToolkit
+
+#endif  // ANALYSIS_TOOLKIT_MEMORY_MAP_WATCHER_H
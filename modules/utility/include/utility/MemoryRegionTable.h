@@ -0,0 +1,263 @@
+/**
+ * @file MemoryRegionTable.h
+ * @brief Compact, column-oriented storage for a process memory map
+ * @author AnalysisToolkit
+ * @date 2024
+ *
+ * A MemoryRegion owns its device and pathname strings, and a large process
+ * maps the same library or heap name dozens of times, so a vector of regions
+ * is mostly duplicated string data. MemoryRegionTable keeps each field in its
+ * own array (start, end, offset, inode, permission bits) and stores every
+ * distinct pathname and device once in a StringPool, referenced by ID. It is
+ * built straight from the parser's in-place views, without allocating per
+ * region, and queries return region indices instead of copies.
+ */
+
+#ifndef ANALYSIS_TOOLKIT_MEMORY_REGION_TABLE_H
+#define ANALYSIS_TOOLKIT_MEMORY_REGION_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "utility/ProcessMemoryParser.h"
+
+namespace AnalysisToolkit {
+
+/**
+ * @brief Append-only set of interned strings
+ *
+ * All characters are kept in one buffer; lookups go through an open
+ * addressing table of IDs, so copying a pool is a plain member copy.
+ */
+class StringPool {
+  public:
+    using Id = uint32_t;
+
+    /// ID of the empty string, which every pool contains
+    static constexpr Id kEmpty = 0;
+
+    StringPool();
+
+    /**
+     * @brief Get the ID of a string, adding it if needed
+     */
+    Id intern(std::string_view text);
+
+    /**
+     * @brief Get the ID of a string without adding it
+     */
+    std::optional<Id> find(std::string_view text) const;
+
+    /**
+     * @brief Text of an ID; valid until the next intern()
+     */
+    std::string_view get(Id id) const {
+        return std::string_view(chars_.data() + offsets_[id], offsets_[id + 1] - offsets_[id]);
+    }
+
+    /**
+     * @brief Number of distinct strings, including the empty string
+     */
+    size_t size() const {
+        return offsets_.size() - 1;
+    }
+
+    /**
+     * @brief Approximate heap usage in bytes
+     */
+    size_t memoryUsage() const;
+
+  private:
+    size_t slotFor(std::string_view text, size_t hash) const;
+    void grow();
+
+    std::string chars_;
+    std::vector<uint32_t> offsets_;  // string i is chars_[offsets_[i], offsets_[i + 1])
+    std::vector<Id> slots_;          // hash table of IDs, kNoSlot when free
+};
+
+/**
+ * @brief Read-only memory map stored as a structure of arrays
+ *
+ * Regions are kept in address order and addressed by index. A table never
+ * changes after construction, so it can be shared between threads without
+ * locking. Use getRegion() or toRegions() to get owning MemoryRegion copies
+ * for the results you keep.
+ */
+class MemoryRegionTable {
+  public:
+    /// Returned by find() for unmapped addresses
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    /**
+     * @brief Lightweight handle to one region of a table
+     *
+     * Only valid while the table it came from is alive.
+     */
+    class RegionRef {
+      public:
+        RegionRef(const MemoryRegionTable& table, size_t index) : table_(&table), index_(index) {}
+
+        size_t index() const {
+            return index_;
+        }
+        uintptr_t getStartAddress() const {
+            return table_->starts_[index_];
+        }
+        uintptr_t getEndAddress() const {
+            return table_->ends_[index_];
+        }
+        size_t getSize() const {
+            return getEndAddress() - getStartAddress();
+        }
+        MemoryPermissions getPermissions() const {
+            return table_->getPermissions(index_);
+        }
+        uint64_t getOffset() const {
+            return table_->offsets_[index_];
+        }
+        uint32_t getInode() const {
+            return table_->inodes_[index_];
+        }
+        std::string_view getDevice() const {
+            return table_->strings_.get(table_->device_ids_[index_]);
+        }
+        std::string_view getPathname() const {
+            return table_->strings_.get(table_->path_ids_[index_]);
+        }
+        StringPool::Id getPathId() const {
+            return table_->path_ids_[index_];
+        }
+        bool contains(uintptr_t address) const {
+            return address >= getStartAddress() && address < getEndAddress();
+        }
+
+        /**
+         * @brief Copy into an owning MemoryRegion
+         */
+        MemoryRegion toRegion() const;
+
+      private:
+        const MemoryRegionTable* table_;
+        size_t index_;
+    };
+
+    /**
+     * @brief Create an empty table
+     */
+    MemoryRegionTable() = default;
+
+    /**
+     * @brief Build a table from parsed regions
+     * @param regions Regions in any order; the table is sorted by start address
+     */
+    explicit MemoryRegionTable(const std::vector<MemoryRegion>& regions);
+
+    /**
+     * @brief Parse a process once and build a table from the in-place views
+     * @param parser Parser to use; its region filters apply. Only a view filter
+     *        (setRegionViewFilter()) keeps the capture free of per-region copies
+     * @param pid Process ID (use -1 for current process)
+     */
+    static ProcessMemoryParser::Result<MemoryRegionTable> capture(ProcessMemoryParser& parser,
+                                                                  int pid = -1);
+
+    size_t size() const {
+        return starts_.size();
+    }
+    bool empty() const {
+        return starts_.empty();
+    }
+
+    RegionRef operator[](size_t index) const {
+        return RegionRef(*this, index);
+    }
+
+    /**
+     * @brief Index of the region containing an address, or npos
+     */
+    size_t find(uintptr_t address) const;
+
+    /**
+     * @brief Indices of the regions with a pathname
+     * @param pathname Path to look for; the empty path selects anonymous regions
+     * @param exact_match Whether the path must match exactly; otherwise any
+     *        path containing @p pathname matches
+     * @return Indices in address order
+     */
+    std::vector<size_t> findByPath(std::string_view pathname, bool exact_match = true) const;
+
+    /**
+     * @brief Indices of the regions that have at least the given permissions
+     */
+    std::vector<size_t> findByPermissions(const MemoryPermissions& permissions) const;
+
+    /**
+     * @brief Copy one region into an owning MemoryRegion
+     */
+    MemoryRegion getRegion(size_t index) const {
+        return (*this)[index].toRegion();
+    }
+
+    /**
+     * @brief Copy the given regions, e.g. a query result
+     */
+    std::vector<MemoryRegion> toRegions(const std::vector<size_t>& indices) const;
+
+    /**
+     * @brief Copy every region
+     */
+    std::vector<MemoryRegion> toRegions() const;
+
+    MemoryPermissions getPermissions(size_t index) const;
+
+    /**
+     * @brief Start addresses in order, for scanning without RegionRef
+     */
+    const std::vector<uintptr_t>& getStartAddresses() const {
+        return starts_;
+    }
+    const std::vector<uintptr_t>& getEndAddresses() const {
+        return ends_;
+    }
+
+    /**
+     * @brief Pool holding the interned pathnames and devices
+     */
+    const StringPool& getStrings() const {
+        return strings_;
+    }
+
+    /**
+     * @brief Approximate heap usage in bytes
+     */
+    size_t memoryUsage() const;
+
+  private:
+    void reserve(size_t count);
+    void append(uintptr_t start,
+                uintptr_t end,
+                const MemoryPermissions& permissions,
+                uint64_t offset,
+                std::string_view device,
+                uint32_t inode,
+                std::string_view pathname);
+    void sortByStart();
+
+    std::vector<uintptr_t> starts_;
+    std::vector<uintptr_t> ends_;
+    std::vector<uint64_t> offsets_;
+    std::vector<uint32_t> inodes_;
+    std::vector<StringPool::Id> path_ids_;
+    std::vector<StringPool::Id> device_ids_;
+    std::vector<uint8_t> permission_bits_;
+    StringPool strings_;
+};
+
+}  // namespace AnalysisToolkit
+
+#endif  // ANALYSIS_TOOLKIT_MEMORY_REGION_TABLE_H
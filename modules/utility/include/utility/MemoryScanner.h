@@ -0,0 +1,204 @@
+/**
+ * @file MemoryScanner.h
+ * @brief Parallel byte-pattern scanner over memory regions
+ * @author AnalysisToolkit
+ * @date 2024
+ *
+ * Scans readable regions of the current process (or, through a
+ * RemoteMemoryReader, of another one) for byte signatures with
+ * wildcards, e.g. function prologues or crypto constants. All patterns are
+ * matched in a single pass: each pattern is anchored on one fully specified
+ * byte, candidate positions are found with a SIMD compare against every
+ * distinct anchor byte (SSE2 on x86_64, NEON on arm64), and only candidates
+ * are verified against the full pattern. Regions are split into chunks that
+ * are processed by a pool of worker threads owned by the scanner.
+ */
+
+#ifndef ANALYSIS_TOOLKIT_MEMORY_SCANNER_H
+#define ANALYSIS_TOOLKIT_MEMORY_SCANNER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "utility/ProcessMemoryParser.h"
+
+namespace AnalysisToolkit {
+
+class RemoteMemoryReader;
+
+/**
+ * @brief A byte signature with per-nibble wildcards
+ */
+class BytePattern {
+  public:
+    /**
+     * @brief Parse a signature such as "55 48 89 e5 ?? ?? 8b 4?"
+     * @return The pattern, or std::nullopt if the text is malformed or has
+     *         no fully specified byte
+     *
+     * Tokens are separated by whitespace. "??" or "?" matches any byte and a
+     * "?" in one nibble ("4?", "?f") matches any value of that nibble.
+     */
+    static std::optional<BytePattern> parse(const std::string& signature);
+
+    /**
+     * @brief Build a pattern from bytes and a mask
+     * @param mask Bits set in the mask must match; must be the same size as
+     *        bytes. An empty mask matches every byte exactly.
+     * @return The pattern, or std::nullopt if no byte is fully specified
+     */
+    static std::optional<BytePattern> fromBytes(const std::vector<uint8_t>& bytes,
+                                                const std::vector<uint8_t>& mask = {});
+
+    size_t size() const {
+        return bytes_.size();
+    }
+    const std::vector<uint8_t>& getBytes() const {
+        return bytes_;
+    }
+    const std::vector<uint8_t>& getMask() const {
+        return mask_;
+    }
+
+    /**
+     * @brief Check the pattern against size() bytes at data
+     */
+    bool matches(const uint8_t* data) const;
+
+  private:
+    BytePattern() = default;
+
+    std::vector<uint8_t> bytes_;  // already masked
+    std::vector<uint8_t> mask_;
+};
+
+/**
+ * @brief A pattern occurrence reported by MemoryScanner
+ */
+struct ScanMatch {
+    size_t pattern_index = 0;              ///< Index returned by addPattern()
+    uintptr_t address = 0;                 ///< Address of the first pattern byte
+    const MemoryRegion* region = nullptr;  ///< Region containing the match
+};
+
+/**
+ * @brief Multi-pattern, multi-threaded memory scanner
+ *
+ * Local scans read the memory of the current process directly. Unreadable
+ * regions and the kernel's [vvar] pages are skipped; other regions are
+ * assumed to be safe to read in full (a file mapping that extends past the
+ * end of its file raises SIGBUS when read). Scans through a
+ * RemoteMemoryReader copy each chunk out of the target first, and skip
+ * chunks that cannot be read.
+ *
+ * All methods are thread-safe; concurrent scans on the same scanner are
+ * serialized.
+ */
+class MemoryScanner {
+  public:
+    /**
+     * @brief Called for every match; return false to stop the scan
+     *
+     * Calls are serialized, but come from worker threads and arrive in no
+     * particular order.
+     */
+    using MatchCallback = std::function<bool(const ScanMatch&)>;
+
+    /**
+     * @param thread_count Threads used per scan, including the calling
+     *        thread; 0 selects std::thread::hardware_concurrency()
+     */
+    explicit MemoryScanner(size_t thread_count = 0);
+    ~MemoryScanner();
+
+    MemoryScanner(const MemoryScanner&) = delete;
+    MemoryScanner& operator=(const MemoryScanner&) = delete;
+
+    /**
+     * @brief Add a pattern
+     * @return Index reported in ScanMatch::pattern_index
+     */
+    size_t addPattern(const BytePattern& pattern);
+
+    /**
+     * @brief Parse and add a signature
+     * @return Pattern index, or std::nullopt if the signature is malformed
+     */
+    std::optional<size_t> addPattern(const std::string& signature);
+
+    void clearPatterns();
+
+    size_t getPatternCount() const;
+
+    size_t getThreadCount() const {
+        return workers_.size() + 1;
+    }
+
+    /**
+     * @brief Scan regions for all patterns
+     * @param regions Regions of the current process, e.g. from ProcessMemoryParser
+     * @param callback Receives each match
+     * @return Number of matches delivered to the callback
+     */
+    size_t scan(const std::vector<MemoryRegion>& regions, const MatchCallback& callback);
+
+    /**
+     * @brief Parse the current process and scan every readable region
+     * @param parser Parser whose region filter selects what to scan
+     * @return Number of matches delivered to the callback, or the parse error
+     */
+    ProcessMemoryParser::Result<size_t> scanProcess(ProcessMemoryParser& parser,
+                                                    const MatchCallback& callback);
+
+    /**
+     * @brief Scan regions of another process
+     * @param reader Reader for the target; regions must describe its memory
+     * @return Number of matches delivered to the callback; addresses are in
+     *         the target's address space
+     */
+    size_t scan(RemoteMemoryReader& reader,
+                const std::vector<MemoryRegion>& regions,
+                const MatchCallback& callback);
+
+    /**
+     * @brief Parse the reader's target process and scan every readable region
+     */
+    ProcessMemoryParser::Result<size_t> scanProcess(RemoteMemoryReader& reader,
+                                                    ProcessMemoryParser& parser,
+                                                    const MatchCallback& callback);
+
+  private:
+    struct ScanJob;
+
+    size_t runScan(RemoteMemoryReader* reader,
+                   const std::vector<MemoryRegion>& regions,
+                   const MatchCallback& callback);
+    void workerLoop();
+    void runJob(ScanJob& job);
+
+    // Guards patterns_ and serializes scans
+    mutable std::mutex scan_mutex_;
+    std::vector<BytePattern> patterns_;
+
+    // Workers pick up job_ when generation_ changes
+    std::mutex pool_mutex_;
+    std::condition_variable job_ready_;
+    std::condition_variable job_done_;
+    ScanJob* job_ = nullptr;
+    uint64_t generation_ = 0;
+    size_t busy_workers_ = 0;
+    bool shutdown_ = false;
+    std::vector<std::thread> workers_;
+};
+
+}  // namespace AnalysisToolkit
+
+#endif  // ANALYSIS_TOOLKIT_MEMORY_SCANNER_H
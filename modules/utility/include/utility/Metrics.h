@@ -0,0 +1,215 @@
+//
+// 指标注册表：计数器和仪表值保存在 mmap 的共享内存文件中，外部工具映射同一文件即可轮询读取，
+// 不需要暂停目标进程，也不在记录路径上引入任何 IPC
+//
+// 段布局（本机字节序，所有数值 8 字节对齐）：
+//   MetricsSegmentHeader
+//   MetricDescriptor[kMaxMetrics]          指标名称和类型，按ID排列
+//   MetricThreadSlot[kMaxMetricThreads]    槽位 0 为公共槽位，其余每个线程独占一个
+//
+// 计数器的值为所有槽位之和：线程只写自己的槽位，线程退出时其计数并入公共槽位，
+// 线程槽位耗尽时直接原子累加到公共槽位。仪表值只保存在公共槽位中。
+// 合并退出线程期间 retire_sequence 为奇数，读者应在其变化时重试（见 MetricsReader）
+//
+
+#ifndef ANALYSIS_TOOLKIT_METRICS_H
+#define ANALYSIS_TOOLKIT_METRICS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace AnalysisToolkit {
+
+constexpr uint64_t kMetricsMagic = 0x31525445'4d4b5441ULL;  // "ATKMETR1"
+constexpr uint32_t kMetricsVersion = 1;
+constexpr size_t kMaxMetrics = 128;
+constexpr size_t kMaxMetricThreads = 256;
+constexpr size_t kMetricNameSize = 48;
+
+using MetricId = uint32_t;
+constexpr MetricId kInvalidMetricId = UINT32_MAX;
+
+enum class MetricKind : uint32_t {
+    COUNTER = 1,  // 单调递增，按线程分槽累加
+    GAUGE = 2     // 当前值（有符号），全进程一个
+};
+
+struct MetricsSegmentHeader {
+    std::atomic<uint64_t> magic;  // 最后写入，读者看到 kMetricsMagic 时其余字段已初始化
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t max_metrics;
+    uint32_t max_threads;
+    uint64_t segment_size;
+    int32_t pid;
+    uint32_t reserved;
+    uint64_t start_time_ns;                 // 创建时间（system_clock 纳秒）
+    std::atomic<uint32_t> metric_count;     // 已发布的描述符数
+    std::atomic<uint32_t> slot_count;       // 使用过的槽位数（含公共槽位）
+    std::atomic<uint64_t> retire_sequence;  // 奇数表示正在合并退出线程的计数
+};
+
+struct MetricDescriptor {
+    char name[kMetricNameSize];  // NUL 结尾
+    uint32_t kind;               // MetricKind
+    uint32_t reserved[3];
+};
+
+struct alignas(64) MetricThreadSlot {
+    std::atomic<uint32_t> thread_id;  // 0 表示空闲
+    uint32_t reserved[15];
+    std::atomic<uint64_t> values[kMaxMetrics];
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "metrics segment requires address-free 64-bit atomics");
+static_assert(sizeof(MetricsSegmentHeader) == 64, "unexpected metrics header size");
+static_assert(sizeof(MetricDescriptor) == 64, "unexpected metric descriptor size");
+
+// 一个指标在某一时刻的值；仪表值按 int64_t 解释
+struct MetricSample {
+    std::string name;
+    MetricKind kind = MetricKind::COUNTER;
+    uint64_t value = 0;
+
+    int64_t gaugeValue() const {
+        return static_cast<int64_t>(value);
+    }
+};
+
+// 进程内注册表（单例）：未打开共享内存段时记录操作只读一次原子变量后返回
+class MetricsRegistry {
+  public:
+    static MetricsRegistry& getInstance();
+
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    // 创建共享内存段并开始记录，path 为空时使用 defaultPath()；已打开时先关闭
+    bool open(const std::string& path = "");
+
+    // 停止记录并删除段文件；映射保留到进程退出，正在记录的线程不会访问已释放的内存
+    void close();
+
+    static bool isRecording() {
+        return recording_.load(std::memory_order_relaxed);
+    }
+
+    std::string getPath() const;
+
+    // Android 为 /data/local/tmp/atkit-metrics-<pid>，Linux 优先使用 /dev/shm
+    static std::string defaultPath(int pid);
+
+    // 按名称注册，重复注册返回同一ID（类型以首次注册为准）；名称超长时截断，表满时返回
+    // kInvalidMetricId。可在打开段之前调用
+    MetricId registerMetric(const char* name, MetricKind kind);
+
+    // 计数器累加
+    void add(MetricId id, uint64_t delta = 1);
+
+    // 仪表值写入 / 增减：未打开段时也会更新，打开时写入段中
+    void set(MetricId id, int64_t value);
+    void addGauge(MetricId id, int64_t delta);
+
+    // 汇总当前值，规则与 MetricsReader 相同；未打开时返回空
+    std::vector<MetricSample> collect() const;
+
+  private:
+    struct Segment;
+    struct ThreadHandle;
+
+    MetricsRegistry() = default;
+
+    MetricThreadSlot* threadSlot(Segment* segment, bool& shared);
+    void releaseSlot(Segment* segment, MetricThreadSlot* slot);
+    void publishDescriptor(Segment* segment, MetricId id);
+
+    static std::atomic<bool> recording_;
+
+    mutable std::mutex mutex_;
+    std::atomic<Segment*> segment_{nullptr};
+    std::vector<Segment*> closed_segments_;  // 已关闭但仍映射的段
+    std::atomic<uint32_t> metric_count_{0};
+    std::string names_[kMaxMetrics];
+    MetricKind kinds_[kMaxMetrics] = {};
+    std::atomic<int64_t> gauges_[kMaxMetrics] = {};
+};
+
+// 外部读者：只读映射另一个进程（或本进程）导出的段
+class MetricsReader {
+  public:
+    MetricsReader() = default;
+    ~MetricsReader();
+
+    MetricsReader(const MetricsReader&) = delete;
+    MetricsReader& operator=(const MetricsReader&) = delete;
+
+    // 映射并校验段文件，段尚未初始化完成或版本不符时返回 false
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const {
+        return base_ != nullptr;
+    }
+
+    // 导出进程的 pid 和段创建时间
+    int getPid() const;
+    uint64_t getStartTimeNs() const;
+
+    // 读取全部指标；与合并退出线程并发时重试，保证计数器不重复计算
+    std::vector<MetricSample> read() const;
+
+  private:
+    const char* base_ = nullptr;
+    size_t size_ = 0;
+};
+
+// 静态存储期的计数器，记录路径在未启用指标时只有一次原子读
+class MetricCounter {
+  public:
+    explicit MetricCounter(const char* name)
+        : id_(MetricsRegistry::getInstance().registerMetric(name, MetricKind::COUNTER)) {}
+
+    void add(uint64_t delta = 1) const {
+        if (MetricsRegistry::isRecording()) {
+            MetricsRegistry::getInstance().add(id_, delta);
+        }
+    }
+
+    MetricId getId() const {
+        return id_;
+    }
+
+  private:
+    MetricId id_;
+};
+
+// 静态存储期的仪表值，用于变化不频繁的状态；未启用指标时也保存当前值
+class MetricGauge {
+  public:
+    explicit MetricGauge(const char* name)
+        : id_(MetricsRegistry::getInstance().registerMetric(name, MetricKind::GAUGE)) {}
+
+    void set(int64_t value) const {
+        MetricsRegistry::getInstance().set(id_, value);
+    }
+
+    void add(int64_t delta) const {
+        MetricsRegistry::getInstance().addGauge(id_, delta);
+    }
+
+    MetricId getId() const {
+        return id_;
+    }
+
+  private:
+    MetricId id_;
+};
+
+}  // namespace AnalysisToolkit
+
+#endif  // ANALYSIS_TOOLKIT_METRICS_H
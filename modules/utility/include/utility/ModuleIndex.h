@@ -0,0 +1,136 @@
+/**
+ * @file ModuleIndex.h
+ * @brief Cached index of loaded modules and their executable ranges
+ * @author AnalysisToolkit
+ * @date 2024
+ *
+ * Groups the file-backed regions of the current process by module so that
+ * repeated module lookups do not re-parse /proc/self/maps. The index is only
+ * rebuilt when the loaded-object list changes or a lookup misses. An index can
+ * also describe another process, for use with a RemoteMemoryReader.
+ */
+
+#ifndef ANALYSIS_TOOLKIT_MODULE_INDEX_H
+#define ANALYSIS_TOOLKIT_MODULE_INDEX_H
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace AnalysisToolkit {
+
+/**
+ * @brief A loaded module and its mapped address ranges
+ */
+struct ModuleInfo {
+    std::string path;             ///< Full pathname as shown in the maps file
+    std::string name;             ///< Basename of the path
+    uintptr_t start_address = 0;  ///< Lowest mapped address
+    uintptr_t end_address = 0;    ///< Highest mapped address (exclusive)
+
+    /// Executable segments as [start, end) pairs, sorted by address
+    std::vector<std::pair<uintptr_t, uintptr_t>> executable_ranges;
+
+    bool contains(uintptr_t address) const {
+        return address >= start_address && address < end_address;
+    }
+};
+
+/**
+ * @brief Cached module/range index for a process
+ *
+ * All methods are thread-safe.
+ */
+class ModuleIndex {
+  public:
+    ModuleIndex() = default;
+
+    /**
+     * @brief Index the modules of another process
+     * @param pid Target process; -1, 0 or the current pid index this process
+     *
+     * The loader fingerprint is not available for another process, so a
+     * remote index is only rebuilt on a lookup miss, refresh() or invalidate().
+     */
+    explicit ModuleIndex(int pid);
+
+    ModuleIndex(const ModuleIndex&) = delete;
+    ModuleIndex& operator=(const ModuleIndex&) = delete;
+
+    /**
+     * @brief Get the process-wide shared index
+     */
+    static ModuleIndex& getInstance();
+
+    /**
+     * @brief Find a module by name
+     * @param name Full path, basename, or a substring of the path
+     * @return The module, or std::nullopt if it is not mapped
+     *
+     * Exact path and basename matches take precedence over substring matches.
+     * A miss triggers one rebuild in case the module was mapped after the
+     * index was built.
+     */
+    std::optional<ModuleInfo> findModule(const std::string& name);
+
+    /**
+     * @brief Find the module that contains an address
+     */
+    std::optional<ModuleInfo> findModuleContaining(uintptr_t address);
+
+    /**
+     * @brief Get a copy of all indexed modules
+     */
+    std::vector<ModuleInfo> getModules();
+
+    /**
+     * @brief Force a rebuild from the maps file
+     * @return true if the maps file was parsed successfully
+     */
+    bool refresh();
+
+    /**
+     * @brief Drop the cached index; the next lookup rebuilds it
+     */
+    void invalidate();
+
+    /**
+     * @brief Number of times the index has been rebuilt
+     */
+    uint64_t getRebuildCount() const;
+
+    /**
+     * @brief Indexed process (-1 for the current process)
+     */
+    int getPid() const {
+        return pid_;
+    }
+
+    /**
+     * @brief Cheap fingerprint of the loaded-object list
+     *
+     * Computed from the dynamic loader's object list without reading the maps
+     * file; it changes whenever a shared object is loaded or unloaded.
+     */
+    static uint64_t computeFingerprint();
+
+  private:
+    bool ensureFreshLocked();
+    bool rebuildLocked();
+    const ModuleInfo* findModuleLocked(const std::string& name) const;
+    uint64_t currentFingerprint() const;
+
+    const int pid_ = -1;
+    mutable std::mutex mutex_;
+    std::vector<ModuleInfo> modules_;
+    uint64_t fingerprint_ = 0;
+    bool valid_ = false;
+    uint64_t rebuild_count_ = 0;
+};
+
+}  // namespace AnalysisToolkit
+
+#endif  // ANALYSIS_TOOLKIT_MODULE_INDEX_H
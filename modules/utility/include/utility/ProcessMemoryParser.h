@@ -15,6 +15,7 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace AnalysisToolkit {
@@ -114,6 +115,36 @@ class MemoryRegion {
     std::string original_line_;
 };
 
+/**
+ * @brief Non-owning view of one memory mapping
+ *
+ * The string views point into the parser's read buffer and are only valid
+ * for the duration of the forEachRegion() callback that received them.
+ */
+struct MemoryRegionView {
+    uintptr_t start_address = 0;
+    uintptr_t end_address = 0;
+    MemoryPermissions permissions;
+    uint64_t offset = 0;
+    std::string_view device;
+    uint32_t inode = 0;
+    std::string_view pathname;
+    std::string_view line;  ///< Raw maps line, empty on platforms without a maps file
+
+    size_t getSize() const {
+        return end_address - start_address;
+    }
+    bool contains(uintptr_t address) const {
+        return address >= start_address && address < end_address;
+    }
+
+    /**
+     * @brief Copy the view into an owning MemoryRegion
+     * @param keep_original_line Whether to copy the raw maps line as well
+     */
+    MemoryRegion toRegion(bool keep_original_line = false) const;
+};
+
 /**
  * @brief Process Memory Parser - Main class for parsing process memory maps
  */
@@ -129,6 +160,7 @@ class ProcessMemoryParser {
         FILE_NOT_FOUND,
         PARSE_ERROR,
         PLATFORM_NOT_SUPPORTED,
+        INVALID_ADDRESS,
         UNKNOWN_ERROR
     };
 
@@ -200,6 +232,41 @@ class ProcessMemoryParser {
      */
     Result<std::vector<MemoryRegion>> parseProcess(int pid = -1);
 
+    /**
+     * @brief Visitor for forEachRegion(); return false to stop the iteration
+     */
+    using RegionVisitor = std::function<bool(const MemoryRegionView&)>;
+
+    /**
+     * @brief Visit every mapping of a process without building a region vector
+     * @param visitor Called once per mapping, in address order
+     * @param pid Process ID (use -1 or 0 for current process)
+     * @return Result containing the number of regions visited, or error
+     *
+     * The maps file is read with one buffer that is reused across calls and
+     * parsed in place. Filters are applied before the visitor: a view filter
+     * (setRegionViewFilter()) tests the view directly, while a MemoryRegion
+     * filter (setRegionFilter()) materializes each region, so prefer the view
+     * filter on hot paths.
+     */
+    Result<size_t> forEachRegion(const RegionVisitor& visitor, int pid = -1);
+
+    /**
+     * @brief Visit the mappings described by maps text that is already in memory
+     * @param maps_text Contents of a /proc/[pid]/maps file, e.g. from readMapsText()
+     * @param visitor Called once per well-formed line; return false to stop
+     * @return Number of regions visited
+     */
+    size_t forEachRegionInText(std::string_view maps_text, const RegionVisitor& visitor) const;
+
+    /**
+     * @brief Read the raw /proc/[pid]/maps text without parsing it
+     * @param pid Process ID (use -1 or 0 for current process)
+     * @return View into the parser's read buffer, valid until the next read
+     *         through this parser; PLATFORM_NOT_SUPPORTED without a maps file
+     */
+    Result<std::string_view> readMapsText(int pid = -1);
+
     /**
      * @brief Parse memory maps for current process
      * @return Result containing vector of memory regions or error
@@ -262,10 +329,30 @@ class ProcessMemoryParser {
     }
 
     /**
-     * @brief Clear region filter
+     * @brief Set a filter that is tested on the in-place view of each region
+     * @param filter Function that returns true for regions to include
+     *
+     * Unlike setRegionFilter() this never materializes a MemoryRegion. When
+     * both filters are set a region must pass both.
+     */
+    void setRegionViewFilter(std::function<bool(const MemoryRegionView&)> filter) {
+        region_view_filter_ = std::move(filter);
+    }
+
+    /**
+     * @brief Clear both region filters
      */
     void clearRegionFilter() {
         region_filter_ = nullptr;
+        region_view_filter_ = nullptr;
+    }
+
+    /**
+     * @brief Keep a copy of the raw maps line in each parsed MemoryRegion
+     * @param keep Disabled by default; getOriginalLine() is empty unless enabled
+     */
+    void setKeepOriginalLine(bool keep) {
+        keep_original_line_ = keep;
     }
 
   private:
@@ -280,9 +367,33 @@ class ProcessMemoryParser {
     Result<std::vector<MemoryRegion>> parseMacOSMaps(int pid);
 
     /**
-     * @brief Parse a single line from /proc/[pid]/maps
+     * @brief Parse a single line from /proc/[pid]/maps in place
+     * @return false if the line is malformed
+     */
+    static bool parseMapsLine(std::string_view line, MemoryRegionView& region);
+
+    /**
+     * @brief Visitor that also receives the region built for the MemoryRegion
+     * filter, or nullptr when none was built, so it can be moved instead of
+     * converting the view a second time
      */
-    std::optional<MemoryRegion> parseMapsLine(const std::string& line);
+    using MaterializingVisitor = std::function<bool(const MemoryRegionView&, MemoryRegion*)>;
+
+    /**
+     * @brief forEachRegion() / forEachRegionInText() with a materializing visitor
+     */
+    Result<size_t> visitRegions(const MaterializingVisitor& visitor, int pid);
+    size_t visitRegionsInText(std::string_view maps_text,
+                              const MaterializingVisitor& visitor) const;
+
+    /**
+     * @brief Materialize the regions accepted by a predicate
+     * @param first_only Stop after the first match
+     */
+    Result<std::vector<MemoryRegion>> collectRegions(
+        const std::function<bool(const MemoryRegionView&)>& predicate,
+        int pid,
+        bool first_only = false);
 
     /**
      * @brief Get maps file path for process
@@ -294,8 +405,13 @@ class ProcessMemoryParser {
      */
     bool shouldIncludeRegion(const MemoryRegion& region) const;
 
-    // Optional filter function
+    // Optional filter functions
     std::function<bool(const MemoryRegion&)> region_filter_;
+    std::function<bool(const MemoryRegionView&)> region_view_filter_;
+
+    // Reused across parses so repeated calls do not reallocate
+    std::string read_buffer_;
+    bool keep_original_line_ = false;
 };
 
 }  // namespace AnalysisToolkit
@@ -0,0 +1,189 @@
+/**
+ * @file RemoteMemoryReader.h
+ * @brief Batched reads from another process's memory
+ * @author AnalysisToolkit
+ * @date 2024
+ *
+ * Reads the memory of a target process with process_vm_readv(). Scattered
+ * reads submitted together are packed into as few scatter/gather calls as
+ * possible, and small reads are served from a page-granular cache that
+ * prefetches ahead when accesses walk forward through memory. Every read is
+ * checked against the target's region list first, so a range that is not
+ * fully mapped and readable fails with INVALID_ADDRESS instead of a partial
+ * copy.
+ *
+ * Reading another process needs ptrace access to it (same user and, with
+ * Yama, a descendant or an explicit PR_SET_PTRACER grant, or CAP_SYS_PTRACE).
+ */
+
+#ifndef ANALYSIS_TOOLKIT_REMOTE_MEMORY_READER_H
+#define ANALYSIS_TOOLKIT_REMOTE_MEMORY_READER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "utility/MemoryMapSnapshot.h"
+#include "utility/ProcessMemoryParser.h"
+
+namespace AnalysisToolkit {
+
+/**
+ * @brief One read submitted to RemoteMemoryReader::readBatch()
+ */
+struct RemoteReadRequest {
+    uintptr_t address = 0;   ///< Address in the target process
+    size_t size = 0;         ///< Number of bytes to read
+    void* buffer = nullptr;  ///< Destination, at least size bytes
+
+    /// Set by readBatch(): SUCCESS, or why this request failed
+    ProcessMemoryParser::ErrorCode error = ProcessMemoryParser::ErrorCode::SUCCESS;
+};
+
+/**
+ * @brief Memory reader for a target process
+ *
+ * Cached pages are a copy taken at the time of the read; call clearCache()
+ * after the target may have written to memory you re-read. All methods are
+ * thread-safe. Large reads do not take the cache lock while copying, so
+ * several threads can stream independent ranges concurrently.
+ */
+class RemoteMemoryReader {
+  public:
+    /**
+     * @brief Read statistics
+     */
+    struct Stats {
+        uint64_t syscalls = 0;      ///< process_vm_readv() calls issued
+        uint64_t bytes_read = 0;    ///< Bytes copied from the target
+        uint64_t cache_hits = 0;    ///< Cached reads served without a syscall
+        uint64_t cache_misses = 0;  ///< Cached reads that had to fetch pages
+    };
+
+    /**
+     * @param pid Target process (use -1 or 0 for the current process)
+     * @param cache_pages Capacity of the page cache; 0 disables caching
+     */
+    explicit RemoteMemoryReader(int pid, size_t cache_pages = 64);
+
+    RemoteMemoryReader(const RemoteMemoryReader&) = delete;
+    RemoteMemoryReader& operator=(const RemoteMemoryReader&) = delete;
+
+    int getPid() const {
+        return pid_;
+    }
+
+    /**
+     * @brief Reload the target's region list
+     * @return Number of regions, or the parse error
+     *
+     * Called automatically before the first read, and when a read touches
+     * memory the current list does not cover (at most once every 50 ms).
+     */
+    ProcessMemoryParser::Result<size_t> refreshRegions();
+
+    /**
+     * @brief Current region list of the target (loaded on first use)
+     */
+    std::shared_ptr<const MemoryMapSnapshot> getRegions();
+
+    /**
+     * @brief Read a contiguous range
+     * @return Number of bytes read (always size on success)
+     *
+     * Reads of up to two pages go through the page cache.
+     */
+    ProcessMemoryParser::Result<size_t> read(uintptr_t address, void* buffer, size_t size);
+
+    /**
+     * @brief Read a trivially copyable value
+     */
+    template <typename T>
+    std::optional<T> readValue(uintptr_t address) {
+        static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable");
+        T value;
+        if (read(address, &value, sizeof(T)).hasError()) {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+    /**
+     * @brief Perform many reads with as few syscalls as possible
+     * @return Number of requests that succeeded; each request's error field
+     *         says whether and why it failed
+     *
+     * Requests fully covered by cached pages are copied from the cache; the
+     * rest are packed, in order, into process_vm_readv() calls of up to
+     * IOV_MAX segments. A failing request does not affect the others.
+     */
+    size_t readBatch(std::vector<RemoteReadRequest>& requests);
+
+    /**
+     * @brief Pages fetched ahead on a sequential cache miss
+     * @param pages Clamped so that a read and its prefetch fit in the cache
+     */
+    void setPrefetchPages(size_t pages);
+
+    /**
+     * @brief Drop all cached pages
+     */
+    void clearCache();
+
+    Stats getStats() const;
+
+  private:
+    struct CacheSlot {
+        uintptr_t page = 0;
+        uint64_t last_use = 0;
+        bool valid = false;
+    };
+
+    // A contiguous piece of a vectored read
+    struct Segment {
+        uintptr_t remote;
+        void* local;
+        size_t size;
+    };
+
+    ProcessMemoryParser::Result<size_t> refreshRegionsLocked();
+    ProcessMemoryParser::ErrorCode checkRangeLocked(uintptr_t address, size_t size);
+    ProcessMemoryParser::Result<size_t> readCachedLocked(uintptr_t address,
+                                                         void* buffer,
+                                                         size_t size);
+    bool copyFromCacheLocked(uintptr_t address, void* buffer, size_t size);
+    size_t acquireSlotLocked(uintptr_t page);
+
+    // Issue vectored reads; returns one error code per segment
+    std::vector<ProcessMemoryParser::ErrorCode> transfer(const std::vector<Segment>& segments);
+
+    const int pid_;
+    const size_t page_size_;
+
+    mutable std::mutex mutex_;
+    std::shared_ptr<const MemoryMapSnapshot> regions_;
+
+    // Page cache: slots_[i] describes the page stored at storage_[i * page_size_]
+    std::vector<uint8_t> storage_;
+    std::vector<CacheSlot> slots_;
+    std::unordered_map<uintptr_t, size_t> page_index_;
+    uint64_t use_clock_ = 0;
+    uintptr_t last_miss_page_ = 0;
+    size_t prefetch_pages_ = 8;
+    uint64_t last_refresh_ns_ = 0;
+
+    std::atomic<uint64_t> syscalls_{0};
+    std::atomic<uint64_t> bytes_read_{0};
+    std::atomic<uint64_t> cache_hits_{0};
+    std::atomic<uint64_t> cache_misses_{0};
+};
+
+}  // namespace AnalysisToolkit
+
+#endif  // ANALYSIS_TOOLKIT_REMOTE_MEMORY_READER_H
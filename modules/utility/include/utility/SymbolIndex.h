@@ -0,0 +1,135 @@
+/**
+ * @file SymbolIndex.h
+ * @brief Cached ELF symbol tables of loaded modules
+ * @author AnalysisToolkit
+ * @date 2024
+ *
+ * Parses the .dynsym/.symtab sections of each loaded ELF module once and
+ * answers name-to-address and address-to-symbol queries from memory. When
+ * the section headers are stripped, the dynamic symbol table is located
+ * through PT_DYNAMIC and sized from the GNU (or SysV) hash table.
+ *
+ * Parsed tables can be persisted to a cache directory. Cache files are keyed
+ * by path and inode and are discarded when the file's size or modification
+ * time no longer match, so a restarted process skips the parse entirely.
+ */
+
+#ifndef ANALYSIS_TOOLKIT_SYMBOL_INDEX_H
+#define ANALYSIS_TOOLKIT_SYMBOL_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace AnalysisToolkit {
+
+class ModuleIndex;
+struct LibrarySymbols;
+
+/**
+ * @brief A symbol resolved to its runtime address
+ */
+struct SymbolInfo {
+    std::string name;         ///< Symbol name
+    std::string module_path;  ///< Path of the module defining the symbol
+    uintptr_t address = 0;    ///< Runtime address (load bias applied)
+    size_t size = 0;          ///< Size in bytes, 0 if unknown
+
+    bool contains(uintptr_t value) const {
+        return value >= address && (size == 0 || value < address + size);
+    }
+};
+
+/**
+ * @brief Per-module symbol tables for the current process
+ *
+ * Only defined function and object symbols are indexed. Name lookups prefer
+ * global and weak definitions over local ones and ignore non-default symbol
+ * versions, matching what dlsym() would return. GNU indirect functions are
+ * not indexed since their symbol value is the resolver rather than the
+ * implementation.
+ *
+ * All methods are thread-safe.
+ */
+class SymbolIndex {
+  public:
+    /**
+     * @param modules Module index used to map library names and addresses to paths
+     */
+    explicit SymbolIndex(ModuleIndex& modules);
+    SymbolIndex();
+    ~SymbolIndex();
+
+    SymbolIndex(const SymbolIndex&) = delete;
+    SymbolIndex& operator=(const SymbolIndex&) = delete;
+
+    /**
+     * @brief Get the process-wide shared index
+     */
+    static SymbolIndex& getInstance();
+
+    /**
+     * @brief Set the directory used to persist parsed tables
+     * @param directory Existing writable directory, or empty to disable persistence
+     */
+    void setCacheDirectory(const std::string& directory);
+
+    /**
+     * @brief Get the current cache directory (empty if persistence is disabled)
+     */
+    std::string getCacheDirectory() const;
+
+    /**
+     * @brief Resolve a symbol in a loaded module
+     * @param library Full path, basename, or a substring of the module path
+     * @param symbol Symbol name
+     * @return Runtime address, or std::nullopt if the module is not loaded or
+     *         does not define the symbol
+     */
+    std::optional<uintptr_t> findSymbol(const std::string& library, const std::string& symbol);
+
+    /**
+     * @brief Resolve several symbols in the same module
+     * @return One address per requested symbol, 0 for symbols that were not found
+     *
+     * The module is looked up and its table pinned once for the whole batch.
+     */
+    std::vector<uintptr_t> findSymbols(const std::string& library,
+                                       const std::vector<std::string>& symbols);
+
+    /**
+     * @brief Find the symbol containing an address
+     * @return The nearest symbol at or below the address whose extent covers
+     *         it (symbols of unknown size cover everything up to the next
+     *         symbol), or std::nullopt if there is none
+     */
+    std::optional<SymbolInfo> findSymbolContaining(uintptr_t address);
+
+    /**
+     * @brief Drop all in-memory tables; cache files are kept
+     */
+    void clear();
+
+    /**
+     * @brief Number of ELF files parsed so far (cache hits are not counted)
+     */
+    uint64_t getParseCount() const;
+
+  private:
+    std::shared_ptr<const LibrarySymbols> getLibrary(const std::string& path);
+
+    ModuleIndex& modules_;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, std::shared_ptr<const LibrarySymbols>> libraries_;
+    std::string cache_directory_;
+    uint64_t parse_count_ = 0;
+};
+
+}  // namespace AnalysisToolkit
+
+#endif  // ANALYSIS_TOOLKIT_SYMBOL_INDEX_H
@@ -0,0 +1,279 @@
+#include "utility/BinaryLog.h"
+
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "utility/Logger.h"
+
+namespace AnalysisToolkit {
+
+namespace {
+
+std::atomic<const char*> g_formats[BinaryLogFormats::kMaxFormats];
+std::atomic<uint32_t> g_format_count{0};
+std::mutex g_register_mutex;
+
+// 解码参数时的游标
+class ArgReader {
+  public:
+    ArgReader(const char* data, size_t size) : data_(data), size_(size) {}
+
+    bool next(BinaryArgType& type, uint64_t& value, std::string_view& text) {
+        if (offset_ >= size_) {
+            return false;
+        }
+        type = static_cast<BinaryArgType>(data_[offset_++]);
+        if (type == BinaryArgType::STRING) {
+            uint16_t length;
+            if (offset_ + sizeof(length) > size_) {
+                return false;
+            }
+            memcpy(&length, data_ + offset_, sizeof(length));
+            offset_ += sizeof(length);
+            if (offset_ + length > size_) {
+                return false;
+            }
+            text = std::string_view(data_ + offset_, length);
+            offset_ += length;
+            return true;
+        }
+        if (offset_ + sizeof(value) > size_) {
+            return false;
+        }
+        memcpy(&value, data_ + offset_, sizeof(value));
+        offset_ += sizeof(value);
+        return true;
+    }
+
+  private:
+    const char* data_;
+    size_t size_;
+    size_t offset_ = 0;
+};
+
+template <typename T>
+void appendFormatted(std::string& output, const std::string& spec, T value) {
+    char buffer[256];
+    int length = snprintf(buffer, sizeof(buffer), spec.c_str(), value);
+    if (length < 0) {
+        return;
+    }
+    if (static_cast<size_t>(length) < sizeof(buffer)) {
+        output.append(buffer, static_cast<size_t>(length));
+        return;
+    }
+    size_t offset = output.size();
+    output.resize(offset + static_cast<size_t>(length) + 1);
+    snprintf(&output[offset], static_cast<size_t>(length) + 1, spec.c_str(), value);
+    output.resize(offset + static_cast<size_t>(length));
+}
+
+double asDouble(BinaryArgType type, uint64_t value) {
+    if (type == BinaryArgType::DOUBLE) {
+        double number;
+        memcpy(&number, &value, sizeof(number));
+        return number;
+    }
+    return type == BinaryArgType::INT64 ? static_cast<double>(static_cast<int64_t>(value))
+                                        : static_cast<double>(value);
+}
+
+uint64_t asInteger(BinaryArgType type, uint64_t value) {
+    if (type == BinaryArgType::DOUBLE) {
+        return static_cast<uint64_t>(static_cast<int64_t>(asDouble(type, value)));
+    }
+    return value;
+}
+
+}  // namespace
+
+uint32_t BinaryLogFormats::registerFormat(const char* format) {
+    std::lock_guard<std::mutex> lock(g_register_mutex);
+    uint32_t count = g_format_count.load(std::memory_order_relaxed);
+    if (format == nullptr || count >= kMaxFormats) {
+        return kBinaryLogText;
+    }
+    g_formats[count].store(format, std::memory_order_relaxed);
+    g_format_count.store(count + 1, std::memory_order_release);
+    return count + 1;
+}
+
+const char* BinaryLogFormats::lookup(uint32_t id) {
+    if (id == kBinaryLogText || id > g_format_count.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    return g_formats[id - 1].load(std::memory_order_relaxed);
+}
+
+uint32_t BinaryLogFormats::count() {
+    return g_format_count.load(std::memory_order_acquire);
+}
+
+void formatBinaryLog(const char* format, const char* args, size_t size, std::string& output) {
+    ArgReader reader(args, size);
+    const char* p = format;
+    while (*p != '\0') {
+        if (*p != '%') {
+            const char* literal = p;
+            while (*p != '\0' && *p != '%') {
+                p++;
+            }
+            output.append(literal, static_cast<size_t>(p - literal));
+            continue;
+        }
+        if (p[1] == '%') {
+            output += '%';
+            p += 2;
+            continue;
+        }
+
+        // 保留标志、宽度和精度，长度修饰符按参数的实际类型重写
+        const char* spec_begin = p++;
+        while (*p != '\0' && strchr("-+ #0123456789.", *p) != nullptr) {
+            p++;
+        }
+        std::string spec(spec_begin, static_cast<size_t>(p - spec_begin));
+        while (*p != '\0' && strchr("hljztLq", *p) != nullptr) {
+            p++;
+        }
+        char conversion = *p;
+        if (conversion == '\0') {
+            break;
+        }
+        p++;
+
+        BinaryArgType type;
+        uint64_t value = 0;
+        std::string_view text;
+        if (!reader.next(type, value, text)) {
+            output += "<?>";
+            continue;
+        }
+
+        switch (conversion) {
+            case 'd':
+            case 'i':
+                appendFormatted(
+                    output, spec + "lld", static_cast<long long>(asInteger(type, value)));
+                break;
+            case 'u':
+            case 'o':
+            case 'x':
+            case 'X':
+                spec += "ll";
+                spec += conversion;
+                appendFormatted(
+                    output, spec, static_cast<unsigned long long>(asInteger(type, value)));
+                break;
+            case 'c':
+                appendFormatted(output, spec + "c", static_cast<int>(asInteger(type, value)));
+                break;
+            case 'e':
+            case 'E':
+            case 'f':
+            case 'F':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                spec += conversion;
+                appendFormatted(output, spec, asDouble(type, value));
+                break;
+            case 'p':
+                if (type != BinaryArgType::STRING) {
+                    appendFormatted(
+                        output, spec + "p", reinterpret_cast<void*>(static_cast<uintptr_t>(value)));
+                } else {
+                    output += "<?>";
+                }
+                break;
+            case 's':
+                if (type == BinaryArgType::STRING) {
+                    appendFormatted(output, spec + "s", std::string(text).c_str());
+                } else {
+                    output += "<?>";
+                }
+                break;
+            default:
+                // 不支持的转换（如 %n、%*d）：参数已消耗，原样输出格式
+                output += spec;
+                output += conversion;
+                break;
+        }
+    }
+}
+
+bool BinaryLogReader::decodeFile(const std::string& path, const EntryCallback& callback) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    // 文件中定义的格式串，文件头出现时清空（每个进程的 ID 独立分配）
+    std::unordered_map<uint32_t, std::string> formats;
+    std::vector<char> payload;
+    bool seen_header = false;
+    BinaryLogRecordHeader header;
+    const BinaryLogRecordHeader zero_header = {};
+    while (file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        // 进程崩溃时预分配段的未写入部分全为 0；有效记录的时间戳不为 0，全零记录头即数据结尾
+        if (memcmp(&header, &zero_header, sizeof(header)) == 0) {
+            return true;
+        }
+        payload.resize(header.payload_size);
+        if (header.payload_size > 0 && !file.read(payload.data(), header.payload_size)) {
+            return false;
+        }
+
+        if (header.format_id == kBinaryLogFileMagic) {
+            uint32_t version = 0;
+            if (header.payload_size < 8 + sizeof(version) ||
+                memcmp(payload.data(), "ATKBLOG", 8) != 0) {
+                return false;
+            }
+            memcpy(&version, payload.data() + 8, sizeof(version));
+            if (version != kBinaryLogVersion) {
+                return false;
+            }
+            formats.clear();
+            seen_header = true;
+            continue;
+        }
+        if (!seen_header) {
+            return false;
+        }
+
+        BinaryLogEntry entry;
+        entry.level = static_cast<LogLevel>(header.level);
+        entry.timestamp = header.timestamp;
+        if (header.format_id == kBinaryLogDefinition) {
+            uint32_t id;
+            if (header.payload_size < sizeof(id)) {
+                return false;
+            }
+            memcpy(&id, payload.data(), sizeof(id));
+            formats[id].assign(payload.data() + sizeof(id), header.payload_size - sizeof(id));
+            continue;
+        } else if (header.format_id == kBinaryLogText) {
+            entry.message.assign(payload.data(), payload.size());
+        } else {
+            auto it = formats.find(header.format_id);
+            if (it == formats.end()) {
+                entry.message = "<unknown format " + std::to_string(header.format_id) + ">";
+            } else {
+                formatBinaryLog(it->second.c_str(), payload.data(), payload.size(), entry.message);
+            }
+        }
+
+        if (!callback(entry)) {
+            return true;
+        }
+    }
+    return file.eof();
+}
+
+}  // namespace AnalysisToolkit
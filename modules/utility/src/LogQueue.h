@@ -0,0 +1,123 @@
+#ifndef ANALYSIS_TOOLKIT_LOG_QUEUE_H
+#define ANALYSIS_TOOLKIT_LOG_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#include "utility/Logger.h"
+
+namespace AnalysisToolkit {
+
+// 单条异步日志记录，固定大小以便在队列中原地构造
+struct LogRecord {
+    static constexpr size_t kMaxMessage = 1024 - 32;
+
+    LogLevel level;
+    uint32_t length;
+    uint32_t format_id;  // kBinaryLogText 为文本，否则 message 为时间戳 + 编码参数
+    uint32_t thread_id;  // 调用线程ID
+    uint64_t timestamp;  // 调用时的单调时钟（纳秒）
+    char message[kMaxMessage];
+};
+
+static_assert(LogRecord::kMaxMessage == kBinaryLogMaxPayload, "binary payload must fit a record");
+
+// 有界多生产者/单消费者无锁队列（每个槽位带序号，参考 Vyukov 有界队列）
+class LogQueue {
+  public:
+    explicit LogQueue(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        mask_ = size - 1;
+        slots_ = std::make_unique<Slot[]>(size);
+        for (size_t i = 0; i < size; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    LogQueue(const LogQueue&) = delete;
+    LogQueue& operator=(const LogQueue&) = delete;
+
+    // 尝试入队，队列满时返回 false（任意线程调用）
+    bool tryPush(LogLevel level,
+                 uint32_t format_id,
+                 uint32_t thread_id,
+                 uint64_t timestamp,
+                 const char* message,
+                 size_t length) {
+        uint64_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot = &slots_[pos & mask_];
+            uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+            int64_t diff = static_cast<int64_t>(sequence) - static_cast<int64_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+
+        length = length < LogRecord::kMaxMessage ? length : LogRecord::kMaxMessage;
+        slot->record.level = level;
+        slot->record.format_id = format_id;
+        slot->record.thread_id = thread_id;
+        slot->record.timestamp = timestamp;
+        slot->record.length = static_cast<uint32_t>(length);
+        memcpy(slot->record.message, message, length);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 出队一条记录（仅消费者线程调用），record 在 release() 前有效
+    const LogRecord* peek() {
+        Slot& slot = slots_[dequeue_pos_ & mask_];
+        if (slot.sequence.load(std::memory_order_acquire) != dequeue_pos_ + 1) {
+            return nullptr;
+        }
+        return &slot.record;
+    }
+
+    void release() {
+        Slot& slot = slots_[dequeue_pos_ & mask_];
+        slot.sequence.store(dequeue_pos_ + mask_ + 1, std::memory_order_release);
+        dequeue_pos_++;
+        consumed_.store(dequeue_pos_, std::memory_order_release);
+    }
+
+    // 已成功入队的记录数
+    uint64_t enqueued() const {
+        return enqueue_pos_.load(std::memory_order_acquire);
+    }
+
+    // 已被消费者处理的记录数
+    uint64_t consumed() const {
+        return consumed_.load(std::memory_order_acquire);
+    }
+
+  private:
+    struct Slot {
+        std::atomic<uint64_t> sequence;
+        LogRecord record;
+    };
+
+    std::unique_ptr<Slot[]> slots_;
+    uint64_t mask_;
+
+    alignas(64) std::atomic<uint64_t> enqueue_pos_{0};
+    alignas(64) uint64_t dequeue_pos_ = 0;
+    std::atomic<uint64_t> consumed_{0};
+};
+
+}  // namespace AnalysisToolkit
+
+#endif
@@ -1,44 +1,165 @@
 #include "utility/Logger.h"
 
+#include <time.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <chrono>
 #include <cstdio>
+#include <cstring>
 #include <ctime>
 #include <iomanip>
 
+#include "LogQueue.h"
+#include "MappedLogFile.h"
+#include "utility/Metrics.h"
+
+#if defined(__linux__) || defined(__ANDROID__)
+#include <sys/syscall.h>
+#elif defined(__APPLE__)
+#include <pthread.h>
+#endif
+
 namespace AnalysisToolkit {
 
+namespace {
+
+// 指标：通过级别过滤的记录数和异步队列满时丢弃的记录数
+const MetricCounter& logRecordsMetric() {
+    static const MetricCounter counter("log.records");
+    return counter;
+}
+
+const MetricCounter& logDroppedMetric() {
+    static const MetricCounter counter("log.dropped");
+    return counter;
+}
+
+// 追加一条二进制记录（头部 + payload）
+void appendBinaryRecord(std::string& output,
+                        LogLevel level,
+                        uint32_t format_id,
+                        uint64_t timestamp,
+                        const char* payload,
+                        size_t size) {
+    size = size < UINT16_MAX ? size : UINT16_MAX;
+
+    BinaryLogRecordHeader header = {};
+    header.format_id = format_id;
+    header.payload_size = static_cast<uint16_t>(size);
+    header.level = static_cast<uint8_t>(level);
+    header.timestamp = timestamp;
+    output.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    output.append(payload, size);
+}
+
+// 映射段的最小大小：通常的异步批次连同前导定义能放进同一个段，更大的写入由轮转时放大新段处理
+constexpr size_t kMinSegmentBytes = 256 * 1024;
+
+// 同步写入时每线程复用的格式化缓冲区：容量在各次调用间保留，稳定后每行不再分配堆内存
+struct DirectWriteBuffers {
+    std::string decoded;  // 二进制记录展开后的文本
+    std::string record;   // 待写入文件的完整记录
+};
+
+// 超过此容量的缓冲区用完即释放，避免个别超长消息长期占用内存
+constexpr size_t kMaxRetainedBufferBytes = 64 * 1024;
+
+DirectWriteBuffers& directWriteBuffers() {
+    static thread_local DirectWriteBuffers buffers;
+    return buffers;
+}
+
+void recycleBuffer(std::string& buffer) {
+    buffer.clear();
+    if (buffer.capacity() > kMaxRetainedBufferBytes) {
+        std::string().swap(buffer);
+    }
+}
+
+}  // namespace
+
 std::unique_ptr<Logger> Logger::instance_ = nullptr;
+std::atomic<Logger*> Logger::instance_ptr_{nullptr};
 std::mutex Logger::instance_mutex_;
 
 Logger* Logger::getInstance() {
+    // 快速路径：实例创建后只需一次 acquire 读取
+    Logger* logger = instance_ptr_.load(std::memory_order_acquire);
+    if (logger != nullptr) {
+        return logger;
+    }
+
     std::lock_guard<std::mutex> lock(instance_mutex_);
     if (instance_ == nullptr) {
         instance_ = std::unique_ptr<Logger>(new Logger());
+        instance_ptr_.store(instance_.get(), std::memory_order_release);
     }
     return instance_.get();
 }
 
+void Logger::FormatBuffer::reserve(size_t size) {
+    if (size <= capacity) {
+        return;
+    }
+    heap_storage = std::make_unique<char[]>(size);
+    data = heap_storage.get();
+    capacity = size;
+}
+
+Logger::FormatBuffer& Logger::threadFormatBuffer() {
+    static thread_local FormatBuffer buffer;
+    return buffer;
+}
+
+uint32_t Logger::currentThreadId() {
+    FormatBuffer& buffer = threadFormatBuffer();
+    if (buffer.thread_id == 0) {
+#if defined(__linux__) || defined(__ANDROID__)
+        buffer.thread_id = static_cast<uint32_t>(syscall(SYS_gettid));
+#elif defined(__APPLE__)
+        uint64_t id = 0;
+        pthread_threadid_np(nullptr, &id);
+        buffer.thread_id = static_cast<uint32_t>(id);
+#else
+        buffer.thread_id =
+            static_cast<uint32_t>(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+#endif
+    }
+    return buffer.thread_id;
+}
+
+uint64_t Logger::monotonicTimestamp() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
 Logger::~Logger() {
+    disableAsync();
     if (file_stream_.is_open()) {
         file_stream_.flush();
         file_stream_.close();
     }
+    mapped_file_.reset();
 }
 
 bool Logger::initialize(const std::string& tag,
                         const std::string& file_path,
                         LogLevel min_level,
-                        bool console_enabled) {
+                        bool console_enabled,
+                        LogFormat format) {
     tag_ = tag.empty() ? "AnalysisToolkit" : tag;
     min_level_.store(min_level);
     console_enabled_.store(console_enabled);
 
+    bool success = true;
     if (!file_path.empty()) {
-        return setLogFile(file_path);
+        success = setLogFile(file_path);
     }
+    setLogFormat(format);
 
-    return true;
+    return success;
 }
 
 void Logger::setTag(const std::string& tag) {
@@ -60,11 +181,25 @@ void Logger::enableFile(bool enabled) {
 bool Logger::setLogFile(const std::string& file_path) {
     std::lock_guard<std::mutex> lock(file_mutex_);
 
-    if (file_stream_.is_open()) {
-        file_stream_.flush();
-        file_stream_.close();
+    closeFileLocked();
+    log_file_path_ = file_path;
+
+    if (file_path.empty()) {
+        file_enabled_.store(false);
+        return true;
     }
 
+    file_stream_.open(file_path, std::ios::app | std::ios::binary);
+    bool success = file_stream_.is_open();
+    file_enabled_.store(success);
+
+    return success;
+}
+
+bool Logger::setRotatingLogFile(const std::string& file_path, const LogRotationConfig& config) {
+    std::lock_guard<std::mutex> lock(file_mutex_);
+
+    closeFileLocked();
     log_file_path_ = file_path;
 
     if (file_path.empty()) {
@@ -72,13 +207,40 @@ bool Logger::setLogFile(const std::string& file_path) {
         return true;
     }
 
-    file_stream_.open(file_path, std::ios::app);
-    bool success = file_stream_.is_open();
+    auto mapped = std::make_unique<MappedLogFile>();
+    size_t segment_bytes = std::max(config.max_file_bytes, kMinSegmentBytes);
+    bool success = mapped->open(file_path, segment_bytes, config.max_files);
+    if (success) {
+        mapped_file_ = std::move(mapped);
+    }
     file_enabled_.store(success);
 
     return success;
 }
 
+void Logger::closeFileLocked() {
+    if (file_stream_.is_open()) {
+        file_stream_.flush();
+        file_stream_.close();
+    }
+    mapped_file_.reset();
+    binary_header_written_ = false;
+    binary_formats_written_ = 0;
+}
+
+void Logger::setLogFormat(LogFormat format) {
+    log_format_.store(format);
+    if (format == LogFormat::BINARY && !async_enabled_.load()) {
+        enableAsync();
+    }
+}
+
+uint64_t Logger::binaryTimestamp() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::system_clock::now().time_since_epoch())
+                                     .count());
+}
+
 const char* Logger::getLevelString(LogLevel level) const {
     switch (level) {
         case LogLevel::TRACE:
@@ -99,46 +261,193 @@ const char* Logger::getLevelString(LogLevel level) const {
 }
 
 void Logger::writeLog(LogLevel level, const std::string& message) const {
-    if (level < min_level_.load()) {
+    writeLog(level, message.data(), message.size());
+}
+
+void Logger::writeLog(LogLevel level, const char* message, size_t length) const {
+    if (!isEnabled(level)) {
         return;
     }
+    logRecordsMetric().add();
+
+    if (async_enabled_.load(std::memory_order_acquire)) {
+        enqueueLog(level, message, length);
+    } else {
+        writeDirect(level, message, length);
+    }
+}
+
+void Logger::writeBinary(LogLevel level,
+                         uint32_t format_id,
+                         const char* payload,
+                         size_t size) const {
+    logRecordsMetric().add();
+    if (async_enabled_.load(std::memory_order_acquire)) {
+        enqueueLog(level, payload, size, format_id);
+    } else {
+        writeDirect(level, payload, size, format_id);
+    }
+}
+
+#ifdef __ANDROID__
+static int toAndroidPriority(LogLevel level) {
+    switch (level) {
+        case LogLevel::TRACE:
+            return ANDROID_LOG_VERBOSE;
+        case LogLevel::DEBUG:
+            return ANDROID_LOG_DEBUG;
+        case LogLevel::INFO:
+            return ANDROID_LOG_INFO;
+        case LogLevel::WARN:
+            return ANDROID_LOG_WARN;
+        case LogLevel::ERROR:
+            return ANDROID_LOG_ERROR;
+        case LogLevel::FATAL:
+            return ANDROID_LOG_FATAL;
+    }
+    return ANDROID_LOG_DEBUG;
+}
+#endif
+
+void Logger::writeDirect(LogLevel level,
+                         const char* message,
+                         size_t length,
+                         uint32_t format_id) const {
+    DirectWriteBuffers& buffers = directWriteBuffers();
+
+    // 二进制记录：message 为时间戳 + 编码参数
+    const char* payload = message;
+    size_t payload_size = length;
+    uint64_t timestamp = 0;
+    std::string& decoded = buffers.decoded;
+    decoded.clear();
+    if (format_id != kBinaryLogText) {
+        memcpy(&timestamp, message, sizeof(timestamp));
+        payload += sizeof(timestamp);
+        payload_size -= sizeof(timestamp);
+        if (const char* format = BinaryLogFormats::lookup(format_id)) {
+            formatBinaryLog(format, payload, payload_size, decoded);
+        }
+        message = decoded.data();
+        length = decoded.size();
+    }
+
+    uint64_t monotonic = monotonicTimestamp();
+    uint32_t thread_id = currentThreadId();
 
     if (console_enabled_.load()) {
 #ifdef __ANDROID__
-        int priority = ANDROID_LOG_DEBUG;
-        switch (level) {
-            case LogLevel::TRACE:
-                priority = ANDROID_LOG_VERBOSE;
-                break;
-            case LogLevel::DEBUG:
-                priority = ANDROID_LOG_DEBUG;
-                break;
-            case LogLevel::INFO:
-                priority = ANDROID_LOG_INFO;
-                break;
-            case LogLevel::WARN:
-                priority = ANDROID_LOG_WARN;
-                break;
-            case LogLevel::ERROR:
-                priority = ANDROID_LOG_ERROR;
-                break;
-            case LogLevel::FATAL:
-                priority = ANDROID_LOG_FATAL;
-                break;
-        }
-        __android_log_print(priority, tag_.c_str(), "%s", message.c_str());
+        __android_log_print(
+            toAndroidPriority(level), tag_.c_str(), "%.*s", static_cast<int>(length), message);
 #else
-        printf("[%s][%s] %s\n", getLevelString(level), tag_.c_str(), message.c_str());
+        printf("[%s][%s] %.*s\n",
+               getLevelString(level),
+               tag_.c_str(),
+               static_cast<int>(length),
+               message);
         fflush(stdout);
 #endif
     }
 
     if (file_enabled_.load()) {
-        std::lock_guard<std::mutex> lock(file_mutex_);
-        if (file_stream_.is_open()) {
-            file_stream_ << getLevelString(level) << " " << tag_ << ": " << message << "\n"
-                         << std::flush;
+        std::string& record = buffers.record;
+        record.clear();
+        bool binary = log_format_.load() == LogFormat::BINARY;
+        if (!binary) {
+            appendFileLine(record, level, monotonic, thread_id, message, length);
+        } else if (format_id == kBinaryLogText) {
+            appendBinaryRecord(record, level, format_id, binaryTimestamp(), message, length);
+        } else {
+            appendBinaryRecord(record, level, format_id, timestamp, payload, payload_size);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(file_mutex_);
+            writeFileLocked(record.data(), record.size(), binary, format_id);
+        }
+        recycleBuffer(record);
+    }
+    recycleBuffer(decoded);
+}
+
+void Logger::appendFileLine(std::string& output,
+                            LogLevel level,
+                            uint64_t timestamp,
+                            uint32_t thread_id,
+                            const char* message,
+                            size_t length) const {
+    // 单调时钟秒.纳秒 + 线程ID，便于事后做延迟分析
+    char prefix[64];
+    int prefix_length = snprintf(prefix,
+                                 sizeof(prefix),
+                                 "%llu.%09llu %u ",
+                                 static_cast<unsigned long long>(timestamp / 1000000000ULL),
+                                 static_cast<unsigned long long>(timestamp % 1000000000ULL),
+                                 thread_id);
+    output.append(prefix, static_cast<size_t>(prefix_length));
+    output += getLevelString(level);
+    output += ' ';
+    output += tag_;
+    output += ": ";
+    output.append(message, length);
+    output += '\n';
+}
+
+void Logger::writeFileLocked(const char* data,
+                             size_t size,
+                             bool binary,
+                             uint32_t max_format_id) const {
+    std::string preamble;
+    if (binary) {
+        appendBinaryPreambleLocked(preamble, max_format_id);
+    }
+
+    if (mapped_file_) {
+        // 记录不跨段：放不下时先轮转，二进制模式在新段开头重写文件头和格式串定义；
+        // 新段按实际写入量放大，批次和前导定义超过段大小时也不会截断半条记录
+        if (!mapped_file_->fits(preamble.size() + size)) {
+            if (binary) {
+                binary_header_written_ = false;
+                preamble.clear();
+                appendBinaryPreambleLocked(preamble, max_format_id);
+            }
+            mapped_file_->rotate(preamble.size() + size);
         }
+        mapped_file_->append(preamble.data(), preamble.size());
+        mapped_file_->append(data, size);
+        return;
+    }
+
+    if (file_stream_.is_open()) {
+        file_stream_.write(preamble.data(), static_cast<std::streamsize>(preamble.size()));
+        file_stream_.write(data, static_cast<std::streamsize>(size));
+        file_stream_.flush();
+    }
+}
+
+void Logger::appendBinaryPreambleLocked(std::string& preamble, uint32_t max_format_id) const {
+    if (!binary_header_written_) {
+        char magic[8 + sizeof(kBinaryLogVersion)] = "ATKBLOG";
+        memcpy(magic + 8, &kBinaryLogVersion, sizeof(kBinaryLogVersion));
+        appendBinaryRecord(preamble, LogLevel::TRACE, kBinaryLogFileMagic, 0, magic, sizeof(magic));
+        binary_header_written_ = true;
+        binary_formats_written_ = 0;
+    }
+
+    // 定义写在引用它的记录之前；新文件需要重新写出全部定义
+    uint32_t registered = BinaryLogFormats::count();
+    max_format_id = max_format_id < registered ? max_format_id : registered;
+    while (binary_formats_written_ < max_format_id) {
+        uint32_t id = ++binary_formats_written_;
+        const char* format = BinaryLogFormats::lookup(id);
+        std::string definition(reinterpret_cast<const char*>(&id), sizeof(id));
+        definition += format;
+        appendBinaryRecord(preamble,
+                           LogLevel::TRACE,
+                           kBinaryLogDefinition,
+                           0,
+                           definition.data(),
+                           definition.size());
     }
 }
 
@@ -167,6 +476,16 @@ void Logger::fatal(const std::string& message) const {
 }
 
 void Logger::flush() {
+    if (async_enabled_.load()) {
+        // 等待后台线程处理完调用 flush() 之前入队的所有记录
+        uint64_t target = queue_->enqueued();
+        std::unique_lock<std::mutex> lock(writer_mutex_);
+        flush_target_.store(target);
+        writer_cv_.notify_one();
+        flushed_cv_.wait(lock, [&] { return written_count_ >= target || writer_stop_; });
+    }
+
+    // 映射文件的内容已在页缓存中，无需刷新
     if (file_enabled_.load()) {
         std::lock_guard<std::mutex> lock(file_mutex_);
         if (file_stream_.is_open()) {
@@ -175,4 +494,213 @@ void Logger::flush() {
     }
 }
 
+// ============================================================================
+// 异步模式
+// ============================================================================
+
+bool Logger::enableAsync(const AsyncLogConfig& config) {
+    disableAsync();
+
+    AsyncLogConfig effective = config;
+    if (effective.queue_capacity == 0) {
+        effective.queue_capacity = AsyncLogConfig().queue_capacity;
+    }
+
+    // 队列在进程生命周期内保留：关闭异步模式后仍可能有生产者持有旧指针
+    // 只在容量变化时重建，不要与日志调用并发地修改容量
+    if (!queue_ || async_config_.queue_capacity != effective.queue_capacity) {
+        queue_ = std::make_unique<LogQueue>(effective.queue_capacity);
+    }
+    async_config_ = effective;
+    {
+        std::lock_guard<std::mutex> lock(writer_mutex_);
+        writer_stop_ = false;
+        written_count_ = queue_->consumed();
+        flush_target_.store(written_count_);
+    }
+
+    writer_thread_ = std::thread(&Logger::writerLoop, this);
+    async_enabled_.store(true, std::memory_order_release);
+    return true;
+}
+
+void Logger::disableAsync() {
+    if (!async_enabled_.exchange(false)) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(writer_mutex_);
+        writer_stop_ = true;
+    }
+    writer_cv_.notify_one();
+    if (writer_thread_.joinable()) {
+        writer_thread_.join();
+    }
+    flushed_cv_.notify_all();
+}
+
+void Logger::enqueueLog(LogLevel level,
+                        const char* message,
+                        size_t length,
+                        uint32_t format_id) const {
+    // 时间戳和线程ID在调用线程获取，后台线程写出时保持原始顺序信息
+    uint64_t timestamp = monotonicTimestamp();
+    uint32_t thread_id = currentThreadId();
+    while (!queue_->tryPush(level, format_id, thread_id, timestamp, message, length)) {
+        if (async_config_.overflow_policy != LogOverflowPolicy::BLOCK ||
+            !async_enabled_.load(std::memory_order_relaxed)) {
+            dropped_count_.fetch_add(1, std::memory_order_relaxed);
+            logDroppedMetric().add();
+            return;
+        }
+        // 队列满：唤醒后台线程并让出CPU（加锁避免唤醒丢失，仅在慢路径）
+        {
+            std::lock_guard<std::mutex> lock(writer_mutex_);
+            queue_full_ = true;
+        }
+        writer_cv_.notify_one();
+        std::this_thread::yield();
+    }
+}
+
+void Logger::writerLoop() {
+    std::string console_batch;
+    std::string file_batch;
+    console_batch.reserve(async_config_.batch_bytes);
+    file_batch.reserve(async_config_.batch_bytes);
+    auto interval = std::chrono::milliseconds(std::max<uint32_t>(async_config_.flush_interval_ms, 1));
+
+    while (true) {
+        bool stopping;
+        {
+            std::unique_lock<std::mutex> lock(writer_mutex_);
+            writer_cv_.wait_for(lock, interval, [&] {
+                return writer_stop_ || queue_full_ || flush_target_.load() > written_count_;
+            });
+            queue_full_ = false;
+            stopping = writer_stop_;
+        }
+
+        // 持续排空，直到队列为空
+        while (drainQueue(console_batch, file_batch) > 0) {
+        }
+        writeBatches(console_batch, file_batch);
+
+        if (async_config_.overflow_policy == LogOverflowPolicy::DROP_AND_REPORT) {
+            uint64_t dropped = dropped_count_.load(std::memory_order_relaxed);
+            if (dropped != reported_drops_) {
+                std::string message =
+                    std::to_string(dropped - reported_drops_) + " log records dropped";
+                reported_drops_ = dropped;
+                writeDirect(LogLevel::WARN, message.data(), message.size());
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(writer_mutex_);
+            written_count_ = queue_->consumed();
+            flushed_cv_.notify_all();
+        }
+
+        if (stopping) {
+            break;
+        }
+    }
+}
+
+size_t Logger::drainQueue(std::string& console_batch, std::string& file_batch) {
+    bool console = console_enabled_.load();
+    bool file = file_enabled_.load();
+    bool binary_file = file && log_format_.load() == LogFormat::BINARY;
+    const char* tag = tag_.c_str();
+    std::string decoded;
+
+    size_t count = 0;
+    while (const LogRecord* record = queue_->peek()) {
+        const char* level = getLevelString(record->level);
+        const char* message = record->message;
+        size_t length = record->length;
+
+        if (binary_file) {
+            file_batch_binary_ = true;
+            if (record->format_id == kBinaryLogText) {
+                appendBinaryRecord(
+                    file_batch, record->level, kBinaryLogText, binaryTimestamp(), message, length);
+            } else {
+                uint64_t timestamp;
+                memcpy(&timestamp, message, sizeof(timestamp));
+                appendBinaryRecord(file_batch,
+                                   record->level,
+                                   record->format_id,
+                                   timestamp,
+                                   message + sizeof(timestamp),
+                                   length - sizeof(timestamp));
+                batch_max_format_ = std::max(batch_max_format_, record->format_id);
+            }
+        }
+
+        // 二进制记录在后台线程格式化，只在需要文本输出时解码
+        if (record->format_id != kBinaryLogText && (console || (file && !binary_file))) {
+            decoded.clear();
+            if (const char* format = BinaryLogFormats::lookup(record->format_id)) {
+                formatBinaryLog(format,
+                                record->message + sizeof(uint64_t),
+                                record->length - sizeof(uint64_t),
+                                decoded);
+            }
+            message = decoded.data();
+            length = decoded.size();
+        }
+
+        // 控制台与文件格式与同步模式保持一致
+        if (console) {
+#ifdef __ANDROID__
+            // logcat 没有批量接口，但调用已移出业务线程
+            __android_log_print(toAndroidPriority(record->level),
+                                tag,
+                                "%.*s",
+                                static_cast<int>(length),
+                                message);
+#else
+            console_batch += '[';
+            console_batch += level;
+            console_batch += "][";
+            console_batch += tag;
+            console_batch += "] ";
+            console_batch.append(message, length);
+            console_batch += '\n';
+#endif
+        }
+        if (file && !binary_file) {
+            appendFileLine(
+                file_batch, record->level, record->timestamp, record->thread_id, message, length);
+        }
+        queue_->release();
+        count++;
+
+        if (console_batch.size() >= async_config_.batch_bytes ||
+            file_batch.size() >= async_config_.batch_bytes) {
+            writeBatches(console_batch, file_batch);
+        }
+    }
+    return count;
+}
+
+void Logger::writeBatches(std::string& console_batch, std::string& file_batch) {
+    if (!console_batch.empty()) {
+        fwrite(console_batch.data(), 1, console_batch.size(), stdout);
+        fflush(stdout);
+        console_batch.clear();
+    }
+
+    if (!file_batch.empty()) {
+        std::lock_guard<std::mutex> lock(file_mutex_);
+        writeFileLocked(file_batch.data(), file_batch.size(), file_batch_binary_, batch_max_format_);
+        file_batch.clear();
+        file_batch_binary_ = false;
+        batch_max_format_ = 0;
+    }
+}
+
 }  // namespace AnalysisToolkit
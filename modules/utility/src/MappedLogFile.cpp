@@ -0,0 +1,123 @@
+#include "MappedLogFile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+
+namespace AnalysisToolkit {
+
+MappedLogFile::~MappedLogFile() {
+    close();
+}
+
+bool MappedLogFile::open(const std::string& path, size_t segment_bytes, size_t max_files) {
+    close();
+
+    // 向上取整到页大小
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    path_ = path;
+    segment_bytes_ = (segment_bytes + page - 1) / page * page;
+    max_files_ = max_files == 0 ? 1 : max_files;
+    rotation_count_ = 0;
+
+    if (access(path_.c_str(), F_OK) == 0) {
+        shiftFiles();
+    }
+    return mapSegment();
+}
+
+void MappedLogFile::close() {
+    unmapSegment();
+}
+
+bool MappedLogFile::rotate(size_t min_bytes) {
+    unmapSegment();
+    shiftFiles();
+    rotation_count_++;
+    return mapSegment(min_bytes);
+}
+
+void MappedLogFile::append(const char* data, size_t size) {
+    if (base_ == nullptr) {
+        return;
+    }
+    size = size < capacity_ - used_ ? size : capacity_ - used_;
+    memcpy(base_ + used_, data, size);
+    used_ += size;
+}
+
+bool MappedLogFile::mapSegment(size_t min_bytes) {
+    fd_ = ::open(path_.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        return false;
+    }
+
+    // 单次写入超过段大小时只放大这一个段，后续段恢复配置的大小
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t capacity = segment_bytes_;
+    if (min_bytes > capacity) {
+        capacity = (min_bytes + page - 1) / page * page;
+    }
+
+    // 预分配磁盘块，避免写入映射页时因空间不足触发 SIGBUS
+#if defined(__linux__) || defined(__ANDROID__)
+    bool allocated = posix_fallocate(fd_, 0, static_cast<off_t>(capacity)) == 0;
+#else
+    bool allocated = ftruncate(fd_, static_cast<off_t>(capacity)) == 0;
+#endif
+    if (!allocated) {
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    void* base = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (base == MAP_FAILED) {
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    base_ = static_cast<char*>(base);
+    capacity_ = capacity;
+    used_ = 0;
+    return true;
+}
+
+void MappedLogFile::unmapSegment() {
+    if (base_ != nullptr) {
+        munmap(base_, capacity_);
+        base_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        // 只保留已写入的部分
+        if (ftruncate(fd_, static_cast<off_t>(used_)) != 0) {
+            perror("MappedLogFile: ftruncate");
+        }
+        ::close(fd_);
+        fd_ = -1;
+    }
+    capacity_ = 0;
+    used_ = 0;
+}
+
+void MappedLogFile::shiftFiles() {
+    // path.(N-2) -> path.(N-1), ..., path -> path.1，最旧的文件被覆盖
+    if (max_files_ <= 1) {
+        unlink(path_.c_str());
+        return;
+    }
+    for (size_t index = max_files_ - 1; index > 0; --index) {
+        std::string from = segmentPath(index - 1);
+        rename(from.c_str(), segmentPath(index).c_str());
+    }
+}
+
+std::string MappedLogFile::segmentPath(size_t index) const {
+    return index == 0 ? path_ : path_ + "." + std::to_string(index);
+}
+
+}  // namespace AnalysisToolkit
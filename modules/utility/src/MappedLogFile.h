@@ -0,0 +1,62 @@
+#ifndef ANALYSIS_TOOLKIT_MAPPED_LOG_FILE_H
+#define ANALYSIS_TOOLKIT_MAPPED_LOG_FILE_H
+
+#include <cstddef>
+#include <string>
+
+namespace AnalysisToolkit {
+
+// 预分配并 mmap 的日志段：写入只是 memcpy，写满后轮转为 path.1 ... path.(N-1)
+// 非线程安全，由 Logger 在 file_mutex_ 下访问
+class MappedLogFile {
+  public:
+    MappedLogFile() = default;
+    ~MappedLogFile();
+
+    MappedLogFile(const MappedLogFile&) = delete;
+    MappedLogFile& operator=(const MappedLogFile&) = delete;
+
+    // 打开日志：已有文件先轮转，再映射一个新段
+    bool open(const std::string& path, size_t segment_bytes, size_t max_files);
+
+    // 截掉未使用的尾部并关闭
+    void close();
+
+    bool isOpen() const {
+        return base_ != nullptr;
+    }
+
+    // 当前段剩余空间能否容纳 size 字节
+    bool fits(size_t size) const {
+        return used_ + size <= capacity_;
+    }
+
+    // 关闭当前段并映射新段；min_bytes 超过段大小时新段放大到能容纳它，保证写入不被截断
+    bool rotate(size_t min_bytes = 0);
+
+    // 追加数据，超出段大小的部分被截断（调用方应先检查 fits() 并轮转）
+    void append(const char* data, size_t size);
+
+    size_t rotationCount() const {
+        return rotation_count_;
+    }
+
+  private:
+    bool mapSegment(size_t min_bytes = 0);
+    void unmapSegment();
+    void shiftFiles();
+    std::string segmentPath(size_t index) const;
+
+    std::string path_;
+    size_t segment_bytes_ = 0;
+    size_t max_files_ = 1;
+    int fd_ = -1;
+    char* base_ = nullptr;
+    size_t capacity_ = 0;
+    size_t used_ = 0;
+    size_t rotation_count_ = 0;
+};
+
+}  // namespace AnalysisToolkit
+
+#endif
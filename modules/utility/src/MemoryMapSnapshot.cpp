@@ -0,0 +1,168 @@
+/**
+ * @file MemoryMapSnapshot.cpp
+ * @brief Implementation of the indexed memory map snapshot
+ */
+
+#include "utility/MemoryMapSnapshot.h"
+
+#include <algorithm>
+
+namespace AnalysisToolkit {
+
+namespace {
+
+constexpr size_t kNotFound = static_cast<size_t>(-1);
+
+bool hasPermissions(const MemoryPermissions& region, const MemoryPermissions& required) {
+    return (!required.readable || region.readable) && (!required.writable || region.writable) &&
+           (!required.executable || region.executable) &&
+           (!required.private_mapping || region.private_mapping);
+}
+
+}  // namespace
+
+MemoryMapSnapshot::MemoryMapSnapshot(std::vector<MemoryRegion> regions)
+    : regions_(std::move(regions)) {
+    // The kernel already reports mappings in address order
+    auto by_start = [](const MemoryRegion& a, const MemoryRegion& b) {
+        return a.getStartAddress() < b.getStartAddress();
+    };
+    if (!std::is_sorted(regions_.begin(), regions_.end(), by_start)) {
+        std::stable_sort(regions_.begin(), regions_.end(), by_start);
+    }
+
+    starts_.reserve(regions_.size());
+    for (size_t i = 0; i < regions_.size(); ++i) {
+        starts_.push_back(regions_[i].getStartAddress());
+        // Anonymous regions are indexed under the empty path
+        path_index_[regions_[i].getPathname()].push_back(i);
+    }
+}
+
+ProcessMemoryParser::Result<MemoryMapSnapshot> MemoryMapSnapshot::capture(
+    ProcessMemoryParser& parser,
+    int pid) {
+    auto parse_result = parser.parseProcess(pid);
+    if (parse_result.hasError()) {
+        return ProcessMemoryParser::Result<MemoryMapSnapshot>(parse_result.getError(),
+                                                              parse_result.getErrorMessage());
+    }
+    return ProcessMemoryParser::Result<MemoryMapSnapshot>(
+        MemoryMapSnapshot(std::move(parse_result.getValue())));
+}
+
+ProcessMemoryParser::Result<MemoryMapSnapshot> MemoryMapSnapshot::captureSelf() {
+    ProcessMemoryParser parser;
+    return capture(parser, -1);
+}
+
+size_t MemoryMapSnapshot::lowerIndex(uintptr_t address) const {
+    auto it = std::upper_bound(starts_.begin(), starts_.end(), address);
+    if (it == starts_.begin()) {
+        return kNotFound;
+    }
+    return static_cast<size_t>(it - starts_.begin()) - 1;
+}
+
+const MemoryRegion* MemoryMapSnapshot::find(uintptr_t address) const {
+    size_t index = lowerIndex(address);
+    if (index == kNotFound || !regions_[index].contains(address)) {
+        return nullptr;
+    }
+    return &regions_[index];
+}
+
+std::vector<const MemoryRegion*> MemoryMapSnapshot::findBatch(
+    const std::vector<uintptr_t>& addresses) const {
+    std::vector<const MemoryRegion*> result(addresses.size(), nullptr);
+    if (!std::is_sorted(addresses.begin(), addresses.end())) {
+        for (size_t i = 0; i < addresses.size(); ++i) {
+            result[i] = find(addresses[i]);
+        }
+        return result;
+    }
+
+    // Each search starts where the previous one ended, so the searched range
+    // only shrinks over the batch
+    auto cursor = starts_.begin();
+    for (size_t i = 0; i < addresses.size(); ++i) {
+        cursor = std::upper_bound(cursor, starts_.end(), addresses[i]);
+        if (cursor == starts_.begin()) {
+            continue;
+        }
+        const MemoryRegion& region = regions_[static_cast<size_t>(cursor - starts_.begin()) - 1];
+        if (region.contains(addresses[i])) {
+            result[i] = &region;
+        }
+    }
+    return result;
+}
+
+bool MemoryMapSnapshot::containsRange(uintptr_t address,
+                                      size_t size,
+                                      const MemoryPermissions& required) const {
+    size_t index = lowerIndex(address);
+    if (index == kNotFound || !regions_[index].contains(address)) {
+        return false;
+    }
+
+    uintptr_t end = address + size;
+    if (end < address) {
+        return false;
+    }
+
+    while (true) {
+        const MemoryRegion& region = regions_[index];
+        if (!hasPermissions(region.getPermissions(), required)) {
+            return false;
+        }
+        if (end <= region.getEndAddress()) {
+            return true;
+        }
+        // The next mapping must start exactly where this one ends
+        if (++index == regions_.size() || starts_[index] != region.getEndAddress()) {
+            return false;
+        }
+    }
+}
+
+std::vector<const MemoryRegion*> MemoryMapSnapshot::findByPath(const std::string& pathname,
+                                                               bool exact_match) const {
+    if (exact_match) {
+        auto it = path_index_.find(pathname);
+        return it == path_index_.end() ? std::vector<const MemoryRegion*>() : collect(it->second);
+    }
+
+    // Substring matching scans the distinct paths rather than every region
+    std::vector<size_t> indices;
+    for (const auto& entry : path_index_) {
+        if (entry.first.find(pathname) != std::string::npos) {
+            indices.insert(indices.end(), entry.second.begin(), entry.second.end());
+        }
+    }
+    std::sort(indices.begin(), indices.end());
+    return collect(indices);
+}
+
+std::vector<const MemoryRegion*> MemoryMapSnapshot::findByPermissions(
+    const MemoryPermissions& permissions) const {
+    std::vector<const MemoryRegion*> result;
+    for (const auto& region : regions_) {
+        if (hasPermissions(region.getPermissions(), permissions)) {
+            result.push_back(&region);
+        }
+    }
+    return result;
+}
+
+std::vector<const MemoryRegion*> MemoryMapSnapshot::collect(
+    const std::vector<size_t>& indices) const {
+    std::vector<const MemoryRegion*> result;
+    result.reserve(indices.size());
+    for (size_t index : indices) {
+        result.push_back(&regions_[index]);
+    }
+    return result;
+}
+
+}  // namespace AnalysisToolkit
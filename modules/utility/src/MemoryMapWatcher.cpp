@@ -0,0 +1,152 @@
+/**
+ * @file MemoryMapWatcher.cpp
+ * @brief Implementation of the incremental memory map watcher
+ */
+
+#include "utility/MemoryMapWatcher.h"
+
+#include <cstring>
+#include <string_view>
+#include <utility>
+
+namespace AnalysisToolkit {
+
+namespace {
+
+// Word-at-a-time FNV-1a variant; only needs to detect edits, not resist attacks
+uint64_t checksumText(std::string_view text) {
+    uint64_t hash = 0xcbf29ce484222325ULL ^ text.size();
+    const char* data = text.data();
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= text.size(); i += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * 0x100000001b3ULL;
+        hash ^= hash >> 29;
+    }
+    for (; i < text.size(); ++i) {
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+bool sameBacking(const MemoryRegion& a, const MemoryRegion& b) {
+    return a.getOffset() == b.getOffset() && a.getInode() == b.getInode() &&
+           a.getDevice() == b.getDevice() && a.getPathname() == b.getPathname();
+}
+
+bool samePermissions(const MemoryPermissions& a, const MemoryPermissions& b) {
+    return a.readable == b.readable && a.writable == b.writable && a.executable == b.executable &&
+           a.private_mapping == b.private_mapping;
+}
+
+}  // namespace
+
+MemoryMapWatcher::MemoryMapWatcher(int pid) : pid_(pid) {}
+
+ProcessMemoryParser::Result<MemoryMapDiff> MemoryMapWatcher::poll() {
+    using Result = ProcessMemoryParser::Result<MemoryMapDiff>;
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::shared_ptr<const MemoryMapSnapshot> next;
+    size_t text_size = 0;
+    uint64_t text_checksum = 0;
+
+    auto text = parser_.readMapsText(pid_);
+    if (text.isSuccess()) {
+        text_size = text.getValue().size();
+        text_checksum = checksumText(text.getValue());
+        if (valid_ && text_size == text_size_ && text_checksum == text_checksum_) {
+            return Result(MemoryMapDiff());
+        }
+
+        std::vector<MemoryRegion> regions;
+        parser_.forEachRegionInText(text.getValue(), [&](const MemoryRegionView& view) {
+            regions.push_back(view.toRegion());
+            return true;
+        });
+        next = std::make_shared<const MemoryMapSnapshot>(std::move(regions));
+    } else if (text.getError() == ProcessMemoryParser::ErrorCode::PLATFORM_NOT_SUPPORTED) {
+        // Without a maps file there is nothing cheap to compare; always re-parse
+        auto captured = MemoryMapSnapshot::capture(parser_, pid_);
+        if (captured.hasError()) {
+            return Result(captured.getError(), captured.getErrorMessage());
+        }
+        next = std::make_shared<const MemoryMapSnapshot>(std::move(captured.getValue()));
+    } else {
+        return Result(text.getError(), text.getErrorMessage());
+    }
+
+    MemoryMapDiff changes = diff(snapshot_ ? *snapshot_ : MemoryMapSnapshot(), *next);
+    snapshot_ = std::move(next);
+    text_size_ = text_size;
+    text_checksum_ = text_checksum;
+    valid_ = true;
+    parse_count_++;
+    return Result(std::move(changes));
+}
+
+std::shared_ptr<const MemoryMapSnapshot> MemoryMapWatcher::getSnapshot() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return snapshot_;
+}
+
+void MemoryMapWatcher::setRegionFilter(std::function<bool(const MemoryRegion&)> filter) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    parser_.setRegionFilter(std::move(filter));
+    valid_ = false;
+}
+
+uint64_t MemoryMapWatcher::getParseCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return parse_count_;
+}
+
+MemoryMapDiff MemoryMapWatcher::diff(const MemoryMapSnapshot& before,
+                                     const MemoryMapSnapshot& after) {
+    // Both sides are sorted and non-overlapping, so one merge pass over
+    // (start, end) pairs finds every difference
+    const auto& old_regions = before.getRegions();
+    const auto& new_regions = after.getRegions();
+    MemoryMapDiff result;
+    size_t i = 0;
+    size_t j = 0;
+
+    while (i < old_regions.size() || j < new_regions.size()) {
+        if (j == new_regions.size()) {
+            result.removed.push_back(old_regions[i++]);
+            continue;
+        }
+        if (i == old_regions.size()) {
+            result.added.push_back(new_regions[j++]);
+            continue;
+        }
+
+        const MemoryRegion& old_region = old_regions[i];
+        const MemoryRegion& new_region = new_regions[j];
+        auto old_key = std::make_pair(old_region.getStartAddress(), old_region.getEndAddress());
+        auto new_key = std::make_pair(new_region.getStartAddress(), new_region.getEndAddress());
+
+        if (old_key < new_key) {
+            result.removed.push_back(old_region);
+            i++;
+        } else if (new_key < old_key) {
+            result.added.push_back(new_region);
+            j++;
+        } else {
+            if (!sameBacking(old_region, new_region)) {
+                result.removed.push_back(old_region);
+                result.added.push_back(new_region);
+            } else if (!samePermissions(old_region.getPermissions(),
+                                        new_region.getPermissions())) {
+                result.permission_changed.push_back({old_region, new_region});
+            }
+            i++;
+            j++;
+        }
+    }
+
+    return result;
+}
+
+}  // namespace AnalysisToolkit
@@ -0,0 +1,288 @@
+/**
+ * @file MemoryRegionTable.cpp
+ * @brief Implementation of the compact memory map table
+ */
+
+#include "utility/MemoryRegionTable.h"
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+
+namespace AnalysisToolkit {
+
+namespace {
+
+constexpr StringPool::Id kNoSlot = static_cast<StringPool::Id>(-1);
+constexpr size_t kInitialSlots = 64;
+
+// Permission flags packed into one byte per region
+constexpr uint8_t kReadable = 1 << 0;
+constexpr uint8_t kWritable = 1 << 1;
+constexpr uint8_t kExecutable = 1 << 2;
+constexpr uint8_t kPrivate = 1 << 3;
+
+uint8_t packPermissions(const MemoryPermissions& permissions) {
+    return static_cast<uint8_t>((permissions.readable ? kReadable : 0) |
+                                (permissions.writable ? kWritable : 0) |
+                                (permissions.executable ? kExecutable : 0) |
+                                (permissions.private_mapping ? kPrivate : 0));
+}
+
+template <typename T>
+size_t capacityBytes(const std::vector<T>& values) {
+    return values.capacity() * sizeof(T);
+}
+
+template <typename T>
+void permute(std::vector<T>& values, const std::vector<size_t>& order) {
+    std::vector<T> sorted;
+    sorted.reserve(values.size());
+    for (size_t index : order) {
+        sorted.push_back(values[index]);
+    }
+    values.swap(sorted);
+}
+
+}  // namespace
+
+// ============================================================================
+// StringPool Implementation
+// ============================================================================
+
+StringPool::StringPool() : offsets_{0, 0}, slots_(kInitialSlots, kNoSlot) {
+    slots_[slotFor(std::string_view(), std::hash<std::string_view>()(std::string_view()))] =
+        kEmpty;
+}
+
+size_t StringPool::slotFor(std::string_view text, size_t hash) const {
+    const size_t mask = slots_.size() - 1;
+    size_t slot = hash & mask;
+    while (slots_[slot] != kNoSlot && get(slots_[slot]) != text) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+StringPool::Id StringPool::intern(std::string_view text) {
+    size_t slot = slotFor(text, std::hash<std::string_view>()(text));
+    if (slots_[slot] != kNoSlot) {
+        return slots_[slot];
+    }
+
+    Id id = static_cast<Id>(size());
+    chars_.append(text);
+    offsets_.push_back(static_cast<uint32_t>(chars_.size()));
+    slots_[slot] = id;
+
+    // Keep the load factor at or below one half
+    if (size() * 2 > slots_.size()) {
+        grow();
+    }
+    return id;
+}
+
+std::optional<StringPool::Id> StringPool::find(std::string_view text) const {
+    Id id = slots_[slotFor(text, std::hash<std::string_view>()(text))];
+    if (id == kNoSlot) {
+        return std::nullopt;
+    }
+    return id;
+}
+
+void StringPool::grow() {
+    slots_.assign(slots_.size() * 2, kNoSlot);
+    for (Id id = 0; id < size(); ++id) {
+        std::string_view text = get(id);
+        slots_[slotFor(text, std::hash<std::string_view>()(text))] = id;
+    }
+}
+
+size_t StringPool::memoryUsage() const {
+    return chars_.capacity() + capacityBytes(offsets_) + capacityBytes(slots_);
+}
+
+// ============================================================================
+// MemoryRegionTable Implementation
+// ============================================================================
+
+MemoryRegion MemoryRegionTable::RegionRef::toRegion() const {
+    return MemoryRegion(getStartAddress(),
+                        getEndAddress(),
+                        getPermissions(),
+                        getOffset(),
+                        std::string(getDevice()),
+                        getInode(),
+                        std::string(getPathname()));
+}
+
+MemoryRegionTable::MemoryRegionTable(const std::vector<MemoryRegion>& regions) {
+    reserve(regions.size());
+    for (const auto& region : regions) {
+        append(region.getStartAddress(),
+               region.getEndAddress(),
+               region.getPermissions(),
+               region.getOffset(),
+               region.getDevice(),
+               region.getInode(),
+               region.getPathname());
+    }
+    sortByStart();
+}
+
+ProcessMemoryParser::Result<MemoryRegionTable> MemoryRegionTable::capture(
+    ProcessMemoryParser& parser,
+    int pid) {
+    MemoryRegionTable table;
+    auto result = parser.forEachRegion(
+        [&table](const MemoryRegionView& view) {
+            table.append(view.start_address,
+                         view.end_address,
+                         view.permissions,
+                         view.offset,
+                         view.device,
+                         view.inode,
+                         view.pathname);
+            return true;
+        },
+        pid);
+    if (result.hasError()) {
+        return ProcessMemoryParser::Result<MemoryRegionTable>(result.getError(),
+                                                              result.getErrorMessage());
+    }
+
+    table.sortByStart();
+    return ProcessMemoryParser::Result<MemoryRegionTable>(std::move(table));
+}
+
+void MemoryRegionTable::reserve(size_t count) {
+    starts_.reserve(count);
+    ends_.reserve(count);
+    offsets_.reserve(count);
+    inodes_.reserve(count);
+    path_ids_.reserve(count);
+    device_ids_.reserve(count);
+    permission_bits_.reserve(count);
+}
+
+void MemoryRegionTable::append(uintptr_t start,
+                               uintptr_t end,
+                               const MemoryPermissions& permissions,
+                               uint64_t offset,
+                               std::string_view device,
+                               uint32_t inode,
+                               std::string_view pathname) {
+    starts_.push_back(start);
+    ends_.push_back(end);
+    offsets_.push_back(offset);
+    inodes_.push_back(inode);
+    path_ids_.push_back(strings_.intern(pathname));
+    device_ids_.push_back(strings_.intern(device));
+    permission_bits_.push_back(packPermissions(permissions));
+}
+
+void MemoryRegionTable::sortByStart() {
+    // The kernel already reports mappings in address order
+    if (std::is_sorted(starts_.begin(), starts_.end())) {
+        return;
+    }
+
+    std::vector<size_t> order(size());
+    std::iota(order.begin(), order.end(), size_t{0});
+    std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+        return starts_[a] < starts_[b];
+    });
+    permute(starts_, order);
+    permute(ends_, order);
+    permute(offsets_, order);
+    permute(inodes_, order);
+    permute(path_ids_, order);
+    permute(device_ids_, order);
+    permute(permission_bits_, order);
+}
+
+size_t MemoryRegionTable::find(uintptr_t address) const {
+    auto it = std::upper_bound(starts_.begin(), starts_.end(), address);
+    if (it == starts_.begin()) {
+        return npos;
+    }
+    size_t index = static_cast<size_t>(it - starts_.begin()) - 1;
+    return address < ends_[index] ? index : npos;
+}
+
+std::vector<size_t> MemoryRegionTable::findByPath(std::string_view pathname,
+                                                  bool exact_match) const {
+    std::vector<size_t> result;
+    if (exact_match) {
+        auto id = strings_.find(pathname);
+        if (!id) {
+            return result;
+        }
+        for (size_t i = 0; i < path_ids_.size(); ++i) {
+            if (path_ids_[i] == *id) {
+                result.push_back(i);
+            }
+        }
+        return result;
+    }
+
+    // Substring matching tests each distinct string once, then scans the IDs
+    std::vector<bool> matches(strings_.size());
+    for (StringPool::Id id = 0; id < strings_.size(); ++id) {
+        matches[id] = strings_.get(id).find(pathname) != std::string_view::npos;
+    }
+    for (size_t i = 0; i < path_ids_.size(); ++i) {
+        if (matches[path_ids_[i]]) {
+            result.push_back(i);
+        }
+    }
+    return result;
+}
+
+std::vector<size_t> MemoryRegionTable::findByPermissions(
+    const MemoryPermissions& permissions) const {
+    const uint8_t required = packPermissions(permissions);
+    std::vector<size_t> result;
+    for (size_t i = 0; i < permission_bits_.size(); ++i) {
+        if ((permission_bits_[i] & required) == required) {
+            result.push_back(i);
+        }
+    }
+    return result;
+}
+
+std::vector<MemoryRegion> MemoryRegionTable::toRegions(const std::vector<size_t>& indices) const {
+    std::vector<MemoryRegion> result;
+    result.reserve(indices.size());
+    for (size_t index : indices) {
+        result.push_back(getRegion(index));
+    }
+    return result;
+}
+
+std::vector<MemoryRegion> MemoryRegionTable::toRegions() const {
+    std::vector<MemoryRegion> result;
+    result.reserve(size());
+    for (size_t i = 0; i < size(); ++i) {
+        result.push_back(getRegion(i));
+    }
+    return result;
+}
+
+MemoryPermissions MemoryRegionTable::getPermissions(size_t index) const {
+    uint8_t bits = permission_bits_[index];
+    MemoryPermissions permissions;
+    permissions.readable = (bits & kReadable) != 0;
+    permissions.writable = (bits & kWritable) != 0;
+    permissions.executable = (bits & kExecutable) != 0;
+    permissions.private_mapping = (bits & kPrivate) != 0;
+    return permissions;
+}
+
+size_t MemoryRegionTable::memoryUsage() const {
+    return capacityBytes(starts_) + capacityBytes(ends_) + capacityBytes(offsets_) +
+           capacityBytes(inodes_) + capacityBytes(path_ids_) + capacityBytes(device_ids_) +
+           capacityBytes(permission_bits_) + strings_.memoryUsage();
+}
+
+}  // namespace AnalysisToolkit
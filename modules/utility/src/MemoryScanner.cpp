@@ -0,0 +1,467 @@
+/**
+ * @file MemoryScanner.cpp
+ * @brief Implementation of the parallel byte-pattern scanner
+ */
+
+#include "utility/MemoryScanner.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <sstream>
+
+#include "utility/RemoteMemoryReader.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+namespace AnalysisToolkit {
+
+namespace {
+
+// Regions are split into chunks of this size so that large mappings are
+// spread over the pool
+constexpr size_t kChunkSize = 256 * 1024;
+
+// Above this many distinct anchor bytes the per-block compares cost more than
+// a table lookup per byte
+constexpr size_t kMaxSimdAnchors = 8;
+
+int hexDigit(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+// Parse one nibble; '?' is a wildcard
+bool parseNibble(char c, uint8_t& value, uint8_t& mask) {
+    if (c == '?') {
+        value = 0;
+        mask = 0;
+        return true;
+    }
+    int digit = hexDigit(c);
+    if (digit < 0) {
+        return false;
+    }
+    value = static_cast<uint8_t>(digit);
+    mask = 0xf;
+    return true;
+}
+
+struct Candidate {
+    uint32_t pattern;
+    uint32_t anchor_offset;
+};
+
+// Patterns prepared for one scan, grouped by anchor byte
+struct CompiledPatterns {
+    const std::vector<BytePattern>* patterns = nullptr;
+    std::array<std::vector<Candidate>, 256> by_anchor;
+    std::vector<uint8_t> anchors;  // distinct anchor bytes
+    size_t max_anchor_offset = 0;
+    size_t max_size = 0;
+
+    explicit CompiledPatterns(const std::vector<BytePattern>& source) : patterns(&source) {
+        for (size_t i = 0; i < source.size(); ++i) {
+            size_t offset = chooseAnchor(source[i]);
+            uint8_t byte = source[i].getBytes()[offset];
+            if (by_anchor[byte].empty()) {
+                anchors.push_back(byte);
+            }
+            by_anchor[byte].push_back({static_cast<uint32_t>(i), static_cast<uint32_t>(offset)});
+            max_anchor_offset = std::max(max_anchor_offset, offset);
+            max_size = std::max(max_size, source[i].size());
+        }
+    }
+
+    // The earliest fully specified byte, skipping 0x00 and 0xff which fill
+    // padding and tables and would produce a candidate at almost every byte
+    static size_t chooseAnchor(const BytePattern& pattern) {
+        const auto& bytes = pattern.getBytes();
+        const auto& mask = pattern.getMask();
+        size_t fallback = bytes.size();
+        for (size_t i = 0; i < bytes.size(); ++i) {
+            if (mask[i] != 0xff) {
+                continue;
+            }
+            if (bytes[i] != 0x00 && bytes[i] != 0xff) {
+                return i;
+            }
+            if (fallback == bytes.size()) {
+                fallback = i;
+            }
+        }
+        return fallback;
+    }
+};
+
+// Call on(p) for every p in [begin, end) whose byte is an anchor byte
+template <typename OnCandidate>
+void findAnchors(const uint8_t* begin,
+                 const uint8_t* end,
+                 const CompiledPatterns& compiled,
+                 OnCandidate&& on) {
+    const uint8_t* p = begin;
+    const size_t anchor_count = compiled.anchors.size();
+
+#if defined(__SSE2__)
+    if (anchor_count <= kMaxSimdAnchors) {
+        __m128i needles[kMaxSimdAnchors];
+        for (size_t k = 0; k < anchor_count; ++k) {
+            needles[k] = _mm_set1_epi8(static_cast<char>(compiled.anchors[k]));
+        }
+        for (; p + 16 <= end; p += 16) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            __m128i hits = _mm_cmpeq_epi8(block, needles[0]);
+            for (size_t k = 1; k < anchor_count; ++k) {
+                hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, needles[k]));
+            }
+            uint32_t bits = static_cast<uint32_t>(_mm_movemask_epi8(hits));
+            while (bits != 0) {
+                on(p + __builtin_ctz(bits));
+                bits &= bits - 1;
+            }
+        }
+    }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    if (anchor_count <= kMaxSimdAnchors) {
+        uint8x16_t needles[kMaxSimdAnchors];
+        for (size_t k = 0; k < anchor_count; ++k) {
+            needles[k] = vdupq_n_u8(compiled.anchors[k]);
+        }
+        for (; p + 16 <= end; p += 16) {
+            uint8x16_t block = vld1q_u8(p);
+            uint8x16_t hits = vceqq_u8(block, needles[0]);
+            for (size_t k = 1; k < anchor_count; ++k) {
+                hits = vorrq_u8(hits, vceqq_u8(block, needles[k]));
+            }
+            // Narrow to one nibble per byte so the mask fits in 64 bits
+            uint64_t bits = vget_lane_u64(
+                vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(hits), 4)), 0);
+            while (bits != 0) {
+                unsigned bit = static_cast<unsigned>(__builtin_ctzll(bits));
+                on(p + (bit >> 2));
+                bits &= ~(uint64_t{0xf} << (bit & ~3u));
+            }
+        }
+    }
+#endif
+
+    for (; p < end; ++p) {
+        if (!compiled.by_anchor[*p].empty()) {
+            on(p);
+        }
+    }
+}
+
+struct ScanChunk {
+    const MemoryRegion* region;
+    uintptr_t begin;  // match start addresses owned by this chunk
+    uintptr_t end;
+};
+
+bool isScannable(const MemoryRegion& region) {
+    // [vvar] is readable but parts of it fault on access
+    return region.getPermissions().readable && region.getSize() > 0 &&
+           region.getPathname().compare(0, 5, "[vvar") != 0;
+}
+
+}  // namespace
+
+// ============================================================================
+// BytePattern Implementation
+// ============================================================================
+
+std::optional<BytePattern> BytePattern::parse(const std::string& signature) {
+    std::vector<uint8_t> bytes;
+    std::vector<uint8_t> mask;
+    std::istringstream iss(signature);
+    std::string token;
+
+    while (iss >> token) {
+        if (token == "?" || token == "??") {
+            bytes.push_back(0);
+            mask.push_back(0);
+            continue;
+        }
+        uint8_t high, high_mask, low, low_mask;
+        if (token.size() != 2 || !parseNibble(token[0], high, high_mask) ||
+            !parseNibble(token[1], low, low_mask)) {
+            return std::nullopt;
+        }
+        bytes.push_back(static_cast<uint8_t>(high << 4 | low));
+        mask.push_back(static_cast<uint8_t>(high_mask << 4 | low_mask));
+    }
+
+    return fromBytes(bytes, mask);
+}
+
+std::optional<BytePattern> BytePattern::fromBytes(const std::vector<uint8_t>& bytes,
+                                                  const std::vector<uint8_t>& mask) {
+    if (!mask.empty() && mask.size() != bytes.size()) {
+        return std::nullopt;
+    }
+
+    BytePattern pattern;
+    pattern.mask_ = mask.empty() ? std::vector<uint8_t>(bytes.size(), 0xff) : mask;
+    pattern.bytes_.resize(bytes.size());
+    bool has_anchor = false;
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        pattern.bytes_[i] = bytes[i] & pattern.mask_[i];
+        has_anchor = has_anchor || pattern.mask_[i] == 0xff;
+    }
+
+    if (!has_anchor) {
+        return std::nullopt;
+    }
+    return pattern;
+}
+
+bool BytePattern::matches(const uint8_t* data) const {
+    for (size_t i = 0; i < bytes_.size(); ++i) {
+        if ((data[i] & mask_[i]) != bytes_[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+// MemoryScanner Implementation
+// ============================================================================
+
+struct MemoryScanner::ScanJob {
+    const CompiledPatterns* compiled;
+    RemoteMemoryReader* reader;  // nullptr for local scans
+    std::vector<ScanChunk> chunks;
+    std::atomic<size_t> next_chunk{0};
+    std::atomic<bool> stopped{false};
+
+    const MatchCallback* callback;
+    std::mutex callback_mutex;
+    size_t delivered = 0;
+};
+
+MemoryScanner::MemoryScanner(size_t thread_count) {
+    if (thread_count == 0) {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workers_.reserve(thread_count - 1);
+    for (size_t i = 1; i < thread_count; ++i) {
+        workers_.emplace_back(&MemoryScanner::workerLoop, this);
+    }
+}
+
+MemoryScanner::~MemoryScanner() {
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        shutdown_ = true;
+    }
+    job_ready_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+size_t MemoryScanner::addPattern(const BytePattern& pattern) {
+    std::lock_guard<std::mutex> lock(scan_mutex_);
+    patterns_.push_back(pattern);
+    return patterns_.size() - 1;
+}
+
+std::optional<size_t> MemoryScanner::addPattern(const std::string& signature) {
+    auto pattern = BytePattern::parse(signature);
+    if (!pattern.has_value()) {
+        return std::nullopt;
+    }
+    return addPattern(*pattern);
+}
+
+void MemoryScanner::clearPatterns() {
+    std::lock_guard<std::mutex> lock(scan_mutex_);
+    patterns_.clear();
+}
+
+size_t MemoryScanner::getPatternCount() const {
+    std::lock_guard<std::mutex> lock(scan_mutex_);
+    return patterns_.size();
+}
+
+size_t MemoryScanner::scan(const std::vector<MemoryRegion>& regions,
+                           const MatchCallback& callback) {
+    return runScan(nullptr, regions, callback);
+}
+
+size_t MemoryScanner::scan(RemoteMemoryReader& reader,
+                           const std::vector<MemoryRegion>& regions,
+                           const MatchCallback& callback) {
+    return runScan(&reader, regions, callback);
+}
+
+size_t MemoryScanner::runScan(RemoteMemoryReader* reader,
+                              const std::vector<MemoryRegion>& regions,
+                              const MatchCallback& callback) {
+    std::lock_guard<std::mutex> scan_lock(scan_mutex_);
+    if (patterns_.empty() || !callback) {
+        return 0;
+    }
+
+    // CompiledPatterns holds 256 vectors; keep it off the stack
+    auto compiled = std::make_unique<CompiledPatterns>(patterns_);
+    ScanJob job;
+    job.compiled = compiled.get();
+    job.reader = reader;
+    job.callback = &callback;
+    for (const auto& region : regions) {
+        if (!isScannable(region)) {
+            continue;
+        }
+        for (uintptr_t begin = region.getStartAddress(); begin < region.getEndAddress();) {
+            uintptr_t end = begin + std::min<uintptr_t>(kChunkSize, region.getEndAddress() - begin);
+            job.chunks.push_back({&region, begin, end});
+            begin = end;
+        }
+    }
+    if (job.chunks.empty()) {
+        return 0;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        job_ = &job;
+        generation_++;
+    }
+    job_ready_.notify_all();
+
+    runJob(job);
+
+    // Workers that never picked the job up see job_ == nullptr and skip it
+    std::unique_lock<std::mutex> lock(pool_mutex_);
+    job_done_.wait(lock, [this] { return busy_workers_ == 0; });
+    job_ = nullptr;
+    return job.delivered;
+}
+
+ProcessMemoryParser::Result<size_t> MemoryScanner::scanProcess(ProcessMemoryParser& parser,
+                                                               const MatchCallback& callback) {
+    auto parse_result = parser.parseSelf();
+    if (parse_result.hasError()) {
+        return ProcessMemoryParser::Result<size_t>(parse_result.getError(),
+                                                   parse_result.getErrorMessage());
+    }
+    return ProcessMemoryParser::Result<size_t>(scan(parse_result.getValue(), callback));
+}
+
+ProcessMemoryParser::Result<size_t> MemoryScanner::scanProcess(RemoteMemoryReader& reader,
+                                                               ProcessMemoryParser& parser,
+                                                               const MatchCallback& callback) {
+    auto parse_result = parser.parseProcess(reader.getPid());
+    if (parse_result.hasError()) {
+        return ProcessMemoryParser::Result<size_t>(parse_result.getError(),
+                                                   parse_result.getErrorMessage());
+    }
+    return ProcessMemoryParser::Result<size_t>(scan(reader, parse_result.getValue(), callback));
+}
+
+void MemoryScanner::workerLoop() {
+    uint64_t seen = 0;
+    while (true) {
+        ScanJob* job = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(pool_mutex_);
+            job_ready_.wait(lock, [&] { return shutdown_ || generation_ != seen; });
+            if (shutdown_) {
+                return;
+            }
+            seen = generation_;
+            job = job_;
+            if (job == nullptr) {
+                continue;
+            }
+            busy_workers_++;
+        }
+
+        runJob(*job);
+
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        if (--busy_workers_ == 0) {
+            job_done_.notify_all();
+        }
+    }
+}
+
+void MemoryScanner::runJob(ScanJob& job) {
+    const CompiledPatterns& compiled = *job.compiled;
+    const std::vector<BytePattern>& patterns = *compiled.patterns;
+    std::vector<ScanMatch> matches;
+    std::vector<uint8_t> copy;
+
+    while (!job.stopped.load(std::memory_order_relaxed)) {
+        size_t index = job.next_chunk.fetch_add(1, std::memory_order_relaxed);
+        if (index >= job.chunks.size()) {
+            break;
+        }
+        const ScanChunk& chunk = job.chunks[index];
+        const uintptr_t region_end = chunk.region->getEndAddress();
+
+        // Anchors of matches starting in this chunk may lie past its end
+        uintptr_t window_end = std::min<uintptr_t>(chunk.end + compiled.max_anchor_offset,
+                                                   region_end);
+
+        // base holds the bytes at chunk.begin: the memory itself, or a copy
+        // that also covers the tail of the longest pattern
+        const uint8_t* base = reinterpret_cast<const uint8_t*>(chunk.begin);
+        if (job.reader != nullptr) {
+            uintptr_t copy_end = std::min<uintptr_t>(chunk.end + compiled.max_size, region_end);
+            copy.resize(copy_end - chunk.begin);
+            if (job.reader->read(chunk.begin, copy.data(), copy.size()).hasError()) {
+                continue;
+            }
+            base = copy.data();
+        }
+
+        matches.clear();
+        findAnchors(base, base + (window_end - chunk.begin), compiled, [&](const uint8_t* p) {
+            uintptr_t anchor = chunk.begin + static_cast<uintptr_t>(p - base);
+            for (const Candidate& candidate : compiled.by_anchor[*p]) {
+                if (anchor < chunk.begin + candidate.anchor_offset) {
+                    continue;
+                }
+                uintptr_t start = anchor - candidate.anchor_offset;
+                const BytePattern& pattern = patterns[candidate.pattern];
+                if (start >= chunk.end || pattern.size() > region_end - start) {
+                    continue;
+                }
+                if (pattern.matches(base + (start - chunk.begin))) {
+                    matches.push_back({candidate.pattern, start, chunk.region});
+                }
+            }
+        });
+
+        if (matches.empty()) {
+            continue;
+        }
+        std::lock_guard<std::mutex> lock(job.callback_mutex);
+        for (const auto& match : matches) {
+            if (job.stopped.load(std::memory_order_relaxed)) {
+                break;
+            }
+            job.delivered++;
+            if (!(*job.callback)(match)) {
+                job.stopped.store(true, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+}  // namespace AnalysisToolkit
@@ -0,0 +1,430 @@
+#include "utility/Metrics.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <thread>
+
+#if defined(__linux__) || defined(__ANDROID__)
+#include <sys/syscall.h>
+#elif defined(__APPLE__)
+#include <pthread.h>
+#endif
+
+namespace AnalysisToolkit {
+
+namespace {
+
+constexpr size_t kDescriptorOffset = sizeof(MetricsSegmentHeader);
+constexpr size_t kSlotOffset = kDescriptorOffset + sizeof(MetricDescriptor) * kMaxMetrics;
+constexpr size_t kSegmentSize = kSlotOffset + sizeof(MetricThreadSlot) * kMaxMetricThreads;
+
+static_assert(kSlotOffset % alignof(MetricThreadSlot) == 0, "misaligned metric slots");
+
+// 读者等待合并完成的最大重试次数；导出进程在合并中途崩溃时返回最后一次读到的值
+constexpr int kMaxReadAttempts = 1000;
+
+struct SegmentView {
+    const MetricsSegmentHeader* header;
+    const MetricDescriptor* descriptors;
+    const MetricThreadSlot* slots;
+};
+
+SegmentView viewOf(const char* base) {
+    return {reinterpret_cast<const MetricsSegmentHeader*>(base),
+            reinterpret_cast<const MetricDescriptor*>(base + kDescriptorOffset),
+            reinterpret_cast<const MetricThreadSlot*>(base + kSlotOffset)};
+}
+
+// 按 seqlock 规则汇总：公共槽位 + 所有线程槽位；仪表值只取公共槽位
+std::vector<MetricSample> readSegment(const SegmentView& view) {
+    std::vector<MetricSample> samples;
+    for (int attempt = 0; attempt < kMaxReadAttempts; ++attempt) {
+        uint64_t sequence = view.header->retire_sequence.load(std::memory_order_acquire);
+        if ((sequence & 1) != 0) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        uint32_t count = std::min<uint32_t>(
+            view.header->metric_count.load(std::memory_order_acquire), kMaxMetrics);
+        uint32_t slots = std::min<uint32_t>(
+            view.header->slot_count.load(std::memory_order_acquire), kMaxMetricThreads);
+        samples.assign(count, MetricSample());
+        for (uint32_t id = 0; id < count; ++id) {
+            const MetricDescriptor& descriptor = view.descriptors[id];
+            samples[id].name.assign(descriptor.name, strnlen(descriptor.name, kMetricNameSize));
+            samples[id].kind = static_cast<MetricKind>(descriptor.kind);
+            samples[id].value = view.slots[0].values[id].load(std::memory_order_relaxed);
+        }
+        for (uint32_t slot = 1; slot < slots; ++slot) {
+            for (uint32_t id = 0; id < count; ++id) {
+                if (samples[id].kind == MetricKind::COUNTER) {
+                    const std::atomic<uint64_t>& value = view.slots[slot].values[id];
+                    samples[id].value += value.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (view.header->retire_sequence.load(std::memory_order_relaxed) == sequence) {
+            break;
+        }
+    }
+    return samples;
+}
+
+uint32_t metricsThreadId() {
+    uint32_t thread_id;
+#if defined(__linux__) || defined(__ANDROID__)
+    thread_id = static_cast<uint32_t>(syscall(SYS_gettid));
+#elif defined(__APPLE__)
+    uint64_t id = 0;
+    pthread_threadid_np(nullptr, &id);
+    thread_id = static_cast<uint32_t>(id);
+#else
+    thread_id = static_cast<uint32_t>(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+#endif
+    return thread_id != 0 ? thread_id : 1;  // 0 表示空闲槽位
+}
+
+}  // namespace
+
+struct MetricsRegistry::Segment {
+    std::string path;
+    char* base = nullptr;
+    MetricsSegmentHeader* header = nullptr;
+    MetricDescriptor* descriptors = nullptr;
+    MetricThreadSlot* slots = nullptr;
+};
+
+// 线程缓存的槽位，线程退出时把计数并入公共槽位
+struct MetricsRegistry::ThreadHandle {
+    Segment* segment = nullptr;
+    MetricThreadSlot* slot = nullptr;
+    bool shared = false;
+
+    ~ThreadHandle() {
+        if (slot != nullptr && !shared) {
+            MetricsRegistry::getInstance().releaseSlot(segment, slot);
+        }
+    }
+};
+
+std::atomic<bool> MetricsRegistry::recording_{false};
+
+// 不析构，避免进程退出时线程局部对象访问已销毁的注册表
+MetricsRegistry& MetricsRegistry::getInstance() {
+    static MetricsRegistry* instance = new MetricsRegistry();
+    return *instance;
+}
+
+bool MetricsRegistry::open(const std::string& path) {
+    std::string segment_path = path.empty() ? defaultPath(getpid()) : path;
+
+    int fd = ::open(segment_path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    if (ftruncate(fd, static_cast<off_t>(kSegmentSize)) != 0) {
+        ::close(fd);
+        unlink(segment_path.c_str());
+        return false;
+    }
+    void* memory = mmap(nullptr, kSegmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED) {
+        unlink(segment_path.c_str());
+        return false;
+    }
+
+    auto* segment = new Segment();
+    segment->path = segment_path;
+    segment->base = static_cast<char*>(memory);
+    segment->header = new (segment->base) MetricsSegmentHeader();
+    segment->descriptors =
+        reinterpret_cast<MetricDescriptor*>(segment->base + kDescriptorOffset);
+    segment->slots = reinterpret_cast<MetricThreadSlot*>(segment->base + kSlotOffset);
+    for (size_t index = 0; index < kMaxMetricThreads; ++index) {
+        new (&segment->slots[index]) MetricThreadSlot();
+    }
+
+    MetricsSegmentHeader* header = segment->header;
+    header->version = kMetricsVersion;
+    header->header_size = sizeof(MetricsSegmentHeader);
+    header->max_metrics = kMaxMetrics;
+    header->max_threads = kMaxMetricThreads;
+    header->segment_size = kSegmentSize;
+    header->pid = static_cast<int32_t>(getpid());
+    header->start_time_ns = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch())
+            .count());
+    header->slot_count.store(1, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t registered = metric_count_.load(std::memory_order_relaxed);
+    for (MetricId id = 0; id < registered; ++id) {
+        publishDescriptor(segment, id);
+        if (kinds_[id] == MetricKind::GAUGE) {
+            segment->slots[0].values[id].store(
+                static_cast<uint64_t>(gauges_[id].load(std::memory_order_relaxed)),
+                std::memory_order_relaxed);
+        }
+    }
+    header->metric_count.store(registered, std::memory_order_release);
+    header->magic.store(kMetricsMagic, std::memory_order_release);
+
+    Segment* previous = segment_.exchange(segment, std::memory_order_acq_rel);
+    if (previous != nullptr) {
+        if (previous->path != segment_path) {
+            unlink(previous->path.c_str());
+        }
+        closed_segments_.push_back(previous);
+    }
+    recording_.store(true, std::memory_order_release);
+    return true;
+}
+
+void MetricsRegistry::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    recording_.store(false, std::memory_order_release);
+    Segment* segment = segment_.exchange(nullptr, std::memory_order_acq_rel);
+    if (segment != nullptr) {
+        unlink(segment->path.c_str());
+        closed_segments_.push_back(segment);
+    }
+}
+
+std::string MetricsRegistry::getPath() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Segment* segment = segment_.load(std::memory_order_acquire);
+    return segment != nullptr ? segment->path : std::string();
+}
+
+std::string MetricsRegistry::defaultPath(int pid) {
+#ifdef __ANDROID__
+    std::string directory = "/data/local/tmp";
+#else
+    std::string directory;
+    if (access("/dev/shm", W_OK) == 0) {
+        directory = "/dev/shm";
+    } else {
+        const char* tmpdir = getenv("TMPDIR");
+        directory = tmpdir != nullptr && tmpdir[0] != '\0' ? tmpdir : "/tmp";
+    }
+#endif
+    return directory + "/atkit-metrics-" + std::to_string(pid);
+}
+
+MetricId MetricsRegistry::registerMetric(const char* name, MetricKind kind) {
+    std::string key(name != nullptr ? name : "");
+    key.resize(std::min(key.size(), kMetricNameSize - 1));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t registered = metric_count_.load(std::memory_order_relaxed);
+    for (MetricId id = 0; id < registered; ++id) {
+        if (names_[id] == key) {
+            return id;
+        }
+    }
+    if (registered >= kMaxMetrics) {
+        return kInvalidMetricId;
+    }
+
+    MetricId id = registered;
+    names_[id] = key;
+    kinds_[id] = kind;
+    metric_count_.store(id + 1, std::memory_order_release);
+
+    Segment* segment = segment_.load(std::memory_order_acquire);
+    if (segment != nullptr) {
+        publishDescriptor(segment, id);
+        segment->header->metric_count.store(id + 1, std::memory_order_release);
+    }
+    return id;
+}
+
+void MetricsRegistry::publishDescriptor(Segment* segment, MetricId id) {
+    MetricDescriptor& descriptor = segment->descriptors[id];
+    std::memset(&descriptor, 0, sizeof(descriptor));
+    std::memcpy(descriptor.name, names_[id].data(), names_[id].size());
+    descriptor.kind = static_cast<uint32_t>(kinds_[id]);
+}
+
+MetricThreadSlot* MetricsRegistry::threadSlot(Segment* segment, bool& shared) {
+    thread_local ThreadHandle handle;
+    if (handle.segment == segment) {
+        shared = handle.shared;
+        return handle.slot;
+    }
+
+    // 段已重新打开：交还旧段中的槽位，再在新段中申请
+    if (handle.slot != nullptr && !handle.shared) {
+        releaseSlot(handle.segment, handle.slot);
+    }
+    handle.segment = segment;
+    handle.slot = &segment->slots[0];
+    handle.shared = true;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t index = 1; index < kMaxMetricThreads; ++index) {
+        MetricThreadSlot& slot = segment->slots[index];
+        if (slot.thread_id.load(std::memory_order_relaxed) == 0) {
+            slot.thread_id.store(metricsThreadId(), std::memory_order_relaxed);
+            uint32_t used = static_cast<uint32_t>(index + 1);
+            if (segment->header->slot_count.load(std::memory_order_relaxed) < used) {
+                segment->header->slot_count.store(used, std::memory_order_release);
+            }
+            handle.slot = &slot;
+            handle.shared = false;
+            break;
+        }
+    }
+    shared = handle.shared;
+    return handle.slot;
+}
+
+void MetricsRegistry::releaseSlot(Segment* segment, MetricThreadSlot* slot) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    MetricsSegmentHeader* header = segment->header;
+    uint64_t sequence = header->retire_sequence.load(std::memory_order_relaxed);
+    header->retire_sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    uint32_t registered = metric_count_.load(std::memory_order_relaxed);
+    for (MetricId id = 0; id < registered; ++id) {
+        uint64_t value = slot->values[id].load(std::memory_order_relaxed);
+        if (value != 0) {
+            segment->slots[0].values[id].fetch_add(value, std::memory_order_relaxed);
+            slot->values[id].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    header->retire_sequence.store(sequence + 2, std::memory_order_release);
+    slot->thread_id.store(0, std::memory_order_release);
+}
+
+void MetricsRegistry::add(MetricId id, uint64_t delta) {
+    Segment* segment = segment_.load(std::memory_order_acquire);
+    if (segment == nullptr || id >= kMaxMetrics) {
+        return;
+    }
+    bool shared = false;
+    MetricThreadSlot* slot = threadSlot(segment, shared);
+    std::atomic<uint64_t>& value = slot->values[id];
+    if (shared) {
+        value.fetch_add(delta, std::memory_order_relaxed);
+    } else {
+        // 只由所属线程写入，无需原子读改写
+        value.store(value.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+}
+
+void MetricsRegistry::set(MetricId id, int64_t value) {
+    if (id >= kMaxMetrics) {
+        return;
+    }
+    gauges_[id].store(value, std::memory_order_relaxed);
+    Segment* segment = segment_.load(std::memory_order_acquire);
+    if (segment != nullptr) {
+        segment->slots[0].values[id].store(static_cast<uint64_t>(value),
+                                           std::memory_order_relaxed);
+    }
+}
+
+void MetricsRegistry::addGauge(MetricId id, int64_t delta) {
+    if (id >= kMaxMetrics) {
+        return;
+    }
+    gauges_[id].fetch_add(delta, std::memory_order_relaxed);
+    Segment* segment = segment_.load(std::memory_order_acquire);
+    if (segment != nullptr) {
+        // 写入最新值而不是增量，并发更新时段中的值最终与本地一致
+        int64_t current = gauges_[id].load(std::memory_order_relaxed);
+        segment->slots[0].values[id].store(static_cast<uint64_t>(current),
+                                           std::memory_order_relaxed);
+    }
+}
+
+std::vector<MetricSample> MetricsRegistry::collect() const {
+    Segment* segment = segment_.load(std::memory_order_acquire);
+    if (segment == nullptr) {
+        return {};
+    }
+    return readSegment(viewOf(segment->base));
+}
+
+// ============================================================================
+// MetricsReader
+// ============================================================================
+
+MetricsReader::~MetricsReader() {
+    close();
+}
+
+bool MetricsReader::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || static_cast<size_t>(file_stat.st_size) < kSegmentSize) {
+        ::close(fd);
+        return false;
+    }
+    void* memory = mmap(nullptr, kSegmentSize, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED) {
+        return false;
+    }
+
+    const auto* header = static_cast<const MetricsSegmentHeader*>(memory);
+    if (header->magic.load(std::memory_order_acquire) != kMetricsMagic ||
+        header->version != kMetricsVersion ||
+        header->header_size != sizeof(MetricsSegmentHeader) ||
+        header->max_metrics != kMaxMetrics || header->max_threads != kMaxMetricThreads ||
+        header->segment_size != kSegmentSize) {
+        munmap(memory, kSegmentSize);
+        return false;
+    }
+
+    base_ = static_cast<const char*>(memory);
+    size_ = kSegmentSize;
+    return true;
+}
+
+void MetricsReader::close() {
+    if (base_ != nullptr) {
+        munmap(const_cast<char*>(base_), size_);
+        base_ = nullptr;
+        size_ = 0;
+    }
+}
+
+int MetricsReader::getPid() const {
+    return base_ != nullptr ? viewOf(base_).header->pid : -1;
+}
+
+uint64_t MetricsReader::getStartTimeNs() const {
+    return base_ != nullptr ? viewOf(base_).header->start_time_ns : 0;
+}
+
+std::vector<MetricSample> MetricsReader::read() const {
+    if (base_ == nullptr) {
+        return {};
+    }
+    return readSegment(viewOf(base_));
+}
+
+}  // namespace AnalysisToolkit
@@ -0,0 +1,218 @@
+/**
+ * @file ModuleIndex.cpp
+ * @brief Implementation of the cached module/range index
+ */
+
+#include "utility/ModuleIndex.h"
+
+#include <algorithm>
+#include <map>
+
+#include <unistd.h>
+
+#include "utility/ProcessMemoryParser.h"
+
+// Platform-specific includes
+#if defined(__linux__) || defined(__ANDROID__)
+#include <link.h>
+#elif __APPLE__
+#include <mach-o/dyld.h>
+#endif
+
+namespace AnalysisToolkit {
+
+namespace {
+
+// FNV-1a style mixing of a 64-bit value into the running hash
+uint64_t mixHash(uint64_t hash, uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        hash ^= (value >> (i * 8)) & 0xff;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+std::string baseName(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+#if defined(__linux__) || defined(__ANDROID__)
+int fingerprintCallback(struct dl_phdr_info* info, size_t /*size*/, void* data) {
+    uint64_t* hash = static_cast<uint64_t*>(data);
+    *hash = mixHash(*hash, static_cast<uint64_t>(info->dlpi_addr));
+    *hash = mixHash(*hash, static_cast<uint64_t>(info->dlpi_phnum));
+    return 0;
+}
+#endif
+
+}  // namespace
+
+ModuleIndex::ModuleIndex(int pid) : pid_(pid <= 0 || pid == getpid() ? -1 : pid) {}
+
+ModuleIndex& ModuleIndex::getInstance() {
+    static ModuleIndex instance;
+    return instance;
+}
+
+uint64_t ModuleIndex::computeFingerprint() {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+#if defined(__linux__) || defined(__ANDROID__)
+    dl_iterate_phdr(fingerprintCallback, &hash);
+#elif __APPLE__
+    uint32_t count = _dyld_image_count();
+    hash = mixHash(hash, count);
+    for (uint32_t i = 0; i < count; ++i) {
+        hash = mixHash(hash, reinterpret_cast<uint64_t>(_dyld_get_image_header(i)));
+    }
+#endif
+    return hash;
+}
+
+std::optional<ModuleInfo> ModuleIndex::findModule(const std::string& name) {
+    if (name.empty()) {
+        return std::nullopt;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    bool rebuilt = !valid_ || fingerprint_ != currentFingerprint();
+    if (rebuilt && !rebuildLocked()) {
+        return std::nullopt;
+    }
+
+    const ModuleInfo* module = findModuleLocked(name);
+    if (module == nullptr && !rebuilt) {
+        // The module may have been mapped without going through the loader
+        if (!rebuildLocked()) {
+            return std::nullopt;
+        }
+        module = findModuleLocked(name);
+    }
+
+    if (module == nullptr) {
+        return std::nullopt;
+    }
+    return *module;
+}
+
+std::optional<ModuleInfo> ModuleIndex::findModuleContaining(uintptr_t address) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!ensureFreshLocked()) {
+        return std::nullopt;
+    }
+
+    for (const auto& module : modules_) {
+        if (module.contains(address)) {
+            return module;
+        }
+    }
+    return std::nullopt;
+}
+
+std::vector<ModuleInfo> ModuleIndex::getModules() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!ensureFreshLocked()) {
+        return {};
+    }
+    return modules_;
+}
+
+bool ModuleIndex::refresh() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return rebuildLocked();
+}
+
+void ModuleIndex::invalidate() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    valid_ = false;
+}
+
+uint64_t ModuleIndex::getRebuildCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return rebuild_count_;
+}
+
+bool ModuleIndex::ensureFreshLocked() {
+    if (valid_ && fingerprint_ == currentFingerprint()) {
+        return true;
+    }
+    return rebuildLocked();
+}
+
+bool ModuleIndex::rebuildLocked() {
+    // Take the fingerprint first so a concurrent load is caught on the next check
+    uint64_t fingerprint = currentFingerprint();
+
+    // Every file-backed mapping has an absolute path
+    ProcessMemoryParser parser;
+    auto result = parser.findRegionsByPath("/", pid_);
+    if (result.hasError()) {
+        valid_ = false;
+        return false;
+    }
+
+    std::map<std::string, ModuleInfo> by_path;
+    for (const auto& region : result.getValue()) {
+        const std::string& path = region.getPathname();
+        if (path.empty() || path[0] != '/') {
+            continue;
+        }
+        // Loaded images are always private. Shared file mappings are data (such as an
+        // exported metrics segment) and may sit at scattered addresses under one path
+        if (!region.getPermissions().private_mapping) {
+            continue;
+        }
+
+        auto it = by_path.find(path);
+        if (it == by_path.end()) {
+            ModuleInfo info;
+            info.path = path;
+            info.name = baseName(path);
+            info.start_address = region.getStartAddress();
+            info.end_address = region.getEndAddress();
+            it = by_path.emplace(path, std::move(info)).first;
+        }
+
+        ModuleInfo& info = it->second;
+        info.start_address = std::min(info.start_address, region.getStartAddress());
+        info.end_address = std::max(info.end_address, region.getEndAddress());
+        if (region.getPermissions().executable) {
+            info.executable_ranges.emplace_back(region.getStartAddress(), region.getEndAddress());
+        }
+    }
+
+    modules_.clear();
+    modules_.reserve(by_path.size());
+    for (auto& entry : by_path) {
+        std::sort(entry.second.executable_ranges.begin(), entry.second.executable_ranges.end());
+        modules_.push_back(std::move(entry.second));
+    }
+    std::sort(modules_.begin(), modules_.end(), [](const ModuleInfo& a, const ModuleInfo& b) {
+        return a.start_address < b.start_address;
+    });
+
+    fingerprint_ = fingerprint;
+    valid_ = true;
+    rebuild_count_++;
+    return true;
+}
+
+uint64_t ModuleIndex::currentFingerprint() const {
+    // Our loader's object list says nothing about another process
+    return pid_ < 0 ? computeFingerprint() : 0;
+}
+
+const ModuleInfo* ModuleIndex::findModuleLocked(const std::string& name) const {
+    const ModuleInfo* partial = nullptr;
+    for (const auto& module : modules_) {
+        if (module.path == name || module.name == name) {
+            return &module;
+        }
+        if (partial == nullptr && module.path.find(name) != std::string::npos) {
+            partial = &module;
+        }
+    }
+    return partial;
+}
+
+}  // namespace AnalysisToolkit
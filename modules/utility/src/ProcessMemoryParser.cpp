@@ -7,14 +7,19 @@
 
 #include <algorithm>
 #include <cerrno>
+#include <charconv>
+#include <chrono>
 #include <cstring>
-#include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <optional>
 #include <sstream>
 
+#include "utility/Metrics.h"
+
 // Platform-specific includes
 #ifdef __linux__
+#include <fcntl.h>
 #include <linux/limits.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -88,10 +93,95 @@ std::string MemoryRegion::toString() const {
     return oss.str();
 }
 
+MemoryRegion MemoryRegionView::toRegion(bool keep_original_line) const {
+    return MemoryRegion(start_address,
+                        end_address,
+                        permissions,
+                        offset,
+                        std::string(device),
+                        inode,
+                        std::string(pathname),
+                        keep_original_line ? std::string(line) : std::string());
+}
+
 // ============================================================================
 // ProcessMemoryParser Implementation
 // ============================================================================
 
+namespace {
+
+// Metrics: number of maps reads and the time spent reading and visiting them
+const MetricCounter& parseCountMetric() {
+    static const MetricCounter counter("maps.parses");
+    return counter;
+}
+
+const MetricCounter& parseTimeMetric() {
+    static const MetricCounter counter("maps.parse_ns");
+    return counter;
+}
+
+uint64_t steadyNowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+}
+
+}  // namespace
+
+ProcessMemoryParser::Result<size_t> ProcessMemoryParser::forEachRegion(
+    const RegionVisitor& visitor,
+    int pid) {
+    return visitRegions(
+        [&visitor](const MemoryRegionView& view, MemoryRegion*) { return visitor(view); }, pid);
+}
+
+ProcessMemoryParser::Result<size_t> ProcessMemoryParser::visitRegions(
+    const MaterializingVisitor& visitor,
+    int pid) {
+#ifdef __linux__
+    // The clock is only read while metrics are exported
+    const uint64_t start_ns = MetricsRegistry::isRecording() ? steadyNowNs() : 0;
+    auto read_result = readMapsText(pid);
+    if (read_result.hasError()) {
+        return Result<size_t>(read_result.getError(), read_result.getErrorMessage());
+    }
+
+    size_t visited = visitRegionsInText(read_result.getValue(), visitor);
+    if (start_ns != 0) {
+        parseCountMetric().add();
+        parseTimeMetric().add(steadyNowNs() - start_ns);
+    }
+    return Result<size_t>(std::move(visited));
+#elif __APPLE__
+    // vm_region() has no textual maps line, so reuse the regular parse
+    auto parse_result = parseMacOSMaps(pid);
+    if (parse_result.hasError()) {
+        return Result<size_t>(parse_result.getError(), parse_result.getErrorMessage());
+    }
+
+    size_t visited = 0;
+    for (const auto& region : parse_result.getValue()) {
+        MemoryRegionView view;
+        view.start_address = region.getStartAddress();
+        view.end_address = region.getEndAddress();
+        view.permissions = region.getPermissions();
+        view.offset = region.getOffset();
+        view.device = region.getDevice();
+        view.inode = region.getInode();
+        view.pathname = region.getPathname();
+        ++visited;
+        if (!visitor(view, nullptr)) {
+            break;
+        }
+    }
+
+    return Result<size_t>(std::move(visited));
+#else
+    return Result<size_t>(ErrorCode::PLATFORM_NOT_SUPPORTED, "Platform not supported");
+#endif
+}
+
 ProcessMemoryParser::Result<std::vector<MemoryRegion>> ProcessMemoryParser::parseProcess(int pid) {
 #ifdef __linux__
     return parseLinuxMaps(pid);
@@ -103,71 +193,62 @@ ProcessMemoryParser::Result<std::vector<MemoryRegion>> ProcessMemoryParser::pars
 #endif
 }
 
-ProcessMemoryParser::Result<std::vector<MemoryRegion>> ProcessMemoryParser::findRegionsContaining(
-    uintptr_t address,
-    int pid) {
-    auto parse_result = parseProcess(pid);
-    if (parse_result.hasError()) {
-        return parse_result;
-    }
+namespace {
+
+bool hasPermissions(const MemoryPermissions& region, const MemoryPermissions& required) {
+    return (!required.readable || region.readable) && (!required.writable || region.writable) &&
+           (!required.executable || region.executable) &&
+           (!required.private_mapping || region.private_mapping);
+}
 
+}  // namespace
+
+ProcessMemoryParser::Result<std::vector<MemoryRegion>> ProcessMemoryParser::collectRegions(
+    const std::function<bool(const MemoryRegionView&)>& predicate,
+    int pid,
+    bool first_only) {
+    // Only matching regions are materialized
     std::vector<MemoryRegion> matching_regions;
-    for (const auto& region : parse_result.getValue()) {
-        if (region.contains(address)) {
-            matching_regions.push_back(region);
-        }
+    auto result = visitRegions(
+        [&](const MemoryRegionView& view, MemoryRegion* region) {
+            if (predicate(view)) {
+                matching_regions.push_back(region != nullptr ? std::move(*region)
+                                                             : view.toRegion(keep_original_line_));
+                return !first_only;
+            }
+            return true;
+        },
+        pid);
+    if (result.hasError()) {
+        return Result<std::vector<MemoryRegion>>(result.getError(), result.getErrorMessage());
     }
 
     return Result<std::vector<MemoryRegion>>(std::move(matching_regions));
 }
 
+ProcessMemoryParser::Result<std::vector<MemoryRegion>> ProcessMemoryParser::findRegionsContaining(
+    uintptr_t address,
+    int pid) {
+    // Mappings never overlap, so at most one region matches
+    return collectRegions(
+        [address](const MemoryRegionView& view) { return view.contains(address); }, pid, true);
+}
+
 ProcessMemoryParser::Result<std::vector<MemoryRegion>>
 ProcessMemoryParser::findRegionsByPath(const std::string& pathname, int pid, bool exact_match) {
-    auto parse_result = parseProcess(pid);
-    if (parse_result.hasError()) {
-        return parse_result;
-    }
-
-    std::vector<MemoryRegion> matching_regions;
-    for (const auto& region : parse_result.getValue()) {
-        bool matches = exact_match ? (region.getPathname() == pathname)
-                                   : (region.getPathname().find(pathname) != std::string::npos);
-
-        if (matches) {
-            matching_regions.push_back(region);
-        }
-    }
-
-    return Result<std::vector<MemoryRegion>>(std::move(matching_regions));
+    return collectRegions(
+        [&](const MemoryRegionView& view) {
+            return exact_match ? view.pathname == pathname
+                               : view.pathname.find(pathname) != std::string_view::npos;
+        },
+        pid);
 }
 
 ProcessMemoryParser::Result<std::vector<MemoryRegion>>
 ProcessMemoryParser::findRegionsByPermissions(const MemoryPermissions& permissions, int pid) {
-    auto parse_result = parseProcess(pid);
-    if (parse_result.hasError()) {
-        return parse_result;
-    }
-
-    std::vector<MemoryRegion> matching_regions;
-    for (const auto& region : parse_result.getValue()) {
-        const auto& region_perms = region.getPermissions();
-        bool matches = true;
-
-        if (permissions.readable && !region_perms.readable)
-            matches = false;
-        if (permissions.writable && !region_perms.writable)
-            matches = false;
-        if (permissions.executable && !region_perms.executable)
-            matches = false;
-        if (permissions.private_mapping && !region_perms.private_mapping)
-            matches = false;
-
-        if (matches) {
-            matching_regions.push_back(region);
-        }
-    }
-
-    return Result<std::vector<MemoryRegion>>(std::move(matching_regions));
+    return collectRegions(
+        [&](const MemoryRegionView& view) { return hasPermissions(view.permissions, permissions); },
+        pid);
 }
 
 void ProcessMemoryParser::printMemoryMap(const std::vector<MemoryRegion>& regions, int limit) {
@@ -219,44 +300,131 @@ std::string ProcessMemoryParser::getErrorString(ErrorCode error) {
             return "Parse error";
         case ErrorCode::PLATFORM_NOT_SUPPORTED:
             return "Platform not supported";
+        case ErrorCode::INVALID_ADDRESS:
+            return "Invalid address";
         case ErrorCode::UNKNOWN_ERROR:
         default:
             return "Unknown error";
     }
 }
 
+size_t ProcessMemoryParser::forEachRegionInText(std::string_view maps_text,
+                                                const RegionVisitor& visitor) const {
+    return visitRegionsInText(maps_text, [&visitor](const MemoryRegionView& view, MemoryRegion*) {
+        return visitor(view);
+    });
+}
+
+size_t ProcessMemoryParser::visitRegionsInText(std::string_view maps_text,
+                                               const MaterializingVisitor& visitor) const {
+    std::string_view remaining = maps_text;
+    size_t visited = 0;
+    MemoryRegionView view;
+    std::optional<MemoryRegion> region;
+
+    while (!remaining.empty()) {
+        size_t newline = remaining.find('\n');
+        std::string_view line = remaining.substr(0, newline);
+        remaining.remove_prefix(newline == std::string_view::npos ? remaining.size()
+                                                                  : newline + 1);
+
+        if (!parseMapsLine(line, view)) {
+            continue;
+        }
+        if (region_view_filter_ && !region_view_filter_(view)) {
+            continue;
+        }
+        // The owning filter needs a MemoryRegion; hand the same one to the visitor
+        region.reset();
+        if (region_filter_) {
+            region.emplace(view.toRegion(keep_original_line_));
+            if (!region_filter_(*region)) {
+                continue;
+            }
+        }
+        ++visited;
+        if (!visitor(view, region ? &*region : nullptr)) {
+            break;
+        }
+    }
+
+    return visited;
+}
+
 // ============================================================================
 // Platform-specific implementations
 // ============================================================================
 
+ProcessMemoryParser::Result<std::string_view> ProcessMemoryParser::readMapsText(int pid) {
 #ifdef __linux__
-ProcessMemoryParser::Result<std::vector<MemoryRegion>> ProcessMemoryParser::parseLinuxMaps(
-    int pid) {
     std::string maps_path = getMapsFilePath(pid);
-    std::ifstream file(maps_path);
+    int fd = open(maps_path.c_str(), O_RDONLY | O_CLOEXEC);
 
-    if (!file.is_open()) {
+    if (fd < 0) {
         if (errno == ENOENT) {
-            return Result<std::vector<MemoryRegion>>(ErrorCode::PROCESS_NOT_FOUND,
-                                                     "Process not found: " + std::to_string(pid));
+            return Result<std::string_view>(ErrorCode::PROCESS_NOT_FOUND,
+                                            "Process not found: " + std::to_string(pid));
         } else if (errno == EACCES) {
-            return Result<std::vector<MemoryRegion>>(
+            return Result<std::string_view>(
                 ErrorCode::PERMISSION_DENIED,
                 "Permission denied accessing process: " + std::to_string(pid));
         } else {
-            return Result<std::vector<MemoryRegion>>(ErrorCode::FILE_NOT_FOUND,
-                                                     "Cannot open maps file: " + maps_path);
+            return Result<std::string_view>(ErrorCode::FILE_NOT_FOUND,
+                                            "Cannot open maps file: " + maps_path);
         }
     }
 
-    std::vector<MemoryRegion> regions;
-    std::string line;
+    // procfs reports no file size: grow until EOF. The buffer is reused across calls
+    if (read_buffer_.size() < 64 * 1024) {
+        read_buffer_.resize(64 * 1024);
+    }
 
-    while (std::getline(file, line)) {
-        auto region = parseMapsLine(line);
-        if (region.has_value() && shouldIncludeRegion(region.value())) {
-            regions.push_back(std::move(region.value()));
+    size_t length = 0;
+    while (true) {
+        if (length == read_buffer_.size()) {
+            read_buffer_.resize(read_buffer_.size() * 2);
+        }
+        ssize_t n = read(fd, &read_buffer_[length], read_buffer_.size() - length);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            int saved_errno = errno;
+            close(fd);
+            return Result<std::string_view>(
+                ErrorCode::UNKNOWN_ERROR,
+                "Cannot read maps file: " + maps_path + ": " + std::strerror(saved_errno));
+        }
+        if (n == 0) {
+            break;
         }
+        length += static_cast<size_t>(n);
+    }
+
+    close(fd);
+    return Result<std::string_view>(std::string_view(read_buffer_.data(), length));
+#else
+    (void)pid;
+    return Result<std::string_view>(ErrorCode::PLATFORM_NOT_SUPPORTED,
+                                    "No maps file on this platform");
+#endif
+}
+
+#ifdef __linux__
+ProcessMemoryParser::Result<std::vector<MemoryRegion>> ProcessMemoryParser::parseLinuxMaps(
+    int pid) {
+    std::vector<MemoryRegion> regions;
+    auto visit_result = visitRegions(
+        [&](const MemoryRegionView& view, MemoryRegion* region) {
+            regions.push_back(region != nullptr ? std::move(*region)
+                                                : view.toRegion(keep_original_line_));
+            return true;
+        },
+        pid);
+
+    if (visit_result.hasError()) {
+        return Result<std::vector<MemoryRegion>>(visit_result.getError(),
+                                                 visit_result.getErrorMessage());
     }
 
     return Result<std::vector<MemoryRegion>>(std::move(regions));
@@ -321,45 +489,78 @@ ProcessMemoryParser::Result<std::vector<MemoryRegion>> ProcessMemoryParser::pars
 }
 #endif
 
-std::optional<MemoryRegion> ProcessMemoryParser::parseMapsLine(const std::string& line) {
-    std::istringstream iss(line);
-    std::string addr_range, perms, offset_str, device, inode_str, pathname;
+namespace {
 
-    // Parse the line: address permissions offset device inode pathname
-    if (!(iss >> addr_range >> perms >> offset_str >> device >> inode_str)) {
-        return std::nullopt;
+// Skip leading blanks and split off the next whitespace-terminated field
+std::string_view nextField(std::string_view& line) {
+    size_t begin = line.find_first_not_of(" \t");
+    if (begin == std::string_view::npos) {
+        line = {};
+        return {};
     }
+    line.remove_prefix(begin);
+    size_t end = std::min(line.find_first_of(" \t"), line.size());
+    std::string_view field = line.substr(0, end);
+    line.remove_prefix(end);
+    return field;
+}
 
-    // Get pathname (may contain spaces)
-    std::getline(iss, pathname);
-    // Trim leading whitespace
-    pathname.erase(0, pathname.find_first_not_of(" \t"));
-
-    // Parse address range
-    size_t dash_pos = addr_range.find('-');
-    if (dash_pos == std::string::npos) {
-        return std::nullopt;
+template <typename T>
+bool parseNumber(std::string_view text, int base, T& value) {
+    if (text.empty()) {
+        return false;
     }
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value, base);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
 
-    std::string start_str = addr_range.substr(0, dash_pos);
-    std::string end_str = addr_range.substr(dash_pos + 1);
+}  // namespace
 
-    uintptr_t start_addr, end_addr;
-    uint64_t offset;
-    uint32_t inode;
+bool ProcessMemoryParser::parseMapsLine(std::string_view line, MemoryRegionView& region) {
+    // Parse the line: address permissions offset device inode pathname
+    std::string_view rest = line;
+    std::string_view addr_range = nextField(rest);
+    std::string_view perms = nextField(rest);
+    std::string_view offset_str = nextField(rest);
+    std::string_view device = nextField(rest);
+    std::string_view inode_str = nextField(rest);
+    if (inode_str.empty()) {
+        return false;
+    }
 
-    try {
-        start_addr = std::stoull(start_str, nullptr, 16);
-        end_addr = std::stoull(end_str, nullptr, 16);
-        offset = std::stoull(offset_str, nullptr, 16);
-        inode = std::stoul(inode_str);
-    } catch (const std::exception&) {
-        return std::nullopt;
+    size_t dash_pos = addr_range.find('-');
+    if (dash_pos == std::string_view::npos) {
+        return false;
     }
 
-    MemoryPermissions permissions = MemoryPermissions::fromString(perms);
+    uint64_t start_addr = 0;
+    uint64_t end_addr = 0;
+    uint64_t inode = 0;
+    if (!parseNumber(addr_range.substr(0, dash_pos), 16, start_addr) ||
+        !parseNumber(addr_range.substr(dash_pos + 1), 16, end_addr) ||
+        !parseNumber(offset_str, 16, region.offset) || !parseNumber(inode_str, 10, inode)) {
+        return false;
+    }
 
-    return MemoryRegion(start_addr, end_addr, permissions, offset, device, inode, pathname, line);
+    // Pathname may contain spaces; only leading whitespace is trimmed
+    size_t path_begin = rest.find_first_not_of(" \t");
+    region.pathname = path_begin == std::string_view::npos ? std::string_view()
+                                                           : rest.substr(path_begin);
+
+    region.start_address = static_cast<uintptr_t>(start_addr);
+    region.end_address = static_cast<uintptr_t>(end_addr);
+    region.device = device;
+    region.inode = static_cast<uint32_t>(inode);
+    region.line = line;
+
+    region.permissions = MemoryPermissions();
+    if (perms.size() >= 4) {
+        region.permissions.readable = (perms[0] == 'r');
+        region.permissions.writable = (perms[1] == 'w');
+        region.permissions.executable = (perms[2] == 'x');
+        region.permissions.private_mapping = (perms[3] == 'p');
+    }
+    return true;
 }
 
 std::string ProcessMemoryParser::getMapsFilePath(int pid) {
@@ -371,6 +572,19 @@ std::string ProcessMemoryParser::getMapsFilePath(int pid) {
 }
 
 bool ProcessMemoryParser::shouldIncludeRegion(const MemoryRegion& region) const {
+    if (region_view_filter_) {
+        MemoryRegionView view;
+        view.start_address = region.getStartAddress();
+        view.end_address = region.getEndAddress();
+        view.permissions = region.getPermissions();
+        view.offset = region.getOffset();
+        view.device = region.getDevice();
+        view.inode = region.getInode();
+        view.pathname = region.getPathname();
+        if (!region_view_filter_(view)) {
+            return false;
+        }
+    }
     return !region_filter_ || region_filter_(region);
 }
 
@@ -0,0 +1,426 @@
+/**
+ * @file RemoteMemoryReader.cpp
+ * @brief Implementation of the batched remote memory reader
+ */
+
+#include "utility/RemoteMemoryReader.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#ifdef __linux__
+#include <limits.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace AnalysisToolkit {
+
+namespace {
+
+using ErrorCode = ProcessMemoryParser::ErrorCode;
+
+// Minimum time between region reloads triggered by reads outside the list
+constexpr uint64_t kRefreshIntervalNs = 50ULL * 1000 * 1000;
+
+#if defined(__linux__) && defined(IOV_MAX)
+constexpr size_t kMaxSegments = IOV_MAX;
+#else
+constexpr size_t kMaxSegments = 1024;
+#endif
+
+uint64_t nowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+}
+
+std::string describeRange(uintptr_t address, size_t size) {
+    char text[64];
+    snprintf(text,
+             sizeof(text),
+             "0x%llx-0x%llx",
+             static_cast<unsigned long long>(address),
+             static_cast<unsigned long long>(address + size));
+    return text;
+}
+
+size_t systemPageSize() {
+#ifdef __linux__
+    long size = sysconf(_SC_PAGESIZE);
+    return size > 0 ? static_cast<size_t>(size) : 4096;
+#else
+    return 4096;
+#endif
+}
+
+ErrorCode errorFromErrno(int error) {
+    switch (error) {
+        case ESRCH:
+            return ErrorCode::PROCESS_NOT_FOUND;
+        case EPERM:
+            return ErrorCode::PERMISSION_DENIED;
+        case EFAULT:
+            return ErrorCode::INVALID_ADDRESS;
+        case ENOSYS:
+            return ErrorCode::PLATFORM_NOT_SUPPORTED;
+        default:
+            return ErrorCode::UNKNOWN_ERROR;
+    }
+}
+
+int resolvePid(int pid) {
+#ifdef __linux__
+    return pid <= 0 ? static_cast<int>(getpid()) : pid;
+#else
+    return pid;
+#endif
+}
+
+}  // namespace
+
+RemoteMemoryReader::RemoteMemoryReader(int pid, size_t cache_pages)
+    : pid_(resolvePid(pid)), page_size_(systemPageSize()) {
+    // A cached read may span two pages, both of which must stay resident
+    if (cache_pages == 1) {
+        cache_pages = 2;
+    }
+    storage_.resize(cache_pages * page_size_);
+    slots_.resize(cache_pages);
+    setPrefetchPages(prefetch_pages_);
+}
+
+ProcessMemoryParser::Result<size_t> RemoteMemoryReader::refreshRegions() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return refreshRegionsLocked();
+}
+
+ProcessMemoryParser::Result<size_t> RemoteMemoryReader::refreshRegionsLocked() {
+    last_refresh_ns_ = nowNs();
+    ProcessMemoryParser parser;
+    auto snapshot = MemoryMapSnapshot::capture(parser, pid_);
+    if (snapshot.hasError()) {
+        return ProcessMemoryParser::Result<size_t>(snapshot.getError(),
+                                                   snapshot.getErrorMessage());
+    }
+    regions_ = std::make_shared<const MemoryMapSnapshot>(std::move(snapshot.getValue()));
+    return ProcessMemoryParser::Result<size_t>(regions_->size());
+}
+
+std::shared_ptr<const MemoryMapSnapshot> RemoteMemoryReader::getRegions() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!regions_) {
+        refreshRegionsLocked();
+    }
+    return regions_;
+}
+
+ErrorCode RemoteMemoryReader::checkRangeLocked(uintptr_t address, size_t size) {
+    MemoryPermissions readable;
+    readable.readable = true;
+
+    if (!regions_) {
+        auto result = refreshRegionsLocked();
+        if (result.hasError()) {
+            return result.getError();
+        }
+    }
+    if (regions_->containsRange(address, size, readable)) {
+        return ErrorCode::SUCCESS;
+    }
+
+    // The target may have mapped the range since the list was loaded
+    if (nowNs() - last_refresh_ns_ < kRefreshIntervalNs) {
+        return ErrorCode::INVALID_ADDRESS;
+    }
+    auto result = refreshRegionsLocked();
+    if (result.hasError()) {
+        return result.getError();
+    }
+    return regions_->containsRange(address, size, readable) ? ErrorCode::SUCCESS
+                                                            : ErrorCode::INVALID_ADDRESS;
+}
+
+ProcessMemoryParser::Result<size_t> RemoteMemoryReader::read(uintptr_t address,
+                                                             void* buffer,
+                                                             size_t size) {
+    using Result = ProcessMemoryParser::Result<size_t>;
+    if (size == 0) {
+        return Result(size_t{0});
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    ErrorCode error = checkRangeLocked(address, size);
+    if (error != ErrorCode::SUCCESS) {
+        return Result(error, "Cannot read " + describeRange(address, size));
+    }
+
+    if (!slots_.empty() && size <= 2 * page_size_) {
+        return readCachedLocked(address, buffer, size);
+    }
+
+    lock.unlock();
+    error = transfer({{address, buffer, size}})[0];
+    if (error != ErrorCode::SUCCESS) {
+        return Result(error, "Cannot read " + describeRange(address, size));
+    }
+    return Result(std::move(size));
+}
+
+size_t RemoteMemoryReader::readBatch(std::vector<RemoteReadRequest>& requests) {
+    std::vector<Segment> segments;
+    std::vector<size_t> owners;
+    size_t succeeded = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++use_clock_;
+        for (size_t i = 0; i < requests.size(); ++i) {
+            RemoteReadRequest& request = requests[i];
+            if (request.size == 0) {
+                request.error = ErrorCode::SUCCESS;
+                succeeded++;
+                continue;
+            }
+            request.error = checkRangeLocked(request.address, request.size);
+            if (request.error != ErrorCode::SUCCESS) {
+                continue;
+            }
+            if (request.size <= 2 * page_size_ &&
+                copyFromCacheLocked(request.address, request.buffer, request.size)) {
+                cache_hits_.fetch_add(1, std::memory_order_relaxed);
+                succeeded++;
+                continue;
+            }
+            segments.push_back({request.address, request.buffer, request.size});
+            owners.push_back(i);
+        }
+    }
+
+    if (segments.empty()) {
+        return succeeded;
+    }
+    std::vector<ErrorCode> errors = transfer(segments);
+    for (size_t i = 0; i < owners.size(); ++i) {
+        requests[owners[i]].error = errors[i];
+        if (errors[i] == ErrorCode::SUCCESS) {
+            succeeded++;
+        }
+    }
+    return succeeded;
+}
+
+ProcessMemoryParser::Result<size_t> RemoteMemoryReader::readCachedLocked(uintptr_t address,
+                                                                         void* buffer,
+                                                                         size_t size) {
+    using Result = ProcessMemoryParser::Result<size_t>;
+    ++use_clock_;
+    if (copyFromCacheLocked(address, buffer, size)) {
+        cache_hits_.fetch_add(1, std::memory_order_relaxed);
+        return Result(std::move(size));
+    }
+    cache_misses_.fetch_add(1, std::memory_order_relaxed);
+
+    const uintptr_t mask = ~static_cast<uintptr_t>(page_size_ - 1);
+    const uintptr_t first = address & mask;
+    const uintptr_t last = (address + size - 1) & mask;
+    std::vector<uintptr_t> pages;
+    for (uintptr_t page = first; page <= last; page += page_size_) {
+        auto it = page_index_.find(page);
+        if (it == page_index_.end()) {
+            pages.push_back(page);
+        } else {
+            // Keep the cached half of the request from being evicted below
+            slots_[it->second].last_use = use_clock_;
+        }
+    }
+
+    // A miss right after the previous one walks forward: fetch ahead
+    if (first == last_miss_page_ + page_size_ || first == last_miss_page_) {
+        MemoryPermissions readable;
+        readable.readable = true;
+        uintptr_t page = last + page_size_;
+        for (size_t i = 0; i < prefetch_pages_ && page > last; ++i, page += page_size_) {
+            if (!regions_->containsRange(page, page_size_, readable)) {
+                break;
+            }
+            if (page_index_.find(page) == page_index_.end()) {
+                pages.push_back(page);
+            }
+        }
+    }
+    last_miss_page_ = pages.empty() ? last : std::max(last, pages.back());
+
+    std::vector<Segment> segments;
+    segments.reserve(pages.size());
+    for (uintptr_t page : pages) {
+        size_t slot = acquireSlotLocked(page);
+        segments.push_back({page, &storage_[slot * page_size_], page_size_});
+    }
+
+    // Only the pages of the request itself must succeed; prefetch is best effort
+    std::vector<ErrorCode> errors = transfer(segments);
+    ErrorCode error = ErrorCode::SUCCESS;
+    for (size_t i = 0; i < pages.size(); ++i) {
+        if (errors[i] == ErrorCode::SUCCESS) {
+            continue;
+        }
+        auto it = page_index_.find(pages[i]);
+        slots_[it->second].valid = false;
+        page_index_.erase(it);
+        if (pages[i] <= last && error == ErrorCode::SUCCESS) {
+            error = errors[i];
+        }
+    }
+    if (error != ErrorCode::SUCCESS) {
+        return Result(error, "Cannot read " + describeRange(address, size));
+    }
+
+    if (!copyFromCacheLocked(address, buffer, size)) {
+        return Result(ErrorCode::UNKNOWN_ERROR, "Page cache lost " + describeRange(address, size));
+    }
+    return Result(std::move(size));
+}
+
+bool RemoteMemoryReader::copyFromCacheLocked(uintptr_t address, void* buffer, size_t size) {
+    if (slots_.empty()) {
+        return false;
+    }
+
+    const uintptr_t mask = ~static_cast<uintptr_t>(page_size_ - 1);
+    const uintptr_t first = address & mask;
+    const uintptr_t last = (address + size - 1) & mask;
+    for (uintptr_t page = first; page <= last; page += page_size_) {
+        if (page_index_.find(page) == page_index_.end()) {
+            return false;
+        }
+    }
+
+    auto* out = static_cast<uint8_t*>(buffer);
+    uintptr_t cursor = address;
+    size_t remaining = size;
+    while (remaining > 0) {
+        uintptr_t page = cursor & mask;
+        size_t slot = page_index_[page];
+        size_t offset = cursor - page;
+        size_t count = std::min(remaining, page_size_ - offset);
+        std::memcpy(out, &storage_[slot * page_size_ + offset], count);
+        slots_[slot].last_use = use_clock_;
+        out += count;
+        cursor += count;
+        remaining -= count;
+    }
+    return true;
+}
+
+size_t RemoteMemoryReader::acquireSlotLocked(uintptr_t page) {
+    auto it = page_index_.find(page);
+    if (it != page_index_.end()) {
+        slots_[it->second].last_use = use_clock_;
+        return it->second;
+    }
+
+    // Least recently used slot, never one already used by the current read
+    size_t victim = slots_.size();
+    for (size_t i = 0; i < slots_.size(); ++i) {
+        if (!slots_[i].valid) {
+            victim = i;
+            break;
+        }
+        if (slots_[i].last_use != use_clock_ &&
+            (victim == slots_.size() || slots_[i].last_use < slots_[victim].last_use)) {
+            victim = i;
+        }
+    }
+
+    CacheSlot& slot = slots_[victim];
+    if (slot.valid) {
+        page_index_.erase(slot.page);
+    }
+    slot.page = page;
+    slot.last_use = use_clock_;
+    slot.valid = true;
+    page_index_[page] = victim;
+    return victim;
+}
+
+std::vector<ErrorCode> RemoteMemoryReader::transfer(const std::vector<Segment>& segments) {
+    std::vector<ErrorCode> errors(segments.size(), ErrorCode::SUCCESS);
+#ifdef __linux__
+    std::vector<iovec> local;
+    std::vector<iovec> remote;
+    size_t index = 0;
+
+    while (index < segments.size()) {
+        size_t count = std::min(segments.size() - index, kMaxSegments);
+        local.resize(count);
+        remote.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            const Segment& segment = segments[index + i];
+            local[i] = {segment.local, segment.size};
+            remote[i] = {reinterpret_cast<void*>(segment.remote), segment.size};
+        }
+
+        ssize_t copied = process_vm_readv(pid_, local.data(), count, remote.data(), count, 0);
+        syscalls_.fetch_add(1, std::memory_order_relaxed);
+        if (copied < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EFAULT) {
+                // Nothing was copied: the first segment is unreadable
+                errors[index++] = ErrorCode::INVALID_ADDRESS;
+                continue;
+            }
+            ErrorCode error = errorFromErrno(errno);
+            std::fill(errors.begin() + static_cast<ptrdiff_t>(index), errors.end(), error);
+            return errors;
+        }
+        bytes_read_.fetch_add(static_cast<uint64_t>(copied), std::memory_order_relaxed);
+
+        // The kernel stops at the first segment it cannot read completely
+        size_t done = 0;
+        size_t total = 0;
+        while (done < count && total + segments[index + done].size <= static_cast<size_t>(copied)) {
+            total += segments[index + done].size;
+            done++;
+        }
+        index += done;
+        if (done < count) {
+            errors[index++] = ErrorCode::INVALID_ADDRESS;
+        }
+    }
+#else
+    std::fill(errors.begin(), errors.end(), ErrorCode::PLATFORM_NOT_SUPPORTED);
+#endif
+    return errors;
+}
+
+void RemoteMemoryReader::setPrefetchPages(size_t pages) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    prefetch_pages_ = slots_.size() > 2 ? std::min(pages, slots_.size() - 2) : 0;
+}
+
+void RemoteMemoryReader::clearCache() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& slot : slots_) {
+        slot.valid = false;
+    }
+    page_index_.clear();
+    last_miss_page_ = 0;
+}
+
+RemoteMemoryReader::Stats RemoteMemoryReader::getStats() const {
+    Stats stats;
+    stats.syscalls = syscalls_.load(std::memory_order_relaxed);
+    stats.bytes_read = bytes_read_.load(std::memory_order_relaxed);
+    stats.cache_hits = cache_hits_.load(std::memory_order_relaxed);
+    stats.cache_misses = cache_misses_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+}  // namespace AnalysisToolkit
@@ -0,0 +1,715 @@
+/**
+ * @file SymbolIndex.cpp
+ * @brief Implementation of the cached ELF symbol index
+ */
+
+#include "utility/SymbolIndex.h"
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string_view>
+
+#include "utility/ModuleIndex.h"
+
+// Platform-specific includes
+#if defined(__linux__) || defined(__ANDROID__)
+#include <elf.h>
+#include <fcntl.h>
+#include <link.h>
+#include <sys/mman.h>
+#endif
+
+namespace AnalysisToolkit {
+
+namespace {
+
+constexpr char kCacheMagic[8] = {'A', 'T', 'K', 'S', 'Y', 'M', 'I', 'X'};
+constexpr uint32_t kCacheVersion = 1;
+
+/**
+ * @brief Identity of a file on disk; a cached table is only valid for the same identity
+ */
+struct FileIdentity {
+    uint64_t device = 0;
+    uint64_t inode = 0;
+    uint64_t size = 0;
+    int64_t mtime_ns = 0;
+
+    bool operator==(const FileIdentity& other) const = default;
+};
+
+/**
+ * @brief One indexed symbol; the layout is also the on-disk cache record
+ */
+struct SymbolEntry {
+    uint64_t value;        ///< Link-time virtual address (st_value)
+    uint64_t size;         ///< st_size
+    uint32_t name_offset;  ///< Offset of the name in the string pool
+    uint32_t name_length;  ///< Length of the name, excluding the terminator
+    uint8_t local;         ///< 1 for STB_LOCAL symbols
+    uint8_t named;         ///< 0 if only reachable by address (non-default version)
+    uint8_t reserved[6];
+};
+
+/**
+ * @brief Header of a cache file, followed by the entries and the string pool
+ */
+struct CacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t symbol_count;
+    uint64_t device;
+    uint64_t inode;
+    uint64_t file_size;
+    int64_t mtime_ns;
+    uint64_t min_vaddr;
+    uint64_t strings_size;
+};
+
+// FNV-1a hash of a string, used to disambiguate cache files of equal basenames
+uint64_t hashPath(const std::string& path) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (unsigned char c : path) {
+        hash ^= c;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+std::string baseName(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+bool statIdentity(const std::string& path, FileIdentity& identity) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+        return false;
+    }
+    identity.device = static_cast<uint64_t>(st.st_dev);
+    identity.inode = static_cast<uint64_t>(st.st_ino);
+    identity.size = static_cast<uint64_t>(st.st_size);
+#if __APPLE__
+    identity.mtime_ns =
+        static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+    identity.mtime_ns = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+    return true;
+}
+
+std::string cacheFilePath(const std::string& directory,
+                          const std::string& path,
+                          const FileIdentity& identity) {
+    char suffix[64];
+    snprintf(suffix,
+             sizeof(suffix),
+             "-%016llx-%llx.symidx",
+             static_cast<unsigned long long>(hashPath(path)),
+             static_cast<unsigned long long>(identity.inode));
+    return directory + "/" + baseName(path) + suffix;
+}
+
+}  // namespace
+
+/**
+ * @brief Immutable symbol table of one module
+ */
+struct LibrarySymbols {
+    FileIdentity identity;
+    uint64_t min_vaddr = 0;            ///< Page-aligned p_vaddr of the first PT_LOAD
+    std::vector<SymbolEntry> symbols;  ///< Sorted by value, globals before locals
+    std::string strings;               ///< NUL-separated symbol names
+    std::unordered_map<std::string_view, uint32_t> by_name;
+
+    LibrarySymbols() = default;
+    LibrarySymbols(const LibrarySymbols&) = delete;
+    LibrarySymbols& operator=(const LibrarySymbols&) = delete;
+
+    std::string_view nameOf(const SymbolEntry& entry) const {
+        return std::string_view(strings.data() + entry.name_offset, entry.name_length);
+    }
+
+    void addSymbol(std::string_view name, uint64_t value, uint64_t size, bool local, bool named) {
+        SymbolEntry entry{};
+        entry.value = value;
+        entry.size = size;
+        entry.name_offset = static_cast<uint32_t>(strings.size());
+        entry.name_length = static_cast<uint32_t>(name.size());
+        entry.local = local ? 1 : 0;
+        entry.named = named ? 1 : 0;
+        strings.append(name.data(), name.size());
+        strings.push_back('\0');
+        symbols.push_back(entry);
+    }
+
+    // Sort by address and drop symbols listed in both .dynsym and .symtab
+    void finalize() {
+        auto order = [this](const SymbolEntry& a, const SymbolEntry& b) {
+            if (a.value != b.value) {
+                return a.value < b.value;
+            }
+            if (a.local != b.local) {
+                return a.local < b.local;
+            }
+            return nameOf(a) < nameOf(b);
+        };
+        std::sort(symbols.begin(), symbols.end(), order);
+        auto last = std::unique(
+            symbols.begin(), symbols.end(), [this](const SymbolEntry& a, const SymbolEntry& b) {
+                return a.value == b.value && nameOf(a) == nameOf(b);
+            });
+        symbols.erase(last, symbols.end());
+    }
+
+    // Global definitions shadow local ones of the same name
+    void buildNameIndex() {
+        by_name.clear();
+        by_name.reserve(symbols.size());
+        for (int pass = 0; pass < 2; ++pass) {
+            for (uint32_t i = 0; i < symbols.size(); ++i) {
+                const SymbolEntry& entry = symbols[i];
+                if (entry.named && entry.local == pass) {
+                    by_name.emplace(nameOf(entry), i);
+                }
+            }
+        }
+    }
+};
+
+namespace {
+
+#if defined(__linux__) || defined(__ANDROID__)
+
+/**
+ * @brief Read-only mapping of a whole file
+ */
+class MappedFile {
+  public:
+    explicit MappedFile(const std::string& path) {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            size_t size = static_cast<size_t>(st.st_size);
+            void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED) {
+                data_ = static_cast<const uint8_t*>(data);
+                size_ = size;
+            }
+        }
+        close(fd);
+    }
+
+    ~MappedFile() {
+        if (data_ != nullptr) {
+            munmap(const_cast<uint8_t*>(data_), size_);
+        }
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const uint8_t* data() const {
+        return data_;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+  private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+/**
+ * @brief Extracts the symbols of a native-class ELF image into a LibrarySymbols table
+ *
+ * Every offset read from the file is bounds-checked, so truncated or corrupt
+ * files yield an empty or partial table instead of a crash.
+ */
+class ElfSymbolParser {
+  public:
+    ElfSymbolParser(const uint8_t* data, size_t size, LibrarySymbols& table)
+        : data_(data), size_(size), table_(table) {}
+
+    bool parse() {
+        const ElfW(Ehdr)* header = at<ElfW(Ehdr)>(0);
+        if (header == nullptr || memcmp(header->e_ident, ELFMAG, SELFMAG) != 0) {
+            return false;
+        }
+        unsigned char native_class = sizeof(void*) == 8 ? ELFCLASS64 : ELFCLASS32;
+        if (header->e_ident[EI_CLASS] != native_class) {
+            return false;
+        }
+
+        if (header->e_phentsize == sizeof(ElfW(Phdr))) {
+            program_headers_ = at<ElfW(Phdr)>(header->e_phoff, header->e_phnum);
+            program_header_count_ = program_headers_ != nullptr ? header->e_phnum : 0;
+        }
+
+        uint64_t page_mask = ~static_cast<uint64_t>(sysconf(_SC_PAGESIZE) - 1);
+        bool has_load = false;
+        for (size_t i = 0; i < program_header_count_; ++i) {
+            const ElfW(Phdr)& segment = program_headers_[i];
+            if (segment.p_type == PT_LOAD && (!has_load || segment.p_vaddr < table_.min_vaddr)) {
+                table_.min_vaddr = segment.p_vaddr;
+                has_load = true;
+            }
+        }
+        table_.min_vaddr &= page_mask;
+
+        if (!parseSections(header)) {
+            parseDynamic();
+        }
+        return true;
+    }
+
+  private:
+    template <typename T>
+    const T* at(uint64_t offset, uint64_t count = 1) const {
+        if (offset > size_ || count > (size_ - offset) / sizeof(T)) {
+            return nullptr;
+        }
+        return reinterpret_cast<const T*>(data_ + offset);
+    }
+
+    // Translate a link-time virtual address to a file offset through the PT_LOAD segments
+    bool vaddrToOffset(uint64_t vaddr, uint64_t& offset) const {
+        for (size_t i = 0; i < program_header_count_; ++i) {
+            const ElfW(Phdr)& segment = program_headers_[i];
+            if (segment.p_type == PT_LOAD && vaddr >= segment.p_vaddr &&
+                vaddr < segment.p_vaddr + segment.p_filesz) {
+                offset = segment.p_offset + (vaddr - segment.p_vaddr);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void addSymbols(const ElfW(Sym)* symbols,
+                    size_t count,
+                    const char* strings,
+                    size_t strings_size,
+                    const ElfW(Half)* versions) {
+        // Index 0 is the reserved undefined symbol
+        for (size_t i = 1; i < count; ++i) {
+            const ElfW(Sym)& symbol = symbols[i];
+            unsigned type = symbol.st_info & 0xf;
+            unsigned bind = symbol.st_info >> 4;
+            if (symbol.st_shndx == SHN_UNDEF || symbol.st_value == 0 ||
+                (type != STT_FUNC && type != STT_OBJECT) || symbol.st_name >= strings_size) {
+                continue;
+            }
+            const char* name = strings + symbol.st_name;
+            size_t length = strnlen(name, strings_size - symbol.st_name);
+            if (length == 0) {
+                continue;
+            }
+            // The hidden bit marks a non-default version (name@VER rather than name@@VER)
+            bool named = versions == nullptr || (versions[i] & 0x8000) == 0;
+            table_.addSymbol(std::string_view(name, length),
+                             symbol.st_value,
+                             symbol.st_size,
+                             bind == STB_LOCAL,
+                             named);
+        }
+    }
+
+    // Read .dynsym and .symtab; returns false if there is no usable .dynsym
+    bool parseSections(const ElfW(Ehdr)* header) {
+        if (header->e_shoff == 0 || header->e_shentsize != sizeof(ElfW(Shdr))) {
+            return false;
+        }
+        const ElfW(Shdr)* sections = at<ElfW(Shdr)>(header->e_shoff, header->e_shnum);
+        if (sections == nullptr) {
+            return false;
+        }
+
+        bool has_dynsym = false;
+        for (size_t i = 0; i < header->e_shnum; ++i) {
+            const ElfW(Shdr)& section = sections[i];
+            if ((section.sh_type != SHT_DYNSYM && section.sh_type != SHT_SYMTAB) ||
+                section.sh_entsize != sizeof(ElfW(Sym)) || section.sh_link >= header->e_shnum) {
+                continue;
+            }
+            size_t count = section.sh_size / sizeof(ElfW(Sym));
+            const ElfW(Sym)* symbols = at<ElfW(Sym)>(section.sh_offset, count);
+            const ElfW(Shdr)& string_section = sections[section.sh_link];
+            const char* strings = at<char>(string_section.sh_offset, string_section.sh_size);
+            if (symbols == nullptr || strings == nullptr) {
+                continue;
+            }
+
+            const ElfW(Half)* versions = nullptr;
+            if (section.sh_type == SHT_DYNSYM) {
+                for (size_t j = 0; j < header->e_shnum; ++j) {
+                    if (sections[j].sh_type == SHT_GNU_versym && sections[j].sh_link == i) {
+                        versions = at<ElfW(Half)>(sections[j].sh_offset, count);
+                        break;
+                    }
+                }
+                has_dynsym = true;
+            }
+            addSymbols(symbols, count, strings, string_section.sh_size, versions);
+        }
+        return has_dynsym;
+    }
+
+    // Locate the dynamic symbol table through PT_DYNAMIC when section headers are stripped
+    void parseDynamic() {
+        const ElfW(Dyn)* dynamic = nullptr;
+        size_t dynamic_count = 0;
+        for (size_t i = 0; i < program_header_count_; ++i) {
+            if (program_headers_[i].p_type == PT_DYNAMIC) {
+                dynamic_count = program_headers_[i].p_filesz / sizeof(ElfW(Dyn));
+                dynamic = at<ElfW(Dyn)>(program_headers_[i].p_offset, dynamic_count);
+                break;
+            }
+        }
+        if (dynamic == nullptr) {
+            return;
+        }
+
+        uint64_t symtab = 0, strtab = 0, strsz = 0, gnu_hash = 0, sysv_hash = 0, versym = 0;
+        for (size_t i = 0; i < dynamic_count && dynamic[i].d_tag != DT_NULL; ++i) {
+            uint64_t value = dynamic[i].d_un.d_val;
+            switch (dynamic[i].d_tag) {
+                case DT_SYMTAB:
+                    symtab = value;
+                    break;
+                case DT_STRTAB:
+                    strtab = value;
+                    break;
+                case DT_STRSZ:
+                    strsz = value;
+                    break;
+                case DT_GNU_HASH:
+                    gnu_hash = value;
+                    break;
+                case DT_HASH:
+                    sysv_hash = value;
+                    break;
+                case DT_VERSYM:
+                    versym = value;
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        uint64_t symtab_offset, strtab_offset;
+        if (!vaddrToOffset(symtab, symtab_offset) || !vaddrToOffset(strtab, strtab_offset)) {
+            return;
+        }
+
+        size_t count = 0;
+        uint64_t hash_offset;
+        if (gnu_hash != 0 && vaddrToOffset(gnu_hash, hash_offset)) {
+            count = gnuHashSymbolCount(hash_offset);
+        } else if (sysv_hash != 0 && vaddrToOffset(sysv_hash, hash_offset)) {
+            const uint32_t* words = at<uint32_t>(hash_offset, 2);
+            count = words != nullptr ? words[1] : 0;
+        }
+
+        const ElfW(Sym)* symbols = at<ElfW(Sym)>(symtab_offset, count);
+        const char* strings = at<char>(strtab_offset, strsz);
+        if (symbols == nullptr || strings == nullptr) {
+            return;
+        }
+        const ElfW(Half)* versions = nullptr;
+        uint64_t versym_offset;
+        if (versym != 0 && vaddrToOffset(versym, versym_offset)) {
+            versions = at<ElfW(Half)>(versym_offset, count);
+        }
+        addSymbols(symbols, count, strings, strsz, versions);
+    }
+
+    // The GNU hash table has no symbol count; it is one past the end of the longest chain
+    size_t gnuHashSymbolCount(uint64_t offset) const {
+        const uint32_t* header = at<uint32_t>(offset, 4);
+        if (header == nullptr) {
+            return 0;
+        }
+        uint32_t bucket_count = header[0];
+        uint32_t symbol_offset = header[1];
+        uint32_t bloom_size = header[2];
+
+        uint64_t buckets_offset =
+            offset + 4 * sizeof(uint32_t) + uint64_t{bloom_size} * sizeof(ElfW(Addr));
+        const uint32_t* buckets = at<uint32_t>(buckets_offset, bucket_count);
+        if (buckets == nullptr) {
+            return 0;
+        }
+        uint32_t last = 0;
+        for (uint32_t i = 0; i < bucket_count; ++i) {
+            last = std::max(last, buckets[i]);
+        }
+        if (last < symbol_offset) {
+            return symbol_offset;
+        }
+
+        uint64_t chains_offset = buckets_offset + uint64_t{bucket_count} * sizeof(uint32_t);
+        for (;;) {
+            uint64_t index = last - symbol_offset;
+            const uint32_t* chain = at<uint32_t>(chains_offset + index * sizeof(uint32_t));
+            if (chain == nullptr) {
+                return 0;
+            }
+            if ((*chain & 1) != 0) {
+                return static_cast<size_t>(last) + 1;
+            }
+            last++;
+        }
+    }
+
+    const uint8_t* data_;
+    size_t size_;
+    LibrarySymbols& table_;
+    const ElfW(Phdr)* program_headers_ = nullptr;
+    size_t program_header_count_ = 0;
+};
+
+#endif
+
+bool parseLibrary(const std::string& path, LibrarySymbols& table) {
+#if defined(__linux__) || defined(__ANDROID__)
+    MappedFile file(path);
+    if (file.data() == nullptr) {
+        return false;
+    }
+    ElfSymbolParser parser(file.data(), file.size(), table);
+    if (!parser.parse()) {
+        return false;
+    }
+    table.finalize();
+    return true;
+#else
+    (void)path;
+    (void)table;
+    return false;
+#endif
+}
+
+bool loadCache(const std::string& file_path, LibrarySymbols& table) {
+    std::ifstream file(file_path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    CacheHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        memcmp(header.magic, kCacheMagic, sizeof(kCacheMagic)) != 0 ||
+        header.version != kCacheVersion) {
+        return false;
+    }
+    FileIdentity cached{header.device, header.inode, header.file_size, header.mtime_ns};
+    if (cached != table.identity) {
+        return false;
+    }
+
+    table.min_vaddr = header.min_vaddr;
+    table.symbols.resize(header.symbol_count);
+    table.strings.resize(header.strings_size);
+    if (!file.read(reinterpret_cast<char*>(table.symbols.data()),
+                   static_cast<std::streamsize>(header.symbol_count * sizeof(SymbolEntry))) ||
+        !file.read(table.strings.data(), static_cast<std::streamsize>(header.strings_size))) {
+        return false;
+    }
+    for (const SymbolEntry& entry : table.symbols) {
+        if (uint64_t{entry.name_offset} + entry.name_length >= table.strings.size() + 1) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void saveCache(const std::string& file_path, const LibrarySymbols& table) {
+    // Write to a private temporary and rename so readers never see a partial file
+    std::string temp_path = file_path + ".tmp" + std::to_string(getpid());
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            return;
+        }
+        CacheHeader header{};
+        memcpy(header.magic, kCacheMagic, sizeof(kCacheMagic));
+        header.version = kCacheVersion;
+        header.symbol_count = static_cast<uint32_t>(table.symbols.size());
+        header.device = table.identity.device;
+        header.inode = table.identity.inode;
+        header.file_size = table.identity.size;
+        header.mtime_ns = table.identity.mtime_ns;
+        header.min_vaddr = table.min_vaddr;
+        header.strings_size = table.strings.size();
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(table.symbols.data()),
+                   static_cast<std::streamsize>(table.symbols.size() * sizeof(SymbolEntry)));
+        file.write(table.strings.data(), static_cast<std::streamsize>(table.strings.size()));
+        if (!file.good()) {
+            file.close();
+            unlink(temp_path.c_str());
+            return;
+        }
+    }
+    if (rename(temp_path.c_str(), file_path.c_str()) != 0) {
+        unlink(temp_path.c_str());
+    }
+}
+
+std::optional<uintptr_t> lookupName(const LibrarySymbols& table,
+                                    uintptr_t bias,
+                                    const std::string& symbol) {
+    auto it = table.by_name.find(symbol);
+    if (it == table.by_name.end()) {
+        return std::nullopt;
+    }
+    return bias + static_cast<uintptr_t>(table.symbols[it->second].value);
+}
+
+}  // namespace
+
+SymbolIndex::SymbolIndex(ModuleIndex& modules) : modules_(modules) {}
+
+SymbolIndex::SymbolIndex() : SymbolIndex(ModuleIndex::getInstance()) {}
+
+SymbolIndex::~SymbolIndex() = default;
+
+SymbolIndex& SymbolIndex::getInstance() {
+    static SymbolIndex instance;
+    return instance;
+}
+
+void SymbolIndex::setCacheDirectory(const std::string& directory) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cache_directory_ = directory;
+}
+
+std::string SymbolIndex::getCacheDirectory() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cache_directory_;
+}
+
+std::optional<uintptr_t> SymbolIndex::findSymbol(const std::string& library,
+                                                 const std::string& symbol) {
+    std::optional<ModuleInfo> module = modules_.findModule(library);
+    if (!module) {
+        return std::nullopt;
+    }
+    std::shared_ptr<const LibrarySymbols> table = getLibrary(module->path);
+    if (!table) {
+        return std::nullopt;
+    }
+    return lookupName(*table, module->start_address - table->min_vaddr, symbol);
+}
+
+std::vector<uintptr_t> SymbolIndex::findSymbols(const std::string& library,
+                                                const std::vector<std::string>& symbols) {
+    std::vector<uintptr_t> addresses(symbols.size(), 0);
+    std::optional<ModuleInfo> module = modules_.findModule(library);
+    if (!module) {
+        return addresses;
+    }
+    std::shared_ptr<const LibrarySymbols> table = getLibrary(module->path);
+    if (!table) {
+        return addresses;
+    }
+
+    uintptr_t bias = module->start_address - table->min_vaddr;
+    for (size_t i = 0; i < symbols.size(); ++i) {
+        addresses[i] = lookupName(*table, bias, symbols[i]).value_or(0);
+    }
+    return addresses;
+}
+
+std::optional<SymbolInfo> SymbolIndex::findSymbolContaining(uintptr_t address) {
+    std::optional<ModuleInfo> module = modules_.findModuleContaining(address);
+    if (!module) {
+        return std::nullopt;
+    }
+    std::shared_ptr<const LibrarySymbols> table = getLibrary(module->path);
+    if (!table || table->symbols.empty()) {
+        return std::nullopt;
+    }
+
+    uintptr_t bias = module->start_address - table->min_vaddr;
+    uint64_t value = address - bias;
+    auto it = std::upper_bound(
+        table->symbols.begin(),
+        table->symbols.end(),
+        value,
+        [](uint64_t target, const SymbolEntry& entry) { return target < entry.value; });
+    if (it == table->symbols.begin()) {
+        return std::nullopt;
+    }
+    --it;
+    // Among aliases at the same address the first one sorts global-first
+    while (it != table->symbols.begin() && std::prev(it)->value == it->value) {
+        --it;
+    }
+    if (it->size != 0 && value >= it->value + it->size) {
+        return std::nullopt;
+    }
+
+    SymbolInfo info;
+    info.name = std::string(table->nameOf(*it));
+    info.module_path = module->path;
+    info.address = bias + static_cast<uintptr_t>(it->value);
+    info.size = static_cast<size_t>(it->size);
+    return info;
+}
+
+void SymbolIndex::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    libraries_.clear();
+}
+
+uint64_t SymbolIndex::getParseCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return parse_count_;
+}
+
+std::shared_ptr<const LibrarySymbols> SymbolIndex::getLibrary(const std::string& path) {
+    FileIdentity identity;
+    if (!statIdentity(path, identity)) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = libraries_.find(path);
+    if (it != libraries_.end() && it->second->identity == identity) {
+        return it->second;
+    }
+
+    // Unparseable files get an empty table so they are not retried on every lookup
+    auto table = std::make_shared<LibrarySymbols>();
+    table->identity = identity;
+    std::string cache_path;
+    if (!cache_directory_.empty()) {
+        cache_path = cacheFilePath(cache_directory_, path, identity);
+    }
+    if (cache_path.empty() || !loadCache(cache_path, *table)) {
+        table->symbols.clear();
+        table->strings.clear();
+        table->min_vaddr = 0;
+        bool parsed = parseLibrary(path, *table);
+        parse_count_++;
+        if (parsed && !cache_path.empty()) {
+            saveCache(cache_path, *table);
+        }
+    }
+    table->buildNameIndex();
+
+    libraries_[path] = table;
+    return table;
+}
+
+}  // namespace AnalysisToolkit
@@ -0,0 +1,38 @@
+#!/bin/bash
+
+# 构建并运行 AnalysisToolkit 的基准测试
+# 结果以 JSON 格式保存，便于跨版本比较
+# 额外参数会原样传给基准程序，例如 --benchmark_filter=BM_Log
+
+set -e
+
+# 项目根目录
+PROJECT_ROOT="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+cd "$PROJECT_ROOT"
+
+# 构建目录
+BENCH_BUILD_DIR="build-benchmarks"
+RESULT_FILE="benchmark_results.json"
+# 被测库按 Release 构建，可用 BUILD_TYPE 环境变量覆盖；构建类型写入结果的 context
+BUILD_TYPE="${BUILD_TYPE:-Release}"
+
+echo "⏱️  开始构建和运行基准测试..."
+
+mkdir -p "$BENCH_BUILD_DIR"
+cd "$BENCH_BUILD_DIR"
+
+echo "🔧 配置 CMake (启用基准, $BUILD_TYPE)..."
+cmake .. -DBUILD_BENCHMARKS=ON -DCMAKE_BUILD_TYPE="$BUILD_TYPE"
+
+echo "🔨 构建基准..."
+make -j$(nproc 2>/dev/null || echo 4) benchmarks
+
+echo "🏃 运行基准..."
+cd benchmarks
+./benchmarks --benchmark_out="$RESULT_FILE" --benchmark_out_format=json \
+    --benchmark_repetitions=3 --benchmark_report_aggregates_only=true \
+    --benchmark_context=build_type="$BUILD_TYPE" "$@"
+
+echo ""
+echo "✅ 基准测试完成!"
+echo "📊 结果已保存到: $BENCH_BUILD_DIR/benchmarks/$RESULT_FILE"
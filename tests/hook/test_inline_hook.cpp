@@ -1,14 +1,38 @@
 #include <dlfcn.h>
 #include <gtest/gtest.h>
 
+#include <atomic>
 #include <cstdarg>
 #include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
 
 #include "hook/inline_hook.h"
+#include "utility/ModuleIndex.h"
 #include "test_utils.h"
 
 using namespace AnalysisToolkit;
 
+// 带统计的 Hook，测试中直接调用替换函数
+ATKIT_HOOK_DEF_STATS(int, stats_add, int a, int b) {
+    ATKIT_HOOK_STATS_SCOPE(stats_add);
+    return ATKIT_HOOK_CALL_ORIGINAL(stats_add, a, b) + 1;
+}
+
+namespace {
+
+std::optional<HookStats> findStats(const std::string& name) {
+    for (const auto& entry : HookManager::getInstance()->getHookStats()) {
+        if (entry.name == name) {
+            return entry;
+        }
+    }
+    return std::nullopt;
+}
+
+}  // namespace
+
 class InlineHookTest : public ::testing::Test {
   protected:
     void SetUp() override {
@@ -104,8 +128,8 @@ TEST_F(InlineHookTest, InitialHookState) {
     // 初始状态应该没有被 hook
     EXPECT_FALSE(hook_manager_->isHooked(func_addr));
 
-    // 获取不存在的 hook 信息应该返回 nullptr
-    EXPECT_EQ(hook_manager_->getHookInfo(func_addr), nullptr);
+    // 获取不存在的 hook 信息应该返回空
+    EXPECT_FALSE(hook_manager_->getHookInfo(func_addr).has_value());
 
     // 初始状态应该没有任何 hooks
     auto hooks = hook_manager_->getAllHooks();
@@ -127,8 +151,8 @@ TEST_F(InlineHookTest, BasicFunctionHook) {
         EXPECT_TRUE(hook_manager_->isHooked(original_func));
 
         // 验证 hook 信息
-        HookInfo* info = hook_manager_->getHookInfo(original_func);
-        ASSERT_NE(info, nullptr);
+        auto info = hook_manager_->getHookInfo(original_func);
+        ASSERT_TRUE(info.has_value());
         EXPECT_EQ(info->target_address, original_func);
         EXPECT_EQ(info->replace_function, hook_func);
         EXPECT_EQ(info->symbol_name, "test_hook");
@@ -138,7 +162,7 @@ TEST_F(InlineHookTest, BasicFunctionHook) {
         // 验证 getAllHooks
         auto hooks = hook_manager_->getAllHooks();
         EXPECT_EQ(hooks.size(), 1);
-        EXPECT_EQ(hooks[0], info);
+        EXPECT_EQ(hooks[0].target_address, info->target_address);
 
         // 测试重复 hook 同一个函数
         HookStatus duplicate_status = hook_manager_->hookFunction(original_func,
@@ -209,7 +233,7 @@ TEST_F(InlineHookTest, UnhookFunction) {
 
         // 验证已经被 unhook
         EXPECT_FALSE(hook_manager_->isHooked(original_func));
-        EXPECT_EQ(hook_manager_->getHookInfo(original_func), nullptr);
+        EXPECT_FALSE(hook_manager_->getHookInfo(original_func).has_value());
 
         // 验证 getAllHooks 为空
         auto hooks = hook_manager_->getAllHooks();
@@ -322,6 +346,277 @@ TEST_F(InlineHookTest, ThreadSafety) {
     SUCCEED();  // 如果没有崩溃，就算通过
 }
 
+// 测试批量 Hook：逐项返回状态，失败项不影响其他项
+TEST_F(InlineHookTest, BatchHook) {
+    void* add_func = reinterpret_cast<void*>(&TestUtils::original_test_function);
+    void* counting_func = reinterpret_cast<void*>(&TestUtils::counting_function);
+    void* add_backup = nullptr;
+    void* counting_backup = nullptr;
+
+    std::vector<HookSpec> specs(4);
+    specs[0].target_address = add_func;
+    specs[0].replace_function = reinterpret_cast<void*>(&TestUtils::hooked_test_function);
+    specs[0].original_function = &add_backup;
+    specs[0].tag = "batch_add";
+    specs[1].target_address = counting_func;
+    specs[1].replace_function = reinterpret_cast<void*>(&TestUtils::counting_hook_function);
+    specs[1].original_function = &counting_backup;
+    specs[1].tag = "batch_counting";
+    specs[2].library_name = "libc.so.6";
+    specs[2].symbol_name = "nonexistent_function";
+    specs[2].replace_function = reinterpret_cast<void*>(&TestUtils::hooked_test_function);
+    specs[3] = specs[0];  // 批内重复项
+
+    auto results = hook_manager_->hookBatch(specs);
+    ASSERT_EQ(results.size(), specs.size());
+    EXPECT_EQ(results[2], HookStatus::SYMBOL_NOT_FOUND);
+
+    if (results[0] != HookStatus::SUCCESS) {
+        GTEST_SKIP() << "Hook operation failed, possibly due to system restrictions";
+    }
+    EXPECT_EQ(results[1], HookStatus::SUCCESS);
+    EXPECT_EQ(results[3], HookStatus::ALREADY_HOOKED);
+    EXPECT_TRUE(hook_manager_->isHooked(add_func));
+    EXPECT_TRUE(hook_manager_->isHooked(counting_func));
+
+    auto info = hook_manager_->getHookInfo(add_func);
+    ASSERT_TRUE(info.has_value());
+    EXPECT_EQ(info->symbol_name, "batch_add");
+    EXPECT_FALSE(info->library_name.empty());
+}
+
+// 测试无锁读路径：Hook 安装和移除期间并发查询
+TEST_F(InlineHookTest, ConcurrentLookupDuringUpdates) {
+    void* func_addr = reinterpret_cast<void*>(&TestUtils::counting_function);
+    void* hook_func = reinterpret_cast<void*>(&TestUtils::counting_hook_function);
+    void* original_backup = nullptr;
+
+    if (hook_manager_->hookFunction(func_addr, hook_func, &original_backup, "concurrent") !=
+        HookStatus::SUCCESS) {
+        GTEST_SKIP() << "Hook operation failed, possibly due to system restrictions";
+    }
+    ASSERT_EQ(hook_manager_->unhookFunction(func_addr), HookStatus::SUCCESS);
+
+    std::atomic<bool> stop{false};
+    std::atomic<size_t> lookups{0};
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i) {
+        readers.emplace_back([&] {
+            while (!stop.load()) {
+                auto info = hook_manager_->getHookInfo(func_addr);
+                if (info.has_value()) {
+                    EXPECT_EQ(info->symbol_name, "concurrent");
+                }
+                HookSnapshotRef snapshot = hook_manager_->acquireSnapshot();
+                for (const HookInfo& hook : snapshot) {
+                    EXPECT_NE(hook.target_address, nullptr);
+                }
+                lookups.fetch_add(1);
+            }
+        });
+    }
+
+    for (int i = 0; i < 50; ++i) {
+        EXPECT_EQ(hook_manager_->hookFunction(func_addr, hook_func, &original_backup, "concurrent"),
+                  HookStatus::SUCCESS);
+        EXPECT_TRUE(hook_manager_->isHooked(func_addr));
+        EXPECT_EQ(hook_manager_->unhookFunction(func_addr), HookStatus::SUCCESS);
+        EXPECT_FALSE(hook_manager_->isHooked(func_addr));
+    }
+
+    // 更新可能在读线程启动前就已完成，至少等到一次查询
+    while (lookups.load() == 0) {
+        std::this_thread::yield();
+    }
+    stop.store(true);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    EXPECT_GT(lookups.load(), 0u);
+}
+
+// 测试插桩回调分发：同一地址多个回调，注销单个回调
+TEST_F(InlineHookTest, InstrumentCallbacks) {
+    void* func_addr = reinterpret_cast<void*>(&TestUtils::counting_function);
+    std::atomic<int> first_calls{0};
+    std::atomic<int> second_calls{0};
+
+    InstrumentId first_id = 0;
+    HookStatus status = hook_manager_->instrumentFunction(
+        func_addr,
+        [&](void* address, void*) {
+            EXPECT_EQ(address, func_addr);
+            first_calls++;
+        },
+        "probe",
+        &first_id);
+    if (status != HookStatus::SUCCESS) {
+        GTEST_SKIP() << "Instrument operation failed, possibly due to system restrictions";
+    }
+
+    InstrumentId second_id = 0;
+    ASSERT_EQ(hook_manager_->instrumentFunction(
+                  func_addr, [&](void*, void*) { second_calls++; }, "probe", &second_id),
+              HookStatus::SUCCESS);
+    EXPECT_NE(first_id, second_id);
+
+    auto info = hook_manager_->getHookInfo(func_addr);
+    ASSERT_TRUE(info.has_value());
+    EXPECT_EQ(info->type, HookType::INSTRUCTION);
+    ASSERT_NE(info->replace_function, nullptr);
+
+    // 直接调用共享跳板，验证分发表本身，不依赖代码补丁是否生效
+    auto trampoline = reinterpret_cast<void (*)(void*, void*)>(info->replace_function);
+    trampoline(func_addr, nullptr);
+    EXPECT_EQ(first_calls.load(), 1);
+    EXPECT_EQ(second_calls.load(), 1);
+
+    EXPECT_EQ(hook_manager_->removeInstrumentCallback(func_addr, first_id), HookStatus::SUCCESS);
+    EXPECT_EQ(hook_manager_->removeInstrumentCallback(func_addr, first_id), HookStatus::FAILED);
+    trampoline(func_addr, nullptr);
+    EXPECT_EQ(first_calls.load(), 1);
+    EXPECT_EQ(second_calls.load(), 2);
+    EXPECT_TRUE(hook_manager_->isHooked(func_addr));
+
+    // 其他地址不会触发回调
+    trampoline(reinterpret_cast<void*>(&TestUtils::original_test_function), nullptr);
+    EXPECT_EQ(second_calls.load(), 2);
+
+    // 普通 Hook 与插桩互斥
+    void* hook_func = reinterpret_cast<void*>(&TestUtils::counting_hook_function);
+    void* backup = nullptr;
+    EXPECT_EQ(hook_manager_->hookFunction(func_addr, hook_func, &backup, "conflict"),
+              HookStatus::ALREADY_HOOKED);
+
+    EXPECT_EQ(hook_manager_->unhookFunction(func_addr), HookStatus::SUCCESS);
+    trampoline(func_addr, nullptr);
+    EXPECT_EQ(second_calls.load(), 2);
+}
+
+// 测试插桩回调中可以修改 Hook 表：注销自身并安装新 Hook 不会死锁
+TEST_F(InlineHookTest, InstrumentCallbackMayUpdateHooks) {
+    void* func_addr = reinterpret_cast<void*>(&TestUtils::counting_function);
+    void* other_addr = reinterpret_cast<void*>(&TestUtils::original_test_function);
+    void* hook_func = reinterpret_cast<void*>(&TestUtils::counting_hook_function);
+
+    InstrumentId id = 0;
+    std::atomic<int> calls{0};
+    HookStatus status = hook_manager_->instrumentFunction(
+        func_addr,
+        [&](void* address, void*) {
+            calls++;
+            void* backup = nullptr;
+            EXPECT_EQ(hook_manager_->removeInstrumentCallback(address, id), HookStatus::SUCCESS);
+            EXPECT_EQ(hook_manager_->hookFunction(other_addr, hook_func, &backup, "nested"),
+                      HookStatus::SUCCESS);
+        },
+        "self_removing",
+        &id);
+    if (status != HookStatus::SUCCESS) {
+        GTEST_SKIP() << "Instrument operation failed, possibly due to system restrictions";
+    }
+
+    auto info = hook_manager_->getHookInfo(func_addr);
+    ASSERT_TRUE(info.has_value());
+    auto trampoline = reinterpret_cast<void (*)(void*, void*)>(info->replace_function);
+    trampoline(func_addr, nullptr);
+    trampoline(func_addr, nullptr);
+    EXPECT_EQ(calls.load(), 1);
+    EXPECT_TRUE(hook_manager_->isHooked(other_addr));
+
+    EXPECT_EQ(hook_manager_->unhookFunction(other_addr), HookStatus::SUCCESS);
+    EXPECT_EQ(hook_manager_->unhookFunction(func_addr), HookStatus::SUCCESS);
+}
+
+// 测试 Hook 统计：命中次数、直方图，以及已退出线程的计数
+TEST_F(InlineHookTest, HookStats) {
+    original_stats_add = &TestUtils::original_test_function;
+    hook_manager_->resetHookStats();
+
+    // 默认关闭，不记录
+    hook_manager_->setHookStatsEnabled(false);
+    EXPECT_EQ(hooked_stats_add(1, 2), 4);
+    auto stats = findStats("stats_add");
+    ASSERT_TRUE(stats.has_value());
+    EXPECT_EQ(stats->hits, 0u);
+
+    hook_manager_->setHookStatsEnabled(true);
+    EXPECT_TRUE(hook_manager_->isHookStatsEnabled());
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(hooked_stats_add(i, 1), i + 2);
+    }
+    std::thread worker([] {
+        for (int i = 0; i < 5; ++i) {
+            hooked_stats_add(i, i);
+        }
+    });
+    worker.join();
+    hook_manager_->setHookStatsEnabled(false);
+
+    stats = findStats("stats_add");
+    ASSERT_TRUE(stats.has_value());
+    EXPECT_EQ(stats->hits, 15u);
+    EXPECT_EQ(stats->original_calls, 15u);
+    EXPECT_GE(stats->total_ns, stats->original_ns);
+    EXPECT_GE(stats->max_ns, stats->averageNs());
+
+    uint64_t bucketed = 0;
+    for (uint64_t count : stats->latency_buckets) {
+        bucketed += count;
+    }
+    EXPECT_EQ(bucketed, stats->hits);
+    EXPECT_LE(stats->percentileNs(0.5), stats->percentileNs(0.99));
+    EXPECT_LE(stats->percentileNs(1.0), stats->max_ns);
+
+    hook_manager_->resetHookStats();
+    stats = findStats("stats_add");
+    ASSERT_TRUE(stats.has_value());
+    EXPECT_EQ(stats->hits, 0u);
+    original_stats_add = nullptr;
+}
+
+// 测试延迟 Hook：未加载的库进入等待队列，已加载的库立即安装
+TEST_F(InlineHookTest, DeferredHook) {
+    void* backup = nullptr;
+    HookSpec missing;
+    missing.library_name = "libdoes_not_exist_12345.so";
+    missing.symbol_name = "missing_function";
+    missing.replace_function = reinterpret_cast<void*>(&TestUtils::hooked_test_function);
+    missing.original_function = &backup;
+    missing.tag = "deferred_missing";
+
+    EXPECT_EQ(hook_manager_->hookSymbolDeferred(missing), HookStatus::PENDING);
+    EXPECT_EQ(hook_manager_->getPendingHookCount(), 1u);
+    EXPECT_EQ(hook_manager_->installPendingHooks(), 0u);
+    EXPECT_EQ(hook_manager_->getPendingHookCount(), 1u);
+
+    HookSpec incomplete;
+    incomplete.symbol_name = "missing_function";
+    EXPECT_EQ(hook_manager_->hookSymbolDeferred(incomplete), HookStatus::FAILED);
+
+    // 测试程序自身已加载，符号从 .symtab 解析
+    void* func_addr = reinterpret_cast<void*>(&TestUtils::original_test_function);
+    auto own =
+        ModuleIndex::getInstance().findModuleContaining(reinterpret_cast<uintptr_t>(func_addr));
+    ASSERT_TRUE(own.has_value());
+    HookSpec loaded;
+    loaded.library_name = own->path;
+    loaded.symbol_name = "_ZN9TestUtils22original_test_functionEii";
+    loaded.replace_function = reinterpret_cast<void*>(&TestUtils::hooked_test_function);
+    loaded.original_function = &backup;
+    loaded.tag = "deferred_loaded";
+
+    HookStatus status = hook_manager_->hookSymbolDeferred(loaded);
+    if (status != HookStatus::SUCCESS) {
+        GTEST_SKIP() << "Hook operation failed, possibly due to system restrictions";
+    }
+    EXPECT_TRUE(hook_manager_->isHooked(func_addr));
+    EXPECT_EQ(hook_manager_->getPendingHookCount(), 1u);
+
+    hook_manager_->cleanup();
+    EXPECT_EQ(hook_manager_->getPendingHookCount(), 0u);
+}
+
 // 主函数
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
@@ -182,6 +182,36 @@ TEST_F(AnalysisToolkitTest, FileLoggingConfig) {
     logger->info("File logging test message");
 }
 
+// Test metrics export configuration
+TEST_F(AnalysisToolkitTest, MetricsExportConfig) {
+    Config config;
+    config.app_tag = "MetricsTest";
+    config.enable_console_log = false;
+    config.enable_metrics = true;
+    config.metrics_path = "/tmp/test_analysis_toolkit.metrics";
+
+    EXPECT_TRUE(initialize(config));
+    EXPECT_TRUE(MetricsRegistry::isRecording());
+    EXPECT_EQ(getMetricsRegistry()->getPath(), config.metrics_path);
+
+    // 外部读者能看到初始化期间写入的日志记录数
+    MetricsReader reader;
+    ASSERT_TRUE(reader.open(config.metrics_path));
+    bool found = false;
+    for (const auto& sample : reader.read()) {
+        if (sample.name == "log.records") {
+            found = true;
+            EXPECT_GT(sample.value, 0u);
+        }
+    }
+    EXPECT_TRUE(found);
+
+    // 清理后停止导出并删除段文件
+    cleanup();
+    EXPECT_FALSE(MetricsRegistry::isRecording());
+    EXPECT_FALSE(reader.open(config.metrics_path));
+}
+
 // Test thread safety of initialization
 TEST_F(AnalysisToolkitTest, ThreadSafetyInitialization) {
     const int num_threads = 10;
@@ -0,0 +1,96 @@
+/**
+ * @file test_coverage.cpp
+ * @brief Unit tests for the per-range coverage bitmap
+ */
+
+#include <gtest/gtest.h>
+
+#include "trace/coverage.h"
+
+using namespace AnalysisToolkit::Trace;
+
+namespace {
+
+constexpr uint64_t kUnit = kCoverageGranularity;
+
+}  // namespace
+
+// Test that marking a block covers exactly its units and reports new coverage once
+TEST(CoverageMapTest, MarkBlockReportsNewCoverage) {
+    CoverageMap map;
+    map.addRange(0x1000, 0x2000);
+
+    EXPECT_TRUE(map.markBlock(0x1000, 0x1000 + 4 * kUnit));
+    EXPECT_FALSE(map.markBlock(0x1000, 0x1000 + 4 * kUnit));
+    EXPECT_TRUE(map.markBlock(0x1000 + 2 * kUnit, 0x1000 + 6 * kUnit));
+
+    EXPECT_TRUE(map.isCovered(0x1000));
+    EXPECT_TRUE(map.isCovered(0x1000 + 5 * kUnit));
+    EXPECT_FALSE(map.isCovered(0x1000 + 6 * kUnit));
+    EXPECT_EQ(map.coveredBytes(), 6 * kUnit);
+}
+
+// Test that addresses outside every range are ignored
+TEST(CoverageMapTest, IgnoresAddressesOutsideRanges) {
+    CoverageMap map;
+    map.addRange(0x1000, 0x1100);
+
+    EXPECT_FALSE(map.markBlock(0x0800, 0x0900));
+    EXPECT_FALSE(map.markBlock(0x1100, 0x1200));
+    EXPECT_FALSE(map.isCovered(0x0ffc));
+    EXPECT_FALSE(map.isCovered(0x1100));
+    EXPECT_EQ(map.coveredBytes(), 0u);
+}
+
+// Test that a block running past the range end is clipped to the range
+TEST(CoverageMapTest, ClipsBlockToRangeEnd) {
+    CoverageMap map;
+    map.addRange(0x1000, 0x1000 + 8 * kUnit);
+
+    EXPECT_TRUE(map.markBlock(0x1000 + 6 * kUnit, 0x1000 + 64 * kUnit));
+    EXPECT_EQ(map.coveredBytes(), 2 * kUnit);
+    // An empty block still covers its first unit
+    EXPECT_TRUE(map.markBlock(0x1000, 0x1000));
+    EXPECT_TRUE(map.isCovered(0x1000));
+}
+
+// Test that several ranges stay sorted and are looked up independently
+TEST(CoverageMapTest, MultipleRanges) {
+    CoverageMap map;
+    map.addRange(0x5000, 0x6000);
+    map.addRange(0x1000, 0x2000);
+    map.addRange(0x3000, 0x4000);
+    map.addRange(0x3000, 0x4000);  // Duplicate ranges are ignored
+
+    ASSERT_EQ(map.ranges().size(), 3u);
+    EXPECT_EQ(map.ranges()[0].start, 0x1000u);
+    EXPECT_EQ(map.ranges()[1].start, 0x3000u);
+    EXPECT_EQ(map.ranges()[2].start, 0x5000u);
+
+    EXPECT_TRUE(map.markBlock(0x5000, 0x5000 + kUnit));
+    EXPECT_TRUE(map.markBlock(0x1000, 0x1000 + kUnit));
+    EXPECT_TRUE(map.markBlock(0x3ff0, 0x4000));
+    EXPECT_FALSE(map.markBlock(0x2000, 0x2010));
+
+    EXPECT_TRUE(map.isCovered(0x5000));
+    EXPECT_TRUE(map.isCovered(0x1000));
+    EXPECT_TRUE(map.isCovered(0x3ff0));
+    EXPECT_FALSE(map.isCovered(0x3000));
+    EXPECT_EQ(map.coveredBytes(), 2 * kUnit + 0x10);
+}
+
+// Test that reset keeps the ranges while clear drops them
+TEST(CoverageMapTest, ResetAndClear) {
+    CoverageMap map;
+    map.addRange(0x1000, 0x2000);
+    map.markBlock(0x1000, 0x1100);
+
+    map.reset();
+    EXPECT_EQ(map.coveredBytes(), 0u);
+    ASSERT_EQ(map.ranges().size(), 1u);
+    EXPECT_TRUE(map.markBlock(0x1000, 0x1100));
+
+    map.clear();
+    EXPECT_TRUE(map.ranges().empty());
+    EXPECT_FALSE(map.isCovered(0x1000));
+}
@@ -0,0 +1,67 @@
+/**
+ * @file test_memory_access.cpp
+ * @brief Unit tests for the columnar memory access batch
+ */
+
+#include <gtest/gtest.h>
+
+#include "trace/memory_access.h"
+
+using namespace AnalysisToolkit::Trace;
+
+// Test that every column receives one value per access
+TEST(MemoryAccessBatchTest, AppendFillsAllColumns) {
+    MemoryAccessBatch batch;
+    EXPECT_TRUE(batch.empty());
+
+    batch.append(0x1000, 0x7f0000, 0x11, 1, MEMORY_ACCESS_READ);
+    batch.append(0x1004, 0x7f0008, 0xdeadbeefcafef00dULL, 8, MEMORY_ACCESS_WRITE);
+    batch.append(0x1008, 0x7f0010, 0, 16, MEMORY_ACCESS_READ | MEMORY_ACCESS_WRITE);
+
+    ASSERT_EQ(batch.count(), 3u);
+    EXPECT_FALSE(batch.empty());
+    EXPECT_EQ(batch.address.size(), 3u);
+    EXPECT_EQ(batch.value.size(), 3u);
+    EXPECT_EQ(batch.size.size(), 3u);
+    EXPECT_EQ(batch.kind.size(), 3u);
+
+    EXPECT_EQ(batch.pc[1], 0x1004u);
+    EXPECT_EQ(batch.address[1], 0x7f0008u);
+    EXPECT_EQ(batch.value[1], 0xdeadbeefcafef00dULL);
+    EXPECT_EQ(batch.size[1], 8u);
+    EXPECT_EQ(batch.kind[1], MEMORY_ACCESS_WRITE);
+    EXPECT_EQ(batch.size[2], 16u);
+    EXPECT_EQ(batch.kind[2], MEMORY_ACCESS_READ | MEMORY_ACCESS_WRITE);
+}
+
+// Test that clearing a batch keeps the reserved capacity for the next one
+TEST(MemoryAccessBatchTest, ClearKeepsCapacity) {
+    MemoryAccessBatch batch;
+    batch.reserve(256);
+    const uint64_t* pc_data = batch.pc.data();
+    const uint8_t* kind_data = batch.kind.data();
+
+    for (int round = 0; round < 3; ++round) {
+        for (uint64_t i = 0; i < 256; ++i) {
+            batch.append(i, i * 8, i, 4, MEMORY_ACCESS_READ);
+        }
+        ASSERT_EQ(batch.count(), 256u);
+        batch.clear();
+        EXPECT_TRUE(batch.empty());
+    }
+
+    // No column was reallocated while staying within the reserved size
+    EXPECT_EQ(batch.pc.data(), pc_data);
+    EXPECT_EQ(batch.kind.data(), kind_data);
+    EXPECT_GE(batch.value.capacity(), 256u);
+    EXPECT_GE(batch.size.capacity(), 256u);
+}
+
+// Test the default configuration traces both directions
+TEST(MemoryAccessBatchTest, DefaultConfig) {
+    MemoryTraceConfig config;
+    EXPECT_TRUE(config.trace_reads);
+    EXPECT_TRUE(config.trace_writes);
+    EXPECT_GT(config.batch_size, 0u);
+    EXPECT_FALSE(config.consumer);
+}
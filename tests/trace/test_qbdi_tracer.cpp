@@ -0,0 +1,159 @@
+/**
+ * @file test_qbdi_tracer.cpp
+ * @brief Unit tests for QBDITracer function calls and hot-spot profiling through the VM
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "trace/qbdi.h"
+#include "utility/ModuleIndex.h"
+
+using namespace AnalysisToolkit;
+using namespace AnalysisToolkit::Trace;
+
+namespace {
+
+extern "C" __attribute__((noinline)) uint64_t atkitTestSum8(uint64_t a,
+                                                            uint64_t b,
+                                                            uint64_t c,
+                                                            uint64_t d,
+                                                            uint64_t e,
+                                                            uint64_t f,
+                                                            uint64_t g,
+                                                            uint64_t h) {
+    return a + b + c + d + e + f + g + h;
+}
+
+extern "C" __attribute__((noinline)) uint64_t atkitTestMix(uint64_t a, uint64_t b) {
+    uint64_t value = a * 31 + b;
+    __asm__ volatile("" : "+r"(value));
+    return value ^ (value >> 3);
+}
+
+extern "C" __attribute__((noinline)) uint64_t atkitTestLoop(uint64_t iterations, uint64_t seed) {
+    uint64_t value = seed;
+    for (uint64_t i = 0; i < iterations; ++i) {
+        value = value * 6364136223846793005ULL + i;
+        __asm__ volatile("" : "+r"(value));
+    }
+    return value;
+}
+
+uint64_t addressOf(uint64_t (*function)(uint64_t, uint64_t)) {
+    return reinterpret_cast<uint64_t>(function);
+}
+
+class QBDITracerTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        tracer_.enableInstructionLogging(false);
+        ASSERT_TRUE(tracer_.initialize());
+    }
+
+    void TearDown() override {
+        tracer_.cleanup();
+    }
+
+    // Traces the executable segment that holds the test functions
+    bool startTestTrace() {
+        uint64_t address = addressOf(&atkitTestMix);
+        auto module = ModuleIndex::getInstance().findModuleContaining(address);
+        if (!module.has_value()) {
+            return false;
+        }
+        for (const auto& range : module->executable_ranges) {
+            if (address >= range.first && address < range.second) {
+                return tracer_.startTrace(range.first, range.second);
+            }
+        }
+        return false;
+    }
+
+    QBDITracer tracer_;
+};
+
+}  // namespace
+
+// Test that all eight register arguments reach the callee
+TEST_F(QBDITracerTest, CallFunctionPassesArguments) {
+    uint64_t address = reinterpret_cast<uint64_t>(&atkitTestSum8);
+    EXPECT_EQ(tracer_.callFunction(address, {1, 2, 3, 4, 5, 6, 7, 8}), 36u);
+    EXPECT_EQ(tracer_.callFunction(addressOf(&atkitTestMix), {5, 9}), atkitTestMix(5, 9));
+
+    // More than eight arguments is rejected
+    EXPECT_EQ(tracer_.callFunction(address, {1, 2, 3, 4, 5, 6, 7, 8, 9}), 0u);
+}
+
+// Test that a batch returns one result per argument set, in order
+TEST_F(QBDITracerTest, CallFunctionBatchMatchesSingleCalls) {
+    std::vector<std::vector<uint64_t>> arg_sets;
+    for (uint64_t i = 0; i < 64; ++i) {
+        arg_sets.push_back({i, i * 7 + 1});
+    }
+
+    std::vector<uint64_t> results = tracer_.callFunctionBatch(addressOf(&atkitTestMix), arg_sets);
+    ASSERT_EQ(results.size(), arg_sets.size());
+    for (size_t i = 0; i < arg_sets.size(); ++i) {
+        EXPECT_EQ(results[i], atkitTestMix(arg_sets[i][0], arg_sets[i][1])) << i;
+    }
+
+    EXPECT_TRUE(tracer_.callFunctionBatch(addressOf(&atkitTestMix), {}).empty());
+    EXPECT_TRUE(tracer_.callFunctionBatch(addressOf(&atkitTestMix), {{1, 2, 3, 4, 5, 6, 7, 8, 9}})
+                    .empty());
+}
+
+// Test that a traced call can itself call back into the VM from a callback
+TEST_F(QBDITracerTest, CallFunctionIsReentrantFromCallback) {
+    static thread_local bool in_nested_call = false;
+    std::atomic<uint64_t> nested_result{0};
+    std::atomic<uint64_t> callbacks{0};
+
+    InstructionSubscriber subscriber;
+    subscriber.needs_disassembly = false;
+    subscriber.callback = [this, &nested_result, &callbacks](const InstructionInfo&) {
+        callbacks.fetch_add(1);
+        if (!in_nested_call && nested_result.load() == 0) {
+            in_nested_call = true;
+            nested_result = tracer_.callFunction(addressOf(&atkitTestMix), {3, 4});
+            in_nested_call = false;
+        }
+    };
+    tracer_.addInstructionSubscriber(subscriber);
+    ASSERT_TRUE(startTestTrace());
+
+    EXPECT_EQ(tracer_.callFunction(addressOf(&atkitTestMix), {10, 20}), atkitTestMix(10, 20));
+    tracer_.stopTrace();
+
+    EXPECT_EQ(nested_result.load(), atkitTestMix(3, 4));
+    EXPECT_GT(callbacks.load(), 0u);
+}
+
+// Test that the loop body of a traced call is the hottest address
+TEST_F(QBDITracerTest, HotSpotsCountLoopBody) {
+    constexpr uint64_t kIterations = 500;
+    tracer_.enableProfiling(true);
+    ASSERT_TRUE(startTestTrace());
+
+    std::vector<std::vector<uint64_t>> arg_sets(4, {kIterations, 1});
+    std::vector<uint64_t> results = tracer_.callFunctionBatch(addressOf(&atkitTestLoop), arg_sets);
+    ASSERT_EQ(results.size(), arg_sets.size());
+    EXPECT_EQ(results[0], atkitTestLoop(kIterations, 1));
+    tracer_.stopTrace();
+
+    std::vector<HotSpot> hot_spots = tracer_.getHotSpots(5);
+    ASSERT_FALSE(hot_spots.empty());
+    EXPECT_GE(hot_spots[0].count, arg_sets.size() * kIterations);
+    for (size_t i = 1; i < hot_spots.size(); ++i) {
+        EXPECT_GE(hot_spots[i - 1].count, hot_spots[i].count);
+    }
+
+    // The hottest address lies inside the loop function's module and is symbolized
+    auto module = ModuleIndex::getInstance().findModuleContaining(addressOf(&atkitTestLoop));
+    ASSERT_TRUE(module.has_value());
+    EXPECT_TRUE(module->contains(hot_spots[0].address));
+    EXPECT_FALSE(hot_spots[0].module.empty());
+}
@@ -0,0 +1,239 @@
+/**
+ * @file test_register_trace.cpp
+ * @brief Unit tests for the register-delta trace encoder, writer and reader
+ */
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <array>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "trace/register_trace.h"
+
+using namespace AnalysisToolkit::Trace;
+
+namespace {
+
+constexpr uint32_t kRegisterCount = 34;
+constexpr uint32_t kPcIndex = 33;
+constexpr uint32_t kKeyframeInterval = 100;
+constexpr uint64_t kRecordsPerThread = 1037;
+
+using RegisterState = std::array<uint64_t, kRegisterCount>;
+
+std::string tempPath(const char* name) {
+    return "/tmp/atkit_" + std::string(name) + "_" + std::to_string(getpid()) + ".regtrace";
+}
+
+// Drives an encoder with a pseudo-random instruction stream and keeps the expected states
+std::vector<RegisterState> encodeStream(RegisterTraceWriter& writer, uint32_t thread_id) {
+    RegisterTraceEncoder encoder;
+    encoder.attach(&writer, thread_id);
+
+    std::mt19937_64 rng(thread_id);
+    std::vector<RegisterState> states;
+    uint64_t registers[kRegisterCount] = {};
+    uint64_t pc = 0x400000;
+    for (uint64_t i = 0; i < kRecordsPerThread; ++i) {
+        // A register changed behind the encoder's back is picked up after invalidate()
+        if (i == 500) {
+            encoder.invalidate();
+            registers[3] = 77;
+        }
+        registers[kPcIndex] = pc;
+        states.emplace_back();
+        std::copy(registers, registers + kRegisterCount, states.back().begin());
+
+        uint32_t written = static_cast<uint32_t>(rng() % kPcIndex);
+        encoder.record(pc, registers, 1ULL << written);
+        registers[written] += rng() % 1000 - 500;
+        pc += 4;
+        if (rng() % 10 == 0) {
+            pc -= 40;
+        }
+    }
+    encoder.detach();
+    return states;
+}
+
+class RegisterTraceTest : public ::testing::TestWithParam<bool> {
+  protected:
+    void SetUp() override {
+        path_ = tempPath(GetParam() ? "register_trace_z" : "register_trace_raw");
+        RegisterTraceConfig config;
+        config.output_path = path_;
+        config.keyframe_interval = kKeyframeInterval;
+        config.compress = GetParam();
+
+        RegisterTraceWriter writer;
+        ASSERT_TRUE(writer.open(config, kRegisterCount, kPcIndex));
+
+        // Several threads interleave their chunks in one file
+        std::vector<std::thread> threads;
+        for (uint32_t tid = 1; tid <= 4; ++tid) {
+            expected_[tid];
+        }
+        for (uint32_t tid = 1; tid <= 4; ++tid) {
+            threads.emplace_back([this, &writer, tid]() {
+                expected_[tid] = encodeStream(writer, tid);
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        ASSERT_TRUE(writer.close());
+    }
+
+    void TearDown() override {
+        unlink(path_.c_str());
+    }
+
+    void expectState(const RegisterTraceEntry& entry, uint32_t tid, uint64_t sequence) {
+        ASSERT_EQ(entry.thread_id, tid);
+        ASSERT_EQ(entry.sequence, sequence);
+        const RegisterState& state = expected_[tid][sequence];
+        EXPECT_EQ(entry.address, state[kPcIndex]);
+        for (uint32_t i = 0; i < kRegisterCount; ++i) {
+            ASSERT_EQ(entry.registers[i], state[i]) << "register " << i << " at " << sequence;
+        }
+    }
+
+    std::string path_;
+    std::map<uint32_t, std::vector<RegisterState>> expected_;
+};
+
+}  // namespace
+
+// Test that replaying every thread reproduces every register state
+TEST_P(RegisterTraceTest, RoundTrip) {
+    RegisterTraceReader reader;
+    ASSERT_TRUE(reader.open(path_));
+    EXPECT_EQ(reader.registerCount(), kRegisterCount);
+    EXPECT_EQ(reader.pcIndex(), kPcIndex);
+    EXPECT_EQ(reader.recordCount(), 4 * kRecordsPerThread);
+    ASSERT_EQ(reader.threads().size(), 4u);
+
+    for (uint32_t tid = 1; tid <= 4; ++tid) {
+        ASSERT_EQ(reader.recordCount(tid), kRecordsPerThread);
+        uint64_t next = 0;
+        reader.forEach(tid, 0, UINT64_MAX, [&](const RegisterTraceEntry& entry) {
+            expectState(entry, tid, next++);
+            return !HasFatalFailure();
+        });
+        EXPECT_EQ(next, kRecordsPerThread);
+    }
+}
+
+// Test random access: each state is rebuilt from the keyframe of its chunk
+TEST_P(RegisterTraceTest, StateAtSequence) {
+    RegisterTraceReader reader;
+    ASSERT_TRUE(reader.open(path_));
+
+    for (uint32_t tid = 1; tid <= 4; ++tid) {
+        for (uint64_t sequence : {uint64_t{0}, uint64_t{99}, uint64_t{100}, uint64_t{555},
+                                  kRecordsPerThread - 1}) {
+            RegisterTraceEntry entry;
+            ASSERT_TRUE(reader.stateAt(tid, sequence, entry));
+            expectState(entry, tid, sequence);
+            EXPECT_EQ(entry.keyframe, sequence % kKeyframeInterval == 0);
+        }
+        RegisterTraceEntry entry;
+        EXPECT_FALSE(reader.stateAt(tid, kRecordsPerThread, entry));
+    }
+    RegisterTraceEntry entry;
+    EXPECT_FALSE(reader.stateAt(99, 0, entry));
+}
+
+// Test replaying a window that starts mid-chunk
+TEST_P(RegisterTraceTest, ForEachWindow) {
+    RegisterTraceReader reader;
+    ASSERT_TRUE(reader.open(path_));
+
+    uint64_t next = 150;
+    reader.forEach(2, 150, 160, [&](const RegisterTraceEntry& entry) {
+        expectState(entry, 2, next++);
+        return !HasFatalFailure();
+    });
+    EXPECT_EQ(next, 310u);
+}
+
+INSTANTIATE_TEST_SUITE_P(Compression, RegisterTraceTest, ::testing::Bool());
+
+// Test that only the changed registers are stored between keyframes
+TEST(RegisterTraceEncoderTest, StoresOnlyChangedRegisters) {
+    std::string path = tempPath("register_trace_delta");
+    RegisterTraceConfig config;
+    config.output_path = path;
+    config.keyframe_interval = 8;
+
+    RegisterTraceWriter writer;
+    ASSERT_TRUE(writer.open(config, kRegisterCount, kPcIndex));
+    RegisterTraceEncoder encoder;
+    encoder.attach(&writer, 7);
+
+    uint64_t registers[kRegisterCount] = {};
+    for (uint64_t i = 0; i < 10; ++i) {
+        registers[kPcIndex] = 0x1000 + i * 4;
+        encoder.record(registers[kPcIndex], registers, 1ULL << 0);
+        registers[0] = i + 1;
+    }
+    EXPECT_EQ(encoder.sequence(), 10u);
+    encoder.detach();
+    ASSERT_TRUE(writer.close());
+
+    RegisterTraceReader reader;
+    ASSERT_TRUE(reader.open(path));
+    ASSERT_EQ(reader.chunks().size(), 2u);
+    std::vector<RegisterTraceEntry> entries;
+    reader.forEach(7, 0, UINT64_MAX, [&entries](const RegisterTraceEntry& entry) {
+        entries.push_back(entry);
+        return true;
+    });
+    ASSERT_EQ(entries.size(), 10u);
+
+    // The keyframe carries every register except PC; later records only x0
+    EXPECT_TRUE(entries[0].keyframe);
+    EXPECT_EQ(entries[0].changed_mask, ((1ULL << kRegisterCount) - 1) & ~(1ULL << kPcIndex));
+    for (size_t i = 1; i < 8; ++i) {
+        EXPECT_FALSE(entries[i].keyframe);
+        EXPECT_EQ(entries[i].changed_mask, 1ULL << 0);
+        EXPECT_EQ(entries[i].registers[0], i);
+    }
+    EXPECT_TRUE(entries[8].keyframe);
+    EXPECT_EQ(entries[9].registers[0], 9u);
+
+    reader.close();
+    unlink(path.c_str());
+}
+
+// Test that a truncated file is rejected
+TEST(RegisterTraceReaderTest, RejectsTruncatedFile) {
+    std::string path = tempPath("register_trace_truncated");
+    RegisterTraceConfig config;
+    config.output_path = path;
+
+    RegisterTraceWriter writer;
+    ASSERT_TRUE(writer.open(config, kRegisterCount, kPcIndex));
+    RegisterTraceEncoder encoder;
+    encoder.attach(&writer, 1);
+    uint64_t registers[kRegisterCount] = {};
+    encoder.record(0x1000, registers, 0);
+    encoder.detach();
+    ASSERT_TRUE(writer.close());
+
+    FILE* file = fopen(path.c_str(), "rb");
+    ASSERT_NE(file, nullptr);
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    ASSERT_EQ(truncate(path.c_str(), size - 4), 0);
+
+    RegisterTraceReader reader;
+    EXPECT_FALSE(reader.open(path));
+    unlink(path.c_str());
+}
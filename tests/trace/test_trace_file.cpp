@@ -0,0 +1,286 @@
+/**
+ * @file test_trace_file.cpp
+ * @brief Unit tests for the indexed trace file writer and memory-mapped reader
+ */
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "trace/trace_file.h"
+#include "trace/trace_recorder.h"
+
+using namespace AnalysisToolkit::Trace;
+
+namespace {
+
+constexpr uint32_t kChunkRecords = 100;
+constexpr uint64_t kRecordCount = 1050;
+
+std::string tempPath(const char* name) {
+    return "/tmp/atkit_" + std::string(name) + "_" + std::to_string(getpid()) + ".trace";
+}
+
+TraceRecord makeRecord(uint64_t i) {
+    TraceRecord record;
+    record.address = 0x400000 + (i % 37) * 4;
+    record.sequence = i / 2;
+    record.thread_id = 100 + static_cast<uint32_t>(i % 2);
+    record.flags = i % 5 == 0 ? TRACE_RECORD_BLOCK_ENTRY : TRACE_RECORD_NONE;
+    return record;
+}
+
+uint64_t timestampOf(uint64_t i) {
+    return 1000000 + i * 10;
+}
+
+// Writes kRecordCount records in uneven batches with one timestamp per record
+bool writeTestFile(const std::string& path, bool compress) {
+    TraceFileOptions options;
+    options.chunk_records = kChunkRecords;
+    options.compress = compress;
+
+    TraceFileWriter writer;
+    if (!writer.open(path, options)) {
+        return false;
+    }
+    std::vector<TraceRecord> records;
+    std::vector<uint64_t> timestamps;
+    for (uint64_t i = 0; i < kRecordCount; ++i) {
+        records.push_back(makeRecord(i));
+        timestamps.push_back(timestampOf(i));
+        if (records.size() == 33 || i + 1 == kRecordCount) {
+            writer.append(records.data(), timestamps.data(), records.size());
+            records.clear();
+            timestamps.clear();
+        }
+    }
+    writer.annotate(0x400000, "mov x0, x1");
+    writer.annotate(0x400000, "ignored duplicate");
+    writer.annotate(0x400004, "ret");
+    return writer.close();
+}
+
+void expectEntry(const TraceFileEntry& entry, uint64_t i) {
+    TraceRecord expected = makeRecord(i);
+    EXPECT_EQ(entry.index, i);
+    EXPECT_EQ(entry.address, expected.address);
+    EXPECT_EQ(entry.sequence, expected.sequence);
+    EXPECT_EQ(entry.thread_id, expected.thread_id);
+    EXPECT_EQ(entry.flags, expected.flags);
+    EXPECT_EQ(entry.timestamp, timestampOf(i));
+}
+
+class TraceFileTest : public ::testing::TestWithParam<bool> {
+  protected:
+    void SetUp() override {
+        path_ = tempPath(GetParam() ? "trace_file_z" : "trace_file_raw");
+        ASSERT_TRUE(writeTestFile(path_, GetParam()));
+    }
+
+    void TearDown() override {
+        unlink(path_.c_str());
+    }
+
+    std::string path_;
+};
+
+}  // namespace
+
+// Test that every record survives the round trip, with or without compression
+TEST_P(TraceFileTest, RoundTrip) {
+    TraceFileReader reader;
+    ASSERT_TRUE(reader.open(path_));
+    EXPECT_EQ(reader.recordCount(), kRecordCount);
+    EXPECT_EQ(reader.chunkCount(), (kRecordCount + kChunkRecords - 1) / kChunkRecords);
+
+    uint64_t next = 0;
+    reader.forEach(0, kRecordCount, [&next](const TraceFileEntry& entry) {
+        expectEntry(entry, next++);
+        return true;
+    });
+    EXPECT_EQ(next, kRecordCount);
+
+    EXPECT_EQ(reader.disassembly(0x400000), "mov x0, x1");
+    EXPECT_EQ(reader.disassembly(0x400004), "ret");
+    EXPECT_TRUE(reader.disassembly(0x400008).empty());
+}
+
+// Test random access to record N and iteration starting mid-chunk
+TEST_P(TraceFileTest, SeekToRecord) {
+    TraceFileReader reader;
+    ASSERT_TRUE(reader.open(path_));
+
+    for (uint64_t index : {uint64_t{0}, uint64_t{99}, uint64_t{100}, uint64_t{517},
+                           kRecordCount - 1}) {
+        TraceFileEntry entry;
+        ASSERT_TRUE(reader.read(index, entry)) << index;
+        expectEntry(entry, index);
+    }
+    TraceFileEntry entry;
+    EXPECT_FALSE(reader.read(kRecordCount, entry));
+
+    // Crosses two chunk boundaries
+    std::vector<uint64_t> indices;
+    reader.forEach(250, 120, [&indices](const TraceFileEntry& entry) {
+        indices.push_back(entry.index);
+        return true;
+    });
+    ASSERT_EQ(indices.size(), 120u);
+    EXPECT_EQ(indices.front(), 250u);
+    EXPECT_EQ(indices.back(), 369u);
+
+    // Requests past the end are clipped
+    size_t tail = 0;
+    reader.forEach(kRecordCount - 10, 100, [&tail](const TraceFileEntry&) {
+        ++tail;
+        return true;
+    });
+    EXPECT_EQ(tail, 10u);
+}
+
+// Test that a time window returns exactly the records stamped inside it
+TEST_P(TraceFileTest, TimeWindow) {
+    TraceFileReader reader;
+    ASSERT_TRUE(reader.open(path_));
+
+    std::vector<uint64_t> indices;
+    reader.forEachInTimeWindow(
+        timestampOf(305), timestampOf(412), [&indices](const TraceFileEntry& entry) {
+            indices.push_back(entry.index);
+            return true;
+        });
+    ASSERT_EQ(indices.size(), 412u - 305u);
+    for (size_t i = 0; i < indices.size(); ++i) {
+        EXPECT_EQ(indices[i], 305 + i);
+    }
+
+    // The callback can stop the scan early
+    size_t seen = 0;
+    reader.forEachInTimeWindow(0, UINT64_MAX, [&seen](const TraceFileEntry&) {
+        return ++seen < 5;
+    });
+    EXPECT_EQ(seen, 5u);
+
+    const std::vector<TraceChunkIndexEntry>& chunks = reader.chunks();
+    EXPECT_EQ(chunks[1].first_timestamp, timestampOf(kChunkRecords));
+    EXPECT_EQ(chunks[1].last_timestamp, timestampOf(2 * kChunkRecords - 1));
+}
+
+INSTANTIATE_TEST_SUITE_P(Compression, TraceFileTest, ::testing::Bool());
+
+// Test that timestamps out of order within a chunk decode exactly
+TEST(TraceFileReaderTest, NonMonotonicTimestamps) {
+    std::string path = tempPath("trace_unordered");
+    TraceFileOptions options;
+    options.chunk_records = 4;
+
+    // Interleaved thread drains: each chunk starts above its minimum
+    const std::vector<uint64_t> timestamps = {100, 50, 200, 75, 900, 10, 910, 5, 300};
+    std::vector<TraceRecord> records;
+    for (uint64_t i = 0; i < timestamps.size(); ++i) {
+        records.push_back(makeRecord(i));
+    }
+    TraceFileWriter writer;
+    ASSERT_TRUE(writer.open(path, options));
+    writer.append(records.data(), timestamps.data(), records.size());
+    ASSERT_TRUE(writer.close());
+
+    TraceFileReader reader;
+    ASSERT_TRUE(reader.open(path));
+    ASSERT_EQ(reader.recordCount(), timestamps.size());
+    for (uint64_t i = 0; i < timestamps.size(); ++i) {
+        TraceFileEntry entry;
+        ASSERT_TRUE(reader.read(i, entry));
+        EXPECT_EQ(entry.timestamp, timestamps[i]) << i;
+        EXPECT_EQ(entry.address, records[i].address);
+    }
+    EXPECT_EQ(reader.chunks()[0].first_timestamp, 50u);
+    EXPECT_EQ(reader.chunks()[1].last_timestamp, 910u);
+
+    std::vector<uint64_t> indices;
+    reader.forEachInTimeWindow(40, 101, [&indices](const TraceFileEntry& entry) {
+        indices.push_back(entry.index);
+        return true;
+    });
+    EXPECT_EQ(indices, (std::vector<uint64_t>{0, 1, 3}));
+
+    reader.close();
+    unlink(path.c_str());
+}
+
+// Test that a damaged footer or a truncated file is rejected instead of misread
+TEST(TraceFileReaderTest, RejectsCorruptFooter) {
+    std::string path = tempPath("trace_corrupt");
+    ASSERT_TRUE(writeTestFile(path, true));
+
+    FILE* file = fopen(path.c_str(), "r+b");
+    ASSERT_NE(file, nullptr);
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+
+    // Point the index past the end of the file
+    TraceFileFooter footer;
+    fseek(file, size - static_cast<long>(sizeof(footer)), SEEK_SET);
+    ASSERT_EQ(fread(&footer, sizeof(footer), 1, file), 1u);
+    footer.index_offset = static_cast<uint64_t>(size);
+    fseek(file, size - static_cast<long>(sizeof(footer)), SEEK_SET);
+    fwrite(&footer, sizeof(footer), 1, file);
+    fclose(file);
+
+    TraceFileReader reader;
+    EXPECT_FALSE(reader.open(path));
+    EXPECT_FALSE(reader.isOpen());
+
+    // A file cut off before its footer has no valid trailer magic
+    ASSERT_EQ(truncate(path.c_str(), size - 8), 0);
+    EXPECT_FALSE(reader.open(path));
+
+    unlink(path.c_str());
+    EXPECT_FALSE(reader.open(path));
+}
+
+// Test that the recorder's indexed output carries producer-side timestamps
+TEST(TraceFileReaderTest, RecorderStampsRecordsWhenProduced) {
+    std::string path = tempPath("trace_recorder_indexed");
+    RecorderConfig config;
+    config.output_path = path;
+    config.file_format = RecordFileFormat::Indexed;
+    config.chunk_records = 64;
+    config.buffer_capacity = 1 << 14;
+    // Long enough that a drain-time stamp would fall after the second phase began
+    config.flush_interval_ms = 1000;
+
+    TraceRecorder recorder;
+    ASSERT_TRUE(recorder.start(config));
+    uint64_t before = traceTimestampNs();
+    for (uint64_t i = 0; i < TraceRingBuffer::kTimestampStride; ++i) {
+        recorder.record(0x1000 + i);
+    }
+    usleep(20000);
+    uint64_t middle = traceTimestampNs();
+    for (uint64_t i = 0; i < TraceRingBuffer::kTimestampStride; ++i) {
+        recorder.record(0x2000 + i);
+    }
+    recorder.stop();
+    uint64_t after = traceTimestampNs();
+
+    TraceFileReader reader;
+    ASSERT_TRUE(reader.open(path));
+    ASSERT_EQ(reader.recordCount(), 2 * TraceRingBuffer::kTimestampStride);
+    reader.forEach(0, reader.recordCount(), [&](const TraceFileEntry& entry) {
+        if (entry.index < TraceRingBuffer::kTimestampStride) {
+            EXPECT_GE(entry.timestamp, before);
+            EXPECT_LT(entry.timestamp, middle);
+        } else {
+            EXPECT_GE(entry.timestamp, middle);
+            EXPECT_LE(entry.timestamp, after);
+        }
+        return true;
+    });
+    reader.close();
+    unlink(path.c_str());
+}
@@ -0,0 +1,196 @@
+/**
+ * @file test_trace_recorder.cpp
+ * @brief Unit tests for the per-thread ring buffer and the binary trace recorder
+ */
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "trace/trace_recorder.h"
+
+using namespace AnalysisToolkit::Trace;
+
+namespace {
+
+std::string tempPath(const char* name) {
+    return "/tmp/atkit_" + std::string(name) + "_" + std::to_string(getpid());
+}
+
+// Collects every delivered record, grouped by thread
+struct RecordSink {
+    std::mutex mutex;
+    std::map<uint32_t, std::vector<TraceRecord>> records;
+    size_t total = 0;
+
+    RecordBatchCallback callback() {
+        return [this](const TraceRecord* batch, size_t count) {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (size_t i = 0; i < count; ++i) {
+                records[batch[i].thread_id].push_back(batch[i]);
+            }
+            total += count;
+        };
+    }
+};
+
+}  // namespace
+
+// Test that records drain in order with consecutive sequence numbers
+TEST(TraceRingBufferTest, PushAndDrainInOrder) {
+    TraceRingBuffer buffer(64, 7);
+    for (uint64_t i = 0; i < 10; ++i) {
+        ASSERT_TRUE(buffer.push(0x1000 + i * 4, TRACE_RECORD_NONE));
+    }
+
+    TraceRecord out[16];
+    ASSERT_EQ(buffer.drain(out, 16), 10u);
+    for (uint64_t i = 0; i < 10; ++i) {
+        EXPECT_EQ(out[i].address, 0x1000 + i * 4);
+        EXPECT_EQ(out[i].sequence, i);
+        EXPECT_EQ(out[i].thread_id, 7u);
+    }
+    EXPECT_EQ(buffer.drain(out, 16), 0u);
+    EXPECT_EQ(buffer.recorded(), 10u);
+}
+
+// Test that a full buffer drops new records and leaves a gap in the sequence
+TEST(TraceRingBufferTest, FullBufferDropsAndCounts) {
+    TraceRingBuffer buffer(64, 1);
+    for (uint64_t i = 0; i < 64; ++i) {
+        ASSERT_TRUE(buffer.push(i, TRACE_RECORD_NONE));
+    }
+    EXPECT_FALSE(buffer.push(64, TRACE_RECORD_NONE));
+    EXPECT_FALSE(buffer.push(65, TRACE_RECORD_NONE));
+    EXPECT_EQ(buffer.dropped(), 2u);
+
+    // Draining frees room; the next record keeps its own sequence number
+    TraceRecord out[64];
+    ASSERT_EQ(buffer.drain(out, 64), 64u);
+    ASSERT_TRUE(buffer.push(0x2000, TRACE_RECORD_BLOCK_ENTRY));
+    ASSERT_EQ(buffer.drain(out, 64), 1u);
+    EXPECT_EQ(out[0].sequence, 66u);
+    EXPECT_EQ(out[0].flags, static_cast<uint32_t>(TRACE_RECORD_BLOCK_ENTRY));
+}
+
+// Test that records from several threads all reach the consumer
+TEST(TraceRecorderTest, DeliversRecordsFromAllThreads) {
+    RecordSink sink;
+    RecorderConfig config;
+    config.consumer = sink.callback();
+    config.buffer_capacity = 1 << 12;
+    config.flush_interval_ms = 1;
+
+    TraceRecorder recorder;
+    ASSERT_TRUE(recorder.start(config));
+
+    constexpr int kThreads = 4;
+    constexpr uint64_t kRecords = 2000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&recorder]() {
+            for (uint64_t i = 0; i < kRecords; ++i) {
+                recorder.record(0x4000 + i);
+                // Leave the drainer time to keep up so nothing is dropped
+                if ((i & 255) == 255) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    recorder.stop();
+
+    TraceRecorder::Stats stats = recorder.getStats();
+    EXPECT_EQ(stats.thread_buffers, static_cast<uint32_t>(kThreads));
+    EXPECT_EQ(stats.recorded_count, kThreads * kRecords);
+    EXPECT_EQ(stats.dropped_count, 0u);
+    EXPECT_EQ(stats.flushed_count, kThreads * kRecords);
+
+    ASSERT_EQ(sink.records.size(), static_cast<size_t>(kThreads));
+    for (const auto& pair : sink.records) {
+        ASSERT_EQ(pair.second.size(), kRecords);
+        for (uint64_t i = 0; i < kRecords; ++i) {
+            EXPECT_EQ(pair.second[i].sequence, i);
+            EXPECT_EQ(pair.second[i].address, 0x4000 + i);
+        }
+    }
+}
+
+// Test that a restart retires the old buffers and starts every thread afresh
+TEST(TraceRecorderTest, RestartRetiresBuffers) {
+    RecordSink first;
+    RecorderConfig config;
+    config.consumer = first.callback();
+
+    TraceRecorder recorder;
+    ASSERT_TRUE(recorder.start(config));
+    recorder.record(0x1000);
+    recorder.stop();
+    EXPECT_EQ(first.total, 1u);
+
+    RecordSink second;
+    config.consumer = second.callback();
+    ASSERT_TRUE(recorder.start(config));
+    EXPECT_EQ(recorder.getStats().thread_buffers, 0u);
+
+    // The first record of the new session picks up a fresh buffer
+    recorder.record(0x2000);
+    recorder.record(0x2004);
+    recorder.reclaimRetired();
+    recorder.stop();
+
+    ASSERT_EQ(second.total, 2u);
+    const std::vector<TraceRecord>& records = second.records.begin()->second;
+    EXPECT_EQ(records[0].address, 0x2000u);
+    EXPECT_EQ(records[0].sequence, 0u);
+    EXPECT_EQ(records[1].sequence, 1u);
+}
+
+// Test that the raw file format is a header followed by the fixed-size records
+TEST(TraceRecorderTest, RawFileRoundTrip) {
+    std::string path = tempPath("trace_raw") + ".bin";
+    RecorderConfig config;
+    config.output_path = path;
+    config.file_format = RecordFileFormat::Raw;
+
+    TraceRecorder recorder;
+    ASSERT_TRUE(recorder.start(config));
+    for (uint64_t i = 0; i < 100; ++i) {
+        recorder.record(0x8000 + i * 4, i % 2 == 0 ? TRACE_RECORD_BLOCK_ENTRY : TRACE_RECORD_NONE);
+    }
+    recorder.stop();
+
+    FILE* file = fopen(path.c_str(), "rb");
+    ASSERT_NE(file, nullptr);
+    char magic[8];
+    uint32_t version = 0;
+    uint32_t record_size = 0;
+    ASSERT_EQ(fread(magic, sizeof(magic), 1, file), 1u);
+    ASSERT_EQ(fread(&version, sizeof(version), 1, file), 1u);
+    ASSERT_EQ(fread(&record_size, sizeof(record_size), 1, file), 1u);
+    EXPECT_EQ(memcmp(magic, "ATKTRACE", sizeof(magic)), 0);
+    EXPECT_EQ(record_size, sizeof(TraceRecord));
+
+    std::vector<TraceRecord> records(128);
+    size_t count = fread(records.data(), sizeof(TraceRecord), records.size(), file);
+    fclose(file);
+    unlink(path.c_str());
+
+    ASSERT_EQ(count, 100u);
+    for (uint64_t i = 0; i < count; ++i) {
+        EXPECT_EQ(records[i].address, 0x8000 + i * 4);
+        EXPECT_EQ(records[i].sequence, i);
+        EXPECT_EQ(records[i].thread_id, TraceRecorder::currentThreadId());
+        EXPECT_EQ(records[i].flags, i % 2 == 0 ? TRACE_RECORD_BLOCK_ENTRY : TRACE_RECORD_NONE);
+    }
+}
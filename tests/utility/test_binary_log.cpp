@@ -0,0 +1,154 @@
+/**
+ * @file test_binary_log.cpp
+ * @brief Unit tests for the binary log format and decoder
+ */
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "utility/BinaryLog.h"
+#include "utility/Logger.h"
+
+using namespace AnalysisToolkit;
+
+namespace {
+
+template <typename... Args>
+std::string roundTrip(const char* format, Args... args) {
+    char buffer[kBinaryLogMaxPayload];
+    BinaryLogEncoder encoder(buffer, sizeof(buffer));
+    encoder.addAll(binaryLogStringArgs(format), args...);
+    std::string output;
+    formatBinaryLog(format, buffer, encoder.size(), output);
+    return output;
+}
+
+}  // namespace
+
+// Test that decoding matches printf for the supported conversions
+TEST(BinaryLogTest, FormatMatchesPrintf) {
+    EXPECT_EQ(roundTrip("int %d, neg %i", 42, -7), "int 42, neg -7");
+    EXPECT_EQ(roundTrip("hex 0x%08lx %X", 0xbeefUL, 255u), "hex 0x0000beef FF");
+    EXPECT_EQ(roundTrip("float %.2f %g", 3.14159, 0.5f), "float 3.14 0.5");
+    EXPECT_EQ(roundTrip("str [%s] [%-5s]", "abc", "de"), "str [abc] [de   ]");
+    EXPECT_EQ(roundTrip("char %c 100%%", 'x'), "char x 100%");
+    EXPECT_EQ(roundTrip("size %zu ll %lld", static_cast<size_t>(9), -1LL), "size 9 ll -1");
+
+    char expected[64];
+    void* pointer = reinterpret_cast<void*>(0x1234);
+    snprintf(expected, sizeof(expected), "ptr %p", pointer);
+    EXPECT_EQ(roundTrip("ptr %p", pointer), expected);
+}
+
+// Test that the format, not the argument type, decides whether a char* is copied
+TEST(BinaryLogTest, CharPointerFollowsConversion) {
+    static_assert(binaryLogStringArgs("%s %p %d %-8s 100%% %zu %s") == (0b1001 | 1ULL << 5));
+    static_assert(binaryLogStringArgs("no args") == 0);
+
+    // A byte buffer logged with %p is not terminated and must not be read
+    char bytes[4] = {'a', 'b', 'c', 'd'};
+    char expected[64];
+    snprintf(expected, sizeof(expected), "buf %p", static_cast<void*>(bytes));
+    EXPECT_EQ(roundTrip("buf %p", bytes), expected);
+
+    const char* name = "libc.so";
+    snprintf(expected, sizeof(expected), "%s at %p", name, static_cast<const void*>(name));
+    EXPECT_EQ(roundTrip("%s at %p", name, name), expected);
+}
+
+// Test that missing arguments are marked instead of reading garbage
+TEST(BinaryLogTest, MissingArgumentsAreMarked) {
+    EXPECT_EQ(roundTrip("%d %d", 1), "1 <?>");
+}
+
+// Test that format IDs are stable and resolvable
+TEST(BinaryLogTest, RegisterAndLookupFormat) {
+    static const char kFormat[] = "registered %d";
+    uint32_t id = BinaryLogFormats::registerFormat(kFormat);
+    ASSERT_NE(id, kBinaryLogText);
+    EXPECT_EQ(BinaryLogFormats::lookup(id), kFormat);
+    EXPECT_GE(BinaryLogFormats::count(), id);
+    EXPECT_EQ(BinaryLogFormats::lookup(kBinaryLogText), nullptr);
+}
+
+// Test end-to-end binary logging through the Logger and the offline reader
+TEST(BinaryLogTest, LoggerWritesDecodableFile) {
+    Logger* logger = Logger::getInstance();
+    std::string path = "/tmp/atkit_binary_log_test_" + std::to_string(getpid()) + ".blog";
+    unlink(path.c_str());
+
+    logger->enableConsole(false);
+    ASSERT_TRUE(logger->setLogFile(path));
+    logger->setLogFormat(LogFormat::BINARY);
+    EXPECT_TRUE(logger->isAsync());
+
+    for (int i = 0; i < 100; ++i) {
+        ATKIT_BLOG_INFO("hit %d at %p", i, reinterpret_cast<void*>(0x1000 + i));
+    }
+    ATKIT_BLOG_WARN("module %s", "libc.so");
+    logger->warn("plain text");
+    logger->flush();
+
+    std::vector<BinaryLogEntry> entries;
+    bool ok = BinaryLogReader::decodeFile(path, [&entries](const BinaryLogEntry& entry) {
+        entries.push_back(entry);
+        return true;
+    });
+
+    logger->setLogFormat(LogFormat::TEXT);
+    logger->disableAsync();
+    logger->setLogFile("");
+    logger->enableConsole(true);
+    unlink(path.c_str());
+
+    ASSERT_TRUE(ok);
+    ASSERT_EQ(entries.size(), 102u);
+    char expected[64];
+    snprintf(expected, sizeof(expected), "hit 5 at %p", reinterpret_cast<void*>(0x1005));
+    EXPECT_EQ(entries[5].message, expected);
+    EXPECT_EQ(entries[5].level, LogLevel::INFO);
+    EXPECT_GT(entries[5].timestamp, 0u);
+    EXPECT_EQ(entries[100].message, "module libc.so");
+    EXPECT_EQ(entries[100].level, LogLevel::WARN);
+    EXPECT_EQ(entries[101].message, "plain text");
+}
+
+// Test that the zero-filled tail of a segment left by a crash is not decoded as records
+TEST(BinaryLogTest, DecoderStopsAtZeroTail) {
+    Logger* logger = Logger::getInstance();
+    std::string path = "/tmp/atkit_binary_log_tail_" + std::to_string(getpid()) + ".blog";
+    unlink(path.c_str());
+
+    logger->enableConsole(false);
+    ASSERT_TRUE(logger->setLogFile(path));
+    logger->setLogFormat(LogFormat::BINARY);
+    for (int i = 0; i < 10; ++i) {
+        ATKIT_BLOG_INFO("record %d", i);
+    }
+    logger->flush();
+    logger->setLogFormat(LogFormat::TEXT);
+    logger->disableAsync();
+    logger->setLogFile("");
+    logger->enableConsole(true);
+
+    // A pre-allocated segment that was never trimmed ends in zero pages
+    FILE* file = fopen(path.c_str(), "ab");
+    ASSERT_NE(file, nullptr);
+    std::vector<char> zeros(8192, 0);
+    fwrite(zeros.data(), 1, zeros.size(), file);
+    fclose(file);
+
+    std::vector<BinaryLogEntry> entries;
+    bool ok = BinaryLogReader::decodeFile(path, [&entries](const BinaryLogEntry& entry) {
+        entries.push_back(entry);
+        return true;
+    });
+    unlink(path.c_str());
+
+    ASSERT_TRUE(ok);
+    ASSERT_EQ(entries.size(), 10u);
+    EXPECT_EQ(entries[9].message, "record 9");
+}
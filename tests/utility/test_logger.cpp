@@ -0,0 +1,226 @@
+/**
+ * @file test_logger.cpp
+ * @brief Unit tests for Logger
+ */
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "utility/Logger.h"
+
+using namespace AnalysisToolkit;
+
+class LoggerTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        logger = Logger::getInstance();
+        log_path = "/tmp/atkit_logger_test_" + std::to_string(getpid()) + ".log";
+        unlink(log_path.c_str());
+        logger->enableConsole(false);
+        ASSERT_TRUE(logger->setLogFile(log_path));
+    }
+
+    void TearDown() override {
+        logger->disableAsync();
+        logger->setLogFile("");
+        logger->enableConsole(true);
+        logger->setMinLevel(LogLevel::DEBUG);
+        unlink(log_path.c_str());
+    }
+
+    size_t countLines(const std::string& needle = "") {
+        std::ifstream file(log_path);
+        std::string line;
+        size_t count = 0;
+        while (std::getline(file, line)) {
+            if (needle.empty() || line.find(needle) != std::string::npos) {
+                count++;
+            }
+        }
+        return count;
+    }
+
+    Logger* logger;
+    std::string log_path;
+};
+
+// Test synchronous file output format
+TEST_F(LoggerTest, SyncFileOutput) {
+    logger->info("hello %d", 42);
+    logger->flush();
+
+    std::ifstream file(log_path);
+    std::string line;
+    ASSERT_TRUE(std::getline(file, line));
+    EXPECT_NE(line.find("I "), std::string::npos);
+    EXPECT_NE(line.find("hello 42"), std::string::npos);
+}
+
+// Test that flush() is a barrier for all records logged before it
+TEST_F(LoggerTest, AsyncFlushBarrier) {
+    AsyncLogConfig config;
+    config.overflow_policy = LogOverflowPolicy::BLOCK;
+    config.flush_interval_ms = 1000;
+    ASSERT_TRUE(logger->enableAsync(config));
+    EXPECT_TRUE(logger->isAsync());
+
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 2000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([this, t] {
+            for (int i = 0; i < kPerThread; ++i) {
+                logger->info("async %d %d", t, i);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    logger->flush();
+    EXPECT_EQ(countLines("async "), static_cast<size_t>(kThreads * kPerThread));
+    EXPECT_EQ(logger->getDroppedCount(), 0u);
+}
+
+// Test that the drop policy accounts for every record
+TEST_F(LoggerTest, AsyncDropPolicyCountsDrops) {
+    AsyncLogConfig config;
+    config.queue_capacity = 4;
+    config.overflow_policy = LogOverflowPolicy::DROP;
+    ASSERT_TRUE(logger->enableAsync(config));
+
+    uint64_t dropped_before = logger->getDroppedCount();
+    constexpr size_t kRecords = 5000;
+    for (size_t i = 0; i < kRecords; ++i) {
+        logger->info("drop %zu", i);
+    }
+    logger->flush();
+
+    size_t written = countLines("drop ");
+    EXPECT_EQ(written + (logger->getDroppedCount() - dropped_before), kRecords);
+}
+
+// Test that disabling async mode drains pending records
+TEST_F(LoggerTest, DisableAsyncDrains) {
+    ASSERT_TRUE(logger->enableAsync());
+    for (int i = 0; i < 100; ++i) {
+        logger->warn("drain %d", i);
+    }
+    logger->disableAsync();
+    EXPECT_FALSE(logger->isAsync());
+    logger->flush();
+    EXPECT_EQ(countLines("drain "), 100u);
+}
+
+// Test that messages longer than the inline buffer are not truncated
+TEST_F(LoggerTest, LongMessageNotTruncated) {
+    std::string payload(4000, 'x');
+    logger->info("long %s end", payload.c_str());
+    logger->flush();
+
+    std::ifstream file(log_path);
+    std::string line;
+    ASSERT_TRUE(std::getline(file, line));
+    EXPECT_NE(line.find("long " + payload + " end"), std::string::npos);
+}
+
+// Test that a filtered macro does not evaluate its arguments
+TEST_F(LoggerTest, DisabledMacroSkipsArguments) {
+    logger->setMinLevel(LogLevel::WARN);
+    int evaluated = 0;
+    auto value = [&evaluated] { return ++evaluated; };
+
+    ATKIT_DEBUG("skipped %d", value());
+    ATKIT_INFO("skipped %d", value());
+    EXPECT_EQ(evaluated, 0);
+
+    ATKIT_WARN("kept %d", value());
+    EXPECT_EQ(evaluated, 1);
+    logger->flush();
+    EXPECT_EQ(countLines("skipped "), 0u);
+    EXPECT_EQ(countLines("kept 1"), 1u);
+}
+
+// Test that records carry a monotonic timestamp and thread id
+TEST_F(LoggerTest, FileRecordsCarryTimestampAndThread) {
+    logger->info("stamped");
+    logger->flush();
+
+    std::ifstream file(log_path);
+    std::string line;
+    ASSERT_TRUE(std::getline(file, line));
+    unsigned long long seconds = 0;
+    unsigned long long nanos = 0;
+    unsigned int thread_id = 0;
+    char level = 0;
+    ASSERT_EQ(sscanf(line.c_str(), "%llu.%llu %u %c", &seconds, &nanos, &thread_id, &level), 4);
+    EXPECT_LT(nanos, 1000000000ULL);
+    EXPECT_NE(thread_id, 0u);
+    EXPECT_EQ(level, 'I');
+}
+
+// Test that the mapped sink rotates on size and keeps a bounded number of files
+TEST_F(LoggerTest, RotatingFileKeepsBoundedSegments) {
+    LogRotationConfig config;
+    config.max_file_bytes = 256 * 1024;
+    config.max_files = 3;
+    ASSERT_TRUE(logger->setRotatingLogFile(log_path, config));
+
+    std::string payload(200, 'r');
+    constexpr int kRecords = 8000;  // ~1.8 MB, several rotations
+    for (int i = 0; i < kRecords; ++i) {
+        logger->info("rotate %d %s", i, payload.c_str());
+    }
+    logger->setLogFile("");
+
+    auto exists = [](const std::string& path) { return access(path.c_str(), F_OK) == 0; };
+    EXPECT_TRUE(exists(log_path));
+    EXPECT_TRUE(exists(log_path + ".1"));
+    EXPECT_TRUE(exists(log_path + ".2"));
+    EXPECT_FALSE(exists(log_path + ".3"));
+
+    // The newest segment is trimmed to its content and ends with the last record
+    std::ifstream file(log_path);
+    std::string line;
+    std::string last;
+    while (std::getline(file, line)) {
+        last = line;
+    }
+    EXPECT_NE(last.find("rotate " + std::to_string(kRecords - 1) + " "), std::string::npos);
+
+    unlink((log_path + ".1").c_str());
+    unlink((log_path + ".2").c_str());
+}
+
+// Test that a write larger than a segment gets one enlarged segment instead of being cut
+TEST_F(LoggerTest, RotatingFileKeepsOversizedRecordWhole) {
+    LogRotationConfig config;
+    config.max_file_bytes = 256 * 1024;
+    config.max_files = 2;
+    ASSERT_TRUE(logger->setRotatingLogFile(log_path, config));
+
+    std::string payload(300 * 1024, 'x');
+    logger->info("before");
+    logger->info("big %s end", payload.c_str());
+    logger->info("after");
+    logger->setLogFile("");
+
+    // The oversized record rotated into its own segment, followed by the next record
+    std::ifstream file(log_path);
+    std::string line;
+    std::vector<std::string> lines;
+    while (std::getline(file, line)) {
+        lines.push_back(line);
+    }
+    ASSERT_EQ(lines.size(), 2u);
+    EXPECT_NE(lines[0].find("big " + payload + " end"), std::string::npos);
+    EXPECT_NE(lines[1].find("after"), std::string::npos);
+
+    unlink((log_path + ".1").c_str());
+}
@@ -0,0 +1,134 @@
+/**
+ * @file test_memory_map_snapshot.cpp
+ * @brief Unit tests for MemoryMapSnapshot
+ */
+
+#include <gtest/gtest.h>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+
+#include "utility/MemoryMapSnapshot.h"
+
+using namespace AnalysisToolkit;
+
+namespace {
+
+MemoryPermissions perms(const char* text) {
+    return MemoryPermissions::fromString(text);
+}
+
+// Three regions: two adjacent ones followed by a gap
+std::vector<MemoryRegion> syntheticRegions() {
+    return {
+        MemoryRegion(0x3000, 0x4000, perms("rw-p"), 0, "00:00", 0, ""),
+        MemoryRegion(0x1000, 0x2000, perms("r-xp"), 0, "08:01", 42, "/lib/libfoo.so"),
+        MemoryRegion(0x2000, 0x3000, perms("r--p"), 0x1000, "08:01", 42, "/lib/libfoo.so"),
+        MemoryRegion(0x8000, 0x9000, perms("r-xp"), 0, "08:01", 43, "/lib/libbar.so"),
+    };
+}
+
+}  // namespace
+
+// Test address lookup, including region boundaries and gaps
+TEST(MemoryMapSnapshotTest, FindByAddress) {
+    MemoryMapSnapshot snapshot(syntheticRegions());
+    ASSERT_EQ(snapshot.size(), 4u);
+    EXPECT_EQ(snapshot.getRegions().front().getStartAddress(), 0x1000u);
+
+    EXPECT_EQ(snapshot.find(0xfff), nullptr);
+    ASSERT_NE(snapshot.find(0x1000), nullptr);
+    EXPECT_EQ(snapshot.find(0x1000)->getStartAddress(), 0x1000u);
+    EXPECT_EQ(snapshot.find(0x1fff)->getStartAddress(), 0x1000u);
+    EXPECT_EQ(snapshot.find(0x2000)->getStartAddress(), 0x2000u);
+    EXPECT_EQ(snapshot.find(0x4000), nullptr);
+    EXPECT_EQ(snapshot.find(0x8800)->getPathname(), "/lib/libbar.so");
+    EXPECT_EQ(snapshot.find(UINTPTR_MAX), nullptr);
+
+    EXPECT_EQ(MemoryMapSnapshot().find(0x1000), nullptr);
+}
+
+// Test that sorted and unsorted batches agree with single lookups
+TEST(MemoryMapSnapshotTest, BatchLookup) {
+    MemoryMapSnapshot snapshot(syntheticRegions());
+    std::vector<uintptr_t> addresses = {0x10, 0x1000, 0x1800, 0x2500, 0x3fff, 0x5000, 0x8000};
+
+    auto sorted = snapshot.findBatch(addresses);
+    ASSERT_EQ(sorted.size(), addresses.size());
+    for (size_t i = 0; i < addresses.size(); ++i) {
+        EXPECT_EQ(sorted[i], snapshot.find(addresses[i])) << std::hex << addresses[i];
+    }
+
+    std::reverse(addresses.begin(), addresses.end());
+    auto unsorted = snapshot.findBatch(addresses);
+    for (size_t i = 0; i < addresses.size(); ++i) {
+        EXPECT_EQ(unsorted[i], snapshot.find(addresses[i])) << std::hex << addresses[i];
+    }
+}
+
+// Test contiguous range checks across adjacent regions
+TEST(MemoryMapSnapshotTest, ContainsRange) {
+    MemoryMapSnapshot snapshot(syntheticRegions());
+
+    EXPECT_TRUE(snapshot.containsRange(0x1800, 0x1000));
+    EXPECT_TRUE(snapshot.containsRange(0x1000, 0x3000));
+    EXPECT_FALSE(snapshot.containsRange(0x3800, 0x1000));
+    EXPECT_FALSE(snapshot.containsRange(0x5000, 1));
+    EXPECT_FALSE(snapshot.containsRange(0x1800, UINTPTR_MAX));
+
+    EXPECT_TRUE(snapshot.containsRange(0x1000, 0x1000, perms("r-x-")));
+    EXPECT_FALSE(snapshot.containsRange(0x1800, 0x1000, perms("r-x-")));
+}
+
+// Test the pathname index and permission queries
+TEST(MemoryMapSnapshotTest, PathAndPermissionQueries) {
+    MemoryMapSnapshot snapshot(syntheticRegions());
+
+    auto foo = snapshot.findByPath("/lib/libfoo.so");
+    ASSERT_EQ(foo.size(), 2u);
+    EXPECT_EQ(foo[0]->getStartAddress(), 0x1000u);
+    EXPECT_EQ(foo[1]->getStartAddress(), 0x2000u);
+
+    EXPECT_TRUE(snapshot.findByPath("libfoo.so").empty());
+    auto libs = snapshot.findByPath("/lib/", false);
+    ASSERT_EQ(libs.size(), 3u);
+    EXPECT_TRUE(std::is_sorted(libs.begin(), libs.end()));
+
+    EXPECT_EQ(snapshot.findByPath("").size(), 1u);
+    EXPECT_EQ(snapshot.findByPath("", false).size(), 4u);
+
+    auto executable = snapshot.findByPermissions(perms("--x-"));
+    ASSERT_EQ(executable.size(), 2u);
+    EXPECT_EQ(executable[1]->getPathname(), "/lib/libbar.so");
+}
+
+// Test a snapshot of the running process against a fresh mapping
+TEST(MemoryMapSnapshotTest, CaptureSelf) {
+    if (!ProcessMemoryParser::isPlatformSupported()) {
+        GTEST_SKIP() << "Platform not supported";
+    }
+
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    void* mapping = mmap(nullptr, page * 2, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    ASSERT_NE(mapping, MAP_FAILED);
+    auto base = reinterpret_cast<uintptr_t>(mapping);
+
+    auto result = MemoryMapSnapshot::captureSelf();
+    ASSERT_TRUE(result.isSuccess());
+    const MemoryMapSnapshot& snapshot = result.getValue();
+
+    const MemoryRegion* region = snapshot.find(base + page);
+    ASSERT_NE(region, nullptr);
+    EXPECT_TRUE(region->getPermissions().readable);
+    EXPECT_FALSE(region->getPermissions().writable);
+    EXPECT_TRUE(snapshot.containsRange(base, page * 2, perms("r---")));
+
+    auto code = snapshot.find(reinterpret_cast<uintptr_t>(&MemoryMapSnapshot::captureSelf));
+    ASSERT_NE(code, nullptr);
+    EXPECT_TRUE(code->getPermissions().executable);
+
+    munmap(mapping, page * 2);
+}
@@ -0,0 +1,141 @@
+/**
+ * @file test_memory_map_watcher.cpp
+ * @brief Unit tests for MemoryMapWatcher
+ */
+
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <string>
+
+#include "utility/MemoryMapWatcher.h"
+
+using namespace AnalysisToolkit;
+
+namespace {
+
+MemoryRegion region(uintptr_t start, uintptr_t end, const char* perms, const char* path) {
+    return MemoryRegion(start, end, MemoryPermissions::fromString(perms), 0, "08:01", 7, path);
+}
+
+// Poll until the map stops changing; the watcher's own allocations may map memory
+bool pollUntilStable(MemoryMapWatcher& watcher) {
+    for (int i = 0; i < 10; ++i) {
+        auto result = watcher.poll();
+        if (result.isSuccess() && result.getValue().empty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool containsPath(const std::vector<MemoryRegion>& regions, const std::string& path) {
+    for (const auto& region : regions) {
+        if (region.getPathname() == path) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace
+
+// Test the diff of two synthetic snapshots
+TEST(MemoryMapWatcherTest, DiffSnapshots) {
+    MemoryMapSnapshot before({
+        region(0x1000, 0x2000, "r-xp", "/lib/a.so"),
+        region(0x2000, 0x3000, "r--p", "/lib/a.so"),
+        region(0x5000, 0x6000, "rw-p", "/lib/b.so"),
+        region(0x7000, 0x8000, "r--p", "/lib/c.so"),
+    });
+    MemoryMapSnapshot after({
+        region(0x1000, 0x2000, "r-xp", "/lib/a.so"),
+        region(0x2000, 0x3000, "rw-p", "/lib/a.so"),
+        region(0x4000, 0x5000, "r-xp", "/lib/d.so"),
+        region(0x7000, 0x8000, "r--p", "/lib/e.so"),
+    });
+
+    MemoryMapDiff diff = MemoryMapWatcher::diff(before, after);
+    ASSERT_EQ(diff.permission_changed.size(), 1u);
+    EXPECT_EQ(diff.permission_changed[0].before.getStartAddress(), 0x2000u);
+    EXPECT_FALSE(diff.permission_changed[0].before.getPermissions().writable);
+    EXPECT_TRUE(diff.permission_changed[0].after.getPermissions().writable);
+
+    ASSERT_EQ(diff.removed.size(), 2u);
+    EXPECT_EQ(diff.removed[0].getPathname(), "/lib/b.so");
+    EXPECT_EQ(diff.removed[1].getPathname(), "/lib/c.so");
+    ASSERT_EQ(diff.added.size(), 2u);
+    EXPECT_EQ(diff.added[0].getPathname(), "/lib/d.so");
+    EXPECT_EQ(diff.added[1].getPathname(), "/lib/e.so");
+
+    EXPECT_TRUE(MemoryMapWatcher::diff(after, after).empty());
+}
+
+// Test that an unchanged map is detected without re-parsing
+TEST(MemoryMapWatcherTest, UnchangedMapSkipsParse) {
+#ifdef __linux__
+    MemoryMapWatcher watcher;
+    EXPECT_EQ(watcher.getSnapshot(), nullptr);
+
+    auto first = watcher.poll();
+    ASSERT_TRUE(first.isSuccess());
+    EXPECT_FALSE(first.getValue().added.empty());
+    EXPECT_TRUE(first.getValue().removed.empty());
+    ASSERT_NE(watcher.getSnapshot(), nullptr);
+
+    ASSERT_TRUE(pollUntilStable(watcher));
+    uint64_t parses = watcher.getParseCount();
+    auto again = watcher.poll();
+    ASSERT_TRUE(again.isSuccess());
+    EXPECT_TRUE(again.getValue().empty());
+    EXPECT_EQ(watcher.getParseCount(), parses);
+#else
+    GTEST_SKIP() << "Change detection requires a maps file";
+#endif
+}
+
+// Test that mapping, mprotect and munmap of a file show up in the diffs
+TEST(MemoryMapWatcherTest, DetectsMappingChanges) {
+#ifdef __linux__
+    char path[] = "/tmp/atkit_watcher_XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_GE(fd, 0);
+    size_t length = static_cast<size_t>(sysconf(_SC_PAGESIZE)) * 2;
+    ASSERT_EQ(ftruncate(fd, static_cast<off_t>(length)), 0);
+
+    // Only watch the temporary file so unrelated allocations do not interfere
+    MemoryMapWatcher watcher;
+    std::string watched = path;
+    watcher.setRegionFilter(
+        [watched](const MemoryRegion& region) { return region.getPathname() == watched; });
+    ASSERT_TRUE(watcher.poll().isSuccess());
+
+    void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ASSERT_NE(mapping, MAP_FAILED);
+    auto mapped = watcher.poll();
+    ASSERT_TRUE(mapped.isSuccess());
+    EXPECT_TRUE(containsPath(mapped.getValue().added, watched));
+
+    ASSERT_EQ(mprotect(mapping, length, PROT_READ | PROT_WRITE), 0);
+    auto protected_diff = watcher.poll();
+    ASSERT_TRUE(protected_diff.isSuccess());
+    ASSERT_EQ(protected_diff.getValue().permission_changed.size(), 1u);
+    EXPECT_TRUE(protected_diff.getValue().permission_changed[0].after.getPermissions().writable);
+    EXPECT_TRUE(protected_diff.getValue().added.empty());
+
+    munmap(mapping, length);
+    auto unmapped = watcher.poll();
+    ASSERT_TRUE(unmapped.isSuccess());
+    EXPECT_TRUE(containsPath(unmapped.getValue().removed, watched));
+    EXPECT_TRUE(watcher.getSnapshot()->findByPath(watched).empty());
+
+    close(fd);
+    unlink(path);
+#else
+    GTEST_SKIP() << "Change detection requires a maps file";
+#endif
+}
@@ -0,0 +1,155 @@
+/**
+ * @file test_memory_region_table.cpp
+ * @brief Unit tests for StringPool and MemoryRegionTable
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "utility/MemoryMapSnapshot.h"
+#include "utility/MemoryRegionTable.h"
+
+using namespace AnalysisToolkit;
+
+namespace {
+
+MemoryRegion makeRegion(uintptr_t start,
+                        uintptr_t end,
+                        const std::string& perms,
+                        const std::string& path,
+                        uint64_t offset = 0) {
+    return MemoryRegion(start,
+                        end,
+                        MemoryPermissions::fromString(perms),
+                        offset,
+                        path.empty() ? "00:00" : "fd:01",
+                        path.empty() ? 0 : 1234,
+                        path);
+}
+
+void expectSameRegion(const MemoryRegion& a, const MemoryRegion& b) {
+    EXPECT_EQ(a.getStartAddress(), b.getStartAddress());
+    EXPECT_EQ(a.getEndAddress(), b.getEndAddress());
+    EXPECT_EQ(a.getPermissions().toString(), b.getPermissions().toString());
+    EXPECT_EQ(a.getOffset(), b.getOffset());
+    EXPECT_EQ(a.getDevice(), b.getDevice());
+    EXPECT_EQ(a.getInode(), b.getInode());
+    EXPECT_EQ(a.getPathname(), b.getPathname());
+}
+
+}  // namespace
+
+// Test interning, lookups and growth of the string pool
+TEST(StringPoolTest, InternsStrings) {
+    StringPool pool;
+    EXPECT_EQ(pool.size(), 1u);
+    EXPECT_EQ(pool.intern(""), StringPool::kEmpty);
+    EXPECT_EQ(pool.get(StringPool::kEmpty), "");
+
+    StringPool::Id libc = pool.intern("/usr/lib/libc.so.6");
+    EXPECT_EQ(pool.intern(std::string("/usr/lib/libc.so.6")), libc);
+    EXPECT_EQ(pool.get(libc), "/usr/lib/libc.so.6");
+    EXPECT_FALSE(pool.find("/usr/lib/libm.so.6").has_value());
+
+    // Enough strings to grow the hash table several times
+    std::vector<StringPool::Id> ids;
+    for (int i = 0; i < 1000; ++i) {
+        ids.push_back(pool.intern("/data/app/lib" + std::to_string(i) + ".so"));
+    }
+    EXPECT_EQ(pool.size(), 1002u);
+    for (int i = 0; i < 1000; ++i) {
+        std::string path = "/data/app/lib" + std::to_string(i) + ".so";
+        ASSERT_EQ(pool.find(path), ids[i]);
+        ASSERT_EQ(pool.get(ids[i]), path);
+    }
+
+    // Copies are independent of the original
+    StringPool copy = pool;
+    EXPECT_EQ(copy.find("/usr/lib/libc.so.6"), libc);
+    copy.intern("only in copy");
+    EXPECT_FALSE(pool.find("only in copy").has_value());
+}
+
+// Test queries against a hand-built map, including sorting and interning
+TEST(MemoryRegionTableTest, QueriesMatchSnapshot) {
+    std::vector<MemoryRegion> regions = {
+        makeRegion(0x5000, 0x6000, "rw-p", "/system/lib64/libc.so", 0x3000),
+        makeRegion(0x1000, 0x2000, "r--p", "/system/lib64/libc.so"),
+        makeRegion(0x2000, 0x4000, "r-xp", "/system/lib64/libc.so", 0x1000),
+        makeRegion(0x7000, 0x8000, "rw-p", ""),
+        makeRegion(0x9000, 0xa000, "r-xp", "/system/lib64/libm.so"),
+        makeRegion(0xb000, 0xc000, "rw-s", "[anon:dalvik-heap]"),
+    };
+    MemoryRegionTable table(regions);
+    MemoryMapSnapshot snapshot(regions);
+
+    ASSERT_EQ(table.size(), regions.size());
+    for (size_t i = 0; i < table.size(); ++i) {
+        expectSameRegion(table.getRegion(i), snapshot.getRegions()[i]);
+    }
+
+    // One entry per distinct path and device, not per region
+    EXPECT_EQ(table.getStrings().size(), 1u + 3u + 2u);
+    EXPECT_EQ(table[0].getPathId(), table[1].getPathId());
+
+    for (uintptr_t address : {0x0ul, 0x1000ul, 0x1ffful, 0x4000ul, 0x5800ul, 0xbfffful}) {
+        size_t index = table.find(address);
+        const MemoryRegion* expected = snapshot.find(address);
+        if (expected == nullptr) {
+            EXPECT_EQ(index, MemoryRegionTable::npos) << address;
+        } else {
+            ASSERT_NE(index, MemoryRegionTable::npos) << address;
+            EXPECT_EQ(table[index].getStartAddress(), expected->getStartAddress());
+        }
+    }
+
+    EXPECT_EQ(table.findByPath("/system/lib64/libc.so"), (std::vector<size_t>{0, 1, 2}));
+    EXPECT_EQ(table.findByPath("lib64", false), (std::vector<size_t>{0, 1, 2, 4}));
+    EXPECT_EQ(table.findByPath(""), (std::vector<size_t>{3}));
+    EXPECT_TRUE(table.findByPath("/system/lib64/libz.so").empty());
+
+    MemoryPermissions executable;
+    executable.executable = true;
+    EXPECT_EQ(table.findByPermissions(executable), (std::vector<size_t>{1, 4}));
+    MemoryPermissions shared_writable = MemoryPermissions::fromString("-w--");
+    shared_writable.private_mapping = false;
+    EXPECT_EQ(table.findByPermissions(shared_writable), (std::vector<size_t>{2, 3, 5}));
+
+    auto refs = table.toRegions(table.findByPath("libm", false));
+    ASSERT_EQ(refs.size(), 1u);
+    expectSameRegion(refs[0], regions[4]);
+}
+
+// Test that capturing the process gives the same regions as a full parse
+TEST(MemoryRegionTableTest, CaptureMatchesParse) {
+    if (!ProcessMemoryParser::isPlatformSupported()) {
+        GTEST_SKIP() << "Platform not supported";
+    }
+
+    ProcessMemoryParser parser;
+    auto table = MemoryRegionTable::capture(parser);
+    ASSERT_TRUE(table.isSuccess()) << table.getErrorMessage();
+    auto parsed = parser.parseSelf();
+    ASSERT_TRUE(parsed.isSuccess());
+
+    // Mappings may change between the two reads; compare the stable prefix
+    const auto& regions = parsed.getValue();
+    ASSERT_FALSE(table.getValue().empty());
+    EXPECT_LT(table.getValue().getStrings().size(), regions.size() + 1);
+    size_t compared = 0;
+    for (size_t i = 0; i < regions.size() && i < table.getValue().size(); ++i) {
+        if (table.getValue()[i].getStartAddress() != regions[i].getStartAddress()) {
+            break;
+        }
+        expectSameRegion(table.getValue().getRegion(i), regions[i]);
+        compared++;
+    }
+    EXPECT_GT(compared, 0u);
+
+    auto address = reinterpret_cast<uintptr_t>(&expectSameRegion);
+    size_t index = table.getValue().find(address);
+    ASSERT_NE(index, MemoryRegionTable::npos);
+    EXPECT_TRUE(table.getValue()[index].getPermissions().executable);
+}
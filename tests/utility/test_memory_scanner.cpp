@@ -0,0 +1,237 @@
+/**
+ * @file test_memory_scanner.cpp
+ * @brief Unit tests for MemoryScanner
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "utility/MemoryScanner.h"
+#include "utility/RemoteMemoryReader.h"
+
+using namespace AnalysisToolkit;
+
+namespace {
+
+// Distinctive bytes placed in .rodata for the whole-process scan
+const uint8_t kMarker[] = {0x3c, 0x9a, 0x51, 0xe7, 0x0b, 0xd4, 0x66, 0x2f,
+                           0xa8, 0x17, 0xc3, 0x7e, 0x45, 0xb9, 0x02, 0xf1};
+
+using MatchSet = std::set<std::pair<size_t, uintptr_t>>;
+
+class MemoryScannerTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        // Spans several scan chunks so that chunk boundaries are exercised
+        buffer.resize(3 * 256 * 1024 + 123);
+        std::mt19937 rng(12345);
+        for (auto& byte : buffer) {
+            byte = static_cast<uint8_t>(rng());
+        }
+    }
+
+    MemoryRegion bufferRegion() const {
+        auto start = reinterpret_cast<uintptr_t>(buffer.data());
+        return MemoryRegion(start,
+                            start + buffer.size(),
+                            MemoryPermissions::fromString("rw-p"),
+                            0,
+                            "00:00",
+                            0,
+                            "");
+    }
+
+    void plant(size_t offset, const std::vector<uint8_t>& bytes) {
+        std::copy(bytes.begin(), bytes.end(), buffer.begin() + offset);
+    }
+
+    MatchSet bruteForce(const std::vector<BytePattern>& patterns) const {
+        MatchSet result;
+        for (size_t p = 0; p < patterns.size(); ++p) {
+            for (size_t i = 0; i + patterns[p].size() <= buffer.size(); ++i) {
+                if (patterns[p].matches(buffer.data() + i)) {
+                    result.emplace(p, reinterpret_cast<uintptr_t>(buffer.data() + i));
+                }
+            }
+        }
+        return result;
+    }
+
+    MatchSet scanAll(MemoryScanner& scanner) const {
+        MatchSet result;
+        size_t delivered = scanner.scan({bufferRegion()}, [&](const ScanMatch& match) {
+            result.emplace(match.pattern_index, match.address);
+            return true;
+        });
+        EXPECT_EQ(delivered, result.size());
+        return result;
+    }
+
+    std::vector<uint8_t> buffer;
+};
+
+}  // namespace
+
+// Test signature parsing, including wildcards and malformed input
+TEST(BytePatternTest, Parse) {
+    auto pattern = BytePattern::parse("55 48 ?? e5 4? ?f");
+    ASSERT_TRUE(pattern.has_value());
+    ASSERT_EQ(pattern->size(), 6u);
+    EXPECT_EQ(pattern->getMask(), (std::vector<uint8_t>{0xff, 0xff, 0x00, 0xff, 0xf0, 0x0f}));
+    EXPECT_EQ(pattern->getBytes(), (std::vector<uint8_t>{0x55, 0x48, 0x00, 0xe5, 0x40, 0x0f}));
+
+    const uint8_t data[] = {0x55, 0x48, 0x12, 0xe5, 0x4a, 0x3f};
+    EXPECT_TRUE(pattern->matches(data));
+    const uint8_t other[] = {0x55, 0x48, 0x12, 0xe5, 0x5a, 0x3f};
+    EXPECT_FALSE(pattern->matches(other));
+
+    EXPECT_FALSE(BytePattern::parse("").has_value());
+    EXPECT_FALSE(BytePattern::parse("?? ??").has_value());
+    EXPECT_FALSE(BytePattern::parse("4? ?4").has_value());
+    EXPECT_FALSE(BytePattern::parse("5 48").has_value());
+    EXPECT_FALSE(BytePattern::parse("zz").has_value());
+    EXPECT_FALSE(BytePattern::fromBytes({1, 2}, {0xff}).has_value());
+    EXPECT_TRUE(BytePattern::fromBytes({1, 2}).has_value());
+}
+
+// Test that matches agree with a brute-force search, across chunk boundaries
+TEST_F(MemoryScannerTest, MatchesBruteForce) {
+    plant(0, {0xde, 0xad, 0xbe, 0xef});
+    plant(256 * 1024 - 2, {0xde, 0xad, 0xbe, 0xef});
+    plant(buffer.size() - 4, {0xde, 0xad, 0xbe, 0xef});
+    plant(512 * 1024 - 5, {0x00, 0x00, 0x13, 0x37, 0x00, 0x00, 0x42, 0x99});
+
+    std::vector<BytePattern> patterns = {*BytePattern::parse("de ad be ef"),
+                                         *BytePattern::parse("?? 13 37 ?? ?? 42"),
+                                         *BytePattern::parse("00 00 ?? 37 00 00 4? 99")};
+
+    MemoryScanner scanner(4);
+    EXPECT_EQ(scanner.getThreadCount(), 4u);
+    for (const auto& pattern : patterns) {
+        scanner.addPattern(pattern);
+    }
+
+    MatchSet expected = bruteForce(patterns);
+    EXPECT_GE(expected.size(), 5u);
+    EXPECT_EQ(scanAll(scanner), expected);
+}
+
+// Test that a scan through RemoteMemoryReader finds the same matches
+TEST_F(MemoryScannerTest, RemoteScanMatchesLocal) {
+#ifdef __linux__
+    plant(256 * 1024 - 3, {0xde, 0xad, 0xbe, 0xef, 0x11});
+    plant(buffer.size() - 5, {0xde, 0xad, 0xbe, 0xef, 0x11});
+    std::vector<BytePattern> patterns = {*BytePattern::parse("de ad be ef 11"),
+                                         *BytePattern::parse("?? ?? ?? ef 1?")};
+
+    MemoryScanner scanner(3);
+    for (const auto& pattern : patterns) {
+        scanner.addPattern(pattern);
+    }
+
+    // The buffer lives on the heap, so the reader sees it in its own maps
+    RemoteMemoryReader reader(-1);
+    MatchSet result;
+    scanner.scan(reader, {bufferRegion()}, [&](const ScanMatch& match) {
+        result.emplace(match.pattern_index, match.address);
+        return true;
+    });
+    EXPECT_EQ(result, bruteForce(patterns));
+    EXPECT_GT(reader.getStats().syscalls, 0u);
+#else
+    GTEST_SKIP() << "process_vm_readv is only available on Linux";
+#endif
+}
+
+// Test many patterns per pass, which exceeds the SIMD anchor limit
+TEST_F(MemoryScannerTest, ManyPatterns) {
+    std::vector<BytePattern> patterns;
+    for (int i = 0; i < 20; ++i) {
+        auto byte = static_cast<uint8_t>(0x10 + i * 7);
+        patterns.push_back(*BytePattern::fromBytes({byte, 0x00, byte}, {0xff, 0x00, 0xff}));
+        plant(static_cast<size_t>(i) * 40000 + 11, {byte, 0x55, byte});
+    }
+
+    MemoryScanner parallel(3);
+    MemoryScanner serial(1);
+    for (const auto& pattern : patterns) {
+        parallel.addPattern(pattern);
+        serial.addPattern(pattern);
+    }
+
+    MatchSet expected = bruteForce(patterns);
+    EXPECT_GE(expected.size(), patterns.size());
+    EXPECT_EQ(scanAll(parallel), expected);
+    EXPECT_EQ(scanAll(serial), expected);
+}
+
+// Test that returning false from the callback stops the scan
+TEST_F(MemoryScannerTest, StopEarly) {
+    for (size_t offset = 0; offset + 2 < buffer.size(); offset += 4096) {
+        plant(offset, {0xab, 0xcd});
+    }
+
+    MemoryScanner scanner(4);
+    ASSERT_TRUE(scanner.addPattern(std::string("ab cd")).has_value());
+    size_t calls = 0;
+    size_t delivered = scanner.scan({bufferRegion()}, [&](const ScanMatch&) {
+        ++calls;
+        return false;
+    });
+    EXPECT_EQ(calls, 1u);
+    EXPECT_EQ(delivered, 1u);
+
+    scanner.clearPatterns();
+    EXPECT_EQ(scanner.getPatternCount(), 0u);
+    EXPECT_EQ(scanner.scan({bufferRegion()}, [](const ScanMatch&) { return true; }), 0u);
+}
+
+// Test that unreadable regions are skipped
+TEST_F(MemoryScannerTest, SkipsUnreadableRegions) {
+    plant(100, {0xfe, 0xed, 0xfa, 0xce});
+    MemoryRegion region = bufferRegion();
+    MemoryRegion unreadable(region.getStartAddress(),
+                            region.getEndAddress(),
+                            MemoryPermissions::fromString("---p"),
+                            0,
+                            "00:00",
+                            0,
+                            "");
+
+    MemoryScanner scanner(2);
+    scanner.addPattern(std::string("fe ed fa ce"));
+    EXPECT_EQ(scanner.scan({unreadable}, [](const ScanMatch&) { return true; }), 0u);
+    EXPECT_GE(scanner.scan({region}, [](const ScanMatch&) { return true; }), 1u);
+}
+
+// Test a scan of the whole process driven by ProcessMemoryParser
+TEST(MemoryScannerProcessTest, FindsMarkerInProcess) {
+    if (!ProcessMemoryParser::isPlatformSupported()) {
+        GTEST_SKIP() << "Platform not supported";
+    }
+
+    ProcessMemoryParser parser;
+    parser.setRegionFilter([](const MemoryRegion& region) {
+        return region.getPermissions().readable && !region.getPermissions().writable;
+    });
+
+    MemoryScanner scanner;
+    scanner.addPattern(*BytePattern::fromBytes(std::vector<uint8_t>(std::begin(kMarker),
+                                                                    std::end(kMarker))));
+
+    bool found = false;
+    auto result = scanner.scanProcess(parser, [&](const ScanMatch& match) {
+        EXPECT_TRUE(match.region->contains(match.address));
+        found = found || match.address == reinterpret_cast<uintptr_t>(kMarker);
+        return true;
+    });
+    ASSERT_TRUE(result.isSuccess());
+    EXPECT_GE(result.getValue(), 1u);
+    EXPECT_TRUE(found);
+}
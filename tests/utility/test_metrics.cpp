@@ -0,0 +1,178 @@
+/**
+ * @file test_metrics.cpp
+ * @brief Unit tests for the shared-memory metrics registry and reader
+ */
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "utility/Logger.h"
+#include "utility/Metrics.h"
+#include "utility/ProcessMemoryParser.h"
+
+using namespace AnalysisToolkit;
+
+namespace {
+
+const MetricSample* findSample(const std::vector<MetricSample>& samples, const std::string& name) {
+    for (const auto& sample : samples) {
+        if (sample.name == name) {
+            return &sample;
+        }
+    }
+    return nullptr;
+}
+
+uint64_t valueOf(const std::vector<MetricSample>& samples, const std::string& name) {
+    const MetricSample* sample = findSample(samples, name);
+    return sample != nullptr ? sample->value : 0;
+}
+
+}  // namespace
+
+class MetricsTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        path = "/tmp/atkit_metrics_test_" + std::to_string(getpid());
+        ASSERT_TRUE(MetricsRegistry::getInstance().open(path));
+    }
+
+    void TearDown() override {
+        MetricsRegistry::getInstance().close();
+    }
+
+    std::string path;
+};
+
+// Test that counters from live and exited threads and gauges reach an external reader
+TEST_F(MetricsTest, ReaderSeesCountersAndGauges) {
+    static const MetricCounter counter("test.counter");
+    static const MetricGauge gauge("test.gauge");
+    gauge.set(-5);
+
+    counter.add(3);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([] {
+            for (int j = 0; j < 1000; ++j) {
+                counter.add();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    gauge.add(2);
+
+    MetricsReader reader;
+    ASSERT_TRUE(reader.open(path));
+    EXPECT_EQ(reader.getPid(), getpid());
+    EXPECT_GT(reader.getStartTimeNs(), 0u);
+
+    std::vector<MetricSample> samples = reader.read();
+    const MetricSample* counter_sample = findSample(samples, "test.counter");
+    const MetricSample* gauge_sample = findSample(samples, "test.gauge");
+    ASSERT_NE(counter_sample, nullptr);
+    ASSERT_NE(gauge_sample, nullptr);
+    EXPECT_EQ(counter_sample->kind, MetricKind::COUNTER);
+    EXPECT_EQ(counter_sample->value, 4003u);
+    EXPECT_EQ(gauge_sample->kind, MetricKind::GAUGE);
+    EXPECT_EQ(gauge_sample->gaugeValue(), -3);
+
+    std::vector<MetricSample> local = MetricsRegistry::getInstance().collect();
+    EXPECT_EQ(valueOf(local, "test.counter"), 4003u);
+}
+
+// Test that registration is idempotent and that metrics registered later are published
+TEST_F(MetricsTest, RegisterAfterOpen) {
+    MetricsRegistry& registry = MetricsRegistry::getInstance();
+    MetricId id = registry.registerMetric("test.late", MetricKind::COUNTER);
+    ASSERT_NE(id, kInvalidMetricId);
+    EXPECT_EQ(registry.registerMetric("test.late", MetricKind::COUNTER), id);
+    registry.add(id, 7);
+
+    MetricsReader reader;
+    ASSERT_TRUE(reader.open(path));
+    EXPECT_EQ(valueOf(reader.read(), "test.late"), 7u);
+}
+
+// Test that counts are neither lost nor doubled while threads exit during reads
+TEST_F(MetricsTest, ReadsDuringThreadExit) {
+    static const MetricCounter counter("test.churn");
+    const uint64_t before = valueOf(MetricsRegistry::getInstance().collect(), "test.churn");
+
+    MetricsReader reader;
+    ASSERT_TRUE(reader.open(path));
+    std::atomic<bool> done{false};
+    std::atomic<bool> monotonic{true};
+    std::thread poller([&] {
+        uint64_t last = 0;
+        while (!done.load()) {
+            uint64_t value = valueOf(reader.read(), "test.churn");
+            if (value < last) {
+                monotonic.store(false);
+            }
+            last = value;
+        }
+    });
+
+    for (int round = 0; round < 50; ++round) {
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 4; ++i) {
+            threads.emplace_back([] { counter.add(10); });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+    done.store(true);
+    poller.join();
+
+    EXPECT_TRUE(monotonic.load());
+    EXPECT_EQ(valueOf(reader.read(), "test.churn") - before, 2000u);
+}
+
+// Test that toolkit subsystems report through the registry
+TEST_F(MetricsTest, SubsystemsReportMetrics) {
+    if (!ProcessMemoryParser::isPlatformSupported()) {
+        GTEST_SKIP() << "Platform not supported";
+    }
+    auto before = MetricsRegistry::getInstance().collect();
+
+    ProcessMemoryParser parser;
+    ASSERT_TRUE(parser.parseSelf().isSuccess());
+
+    Logger* logger = Logger::getInstance();
+    bool console = logger->isConsoleEnabled();
+    logger->enableConsole(false);
+    logger->error("metrics test record");
+    logger->enableConsole(console);
+
+    auto after = MetricsRegistry::getInstance().collect();
+    EXPECT_EQ(valueOf(after, "maps.parses") - valueOf(before, "maps.parses"), 1u);
+    EXPECT_GT(valueOf(after, "maps.parse_ns"), valueOf(before, "maps.parse_ns"));
+    EXPECT_GE(valueOf(after, "log.records") - valueOf(before, "log.records"), 1u);
+}
+
+// Test that closing stops recording and removes the segment file
+TEST(MetricsRegistryTest, CloseRemovesSegment) {
+    std::string path = "/tmp/atkit_metrics_close_" + std::to_string(getpid());
+    MetricsRegistry& registry = MetricsRegistry::getInstance();
+    ASSERT_TRUE(registry.open(path));
+    EXPECT_TRUE(MetricsRegistry::isRecording());
+    EXPECT_EQ(registry.getPath(), path);
+
+    registry.close();
+    EXPECT_FALSE(MetricsRegistry::isRecording());
+    EXPECT_TRUE(registry.getPath().empty());
+    EXPECT_TRUE(registry.collect().empty());
+    EXPECT_NE(access(path.c_str(), F_OK), 0);
+
+    MetricsReader reader;
+    EXPECT_FALSE(reader.open(path));
+}
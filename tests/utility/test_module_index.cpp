@@ -0,0 +1,165 @@
+/**
+ * @file test_module_index.cpp
+ * @brief Unit tests for ModuleIndex
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "utility/ModuleIndex.h"
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace AnalysisToolkit;
+
+namespace {
+
+int module_index_test_function() {
+    return 42;
+}
+
+}  // namespace
+
+class ModuleIndexTest : public ::testing::Test {
+  protected:
+    ModuleIndex index;
+};
+
+// Test that the running executable is indexed with executable ranges
+TEST_F(ModuleIndexTest, FindsModuleContainingOwnCode) {
+#if defined(__linux__)
+    auto address = reinterpret_cast<uintptr_t>(&module_index_test_function);
+    auto module = index.findModuleContaining(address);
+    ASSERT_TRUE(module.has_value());
+    EXPECT_FALSE(module->path.empty());
+    EXPECT_FALSE(module->executable_ranges.empty());
+
+    bool in_exec_range = false;
+    for (const auto& range : module->executable_ranges) {
+        EXPECT_LT(range.first, range.second);
+        in_exec_range |= address >= range.first && address < range.second;
+    }
+    EXPECT_TRUE(in_exec_range);
+#else
+    GTEST_SKIP() << "Module index requires /proc/self/maps";
+#endif
+}
+
+// Test lookup by basename and by full path
+TEST_F(ModuleIndexTest, FindByNameAndPath) {
+#if defined(__linux__)
+    auto address = reinterpret_cast<uintptr_t>(&module_index_test_function);
+    auto own = index.findModuleContaining(address);
+    ASSERT_TRUE(own.has_value());
+
+    auto by_name = index.findModule(own->name);
+    ASSERT_TRUE(by_name.has_value());
+    EXPECT_EQ(by_name->path, own->path);
+
+    auto by_path = index.findModule(own->path);
+    ASSERT_TRUE(by_path.has_value());
+    EXPECT_EQ(by_path->start_address, own->start_address);
+#else
+    GTEST_SKIP() << "Module index requires /proc/self/maps";
+#endif
+}
+
+// Test that repeated lookups reuse the cached index
+TEST_F(ModuleIndexTest, ReusesCachedIndex) {
+#if defined(__linux__)
+    auto modules = index.getModules();
+    ASSERT_FALSE(modules.empty());
+    uint64_t rebuilds = index.getRebuildCount();
+
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_TRUE(index.findModule(modules.front().name).has_value());
+    }
+    EXPECT_EQ(index.getRebuildCount(), rebuilds);
+
+    index.invalidate();
+    index.getModules();
+    EXPECT_EQ(index.getRebuildCount(), rebuilds + 1);
+#else
+    GTEST_SKIP() << "Module index requires /proc/self/maps";
+#endif
+}
+
+// Test that unknown modules are reported as missing
+TEST_F(ModuleIndexTest, UnknownModule) {
+    EXPECT_FALSE(index.findModule("").has_value());
+    EXPECT_FALSE(index.findModule("libdoes_not_exist_12345.so").has_value());
+}
+
+// Test that the fingerprint is stable while nothing is loaded
+TEST_F(ModuleIndexTest, FingerprintStable) {
+    EXPECT_EQ(ModuleIndex::computeFingerprint(), ModuleIndex::computeFingerprint());
+}
+
+// Test that shared file mappings are not mistaken for loaded modules
+TEST_F(ModuleIndexTest, IgnoresSharedFileMappings) {
+#if defined(__linux__)
+    std::string path = "/tmp/atkit_module_index_shared_" + std::to_string(getpid());
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(ftruncate(fd, 4096), 0);
+    void* mapping = mmap(nullptr, 4096, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    ASSERT_NE(mapping, MAP_FAILED);
+
+    index.refresh();
+    EXPECT_FALSE(index.findModule(path).has_value());
+    EXPECT_FALSE(index.findModuleContaining(reinterpret_cast<uintptr_t>(mapping)).has_value());
+
+    munmap(mapping, 4096);
+    unlink(path.c_str());
+#else
+    GTEST_SKIP() << "Module index requires /proc maps";
+#endif
+}
+
+// Test indexing another process: a forked child has the same layout
+TEST(ModuleIndexRemoteTest, IndexesChildProcess) {
+#if defined(__linux__)
+    EXPECT_EQ(ModuleIndex(getpid()).getPid(), -1);
+
+    int done[2];
+    ASSERT_EQ(pipe(done), 0);
+    pid_t child = fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) {
+        char byte;
+        (void)!read(done[0], &byte, 1);
+        _exit(0);
+    }
+
+    ModuleIndex remote(child);
+    EXPECT_EQ(remote.getPid(), child);
+    auto address = reinterpret_cast<uintptr_t>(&module_index_test_function);
+    auto module = remote.findModuleContaining(address);
+    auto again = remote.findModuleContaining(address);
+    uint64_t rebuilds = remote.getRebuildCount();
+
+    char byte = 0;
+    EXPECT_EQ(write(done[1], &byte, 1), 1);
+    waitpid(child, nullptr, 0);
+    close(done[0]);
+    close(done[1]);
+
+    if (rebuilds == 0) {
+        GTEST_SKIP() << "Cannot read the child's maps file";
+    }
+    ASSERT_TRUE(module.has_value());
+    ASSERT_TRUE(again.has_value());
+    EXPECT_EQ(module->path, ModuleIndex().findModuleContaining(address)->path);
+    // Without a loader fingerprint, hits do not trigger rebuilds
+    EXPECT_EQ(rebuilds, 1u);
+#else
+    GTEST_SKIP() << "Platform not supported";
+#endif
+}
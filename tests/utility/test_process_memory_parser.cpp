@@ -44,6 +44,9 @@ TEST_F(ProcessMemoryParserTest, ErrorStringConversion) {
     error_str =
         ProcessMemoryParser::getErrorString(ProcessMemoryParser::ErrorCode::PLATFORM_NOT_SUPPORTED);
     EXPECT_EQ(error_str, "Platform not supported");
+
+    error_str = ProcessMemoryParser::getErrorString(ProcessMemoryParser::ErrorCode::INVALID_ADDRESS);
+    EXPECT_EQ(error_str, "Invalid address");
 }
 
 // Test memory permissions
@@ -217,6 +220,42 @@ TEST_F(ProcessMemoryParserTest, CustomFiltering) {
     parser->clearRegionFilter();
 }
 
+// Test that view and region filters combine and both apply to in-place visits
+TEST_F(ProcessMemoryParserTest, ViewFilterCombinesWithRegionFilter) {
+    const std::string maps =
+        "00400000-00401000 r-xp 00000000 08:01 1234 /usr/bin/app\n"
+        "00600000-00602000 rw-p 00000000 00:00 0\n"
+        "7f0000000000-7f0000004000 r-xp 00000000 08:01 99 /lib/libc.so\n";
+
+    parser->setRegionViewFilter(
+        [](const MemoryRegionView& view) { return view.permissions.executable; });
+    std::vector<uintptr_t> starts;
+    parser->forEachRegionInText(maps, [&starts](const MemoryRegionView& view) {
+        starts.push_back(view.start_address);
+        return true;
+    });
+    EXPECT_EQ(starts, (std::vector<uintptr_t>{0x400000, 0x7f0000000000}));
+
+    parser->setRegionFilter([](const MemoryRegion& region) { return region.getSize() > 4096; });
+    starts.clear();
+    parser->forEachRegionInText(maps, [&starts](const MemoryRegionView& view) {
+        starts.push_back(view.start_address);
+        return true;
+    });
+    EXPECT_EQ(starts, (std::vector<uintptr_t>{0x7f0000000000}));
+
+    // Regions parsed from the process honour the view filter as well
+    auto result = parser->parseSelf();
+    if (result.isSuccess()) {
+        for (const auto& region : result.getValue()) {
+            EXPECT_TRUE(region.getPermissions().executable);
+            EXPECT_GT(region.getSize(), 4096u);
+        }
+    }
+
+    parser->clearRegionFilter();
+}
+
 // Test Result class functionality
 TEST_F(ProcessMemoryParserTest, ResultClass) {
     // Test successful result
@@ -262,3 +301,71 @@ TEST_F(ProcessMemoryParserTest, FindRegionsByPath) {
     // Empty string should match all regions with non-empty paths
     // (this is a basic test, exact behavior may vary)
 }
+
+// Test that the visitor sees the same regions as parseProcess
+TEST_F(ProcessMemoryParserTest, ForEachRegionMatchesParse) {
+    if (!ProcessMemoryParser::isPlatformSupported()) {
+        GTEST_SKIP() << "Platform not supported";
+    }
+
+    auto parsed = parser->parseProcess();
+    ASSERT_TRUE(parsed.isSuccess());
+    const auto& regions = parsed.getValue();
+    ASSERT_FALSE(regions.empty());
+
+    std::vector<MemoryRegion> visited;
+    auto result = parser->forEachRegion([&](const MemoryRegionView& view) {
+        visited.push_back(view.toRegion());
+        return true;
+    });
+    ASSERT_TRUE(result.isSuccess());
+    EXPECT_EQ(result.getValue(), visited.size());
+
+    // The maps of a live process may change between reads; compare the stable prefix
+    ASSERT_FALSE(visited.empty());
+    EXPECT_EQ(visited[0].getStartAddress(), regions[0].getStartAddress());
+    EXPECT_EQ(visited[0].getEndAddress(), regions[0].getEndAddress());
+    EXPECT_EQ(visited[0].getPathname(), regions[0].getPathname());
+    EXPECT_EQ(visited[0].getPermissions().toString(), regions[0].getPermissions().toString());
+
+    // Returning false stops the walk
+    size_t calls = 0;
+    auto stopped = parser->forEachRegion([&](const MemoryRegionView&) {
+        ++calls;
+        return false;
+    });
+    ASSERT_TRUE(stopped.isSuccess());
+    EXPECT_EQ(calls, 1u);
+    EXPECT_EQ(stopped.getValue(), 1u);
+}
+
+// Test that the raw maps line is only kept on request
+TEST_F(ProcessMemoryParserTest, OriginalLineOptional) {
+#ifdef __linux__
+    auto parsed = parser->parseProcess();
+    ASSERT_TRUE(parsed.isSuccess());
+    ASSERT_FALSE(parsed.getValue().empty());
+    EXPECT_TRUE(parsed.getValue()[0].getOriginalLine().empty());
+
+    parser->setKeepOriginalLine(true);
+    auto with_lines = parser->parseProcess();
+    ASSERT_TRUE(with_lines.isSuccess());
+    ASSERT_FALSE(with_lines.getValue().empty());
+    const auto& first = with_lines.getValue()[0];
+    EXPECT_FALSE(first.getOriginalLine().empty());
+    EXPECT_EQ(first.getOriginalLine().find('\n'), std::string::npos);
+#else
+    GTEST_SKIP() << "Maps lines are only available on Linux";
+#endif
+}
+
+// Test that a missing process reports PROCESS_NOT_FOUND
+TEST_F(ProcessMemoryParserTest, ForEachRegionMissingProcess) {
+#ifdef __linux__
+    auto result = parser->forEachRegion([](const MemoryRegionView&) { return true; }, 0x7ffffffe);
+    ASSERT_TRUE(result.hasError());
+    EXPECT_EQ(result.getError(), ProcessMemoryParser::ErrorCode::PROCESS_NOT_FOUND);
+#else
+    GTEST_SKIP() << "Maps files are only available on Linux";
+#endif
+}
@@ -0,0 +1,245 @@
+/**
+ * @file test_remote_memory_reader.cpp
+ * @brief Unit tests for RemoteMemoryReader
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "utility/RemoteMemoryReader.h"
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace AnalysisToolkit;
+using ErrorCode = ProcessMemoryParser::ErrorCode;
+
+#ifdef __linux__
+
+namespace {
+
+// Anonymous mapping with a known pattern, released on destruction
+class TestMapping {
+  public:
+    explicit TestMapping(size_t pages) : size_(pages * static_cast<size_t>(getpagesize())) {
+        void* memory = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                            -1, 0);
+        data_ = memory == MAP_FAILED ? nullptr : static_cast<uint8_t*>(memory);
+        if (data_ != nullptr) {
+            for (size_t i = 0; i < size_; ++i) {
+                data_[i] = static_cast<uint8_t>(i * 31 + i / 4096);
+            }
+        }
+    }
+    ~TestMapping() {
+        if (data_ != nullptr) {
+            munmap(data_, size_);
+        }
+    }
+
+    uint8_t* data() const {
+        return data_;
+    }
+    uintptr_t address() const {
+        return reinterpret_cast<uintptr_t>(data_);
+    }
+    size_t size() const {
+        return size_;
+    }
+
+  private:
+    size_t size_;
+    uint8_t* data_ = nullptr;
+};
+
+}  // namespace
+
+class RemoteMemoryReaderTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        page_size = static_cast<size_t>(getpagesize());
+        ASSERT_NE(mapping.data(), nullptr);
+    }
+
+    size_t page_size = 4096;
+    TestMapping mapping{32};
+};
+
+TEST_F(RemoteMemoryReaderTest, ReadsOwnMemory) {
+    RemoteMemoryReader reader(getpid());
+    EXPECT_EQ(reader.getPid(), getpid());
+
+    // Small cached read across a page boundary
+    std::vector<uint8_t> small(100);
+    auto result = reader.read(mapping.address() + page_size - 50, small.data(), small.size());
+    ASSERT_TRUE(result.isSuccess()) << result.getErrorMessage();
+    EXPECT_EQ(result.getValue(), small.size());
+    EXPECT_EQ(std::memcmp(small.data(), mapping.data() + page_size - 50, small.size()), 0);
+
+    // Large read bypasses the cache
+    std::vector<uint8_t> large(mapping.size() - 7);
+    result = reader.read(mapping.address() + 7, large.data(), large.size());
+    ASSERT_TRUE(result.isSuccess()) << result.getErrorMessage();
+    EXPECT_EQ(std::memcmp(large.data(), mapping.data() + 7, large.size()), 0);
+
+    uint64_t expected;
+    std::memcpy(&expected, mapping.data() + 3 * page_size + 8, sizeof(expected));
+    auto value = reader.readValue<uint64_t>(mapping.address() + 3 * page_size + 8);
+    ASSERT_TRUE(value.has_value());
+    EXPECT_EQ(*value, expected);
+}
+
+TEST_F(RemoteMemoryReaderTest, RejectsUnreadableRanges) {
+    // Guard page in the middle and an unmapped page at the end
+    ASSERT_EQ(mprotect(mapping.data() + 8 * page_size, page_size, PROT_NONE), 0);
+    ASSERT_EQ(munmap(mapping.data() + 31 * page_size, page_size), 0);
+
+    RemoteMemoryReader reader(-1);
+    uint8_t buffer[64];
+
+    auto result = reader.read(mapping.address() + 8 * page_size + 16, buffer, sizeof(buffer));
+    ASSERT_TRUE(result.hasError());
+    EXPECT_EQ(result.getError(), ErrorCode::INVALID_ADDRESS);
+
+    // A read that starts readable and runs into the guard page fails as a whole
+    std::vector<uint8_t> large(4 * page_size);
+    result = reader.read(mapping.address() + 5 * page_size, large.data(), large.size());
+    ASSERT_TRUE(result.hasError());
+    EXPECT_EQ(result.getError(), ErrorCode::INVALID_ADDRESS);
+
+    result = reader.read(mapping.address() + 31 * page_size, buffer, sizeof(buffer));
+    ASSERT_TRUE(result.hasError());
+    EXPECT_EQ(result.getError(), ErrorCode::INVALID_ADDRESS);
+
+    EXPECT_FALSE(reader.readValue<uint32_t>(0).has_value());
+
+    // The part of the mapping before the guard page is still readable
+    EXPECT_TRUE(reader.read(mapping.address() + 7 * page_size, buffer, sizeof(buffer)).isSuccess());
+}
+
+TEST_F(RemoteMemoryReaderTest, BatchUsesFewSyscalls) {
+    RemoteMemoryReader reader(-1, 0);
+    ASSERT_TRUE(reader.refreshRegions().isSuccess());
+
+    const size_t count = 300;
+    std::vector<uint32_t> values(count);
+    std::vector<RemoteReadRequest> requests(count);
+    for (size_t i = 0; i < count; ++i) {
+        size_t offset = (i * 4099) % (mapping.size() - sizeof(uint32_t));
+        requests[i].address = mapping.address() + offset;
+        requests[i].size = sizeof(uint32_t);
+        requests[i].buffer = &values[i];
+    }
+    // One bad request in the middle must not affect the others
+    uint64_t bad_value = 0;
+    requests.push_back({0x10, sizeof(bad_value), &bad_value});
+
+    size_t succeeded = reader.readBatch(requests);
+    EXPECT_EQ(succeeded, count);
+    EXPECT_EQ(requests.back().error, ErrorCode::INVALID_ADDRESS);
+    for (size_t i = 0; i < count; ++i) {
+        EXPECT_EQ(requests[i].error, ErrorCode::SUCCESS);
+        uint32_t expected;
+        std::memcpy(&expected,
+                    reinterpret_cast<const void*>(requests[i].address),
+                    sizeof(expected));
+        EXPECT_EQ(values[i], expected);
+    }
+
+    auto stats = reader.getStats();
+    EXPECT_EQ(stats.syscalls, 1u);
+    EXPECT_EQ(stats.bytes_read, count * sizeof(uint32_t));
+}
+
+TEST_F(RemoteMemoryReaderTest, SequentialReadsArePrefetched) {
+    RemoteMemoryReader reader(-1, 32);
+    reader.setPrefetchPages(8);
+
+    const size_t step = 64;
+    size_t reads = 0;
+    for (size_t offset = 0; offset + step <= 16 * page_size; offset += step, ++reads) {
+        uint8_t buffer[step];
+        ASSERT_TRUE(reader.read(mapping.address() + offset, buffer, step).isSuccess());
+        ASSERT_EQ(std::memcmp(buffer, mapping.data() + offset, step), 0);
+    }
+
+    auto stats = reader.getStats();
+    EXPECT_EQ(stats.cache_hits + stats.cache_misses, reads);
+    // Sixteen pages: the first miss, then one fetch per eight prefetched pages
+    EXPECT_LE(stats.syscalls, 4u);
+    EXPECT_LE(stats.cache_misses, 4u);
+
+    // Cached copies are snapshots until the cache is cleared
+    uint8_t original = mapping.data()[0];
+    mapping.data()[0] = static_cast<uint8_t>(original + 1);
+    auto value = reader.readValue<uint8_t>(mapping.address());
+    ASSERT_TRUE(value.has_value());
+    EXPECT_EQ(*value, original);
+    reader.clearCache();
+    value = reader.readValue<uint8_t>(mapping.address());
+    ASSERT_TRUE(value.has_value());
+    EXPECT_EQ(*value, static_cast<uint8_t>(original + 1));
+}
+
+TEST_F(RemoteMemoryReaderTest, ReadsChildProcess) {
+    int ready[2];
+    int done[2];
+    ASSERT_EQ(pipe(ready), 0);
+    ASSERT_EQ(pipe(done), 0);
+
+    // The child inherits the mapping and changes it, so the parent can tell
+    // the two address spaces apart
+    pid_t child = fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) {
+        mapping.data()[100] = 0x5a;
+        char byte = 0;
+        (void)!write(ready[1], &byte, 1);
+        (void)!read(done[0], &byte, 1);
+        _exit(0);
+    }
+
+    char byte = 0;
+    ASSERT_EQ(read(ready[0], &byte, 1), 1);
+    mapping.data()[100] = 0xa5;
+
+    RemoteMemoryReader reader(child);
+    uint8_t value = 0;
+    auto result = reader.read(mapping.address() + 100, &value, sizeof(value));
+
+    ASSERT_EQ(write(done[1], &byte, 1), 1);
+    waitpid(child, nullptr, 0);
+    for (int fd : {ready[0], ready[1], done[0], done[1]}) {
+        close(fd);
+    }
+
+    if (result.hasError() && result.getError() == ErrorCode::PERMISSION_DENIED) {
+        GTEST_SKIP() << "Reading the child is not permitted: " << result.getErrorMessage();
+    }
+    ASSERT_TRUE(result.isSuccess()) << result.getErrorMessage();
+    EXPECT_EQ(value, 0x5a);
+}
+
+TEST(RemoteMemoryReaderProcessTest, MissingProcess) {
+    RemoteMemoryReader reader(0x7ffffffe);
+    uint8_t buffer[8];
+    auto result = reader.read(0x1000, buffer, sizeof(buffer));
+    ASSERT_TRUE(result.hasError());
+    EXPECT_EQ(result.getError(), ErrorCode::PROCESS_NOT_FOUND);
+}
+
+#else
+
+TEST(RemoteMemoryReaderProcessTest, NotSupported) {
+    RemoteMemoryReader reader(1);
+    uint8_t buffer[8];
+    EXPECT_TRUE(reader.read(0x1000, buffer, sizeof(buffer)).hasError());
+}
+
+#endif
@@ -0,0 +1,130 @@
+/**
+ * @file test_symbol_index.cpp
+ * @brief Unit tests for SymbolIndex
+ */
+
+#include <gtest/gtest.h>
+
+#include <dlfcn.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <string>
+
+#include "utility/ModuleIndex.h"
+#include "utility/SymbolIndex.h"
+
+using namespace AnalysisToolkit;
+
+namespace {
+
+__attribute__((noinline)) int symbol_index_test_function(int value) {
+    return value * 3 + 1;
+}
+
+}  // namespace
+
+class SymbolIndexTest : public ::testing::Test {
+  protected:
+    // Module that defines getpid(), as resolved by the dynamic loader
+    std::string libcName() {
+        void* address = dlsym(RTLD_DEFAULT, "getpid");
+        if (address == nullptr) {
+            return {};
+        }
+        auto module = modules.findModuleContaining(reinterpret_cast<uintptr_t>(address));
+        return module ? module->path : std::string();
+    }
+
+    ModuleIndex modules;
+    SymbolIndex index{modules};
+};
+
+// Test that exported symbols resolve to the same address as dlsym
+TEST_F(SymbolIndexTest, FindSymbolMatchesDlsym) {
+#if defined(__linux__)
+    std::string libc = libcName();
+    ASSERT_FALSE(libc.empty());
+
+    auto address = index.findSymbol(libc, "getpid");
+    ASSERT_TRUE(address.has_value());
+    EXPECT_EQ(*address, reinterpret_cast<uintptr_t>(dlsym(RTLD_DEFAULT, "getpid")));
+    EXPECT_FALSE(index.findSymbol(libc, "nonexistent_symbol_12345").has_value());
+#else
+    GTEST_SKIP() << "Symbol index requires ELF modules";
+#endif
+}
+
+// Test that a bulk lookup parses the module once and reports misses as 0
+TEST_F(SymbolIndexTest, BulkLookup) {
+#if defined(__linux__)
+    std::string libc = libcName();
+    ASSERT_FALSE(libc.empty());
+
+    auto addresses = index.findSymbols(libc, {"getpid", "nonexistent_symbol_12345", "getppid"});
+    ASSERT_EQ(addresses.size(), 3u);
+    EXPECT_EQ(addresses[0], reinterpret_cast<uintptr_t>(dlsym(RTLD_DEFAULT, "getpid")));
+    EXPECT_EQ(addresses[1], 0u);
+    EXPECT_EQ(addresses[2], reinterpret_cast<uintptr_t>(dlsym(RTLD_DEFAULT, "getppid")));
+
+    index.findSymbol(libc, "getpid");
+    EXPECT_EQ(index.getParseCount(), 1u);
+#else
+    GTEST_SKIP() << "Symbol index requires ELF modules";
+#endif
+}
+
+// Test address-to-symbol lookup, including local symbols from .symtab
+TEST_F(SymbolIndexTest, ReverseLookup) {
+#if defined(__linux__)
+    EXPECT_EQ(symbol_index_test_function(1), 4);
+    auto address = reinterpret_cast<uintptr_t>(&symbol_index_test_function);
+
+    auto symbol = index.findSymbolContaining(address + 1);
+    ASSERT_TRUE(symbol.has_value());
+    EXPECT_NE(symbol->name.find("symbol_index_test_function"), std::string::npos);
+    EXPECT_EQ(symbol->address, address);
+    EXPECT_TRUE(symbol->contains(address + 1));
+    EXPECT_FALSE(symbol->module_path.empty());
+
+    EXPECT_FALSE(index.findSymbolContaining(0).has_value());
+#else
+    GTEST_SKIP() << "Symbol index requires ELF modules";
+#endif
+}
+
+// Test that a second index reuses the persisted table instead of parsing
+TEST_F(SymbolIndexTest, PersistentCacheSkipsParse) {
+#if defined(__linux__)
+    std::string libc = libcName();
+    ASSERT_FALSE(libc.empty());
+
+    char directory[] = "/tmp/atkit_symidx_XXXXXX";
+    ASSERT_NE(mkdtemp(directory), nullptr);
+
+    index.setCacheDirectory(directory);
+    auto first = index.findSymbol(libc, "getpid");
+    ASSERT_TRUE(first.has_value());
+    EXPECT_EQ(index.getParseCount(), 1u);
+
+    SymbolIndex restarted(modules);
+    restarted.setCacheDirectory(directory);
+    auto second = restarted.findSymbol(libc, "getpid");
+    ASSERT_TRUE(second.has_value());
+    EXPECT_EQ(*second, *first);
+    EXPECT_EQ(restarted.getParseCount(), 0u);
+
+    std::string command = std::string("rm -rf ") + directory;
+    EXPECT_EQ(system(command.c_str()), 0);
+#else
+    GTEST_SKIP() << "Symbol index requires ELF modules";
+#endif
+}
+
+// Test that unknown modules are reported as missing
+TEST_F(SymbolIndexTest, UnknownModule) {
+    EXPECT_FALSE(index.findSymbol("libdoes_not_exist_12345.so", "getpid").has_value());
+    auto addresses = index.findSymbols("libdoes_not_exist_12345.so", {"getpid"});
+    ASSERT_EQ(addresses.size(), 1u);
+    EXPECT_EQ(addresses[0], 0u);
+}